@@ -0,0 +1,164 @@
+/*
+    bench.h - Tiny timing harness for the bench/ programs.
+    Each benchmark is a callback doing one operation. bench_run calibrates how many
+    calls make a sample of at least BENCH_MIN_SAMPLE_US, runs the warmup samples,
+    then times the repetitions and prints the median and p99 time per operation
+    and, given the bytes one operation processes, the rate at the median.
+
+    Command line (bench_init): -r N repetitions, -w N warmup samples, -q quick
+    (few repetitions, for smoke runs), and a substring filter on benchmark names.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__GNUC__)
+#define BENCH_UNUSED __attribute__((unused))
+#else
+#define BENCH_UNUSED
+#endif
+
+#ifndef BENCH_MAX_REPS
+#define BENCH_MAX_REPS 1000
+#endif
+#ifndef BENCH_MIN_SAMPLE_US
+#define BENCH_MIN_SAMPLE_US 200
+#endif
+
+/* One operation; user is the pointer passed to bench_run. */
+typedef void (*bench_fn)(void *user);
+
+typedef struct {
+    double median_ns;   /* per operation */
+    double p99_ns;
+    double min_ns;
+    long   iters;       /* operations per sample */
+} bench_result;
+
+static int         g_bench_reps = 100;
+static int         g_bench_warmup = 5;
+static const char *g_bench_filter;
+
+/* Benchmarks store results here so the work is not optimised away. */
+static volatile size_t g_bench_sink;
+
+static double g_bench_samples[BENCH_MAX_REPS];
+
+/* Monotonic clock in nanoseconds. */
+static double bench_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+BENCH_UNUSED static void bench_init(int argc, char **argv) {
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) g_bench_reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) g_bench_warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-q") == 0) { g_bench_reps = 5; g_bench_warmup = 1; }
+        else g_bench_filter = argv[i];
+    }
+    if (g_bench_reps < 1) g_bench_reps = 1;
+    if (g_bench_reps > BENCH_MAX_REPS) g_bench_reps = BENCH_MAX_REPS;
+    if (g_bench_warmup < 0) g_bench_warmup = 0;
+}
+
+/* 1 when name passes the command-line filter (suites can skip their setup too). */
+BENCH_UNUSED static int bench_enabled(const char *name) {
+    return !g_bench_filter || strstr(name, g_bench_filter) != NULL;
+}
+
+static double bench_sample(bench_fn fn, void *user, long iters) {
+    double t0 = bench_now_ns();
+    long i;
+
+    for (i = 0; i < iters; i++) fn(user);
+    return bench_now_ns() - t0;
+}
+
+static int bench_cmp(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+BENCH_UNUSED static void bench_header(const char *title) {
+    printf("\n%s\n%-40s %12s %12s %14s\n", title, "benchmark", "median", "p99", "rate");
+}
+
+static void bench_print_time(double ns) {
+    if (ns < 1e3) printf(" %9.1f ns", ns);
+    else if (ns < 1e6) printf(" %9.2f us", ns / 1e3);
+    else printf(" %9.2f ms", ns / 1e6);
+}
+
+/*
+    Times fn and prints one line. bytes: processed by one call (0: print calls per
+    second instead). ops: operations one call stands for (e.g. lookups in a batch),
+    so times are per operation; 0 counts as 1.
+*/
+BENCH_UNUSED static bench_result bench_run_n(const char *name, bench_fn fn, void *user,
+                                             double bytes, long ops) {
+    bench_result r;
+    long iters = 1;
+    double t, per;
+    int i, n = g_bench_reps;
+
+    memset(&r, 0, sizeof(r));
+    if (!bench_enabled(name)) return r;
+    if (ops < 1) ops = 1;
+
+    /* calibrate: smallest power of two that fills a sample */
+    while ((t = bench_sample(fn, user, iters)) < BENCH_MIN_SAMPLE_US * 1e3 && iters < (1L << 30))
+        iters *= 2;
+    for (i = 0; i < g_bench_warmup; i++) (void)bench_sample(fn, user, iters);
+    for (i = 0; i < n; i++) g_bench_samples[i] = bench_sample(fn, user, iters) / (double)(iters * ops);
+    qsort(g_bench_samples, (size_t)n, sizeof(double), bench_cmp);
+
+    r.iters = iters;
+    r.min_ns = g_bench_samples[0];
+    r.median_ns = n & 1 ? g_bench_samples[n / 2]
+                        : (g_bench_samples[n / 2 - 1] + g_bench_samples[n / 2]) / 2;
+    r.p99_ns = g_bench_samples[(n * 99 + 99) / 100 - 1];
+
+    printf("%-40s", name);
+    bench_print_time(r.median_ns);
+    bench_print_time(r.p99_ns);
+    per = r.median_ns > 0 ? 1e9 / r.median_ns : 0;
+    if (bytes > 0) {
+        per *= bytes / (double)ops;
+        if (per >= 1e9) printf(" %9.2f GB/s\n", per / 1e9);
+        else printf(" %9.1f MB/s\n", per / 1e6);
+    } else if (per >= 1e6) {
+        printf(" %9.2f M/s\n", per / 1e6);
+    } else {
+        printf(" %9.1f k/s\n", per / 1e3);
+    }
+    fflush(stdout);
+    return r;
+}
+
+BENCH_UNUSED static bench_result bench_run(const char *name, bench_fn fn, void *user, double bytes) {
+    return bench_run_n(name, fn, user, bytes, 1);
+}
+
+#endif /* BENCH_H */
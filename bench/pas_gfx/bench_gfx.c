@@ -0,0 +1,192 @@
+/*
+    bench_gfx.c - Fill, blend and text rates of pas_gfx at 1080p and 4K.
+    From repo root: gcc -O2 -o bench/pas_gfx/bench_gfx bench/pas_gfx/bench_gfx.c -I.
+    pas_gfx_text runs through tests/pas_gfx/fake_truetype.h (layout, glyph cache and blending,
+    no real rasterizer). For a real font add -DBENCH_STB_TRUETYPE with stb_truetype.h on the
+    include path; it loads data/font.ttf, or the file named by BENCH_TTF.
+    Fill and blend rates are framebuffer bytes written per second, text rates glyphs per second.
+*/
+
+#ifdef BENCH_STB_TRUETYPE
+#define STB_TRUETYPE_IMPLEMENTATION
+#else
+#define PAS_GFX_STB_TRUETYPE_PATH "tests/pas_gfx/fake_truetype.h"
+#endif
+#define PAS_GFX_USE_STB_TRUETYPE
+#define PAS_GFX_IMPLEMENTATION
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_gfx.h"
+#include "bench/bench.h"
+
+#define MAX_W 3840
+#define MAX_H 2160
+#define MASK  256   /* alpha mask tiled over the screen */
+#define RECTS 256   /* small rects per call */
+
+static uint32_t g_pixels[MAX_W * MAX_H];
+static uint8_t g_mask[MASK * MASK];
+static pas_gfx_glyph_t g_glyphs[512];
+static uint8_t g_atlas[1u << 20];
+static unsigned char g_ttf[1u << 24];
+
+static const char g_line[] =
+    "The quick brown fox jumps over the lazy dog. 0123456789 (){}[] <=> +-*/ ?!;: #$%&@ abcdefghij";
+
+static unsigned long g_seed = 1234;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+typedef struct {
+    pas_gfx_fb_t fb;
+    int          w, h;
+    int          rx[RECTS], ry[RECTS];
+    uint32_t     color;
+    pas_font_t  *font;
+    int          line_h;
+    long         glyphs;   /* drawn by one text call */
+} scene;
+
+/* --- benchmarks --- */
+
+static void run_clear(void *u)
+{
+    scene *s = (scene *)u;
+    pas_gfx_rect(&s->fb, 0, 0, s->w, s->h, s->color);
+}
+
+static void run_rects(void *u)
+{
+    scene *s = (scene *)u;
+    int i;
+
+    for (i = 0; i < RECTS; i++) pas_gfx_rect(&s->fb, s->rx[i], s->ry[i], 64, 64, s->color);
+}
+
+/* The mask tiled over the whole fb, clipped at the right and bottom edges. */
+static void run_blend(void *u)
+{
+    scene *s = (scene *)u;
+    int x, y;
+
+    for (y = 0; y < s->h; y += MASK)
+        for (x = 0; x < s->w; x += MASK)
+            pas_gfx_bitmap(&s->fb, x, y, g_mask, MASK, MASK, s->color);
+}
+
+static void run_text_mono(void *u)
+{
+    scene *s = (scene *)u;
+    int y;
+
+    for (y = 0; y + s->line_h <= s->h; y += s->line_h)
+        pas_gfx_text_mono(&s->fb, 0, y, g_line, s->color, s->line_h / 9);
+}
+
+static void run_text(void *u)
+{
+    scene *s = (scene *)u;
+    int y;
+
+    for (y = 0; y + s->line_h <= s->h; y += s->line_h)
+        pas_gfx_text(&s->fb, s->font, 0, y, g_line, s->color);
+}
+
+/* Glyphs one text call draws: lines that fit times the characters of a line that fit. */
+static long text_glyphs(int w, int h, int line_h, int advance)
+{
+    long per_line = (long)(w / advance);
+    if (per_line > (long)sizeof(g_line) - 1) per_line = (long)sizeof(g_line) - 1;
+    return (long)(h / line_h) * per_line;
+}
+
+static pas_font_t *load_font(void)
+{
+#ifdef BENCH_STB_TRUETYPE
+    const char *path = getenv("BENCH_TTF");
+    FILE *f = fopen(path ? path : "data/font.ttf", "rb");
+    size_t n;
+
+    if (!f) return NULL;
+    n = fread(g_ttf, 1, sizeof(g_ttf), f);
+    fclose(f);
+    if (!n) return NULL;
+#endif
+    return pas_gfx_font_open(g_ttf, 20.0f);
+}
+
+static void bench_size(scene *s, int w, int h)
+{
+    static pas_gfx_glyph_cache_t cache;
+    double px = (double)w * h * 4;
+    char label[64], title[64];
+    int i;
+
+    s->w = w;
+    s->h = h;
+    (void)pas_gfx_fb_init(&s->fb, g_pixels, w, h, w);
+    for (i = 0; i < RECTS; i++) {
+        s->rx[i] = (int)rnd((unsigned)(w - 64));
+        s->ry[i] = (int)rnd((unsigned)(h - 64));
+    }
+    sprintf(title, "%dx%d", w, h);
+    bench_header(title);
+
+    s->color = PAS_GFX_RGBA(0xFF, 0x20, 0x40, 0x60);
+    sprintf(label, "rect/clear/%dx%d", w, h);
+    (void)bench_run(label, run_clear, s, px);
+    sprintf(label, "rect/64x64/%dx%d", w, h);
+    (void)bench_run_n(label, run_rects, s, 64.0 * 64 * 4 * RECTS, RECTS);
+
+    s->color = PAS_GFX_RGBA(0xC0, 0xF0, 0x80, 0x10);
+    sprintf(label, "bitmap/straight/%dx%d", w, h);
+    (void)bench_run(label, run_blend, s, px);
+    s->fb.flags = PAS_GFX_FB_PREMULTIPLIED;
+    s->color = pas_gfx_premultiply(s->color);
+    sprintf(label, "bitmap/premultiplied/%dx%d", w, h);
+    (void)bench_run(label, run_blend, s, px);
+    s->fb.flags = 0;
+
+    s->color = PAS_GFX_WHITE;
+    for (i = 1; i <= 2; i++) {
+        s->line_h = 9 * i;
+        sprintf(label, "text_mono/scale%d/%dx%d", i, w, h);
+        (void)bench_run_n(label, run_text_mono, s, 0, text_glyphs(w, h, s->line_h, 6 * i));
+    }
+
+    if (s->font) {
+        pas_gfx_glyph_cache_init(&cache, g_glyphs, (int)(sizeof(g_glyphs) / sizeof(g_glyphs[0])),
+                                 g_atlas, sizeof(g_atlas));
+        s->line_h = 24;
+        s->glyphs = (long)(h / s->line_h) * (long)(sizeof(g_line) - 1);
+        s->font->cache = NULL;
+        sprintf(label, "text/uncached/%dx%d", w, h);
+        (void)bench_run_n(label, run_text, s, 0, s->glyphs);
+        s->font->cache = &cache;
+        sprintf(label, "text/cached/%dx%d", w, h);
+        (void)bench_run_n(label, run_text, s, 0, s->glyphs);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static scene s;
+    int i;
+
+    bench_init(argc, argv);
+    for (i = 0; i < MASK * MASK; i++) {
+        /* glyph-like coverage: empty and solid runs with ramps between them */
+        int v = (i % MASK + (i / MASK) * 3) % 96;
+        g_mask[i] = (uint8_t)(v < 32 ? 0 : v < 48 ? (v - 32) * 16 : v < 80 ? 255 : (95 - v) * 16);
+    }
+    s.font = load_font();
+    if (!s.font) printf("no font: pas_gfx_text skipped\n");
+
+    printf("pas_gfx: %d-pixel alpha mask tiles, %d 64x64 rects per call\n", MASK, RECTS);
+    bench_size(&s, 1920, 1080);
+    bench_size(&s, MAX_W, MAX_H);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+    bench_unicode.c - Throughput of the pas_unicode buffer calls over ASCII, CJK and mixed-script text.
+    From repo root: gcc -O2 -o bench/pas_unicode/bench_unicode bench/pas_unicode/bench_unicode.c -I.
+    Also build with -mavx2 and -DPASU_NO_SIMD to compare the paths. Rates are input bytes per second.
+*/
+
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_unicode.h"
+#include "bench/bench.h"
+
+#define CORPUS (1u << 20)   /* bytes of UTF-8 per corpus */
+
+static pasu_uint8 g_u8[CORPUS];
+static pasu_uint16 g_u16[CORPUS];
+static pasu_uint16 g_out16[CORPUS];
+static pasu_uint8 g_out8[CORPUS];
+
+static unsigned long g_seed = 4242;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+/* --- corpora: whole UTF-8 sequences up to CORPUS bytes --- */
+
+enum { ASCII, CJK, MIXED };
+
+static pasu_codepoint next_cp(int kind, unsigned *script, unsigned *run)
+{
+    if (kind == ASCII)
+        return rnd(7) == 0 ? (rnd(9) == 0 ? '\n' : ' ') : 'a' + rnd(26);
+    if (kind == CJK)
+        return rnd(40) == 0 ? 0x3002 : 0x4E00 + rnd(0x5000);
+    /* mixed: runs by script, like the tests' generator */
+    if (*run == 0) {
+        *script = rnd(5);
+        *run = 1 + rnd(24);
+    }
+    --*run;
+    switch (*script) {
+    case 0:  return 0x20 + rnd(0x5F);
+    case 1:  return rnd(3) ? 0x20 + rnd(0x5F) : 0xC0 + rnd(0x40);
+    case 2:  return rnd(5) ? 0x410 + rnd(0x40) : 0x20;
+    case 3:  return 0x4E00 + rnd(0x5000);
+    default: return 0x1F600 + rnd(0x50);
+    }
+}
+
+static pasu_size gen_corpus(int kind, pasu_uint8 *dst)
+{
+    pasu_size n = 0, used;
+    unsigned script = 0, run = 0;
+    pasu_uint8 tmp[4];
+
+    for (;;) {
+        (void)pasu_utf8_encode(next_cp(kind, &script, &run), tmp, &used);
+        if (n + used > CORPUS) break;
+        memcpy(dst + n, tmp, used);
+        n += used;
+    }
+    return n;
+}
+
+/* --- benchmarks --- */
+
+typedef struct {
+    pasu_size n8, n16;
+} job;
+
+static void run_to_utf16(void *u)
+{
+    job *j = (job *)u;
+    g_bench_sink += pasu_utf8_to_utf16(g_u8, j->n8, g_out16, CORPUS, NULL);
+}
+
+static void run_to_utf16_size(void *u)
+{
+    job *j = (job *)u;
+    g_bench_sink += pasu_utf8_to_utf16_size(g_u8, j->n8, NULL);
+}
+
+static void run_length(void *u)
+{
+    job *j = (job *)u;
+    g_bench_sink += pasu_utf8_length(g_u8, j->n8, NULL);
+}
+
+static void run_validate(void *u)
+{
+    job *j = (job *)u;
+    g_bench_sink += pasu_utf8_validate(g_u8, j->n8, NULL);
+}
+
+static void run_to_utf8(void *u)
+{
+    job *j = (job *)u;
+    g_bench_sink += pasu_utf16_to_utf8(g_u16, j->n16, g_out8, CORPUS, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *names[] = { "ascii", "cjk", "mixed" };
+    char label[64];
+    pasu_status st;
+    job j;
+    int kind;
+
+    bench_init(argc, argv);
+    printf("pas_unicode: %u KiB corpora, rates in UTF-8 bytes per second", CORPUS >> 10);
+#if defined(PASU__AVX2)
+    printf(" (AVX2)\n");
+#elif defined(PASU__SSSE3)
+    printf(" (SSSE3)\n");
+#elif defined(PASU__SSE2)
+    printf(" (SSE2)\n");
+#elif defined(PASU__NEON)
+    printf(" (NEON)\n");
+#else
+    printf(" (scalar)\n");
+#endif
+
+    for (kind = ASCII; kind <= MIXED; ++kind) {
+        j.n8 = gen_corpus(kind, g_u8);
+        j.n16 = pasu_utf8_to_utf16(g_u8, j.n8, g_u16, CORPUS, &st);
+        if (st != PASU_OK) {
+            fprintf(stderr, "corpus %s: conversion failed (%d)\n", names[kind], (int)st);
+            return 1;
+        }
+        bench_header(names[kind]);
+        sprintf(label, "utf8_to_utf16/%s", names[kind]);
+        (void)bench_run(label, run_to_utf16, &j, (double)j.n8);
+        sprintf(label, "utf8_to_utf16_size/%s", names[kind]);
+        (void)bench_run(label, run_to_utf16_size, &j, (double)j.n8);
+        sprintf(label, "utf8_length/%s", names[kind]);
+        (void)bench_run(label, run_length, &j, (double)j.n8);
+        sprintf(label, "utf8_validate/%s", names[kind]);
+        (void)bench_run(label, run_validate, &j, (double)j.n8);
+        sprintf(label, "utf16_to_utf8/%s", names[kind]);
+        (void)bench_run(label, run_to_utf8, &j, (double)j.n8);
+    }
+    return 0;
+}
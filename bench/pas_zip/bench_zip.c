@@ -0,0 +1,165 @@
+/*
+    bench_zip.c - Lookup and extract rates on synthetic Store archives of 10, 1000, 10k and 100k entries.
+    From repo root: gcc -O2 -o bench/pas_zip/bench_zip bench/pas_zip/bench_zip.c -I.
+    Lookups are timed in batches of random names (hits); rates are lookups, indexed
+    entries or payload bytes per second.
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include "bench/bench.h"
+
+#define MAX_ENTRIES 100000
+#define ENTRY_SIZE  64           /* payload of the small entries */
+#define BIG_SIZE    (1u << 22)  /* one large entry for the Store copy rate */
+#define LOOKUPS     256          /* random names per batch */
+
+static char g_names[MAX_ENTRIES][24];
+static const char *g_name_ptrs[MAX_ENTRIES + 1];
+static const void *g_data_ptrs[MAX_ENTRIES + 1];
+static size_t g_sizes[MAX_ENTRIES + 1];
+static unsigned char g_payload[ENTRY_SIZE * 256];
+static unsigned char g_big[BIG_SIZE];
+static unsigned char g_archive[MAX_ENTRIES * 192 + BIG_SIZE + 4096];
+static unsigned char g_out[BIG_SIZE];
+static uint32_t g_index[1u << 19];
+
+static unsigned long g_seed = 777;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)(((g_seed >> 16) & 0x7FFFu) << 15 | ((g_seed >> 1) & 0x7FFFu)) % n;
+}
+
+typedef struct {
+    pas_zip_t       zip;
+    int             count;
+    int             linear_batch;   /* names per batch when walking the central directory */
+    const char     *lookup[LOOKUPS];
+    pas_zip_file_t  files[LOOKUPS];
+    pas_zip_file_t  big;
+    char            title[64];
+} suite;
+
+/* count small entries plus "big.bin" last, so it sits at the end of the central directory. */
+static int build(suite *s, int count)
+{
+    pas_zip_status st;
+    size_t len;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        g_name_ptrs[i] = g_names[i];
+        g_data_ptrs[i] = g_payload + (size_t)(i & 255) * ENTRY_SIZE;
+        g_sizes[i] = ENTRY_SIZE;
+    }
+    g_name_ptrs[count] = "big.bin";
+    g_data_ptrs[count] = g_big;
+    g_sizes[count] = BIG_SIZE;
+    len = pas_zip_create(g_name_ptrs, g_data_ptrs, g_sizes, count + 1, g_archive, sizeof(g_archive), &st);
+    if (!len || pas_zip_init(&s->zip, g_archive, len) != PAS_ZIP_OK) {
+        fprintf(stderr, "%d entries: create/init failed (%d)\n", count, st);
+        return 0;
+    }
+    s->count = count;
+    s->linear_batch = count >= 10000 ? 4 : LOOKUPS;
+    for (i = 0; i < LOOKUPS; i++) {
+        s->lookup[i] = g_names[rnd((unsigned)count)];
+        if (pas_zip_find_file(&s->zip, s->lookup[i], &s->files[i]) != PAS_ZIP_OK) return 0;
+    }
+    if (pas_zip_find_file(&s->zip, "big.bin", &s->big) != PAS_ZIP_OK) return 0;
+    sprintf(s->title, "%d entries, %lu KiB archive", count, (unsigned long)(len >> 10));
+    return 1;
+}
+
+/* --- benchmarks --- */
+
+static void run_find_linear(void *u)
+{
+    suite *s = (suite *)u;
+    int i;
+
+    for (i = 0; i < s->linear_batch; i++)
+        g_bench_sink += (size_t)pas_zip_find(&s->zip, s->lookup[i]);
+}
+
+static void run_find(void *u)
+{
+    suite *s = (suite *)u;
+    int i;
+
+    for (i = 0; i < LOOKUPS; i++)
+        g_bench_sink += (size_t)pas_zip_find(&s->zip, s->lookup[i]);
+}
+
+static void run_find_file(void *u)
+{
+    suite *s = (suite *)u;
+    pas_zip_file_t f;
+    int i;
+
+    for (i = 0; i < LOOKUPS; i++)
+        g_bench_sink += (size_t)pas_zip_find_file(&s->zip, s->lookup[i], &f) + f.name_len;
+}
+
+static void run_extract_small(void *u)
+{
+    suite *s = (suite *)u;
+    int i;
+
+    for (i = 0; i < LOOKUPS; i++)
+        g_bench_sink += pas_zip_extract(&s->files[i], g_out, sizeof(g_out), NULL);
+}
+
+static void run_extract_big(void *u)
+{
+    suite *s = (suite *)u;
+    g_bench_sink += pas_zip_extract(&s->big, g_out, sizeof(g_out), NULL);
+}
+
+static void run_index_build(void *u)
+{
+    suite *s = (suite *)u;
+    g_bench_sink += (size_t)pas_zip_index_build(&s->zip, g_index, sizeof(g_index));
+}
+
+int main(int argc, char **argv)
+{
+    static const int counts[] = { 10, 1000, 10000, MAX_ENTRIES };
+    static suite s;
+    char label[64];
+    size_t i;
+    int c;
+
+    bench_init(argc, argv);
+    for (i = 0; i < sizeof(g_payload); i++) g_payload[i] = (unsigned char)(i * 7 + (i >> 5));
+    for (i = 0; i < sizeof(g_big); i++) g_big[i] = (unsigned char)(i * 31 + (i >> 9));
+    for (c = 0; c < MAX_ENTRIES; c++) sprintf(g_names[c], "dir%03d/file%06d.dat", c % 997, c);
+
+    printf("pas_zip: Store archives, %d-byte entries plus one %u KiB entry\n", ENTRY_SIZE, BIG_SIZE >> 10);
+    for (c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+        if (!build(&s, counts[c])) return 1;
+        bench_header(s.title);
+
+        sprintf(label, "find/linear/%d", counts[c]);
+        (void)bench_run_n(label, run_find_linear, &s, 0, s.linear_batch);
+        sprintf(label, "index_build/%d", counts[c]);
+        (void)bench_run_n(label, run_index_build, &s, 0, counts[c]);
+        if (pas_zip_index_build(&s.zip, g_index, sizeof(g_index)) != PAS_ZIP_OK) {
+            fprintf(stderr, "index_build failed\n");
+            return 1;
+        }
+        sprintf(label, "find/indexed/%d", counts[c]);
+        (void)bench_run_n(label, run_find, &s, 0, LOOKUPS);
+        sprintf(label, "find_file/indexed/%d", counts[c]);
+        (void)bench_run_n(label, run_find_file, &s, 0, LOOKUPS);
+        sprintf(label, "extract/%d-byte/%d", ENTRY_SIZE, counts[c]);
+        (void)bench_run_n(label, run_extract_small, &s, (double)ENTRY_SIZE * LOOKUPS, LOOKUPS);
+        if (c == 0) {
+            sprintf(label, "extract/%u-KiB", BIG_SIZE >> 10);
+            (void)bench_run(label, run_extract_big, &s, BIG_SIZE);
+        }
+    }
+    return 0;
+}
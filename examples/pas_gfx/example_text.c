@@ -1,5 +1,5 @@
 /*
-    example_text.c - TTF text via stb_truetype; multiline and kerning.
+    example_text.c - TTF text via stb_truetype; multiline, kerning, UTF-8, glyph cache.
     Requires: data/font.ttf and -DPAS_GFX_USE_STB_TRUETYPE, stb_truetype.h in include path.
     From repo root: gcc -o examples/pas_gfx/example_text examples/pas_gfx/example_text.c -I. -DPAS_GFX_USE_STB_TRUETYPE
 */
@@ -7,6 +7,7 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #define PAS_GFX_USE_STB_TRUETYPE
 #define PAS_GFX_IMPLEMENTATION
+#define PAS_UNICODE_IMPLEMENTATION
 #include "pas_gfx.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -69,6 +70,9 @@ int main(void)
 {
 #ifdef PAS_GFX_USE_STB_TRUETYPE
     static uint32_t pixels[W * H];
+    static pas_gfx_glyph_t glyphs[128];
+    static uint8_t atlas[64 * 1024];
+    pas_gfx_glyph_cache_t cache;
     pas_gfx_fb_t *fb;
     pas_font_t *font;
     unsigned char *ttf_data;
@@ -93,6 +97,10 @@ int main(void)
         return 1;
     }
 
+    /* glyphs are rasterized once into the atlas, then blitted */
+    pas_gfx_glyph_cache_init(&cache, glyphs, 128, atlas, sizeof(atlas));
+    font->cache = &cache;
+
     pas_gfx_rect(fb, 0, 0, W, H, PAS_GFX_WHITE);
 
     /* Multiline text */
@@ -101,6 +109,8 @@ int main(void)
     /* Kerning demo: "AVA" and "To" show kerning */
     pas_gfx_text(fb, font, 20, 150, "AVA Tea", PAS_GFX_BLUE);
     pas_gfx_text(fb, font, 20, 200, "Typography", PAS_GFX_RED);
+    pas_gfx_text(fb, font, 20, 250, "Gr\xC3\xBC\xC3\x9F \xE2\x82\xAC 5", PAS_GFX_BLACK);   /* UTF-8 */
+    printf("glyph cache: %lu hits, %lu misses\n", cache.hits, cache.misses);
 
     if (save_ppm_raw("example_text.ppm", pixels, W, H, PITCH) != 0) {
         fprintf(stderr, "Failed to write example_text.ppm\n");
@@ -3,7 +3,17 @@
 
     - No malloc: works with user-supplied framebuffer memory
     - No OS/window dependencies: pure software rasterizer into 32-bit RGBA
-    - Optional stb_truetype integration (define PAS_GFX_USE_STB_TRUETYPE and have stb_truetype.h available)
+    - Optional stb_truetype integration (define PAS_GFX_USE_STB_TRUETYPE and have stb_truetype.h available;
+      UTF-8 text is decoded with pas_unicode.h, so define PAS_UNICODE_IMPLEMENTATION in one TU as well)
+    - Optional glyph cache for TTF text in a caller-supplied atlas (LRU, kerning pairs memoised)
+    - Fills are clipped once and written as row spans (AVX2 / SSE2 / NEON when the
+      compiler targets them, scalar otherwise; define PAS_GFX_NO_SIMD to force scalar)
+    - Optional damage tracking: a bounded, self-merging list of changed rectangles per fb
+    - Any number of caller-owned framebuffers, each with a clip-rectangle stack
+    - Command lists: record primitives, then replay them per screen tile (on worker
+      threads with PAS_GFX_USE_THREADS: pthreads, or Win32 threads on _WIN32)
+    - Alpha-mask blits blend 4 or 8 pixels per step with the same exact rounding as the
+      scalar path; straight or premultiplied alpha per framebuffer
 
     Usage:
         In ONE translation unit:
@@ -37,27 +47,130 @@ extern "C" {
 #define PAS_GFX_MAGENTA PAS_GFX_RGBA(0xFF,0xFF,0x00,0xFF)
 #define PAS_GFX_GRAY    PAS_GFX_RGBA(0xFF,0x80,0x80,0x80)
 
+typedef struct pas_gfx_rect {
+    int x, y, w, h;
+} pas_gfx_rect_t;
+
+/*
+    Damage list over a caller array. Primitives add their clipped bounds. A rect
+    joins an existing one when their union is no larger than the two apart, and
+    when the list is full the new rect is merged into the one it grows least, so
+    count never passes capacity and every changed pixel is inside some rect.
+*/
+typedef struct pas_gfx_damage {
+    pas_gfx_rect_t *rects;
+    int             capacity;
+    int             count;
+} pas_gfx_damage_t;
+
+/* One recorded primitive; the pointers must stay valid until the list is replayed. */
+typedef struct pas_gfx_cmd {
+    int         op;
+    int         a, b, c, d, e;
+    uint32_t    color;
+    const void *p, *q;
+} pas_gfx_cmd_t;
+
+typedef struct pas_gfx_cmdlist {
+    pas_gfx_cmd_t *cmds;       /* caller array */
+    int            capacity;
+    int            count;
+    int            overflow;   /* commands dropped because the list was full */
+} pas_gfx_cmdlist_t;
+
+#ifndef PAS_GFX_CLIP_DEPTH
+#define PAS_GFX_CLIP_DEPTH 8
+#endif
+
 typedef struct pas_gfx_fb {
     uint32_t *pixels;  /* pointer to first pixel (0,0) */
     int       width;   /* width in pixels */
     int       height;  /* height in pixels */
     int       pitch;   /* pixels per row (>= width) */
+    unsigned  flags;   /* PAS_GFX_FB_* */
+    pas_gfx_damage_t  *damage;   /* optional; NULL: not tracked */
+    pas_gfx_cmdlist_t *record;   /* non-NULL: primitives are recorded here, not drawn */
+    int            clip_depth;   /* 0: clip is the whole fb */
+    pas_gfx_rect_t clip_stack[PAS_GFX_CLIP_DEPTH + 1];   /* + the tile level of a replay view */
 } pas_gfx_fb_t;
 
-/* Global singleton framebuffer. Library currently supports one active fb. */
+/* fb->flags: pixels and colors drawn into the fb hold premultiplied alpha */
+#define PAS_GFX_FB_PREMULTIPLIED 1u
+
+/* Caller-owned framebuffer: all fields reset, clip = whole fb. Returns fb. */
+pas_gfx_fb_t *pas_gfx_fb_init(pas_gfx_fb_t *fb, uint32_t *pixels, int width, int height, int pitch);
+/* pas_gfx_fb_init on a library-owned global fb, for single-surface programs. */
 pas_gfx_fb_t *pas_gfx_init(uint32_t *pixels, int width, int height, int pitch);
 
+/*
+    Clip stack: push intersects (x, y, w, h) with the current clip; every primitive
+    draws inside the top. Push returns -1 when PAS_GFX_CLIP_DEPTH deep.
+*/
+int  pas_gfx_clip_push(pas_gfx_fb_t *fb, int x, int y, int w, int h);
+void pas_gfx_clip_pop(pas_gfx_fb_t *fb);
+pas_gfx_rect_t pas_gfx_clip_get(const pas_gfx_fb_t *fb);
+
+/*
+    Command lists: with fb->record = &list, primitives (clip push/pop included) are
+    appended instead of drawn. pas_gfx_replay draws the list into fb one tile at a
+    time, each tile clipped to itself (and to fb's current clip). With
+    PAS_GFX_USE_THREADS, up to threads workers take tiles in parallel; they share
+    no pixels, so no locking. Returns -1 if the list overflowed (what fit is drawn).
+*/
+void pas_gfx_cmdlist_init(pas_gfx_cmdlist_t *list, pas_gfx_cmd_t *cmds, int capacity);
+void pas_gfx_cmdlist_reset(pas_gfx_cmdlist_t *list);
+int  pas_gfx_replay(pas_gfx_fb_t *fb, const pas_gfx_cmdlist_t *list, int tile_w, int tile_h, int threads);
+
 /* Primitives */
 void pas_gfx_pixel(pas_gfx_fb_t *fb, int x, int y, uint32_t color);
 void pas_gfx_line(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t color);
 void pas_gfx_rect(pas_gfx_fb_t *fb, int x, int y, int w, int h, uint32_t color);   /* filled rectangle */
+void pas_gfx_hline(pas_gfx_fb_t *fb, int x, int y, int w, uint32_t color);         /* w pixels right from x */
+void pas_gfx_vline(pas_gfx_fb_t *fb, int x, int y, int h, uint32_t color);         /* h pixels down from y */
 void pas_gfx_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color);      /* outline circle */
 void pas_gfx_bitmap(pas_gfx_fb_t *fb, int x, int y,
                     const uint8_t *bitmap, int w, int h, uint32_t color);          /* 8-bit alpha mask */
 
+/*
+    Filled shapes, drawn as clipped row spans. The disc holds the pixels with
+    dx*dx + dy*dy <= r*r + r, so it covers pas_gfx_circle's outline; the rounded rect
+    uses the same corner arcs, with r clamped to half the shorter side. The polygon
+    is n (x, y) vertex pairs, convex, either winding; pixels whose centers are inside
+    are filled, with shared edges drawn once (a non-convex polygon fills each row
+    between its outermost edges).
+*/
+void pas_gfx_fill_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color);
+void pas_gfx_fill_round_rect(pas_gfx_fb_t *fb, int x, int y, int w, int h, int r, uint32_t color);
+void pas_gfx_fill_polygon(pas_gfx_fb_t *fb, const int *xy, int n, uint32_t color);
+
+/* Anti-aliased line and circle outline (Wu): coverage blended like pas_gfx_bitmap; r < 2^24. */
+void pas_gfx_line_aa(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t color);
+void pas_gfx_circle_aa(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color);
+
+/* Damage tracking: attach with fb->damage = &damage; present damage.rects[0..count), then reset. */
+void pas_gfx_damage_init(pas_gfx_damage_t *damage, pas_gfx_rect_t *rects, int capacity);
+void pas_gfx_damage_reset(pas_gfx_damage_t *damage);
+void pas_gfx_damage_add(pas_gfx_fb_t *fb, int x, int y, int w, int h);   /* pixels written directly */
+
+/* Straight 0xAARRGGBB to premultiplied (each channel scaled by alpha, rounded). */
+uint32_t pas_gfx_premultiply(uint32_t color);
+
 /* stb_truetype integration (optional) */
 #ifdef PAS_GFX_USE_STB_TRUETYPE
+#ifdef PAS_GFX_STB_TRUETYPE_PATH
+#include PAS_GFX_STB_TRUETYPE_PATH   /* e.g. "stb/stb_truetype.h" */
+#else
 #include "stb_truetype.h"
+#endif
+
+#ifndef PAS_GFX_GLYPH_HASH
+#define PAS_GFX_GLYPH_HASH 256   /* glyph cache buckets, power of two */
+#endif
+#ifndef PAS_GFX_KERN_CACHE
+#define PAS_GFX_KERN_CACHE 256   /* memoised kerning pairs, power of two */
+#endif
+
+struct pas_gfx_glyph_cache;
 
 typedef struct pas_font {
     stbtt_fontinfo info;
@@ -66,13 +179,66 @@ typedef struct pas_font {
     int            ascent;
     int            descent;
     int            line_gap;
+    struct pas_gfx_glyph_cache *cache;   /* optional; pas_gfx_font_open sets NULL */
 } pas_font_t;
 
+/* One cached glyph: key (font, size, codepoint), metrics, and its bitmap in the atlas. */
+typedef struct pas_gfx_glyph {
+    const pas_font_t *font;    /* NULL: slot unused */
+    float    size;
+    uint32_t codepoint;
+    int      index;            /* stb_truetype glyph index */
+    int      advance;          /* font units */
+    int      x0, y0;           /* bitmap origin relative to the pen, pixels */
+    int      w, h;             /* bitmap size; w * h bytes at atlas + offset */
+    size_t   offset;
+    uint32_t used;             /* cache clock at last use */
+    int      hash_next;
+    int      atlas_next;       /* next glyph by atlas offset; free list link when unused */
+} pas_gfx_glyph_t;
+
+typedef struct pas_gfx_kern {
+    const pas_font_t *font;    /* NULL: empty */
+    int a, b;                  /* glyph indices */
+    int kern;                  /* font units */
+} pas_gfx_kern_t;
+
+typedef struct pas_gfx_glyph_cache {
+    pas_gfx_glyph_t *glyphs;   /* caller array */
+    int              capacity;
+    uint8_t         *atlas;    /* caller buffer for glyph bitmaps */
+    size_t           atlas_size;
+    int              atlas_head;   /* live glyphs with pixels, by offset */
+    int              free_head;
+    uint32_t         clock;
+    unsigned long    hits, misses, evictions;
+    int              hash[PAS_GFX_GLYPH_HASH];
+    pas_gfx_kern_t   kern[PAS_GFX_KERN_CACHE];
+} pas_gfx_glyph_cache_t;
+
 pas_font_t *pas_gfx_font_open(const uint8_t *ttf_data, float size);
 void pas_gfx_text(pas_gfx_fb_t *fb, pas_font_t *font,
-                  int x, int y, const char *text, uint32_t color);
+                  int x, int y, const char *text, uint32_t color);    /* UTF-8 */
+
+/*
+    Glyph cache over caller memory: glyph slots plus an atlas for their bitmaps.
+    Attach with font->cache = cache. When either runs out the least recently used
+    glyphs are evicted. A glyph bigger than the whole atlas is drawn uncached; uncached
+    glyphs over 128 px are rasterized in 128x128 blocks, skipping blocks outside the clip.
+    Reset after re-opening a font in place (pas_gfx_font_open reuses one pas_font_t).
+*/
+void pas_gfx_glyph_cache_init(pas_gfx_glyph_cache_t *cache, pas_gfx_glyph_t *glyphs, int count,
+                              uint8_t *atlas, size_t atlas_size);
+void pas_gfx_glyph_cache_reset(pas_gfx_glyph_cache_t *cache);
 #endif /* PAS_GFX_USE_STB_TRUETYPE */
 
+/*
+    Built-in 6x8 ASCII font (what window titles and button labels use), each pixel
+    drawn scale x scale (1, or 2/3 for HiDPI). Cells advance 6 * scale, lines 9 * scale;
+    bytes outside 32..126 leave a blank cell. Opaque: set bits are written as color.
+*/
+void pas_gfx_text_mono(pas_gfx_fb_t *fb, int x, int y, const char *text, uint32_t color, int scale);
+
 /* Window primitives (use internal monospace bitmap font for title/label) */
 void pas_gfx_window_frame(pas_gfx_fb_t *fb, int x, int y, int w, int h,
                           const char *title, uint32_t bg_color);
@@ -87,30 +253,330 @@ void pas_gfx_button(pas_gfx_fb_t *fb, int x, int y, int w, int h,
 
 #ifdef PAS_GFX_IMPLEMENTATION
 
+#if !defined(PAS_GFX_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PAS_GFX__AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PAS_GFX__SSE2 1
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#define PAS_GFX__NEON 1
+#endif
+#endif
+
+#ifdef PAS_GFX_USE_THREADS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
+#ifndef PAS_GFX_TILE
+#define PAS_GFX_TILE 128             /* default replay tile edge */
+#endif
+#ifndef PAS_GFX_MAX_THREADS
+#define PAS_GFX_MAX_THREADS 16
+#endif
+#ifndef PAS_GFX_WORKER_DAMAGE
+#define PAS_GFX_WORKER_DAMAGE 16     /* damage rects per replay worker */
+#endif
+
+/* fb->flags, internal: a tile view drawn concurrently with others (shared caches read-only) */
+#define PAS_GFX__FB_SHARED 0x80000000u
+/* fb->flags, internal: a tile view, whose clip stack holds the tile above PAS_GFX_CLIP_DEPTH levels */
+#define PAS_GFX__FB_TILE   0x40000000u
+
+enum {
+    PAS_GFX__OP_PIXEL = 1,
+    PAS_GFX__OP_LINE,
+    PAS_GFX__OP_RECT,
+    PAS_GFX__OP_HLINE,
+    PAS_GFX__OP_VLINE,
+    PAS_GFX__OP_CIRCLE,
+    PAS_GFX__OP_BITMAP,
+    PAS_GFX__OP_TEXT,
+    PAS_GFX__OP_FRAME,
+    PAS_GFX__OP_BUTTON,
+    PAS_GFX__OP_CLIP_PUSH,
+    PAS_GFX__OP_CLIP_POP,
+    PAS_GFX__OP_FILL_CIRCLE,
+    PAS_GFX__OP_FILL_ROUND_RECT,
+    PAS_GFX__OP_FILL_POLYGON,
+    PAS_GFX__OP_LINE_AA,
+    PAS_GFX__OP_CIRCLE_AA,
+    PAS_GFX__OP_TEXT_MONO
+};
+
 /* Internal helpers */
 
 static pas_gfx_fb_t pas_gfx__global_fb;
 
+pas_gfx_fb_t *pas_gfx_fb_init(pas_gfx_fb_t *fb, uint32_t *pixels, int width, int height, int pitch)
+{
+    if (!fb) return NULL;
+    fb->pixels     = pixels;
+    fb->width      = width;
+    fb->height     = height;
+    fb->pitch      = pitch;
+    fb->flags      = 0;
+    fb->damage     = NULL;
+    fb->record     = NULL;
+    fb->clip_depth = 0;
+    return fb;
+}
+
 pas_gfx_fb_t *pas_gfx_init(uint32_t *pixels, int width, int height, int pitch)
 {
-    pas_gfx__global_fb.pixels = pixels;
-    pas_gfx__global_fb.width  = width;
-    pas_gfx__global_fb.height = height;
-    pas_gfx__global_fb.pitch  = pitch;
-    return &pas_gfx__global_fb;
+    return pas_gfx_fb_init(&pas_gfx__global_fb, pixels, width, height, pitch);
+}
+
+/* Appends a command if fb is recording; returns 1 if it did (the caller must not draw). */
+static int pas_gfx__record(pas_gfx_fb_t *fb, int op, int a, int b, int c, int d, int e,
+                           uint32_t color, const void *p, const void *q)
+{
+    pas_gfx_cmdlist_t *list;
+    pas_gfx_cmd_t *cmd;
+
+    if (!fb || !fb->record) return 0;
+    list = fb->record;
+    if (list->count >= list->capacity) {
+        list->overflow++;
+        return 1;
+    }
+    cmd = &list->cmds[list->count++];
+    cmd->op = op;
+    cmd->a = a;
+    cmd->b = b;
+    cmd->c = c;
+    cmd->d = d;
+    cmd->e = e;
+    cmd->color = color;
+    cmd->p = p;
+    cmd->q = q;
+    return 1;
+}
+
+pas_gfx_rect_t pas_gfx_clip_get(const pas_gfx_fb_t *fb)
+{
+    pas_gfx_rect_t r;
+    if (fb->clip_depth > 0) return fb->clip_stack[fb->clip_depth - 1];
+    r.x = 0;
+    r.y = 0;
+    r.w = fb->width;
+    r.h = fb->height;
+    return r;
+}
+
+int pas_gfx_clip_push(pas_gfx_fb_t *fb, int x, int y, int w, int h)
+{
+    pas_gfx_rect_t c, *top;
+    int64_t x0 = x, y0 = y, x1 = x0 + w, y1 = y0 + h;
+
+    if (!fb) return -1;
+    if (pas_gfx__record(fb, PAS_GFX__OP_CLIP_PUSH, x, y, w, h, 0, 0, NULL, NULL)) return 0;
+    if (fb->clip_depth >= PAS_GFX_CLIP_DEPTH + ((fb->flags & PAS_GFX__FB_TILE) ? 1 : 0)) return -1;
+    c = pas_gfx_clip_get(fb);
+    if (x0 < c.x) x0 = c.x;
+    if (y0 < c.y) y0 = c.y;
+    if (x1 > (int64_t)c.x + c.w) x1 = (int64_t)c.x + c.w;
+    if (y1 > (int64_t)c.y + c.h) y1 = (int64_t)c.y + c.h;
+    top = &fb->clip_stack[fb->clip_depth++];
+    top->x = (int)x0;
+    top->y = (int)y0;
+    top->w = x1 > x0 ? (int)(x1 - x0) : 0;
+    top->h = y1 > y0 ? (int)(y1 - y0) : 0;
+    return 0;
+}
+
+void pas_gfx_clip_pop(pas_gfx_fb_t *fb)
+{
+    if (!fb) return;
+    if (pas_gfx__record(fb, PAS_GFX__OP_CLIP_POP, 0, 0, 0, 0, 0, 0, NULL, NULL)) return;
+    if (fb->clip_depth > 0) fb->clip_depth--;
 }
 
 static void pas_gfx__put_pixel_clipped(pas_gfx_fb_t *fb, int x, int y, uint32_t color)
 {
+    pas_gfx_rect_t c;
     if (!fb || !fb->pixels) return;
-    if ((unsigned)x >= (unsigned)fb->width) return;
-    if ((unsigned)y >= (unsigned)fb->height) return;
+    c = pas_gfx_clip_get(fb);
+    if ((unsigned)x - (unsigned)c.x >= (unsigned)c.w) return;
+    if ((unsigned)y - (unsigned)c.y >= (unsigned)c.h) return;
     fb->pixels[y * fb->pitch + x] = color;
 }
 
+static void pas_gfx__damage(pas_gfx_fb_t *fb, int x, int y, int w, int h);
+
 void pas_gfx_pixel(pas_gfx_fb_t *fb, int x, int y, uint32_t color)
 {
+    if (pas_gfx__record(fb, PAS_GFX__OP_PIXEL, x, y, 0, 0, 0, color, NULL, NULL)) return;
     pas_gfx__put_pixel_clipped(fb, x, y, color);
+    pas_gfx__damage(fb, x, y, 1, 1);
+}
+
+/* Clips the rectangle (x, y, w, h) to the fb's current clip in place; returns 0 if nothing is left. */
+static int pas_gfx__clip(const pas_gfx_fb_t *fb, int *x, int *y, int *w, int *h)
+{
+    /* 64-bit edges: x + w must not overflow for any int inputs */
+    int64_t x0 = *x, y0 = *y, x1 = x0 + *w, y1 = y0 + *h;
+    pas_gfx_rect_t c;
+
+    if (!fb || !fb->pixels || *w <= 0 || *h <= 0) return 0;
+    c = pas_gfx_clip_get(fb);
+    if (x0 < c.x) x0 = c.x;
+    if (y0 < c.y) y0 = c.y;
+    if (x1 > (int64_t)c.x + c.w) x1 = (int64_t)c.x + c.w;
+    if (y1 > (int64_t)c.y + c.h) y1 = (int64_t)c.y + c.h;
+    if (x0 >= x1 || y0 >= y1) return 0;
+    *x = (int)x0;
+    *y = (int)y0;
+    *w = (int)(x1 - x0);
+    *h = (int)(y1 - y0);
+    return 1;
+}
+
+void pas_gfx_damage_init(pas_gfx_damage_t *damage, pas_gfx_rect_t *rects, int capacity)
+{
+    if (!damage) return;
+    damage->rects = rects;
+    damage->capacity = rects ? capacity : 0;
+    damage->count = 0;
+}
+
+void pas_gfx_damage_reset(pas_gfx_damage_t *damage)
+{
+    if (damage) damage->count = 0;
+}
+
+static int64_t pas_gfx__area(const pas_gfx_rect_t *r)
+{
+    return (int64_t)r->w * r->h;
+}
+
+static pas_gfx_rect_t pas_gfx__union(const pas_gfx_rect_t *a, const pas_gfx_rect_t *b)
+{
+    pas_gfx_rect_t u;
+    int x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+    int y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+    u.x = a->x < b->x ? a->x : b->x;
+    u.y = a->y < b->y ? a->y : b->y;
+    u.w = x1 - u.x;
+    u.h = y1 - u.y;
+    return u;
+}
+
+static void pas_gfx__damage_insert(pas_gfx_damage_t *d, pas_gfx_rect_t r)
+{
+    for (;;) {
+        int i, best = -1;
+        int64_t best_cost = 0;
+
+        /* a union no larger than both apart: merge, then look again with the bigger rect */
+        for (i = 0; i < d->count; ++i) {
+            pas_gfx_rect_t u = pas_gfx__union(&d->rects[i], &r);
+            int64_t cost = pas_gfx__area(&u) - pas_gfx__area(&d->rects[i]) - pas_gfx__area(&r);
+            if (cost <= 0) break;
+            if (best < 0 || cost < best_cost) { best = i; best_cost = cost; }
+        }
+        if (i == d->count) {
+            if (d->count < d->capacity) {
+                d->rects[d->count++] = r;
+                return;
+            }
+            i = best;   /* full: the cheapest merge */
+        }
+        r = pas_gfx__union(&d->rects[i], &r);
+        d->rects[i] = d->rects[--d->count];
+    }
+}
+
+/* Records (x, y, w, h), clipped, in fb->damage. */
+static void pas_gfx__damage(pas_gfx_fb_t *fb, int x, int y, int w, int h)
+{
+    pas_gfx_rect_t r;
+
+    if (!fb || !fb->damage || fb->damage->capacity <= 0) return;
+    if (!pas_gfx__clip(fb, &x, &y, &w, &h)) return;
+    r.x = x;
+    r.y = y;
+    r.w = w;
+    r.h = h;
+    pas_gfx__damage_insert(fb->damage, r);
+}
+
+void pas_gfx_damage_add(pas_gfx_fb_t *fb, int x, int y, int w, int h)
+{
+    pas_gfx__damage(fb, x, y, w, h);
+}
+
+/* Writes color to n consecutive pixels. */
+static void pas_gfx__fill_span(uint32_t *dst, size_t n, uint32_t color)
+{
+#if defined(PAS_GFX__AVX2)
+    __m256i v = _mm256_set1_epi32((int)color);
+    /* scalar head up to 32-byte alignment, then aligned stores */
+    while (n && ((uintptr_t)dst & 31)) { *dst++ = color; --n; }
+    for (; n >= 16; n -= 16, dst += 16) {
+        _mm256_store_si256((__m256i *)(void *)dst, v);
+        _mm256_store_si256((__m256i *)(void *)(dst + 8), v);
+    }
+    if (n >= 8) { _mm256_store_si256((__m256i *)(void *)dst, v); dst += 8; n -= 8; }
+#elif defined(PAS_GFX__SSE2)
+    __m128i v = _mm_set1_epi32((int)color);
+    while (n && ((uintptr_t)dst & 15)) { *dst++ = color; --n; }
+    for (; n >= 8; n -= 8, dst += 8) {
+        _mm_store_si128((__m128i *)(void *)dst, v);
+        _mm_store_si128((__m128i *)(void *)(dst + 4), v);
+    }
+    if (n >= 4) { _mm_store_si128((__m128i *)(void *)dst, v); dst += 4; n -= 4; }
+#elif defined(PAS_GFX__NEON)
+    uint32x4_t v = vdupq_n_u32(color);
+    for (; n >= 8; n -= 8, dst += 8) {
+        vst1q_u32(dst, v);
+        vst1q_u32(dst + 4, v);
+    }
+    if (n >= 4) { vst1q_u32(dst, v); dst += 4; n -= 4; }
+#else
+    for (; n >= 4; n -= 4, dst += 4) {
+        dst[0] = color; dst[1] = color; dst[2] = color; dst[3] = color;
+    }
+#endif
+    while (n--) *dst++ = color;
+}
+
+/* Fills an already clipped rectangle. */
+static void pas_gfx__fill_rect(pas_gfx_fb_t *fb, int x, int y, int w, int h, uint32_t color)
+{
+    uint32_t *row = fb->pixels + (size_t)y * (size_t)fb->pitch + (size_t)x;
+
+    if (w == fb->pitch) {
+        /* whole rows: one span */
+        pas_gfx__fill_span(row, (size_t)w * (size_t)h, color);
+        return;
+    }
+    for (; h > 0; --h, row += fb->pitch) pas_gfx__fill_span(row, (size_t)w, color);
+}
+
+void pas_gfx_hline(pas_gfx_fb_t *fb, int x, int y, int w, uint32_t color)
+{
+    int h = 1;
+    if (pas_gfx__record(fb, PAS_GFX__OP_HLINE, x, y, w, 1, 0, color, NULL, NULL)) return;
+    if (!pas_gfx__clip(fb, &x, &y, &w, &h)) return;
+    pas_gfx__fill_span(fb->pixels + (size_t)y * (size_t)fb->pitch + (size_t)x, (size_t)w, color);
+    pas_gfx__damage(fb, x, y, w, h);
+}
+
+void pas_gfx_vline(pas_gfx_fb_t *fb, int x, int y, int h, uint32_t color)
+{
+    uint32_t *p;
+    int w = 1;
+    if (pas_gfx__record(fb, PAS_GFX__OP_VLINE, x, y, 1, h, 0, color, NULL, NULL)) return;
+    if (!pas_gfx__clip(fb, &x, &y, &w, &h)) return;
+    pas_gfx__damage(fb, x, y, w, h);
+    for (p = fb->pixels + (size_t)y * (size_t)fb->pitch + (size_t)x; h > 0; --h, p += fb->pitch) *p = color;
 }
 
 void pas_gfx_line(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t color)
@@ -121,6 +587,19 @@ void pas_gfx_line(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t col
     int sy = (y1 < y2) ? 1 : -1;
     int err = dx + dy;
 
+    if (pas_gfx__record(fb, PAS_GFX__OP_LINE, x1, y1, x2, y2, 0, color, NULL, NULL)) return;
+
+    /* axis-aligned: spans, not Bresenham */
+    if (y1 == y2) {
+        pas_gfx_hline(fb, x1 < x2 ? x1 : x2, y1, dx + 1, color);
+        return;
+    }
+    if (x1 == x2) {
+        pas_gfx_vline(fb, x1, y1 < y2 ? y1 : y2, -dy + 1, color);
+        return;
+    }
+    pas_gfx__damage(fb, x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2, dx + 1, -dy + 1);
+
     for (;;) {
         pas_gfx__put_pixel_clipped(fb, x1, y1, color);
         if (x1 == x2 && y1 == y2) break;
@@ -134,19 +613,10 @@ void pas_gfx_line(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t col
 
 void pas_gfx_rect(pas_gfx_fb_t *fb, int x, int y, int w, int h, uint32_t color)
 {
-    int j;
-    if (!fb || !fb->pixels) return;
-    if (w <= 0 || h <= 0) return;
-    for (j = 0; j < h; ++j) {
-        int yy = y + j;
-        int i;
-        if ((unsigned)yy >= (unsigned)fb->height) continue;
-        for (i = 0; i < w; ++i) {
-            int xx = x + i;
-            if ((unsigned)xx >= (unsigned)fb->width) continue;
-            fb->pixels[yy * fb->pitch + xx] = color;
-        }
-    }
+    if (pas_gfx__record(fb, PAS_GFX__OP_RECT, x, y, w, h, 0, color, NULL, NULL)) return;
+    if (!pas_gfx__clip(fb, &x, &y, &w, &h)) return;
+    pas_gfx__fill_rect(fb, x, y, w, h, color);
+    pas_gfx__damage(fb, x, y, w, h);
 }
 
 void pas_gfx_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color)
@@ -155,7 +625,9 @@ void pas_gfx_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color)
     int y = 0;
     int err = 1 - r;
 
+    if (pas_gfx__record(fb, PAS_GFX__OP_CIRCLE, cx, cy, r, 0, 0, color, NULL, NULL)) return;
     if (r <= 0 || !fb || !fb->pixels) return;
+    pas_gfx__damage(fb, cx - r, cy - r, 2 * r + 1, 2 * r + 1);
 
     while (x >= y) {
         pas_gfx__put_pixel_clipped(fb, cx + x, cy + y, color);
@@ -177,52 +649,546 @@ void pas_gfx_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color)
     }
 }
 
-static uint32_t pas_gfx__blend_rgba(uint32_t dst, uint32_t src, uint8_t alpha)
+/* floor(sqrt(v)) */
+static uint64_t pas_gfx__isqrt(uint64_t v)
+{
+    uint64_t root = 0, bit = (uint64_t)1 << 62;
+
+    while (bit > v) bit >>= 2;
+    for (; bit; bit >>= 2) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+/* Fills [x0, x1) of row y, clipped to c. */
+static void pas_gfx__fill_row(pas_gfx_fb_t *fb, const pas_gfx_rect_t *c, int64_t x0, int64_t x1, int64_t y, uint32_t color)
+{
+    if (x0 < c->x) x0 = c->x;
+    if (x1 > (int64_t)c->x + c->w) x1 = (int64_t)c->x + c->w;
+    if (x0 >= x1) return;
+    pas_gfx__fill_span(fb->pixels + (size_t)y * (size_t)fb->pitch + (size_t)x0, (size_t)(x1 - x0), color);
+}
+
+/* Reports the part of [x0, x1) x [y0, y1) inside c. */
+static void pas_gfx__damage_clipped(pas_gfx_fb_t *fb, const pas_gfx_rect_t *c,
+                                    int64_t x0, int64_t y0, int64_t x1, int64_t y1)
+{
+    if (x0 < c->x) x0 = c->x;
+    if (y0 < c->y) y0 = c->y;
+    if (x1 > (int64_t)c->x + c->w) x1 = (int64_t)c->x + c->w;
+    if (y1 > (int64_t)c->y + c->h) y1 = (int64_t)c->y + c->h;
+    if (x0 < x1 && y0 < y1) pas_gfx__damage(fb, (int)x0, (int)y0, (int)(x1 - x0), (int)(y1 - y0));
+}
+
+/*
+    Rounded rect w x h at (x, y) with corner radius r (already clamped). A row qy
+    pixels into a corner arc reaches hw = isqrt(r*r + r - qy*qy) past the arc's
+    center column; rows between the arcs have qy = 0, so hw = r: full width.
+*/
+static void pas_gfx__fill_round(pas_gfx_fb_t *fb, int64_t x, int64_t y, int64_t w, int64_t h, int64_t r, uint32_t color)
+{
+    pas_gfx_rect_t c;
+    int64_t row, end, top = y + r, bottom = y + h - 1 - r;
+
+    if (!fb || !fb->pixels || w <= 0 || h <= 0) return;
+    c = pas_gfx_clip_get(fb);
+    row = y > c.y ? y : c.y;
+    end = y + h < (int64_t)c.y + c.h ? y + h : (int64_t)c.y + c.h;
+    for (; row < end; ++row) {
+        int64_t qy = row < top ? top - row : row > bottom ? row - bottom : 0;
+        int64_t hw = (int64_t)pas_gfx__isqrt((uint64_t)(r * r + r - qy * qy));
+        pas_gfx__fill_row(fb, &c, x + r - hw, x + w - r + hw, row, color);
+    }
+    pas_gfx__damage_clipped(fb, &c, x, y, x + w, y + h);
+}
+
+void pas_gfx_fill_circle(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color)
+{
+    if (pas_gfx__record(fb, PAS_GFX__OP_FILL_CIRCLE, cx, cy, r, 0, 0, color, NULL, NULL)) return;
+    if (r < 0) return;
+    pas_gfx__fill_round(fb, (int64_t)cx - r, (int64_t)cy - r, 2 * (int64_t)r + 1, 2 * (int64_t)r + 1, r, color);
+}
+
+void pas_gfx_fill_round_rect(pas_gfx_fb_t *fb, int x, int y, int w, int h, int r, uint32_t color)
 {
-    /* alpha: 0..255, src in 0xAARRGGBB (we combine src.A with alpha) */
-    uint8_t src_a = (uint8_t)((src >> 24) & 0xFF);
-    uint8_t a = (uint8_t)((src_a * (uint32_t)alpha + 127) / 255);
-    uint8_t inv_a = (uint8_t)(255 - a);
+    if (pas_gfx__record(fb, PAS_GFX__OP_FILL_ROUND_RECT, x, y, w, h, r, color, NULL, NULL)) return;
+    if (w <= 0 || h <= 0) return;
+    if (r > (w - 1) / 2) r = (w - 1) / 2;
+    if (r > (h - 1) / 2) r = (h - 1) / 2;
+    if (r < 0) r = 0;
+    pas_gfx__fill_round(fb, x, y, w, h, r, color);
+}
 
-    uint8_t dst_r = (uint8_t)((dst >> 16) & 0xFF);
-    uint8_t dst_g = (uint8_t)((dst >> 8) & 0xFF);
-    uint8_t dst_b = (uint8_t)(dst & 0xFF);
+/* ceil(a / b) for b > 0 */
+static int64_t pas_gfx__ceil_div(int64_t a, int64_t b)
+{
+    return a >= 0 ? (a + b - 1) / b : -((-a) / b);
+}
 
-    uint8_t src_r = (uint8_t)((src >> 16) & 0xFF);
-    uint8_t src_g = (uint8_t)((src >> 8) & 0xFF);
-    uint8_t src_b = (uint8_t)(src & 0xFF);
+void pas_gfx_fill_polygon(pas_gfx_fb_t *fb, const int *xy, int n, uint32_t color)
+{
+    pas_gfx_rect_t c;
+    int64_t row, end;
+    int minx, miny, maxx, maxy, i;
+
+    if (!xy || n < 3) return;
+    minx = maxx = xy[0];
+    miny = maxy = xy[1];
+    for (i = 1; i < n; ++i) {
+        if (xy[2 * i] < minx) minx = xy[2 * i];
+        if (xy[2 * i] > maxx) maxx = xy[2 * i];
+        if (xy[2 * i + 1] < miny) miny = xy[2 * i + 1];
+        if (xy[2 * i + 1] > maxy) maxy = xy[2 * i + 1];
+    }
+    if (pas_gfx__record(fb, PAS_GFX__OP_FILL_POLYGON, minx, miny, maxx - minx, maxy - miny, n, color, xy, NULL)) return;
+    if (!fb || !fb->pixels) return;
 
-    uint8_t out_r = (uint8_t)((src_r * a + dst_r * inv_a + 127) / 255);
-    uint8_t out_g = (uint8_t)((src_g * a + dst_g * inv_a + 127) / 255);
-    uint8_t out_b = (uint8_t)((src_b * a + dst_b * inv_a + 127) / 255);
+    c = pas_gfx_clip_get(fb);
+    row = miny > c.y ? miny : c.y;
+    end = maxy < (int64_t)c.y + c.h ? maxy : (int64_t)c.y + c.h;
+    for (; row < end; ++row) {
+        int64_t lo = 0, hi = 0;
+        int found = 0;
+
+        /*
+            Each edge whose half-open y range holds the row center crosses it at
+            X = N / D, D = 2 * (y1 - y0); the pixels with centers in [X_left, X_right)
+            start at ceil(X - 0.5) = ceil((2N - D) / 2D).
+        */
+        for (i = 0; i < n; ++i) {
+            int j = i + 1 == n ? 0 : i + 1;
+            int64_t x0 = xy[2 * i], y0 = xy[2 * i + 1], x1 = xy[2 * j], y1 = xy[2 * j + 1], d, num, px;
+            if (y0 == y1) continue;
+            if (y0 > y1) {
+                int64_t t = x0; x0 = x1; x1 = t;
+                t = y0; y0 = y1; y1 = t;
+            }
+            if (row < y0 || row >= y1) continue;
+            d = 2 * (y1 - y0);
+            num = x0 * d + (x1 - x0) * (2 * (row - y0) + 1);
+            px = pas_gfx__ceil_div(2 * num - d, 2 * d);
+            if (!found || px < lo) lo = px;
+            if (!found || px > hi) hi = px;
+            found = 1;
+        }
+        if (found) pas_gfx__fill_row(fb, &c, lo, hi, row, color);
+    }
+    pas_gfx__damage_clipped(fb, &c, minx, miny, maxx, maxy);
+}
 
-    /* resulting alpha: just max of both for simplicity */
-    uint8_t out_a = (uint8_t)(((dst >> 24) & 0xFF) | a);
+/* Exact (x + 127) / 255 for 0 <= x <= 65535, without a division. */
+#define PAS_GFX__DIV255(x) (((x) + (((x) + 128) >> 8) + 128) >> 8)
+
+/*
+    One pixel of color (0xAARRGGBB) over dst at coverage cov. The effective alpha is
+    a = src.A * cov / 255. Straight: c = (src.c * a + dst.c * (255 - a)) / 255, alpha
+    dst.A | a. Premultiplied: c = (src.c * cov + dst.c * (255 - a)) / 255 on all four
+    channels. The SIMD kernels below compute exactly the same values.
+*/
+static uint32_t pas_gfx__blend_rgba(uint32_t dst, uint32_t src, uint32_t cov, int premul)
+{
+    uint32_t sa = src >> 24;
+    uint32_t a = PAS_GFX__DIV255(sa * cov);
+    uint32_t inv = 255 - a;
+    uint32_t f = premul ? cov : a;
+
+    uint32_t out_r = PAS_GFX__DIV255(((src >> 16) & 0xFF) * f + ((dst >> 16) & 0xFF) * inv);
+    uint32_t out_g = PAS_GFX__DIV255(((src >> 8) & 0xFF) * f + ((dst >> 8) & 0xFF) * inv);
+    uint32_t out_b = PAS_GFX__DIV255((src & 0xFF) * f + (dst & 0xFF) * inv);
+    uint32_t out_a = premul ? PAS_GFX__DIV255(sa * cov + (dst >> 24) * inv) : ((dst >> 24) | a);
 
     return PAS_GFX_RGBA(out_a, out_r, out_g, out_b);
 }
 
+uint32_t pas_gfx_premultiply(uint32_t color)
+{
+    uint32_t a = color >> 24;
+    return PAS_GFX_RGBA(a, PAS_GFX__DIV255(((color >> 16) & 0xFF) * a),
+                        PAS_GFX__DIV255(((color >> 8) & 0xFF) * a), PAS_GFX__DIV255((color & 0xFF) * a));
+}
+
+#if defined(PAS_GFX__AVX2) || defined(PAS_GFX__SSE2) || defined(PAS_GFX__NEON)
+/* Coverage bytes cov[0..3] as one word, cov[0] lowest. */
+static uint32_t pas_gfx__cov4(const uint8_t *cov)
+{
+    return (uint32_t)cov[0] | ((uint32_t)cov[1] << 8) | ((uint32_t)cov[2] << 16) | ((uint32_t)cov[3] << 24);
+}
+#endif
+
+/*
+    x86 kernels hold two pixels per 128-bit lane as 16-bit channels; c carries each
+    pixel's coverage in its four channels. Every product and sum stays below 65536
+    (premultiplied colors are clamped to their alpha first), so mulhi by 0x8081 >> 7
+    is the exact /255.
+*/
+#if defined(PAS_GFX__AVX2)
+static __m256i pas_gfx__div255_avx2(__m256i x)
+{
+    return _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_add_epi16(x, _mm256_set1_epi16(127)),
+                                                _mm256_set1_epi16((short)0x8081)), 7);
+}
+
+static __m256i pas_gfx__blend4_avx2(__m256i d, __m256i c, __m256i s, __m256i sa, int premul)
+{
+    __m256i a = pas_gfx__div255_avx2(_mm256_mullo_epi16(c, sa));
+    __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    __m256i out = pas_gfx__div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, premul ? c : a),
+                                                        _mm256_mullo_epi16(d, inv)));
+    if (!premul) {
+        __m256i amask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+        out = _mm256_or_si256(_mm256_andnot_si256(amask, out), _mm256_and_si256(amask, _mm256_or_si256(d, a)));
+    }
+    return out;
+}
+
+/* Blends whole blocks of 8 pixels; returns how many pixels it did. */
+static size_t pas_gfx__blend_simd(uint32_t *dst, const uint8_t *cov, size_t n, uint32_t color, int premul)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i splat = _mm256_set1_epi32((int)color);
+    const __m256i s = _mm256_unpacklo_epi8(splat, zero);
+    const __m256i sa = _mm256_set1_epi16((short)(color >> 24));
+    int opaque = (color >> 24) == 255;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        uint32_t c0 = pas_gfx__cov4(cov + i), c1 = pas_gfx__cov4(cov + i + 4);
+        __m128i c8;
+        __m256i c, d, lo, hi;
+
+        if ((c0 | c1) == 0) continue;
+        if (opaque && (c0 & c1) == 0xFFFFFFFFu) {
+            _mm256_storeu_si256((__m256i *)(void *)(dst + i), splat);
+            continue;
+        }
+        c8 = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, (int)c1, (int)c0), _mm_set_epi32(0, 0, (int)c1, (int)c0));
+        c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(c8, c8)),
+                                    _mm_unpackhi_epi16(c8, c8), 1);
+        d = _mm256_loadu_si256((const __m256i *)(const void *)(dst + i));
+        lo = pas_gfx__blend4_avx2(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(c, zero), s, sa, premul);
+        hi = pas_gfx__blend4_avx2(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(c, zero), s, sa, premul);
+        _mm256_storeu_si256((__m256i *)(void *)(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#elif defined(PAS_GFX__SSE2)
+static __m128i pas_gfx__div255_sse2(__m128i x)
+{
+    return _mm_srli_epi16(_mm_mulhi_epu16(_mm_add_epi16(x, _mm_set1_epi16(127)),
+                                          _mm_set1_epi16((short)0x8081)), 7);
+}
+
+static __m128i pas_gfx__blend2_sse2(__m128i d, __m128i c, __m128i s, __m128i sa, int premul)
+{
+    __m128i a = pas_gfx__div255_sse2(_mm_mullo_epi16(c, sa));
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    __m128i out = pas_gfx__div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, premul ? c : a),
+                                                     _mm_mullo_epi16(d, inv)));
+    if (!premul) {
+        __m128i amask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        out = _mm_or_si128(_mm_andnot_si128(amask, out), _mm_and_si128(amask, _mm_or_si128(d, a)));
+    }
+    return out;
+}
+
+/* Blends whole blocks of 4 pixels; returns how many pixels it did. */
+static size_t pas_gfx__blend_simd(uint32_t *dst, const uint8_t *cov, size_t n, uint32_t color, int premul)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i splat = _mm_set1_epi32((int)color);
+    const __m128i s = _mm_unpacklo_epi8(splat, zero);
+    const __m128i sa = _mm_set1_epi16((short)(color >> 24));
+    int opaque = (color >> 24) == 255;
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        uint32_t c4 = pas_gfx__cov4(cov + i);
+        __m128i c, d, lo, hi;
+
+        if (c4 == 0) continue;
+        if (opaque && c4 == 0xFFFFFFFFu) {
+            _mm_storeu_si128((__m128i *)(void *)(dst + i), splat);
+            continue;
+        }
+        c = _mm_cvtsi32_si128((int)c4);
+        c = _mm_unpacklo_epi8(c, c);
+        c = _mm_unpacklo_epi16(c, c);   /* pixel k's coverage in bytes 4k..4k+3 */
+        d = _mm_loadu_si128((const __m128i *)(const void *)(dst + i));
+        lo = pas_gfx__blend2_sse2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(c, zero), s, sa, premul);
+        hi = pas_gfx__blend2_sse2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(c, zero), s, sa, premul);
+        _mm_storeu_si128((__m128i *)(void *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#elif defined(PAS_GFX__NEON)
+/* Exact /255 of 16-bit lanes, narrowed: (x + ((x + 128) >> 8) + 128) >> 8. */
+static uint8x8_t pas_gfx__div255_neon(uint16x8_t x)
+{
+    return vrshrn_n_u16(vaddq_u16(x, vrshrq_n_u16(x, 8)), 8);
+}
+
+static uint8x8_t pas_gfx__blend2_neon(uint8x8_t d, uint8x8_t c, uint8x8_t s, uint8x8_t sa, int premul)
+{
+    uint8x8_t a = pas_gfx__div255_neon(vmull_u8(c, sa));
+    uint8x8_t out = pas_gfx__div255_neon(vmlal_u8(vmull_u8(s, premul ? c : a), d, vmvn_u8(a)));
+    if (!premul) out = vbsl_u8(vreinterpret_u8_u32(vdup_n_u32(0xFF000000u)), vorr_u8(d, a), out);
+    return out;
+}
+
+/* Blends whole blocks of 4 pixels; returns how many pixels it did. */
+static size_t pas_gfx__blend_simd(uint32_t *dst, const uint8_t *cov, size_t n, uint32_t color, int premul)
+{
+    const uint8x8_t s = vreinterpret_u8_u32(vdup_n_u32(color));
+    const uint8x8_t sa = vdup_n_u8((uint8_t)(color >> 24));
+    const uint32x4_t splat = vdupq_n_u32(color);
+    int opaque = (color >> 24) == 255;
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        uint32_t c4 = pas_gfx__cov4(cov + i);
+        uint8x8x2_t z;
+        uint16x4x2_t zz;
+        uint8x16_t d;
+
+        if (c4 == 0) continue;
+        if (opaque && c4 == 0xFFFFFFFFu) {
+            vst1q_u32(dst + i, splat);
+            continue;
+        }
+        z = vzip_u8(vreinterpret_u8_u32(vdup_n_u32(c4)), vreinterpret_u8_u32(vdup_n_u32(c4)));
+        zz = vzip_u16(vreinterpret_u16_u8(z.val[0]), vreinterpret_u16_u8(z.val[0]));
+        d = vld1q_u8((const uint8_t *)(dst + i));
+        vst1q_u8((uint8_t *)(dst + i),
+                 vcombine_u8(pas_gfx__blend2_neon(vget_low_u8(d), vreinterpret_u8_u16(zz.val[0]), s, sa, premul),
+                             pas_gfx__blend2_neon(vget_high_u8(d), vreinterpret_u8_u16(zz.val[1]), s, sa, premul)));
+    }
+    return i;
+}
+#endif
+
+/* color over n pixels of dst with per-pixel coverage cov. */
+static void pas_gfx__blend_span(uint32_t *dst, const uint8_t *cov, size_t n, uint32_t color, int premul)
+{
+    int opaque;
+    size_t i = 0;
+
+    if (premul) {
+        /* channels above alpha are not premultiplied colors; clamp so no sum can pass 255 */
+        uint32_t a = color >> 24, r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+        color = PAS_GFX_RGBA(a, r > a ? a : r, g > a ? a : g, b > a ? a : b);
+    }
+    opaque = (color >> 24) == 255;
+#if defined(PAS_GFX__AVX2) || defined(PAS_GFX__SSE2) || defined(PAS_GFX__NEON)
+    i = pas_gfx__blend_simd(dst, cov, n, color, premul);
+#endif
+    for (; i < n; ++i) {
+        if (cov[i] == 0) continue;
+        dst[i] = (cov[i] == 255 && opaque) ? color : pas_gfx__blend_rgba(dst[i], color, cov[i], premul);
+    }
+}
+
 void pas_gfx_bitmap(pas_gfx_fb_t *fb, int x, int y,
                     const uint8_t *bitmap, int w, int h, uint32_t color)
 {
-    int j, i;
-    if (!fb || !fb->pixels || !bitmap) return;
-    if (w <= 0 || h <= 0) return;
+    int cx = x, cy = y, cw = w, ch = h;
+    const uint8_t *src;
+    uint32_t *row;
+
+    if (pas_gfx__record(fb, PAS_GFX__OP_BITMAP, x, y, w, h, 0, color, bitmap, NULL)) return;
+    if (!bitmap || !pas_gfx__clip(fb, &cx, &cy, &cw, &ch)) return;
+
+    pas_gfx__damage(fb, cx, cy, cw, ch);
+    src = bitmap + (size_t)(cy - y) * (size_t)w + (size_t)(cx - x);
+    row = fb->pixels + (size_t)cy * (size_t)fb->pitch + (size_t)cx;
+    for (; ch > 0; --ch, src += w, row += fb->pitch)
+        pas_gfx__blend_span(row, src, (size_t)cw, color, (fb->flags & PAS_GFX_FB_PREMULTIPLIED) != 0);
+}
+
+#ifndef PAS_GFX_AA_RUN
+#define PAS_GFX_AA_RUN 64   /* coverage batched per blend call by the anti-aliased primitives */
+#endif
+
+/* Blends n coverage values at (x, y), clipped to c. */
+static void pas_gfx__blend_row(pas_gfx_fb_t *fb, const pas_gfx_rect_t *c, int64_t x, int64_t y,
+                               const uint8_t *cov, int64_t n, uint32_t color)
+{
+    if (y < c->y || y >= (int64_t)c->y + c->h) return;
+    if (x < c->x) {
+        cov += c->x - x;
+        n -= c->x - x;
+        x = c->x;
+    }
+    if (x + n > (int64_t)c->x + c->w) n = (int64_t)c->x + c->w - x;
+    if (n <= 0) return;
+    pas_gfx__blend_span(fb->pixels + (size_t)y * (size_t)fb->pitch + (size_t)x, cov, (size_t)n, color,
+                        (fb->flags & PAS_GFX_FB_PREMULTIPLIED) != 0);
+}
+
+/* 16.16 integer part and top 8 fraction bits, for either sign. */
+#define PAS_GFX__FIX_INT(v)  (((v) - ((v) & 0xFFFF)) / 65536)
+#define PAS_GFX__FIX_FRAC(v) ((uint8_t)(((v) & 0xFFFF) >> 8))
+
+void pas_gfx_line_aa(pas_gfx_fb_t *fb, int x1, int y1, int x2, int y2, uint32_t color)
+{
+    uint8_t cov0[PAS_GFX_AA_RUN], cov1[PAS_GFX_AA_RUN];
+    pas_gfx_rect_t c;
+    int64_t u1, v1, u2, v2, du, dv, lo, hi, u, t, pos, gq, gr, rem, run_u = 0, run_v = 0;
+    int steep, run = 0;
+
+    if (pas_gfx__record(fb, PAS_GFX__OP_LINE_AA, x1, y1, x2, y2, 0, color, NULL, NULL)) return;
+    if (!fb || !fb->pixels) return;
+
+    /* u runs along the major axis, one step per pixel; v is the minor axis */
+    steep = ((int64_t)y2 - y1 < 0 ? (int64_t)y1 - y2 : (int64_t)y2 - y1) >
+            ((int64_t)x2 - x1 < 0 ? (int64_t)x1 - x2 : (int64_t)x2 - x1);
+    u1 = steep ? y1 : x1; v1 = steep ? x1 : y1;
+    u2 = steep ? y2 : x2; v2 = steep ? x2 : y2;
+    if (u1 > u2) {
+        t = u1; u1 = u2; u2 = t;
+        t = v1; v1 = v2; v2 = t;
+    }
+    du = u2 - u1;
+    dv = v2 - v1;
+    c = pas_gfx_clip_get(fb);
+    if (steep) pas_gfx__damage_clipped(fb, &c, v1 < v2 ? v1 : v2, u1, (v1 < v2 ? v2 : v1) + 1, u2 + 1);
+    else       pas_gfx__damage_clipped(fb, &c, u1, v1 < v2 ? v1 : v2, u2 + 1, (v1 < v2 ? v2 : v1) + 1);
+
+    /* only the steps inside the clip along u are walked */
+    lo = steep ? c.y : c.x;
+    hi = lo + (steep ? c.h : c.w) - 1;
+    if (lo < u1) lo = u1;
+    if (hi > u2) hi = u2;
+    if (lo > hi) return;
+
+    /* v at step u is exactly floor(65536 * (v1 + dv * (u - u1) / du)), advanced as gq + gr / du per step */
+    if (!du) du = 1;
+    gq = dv * 65536 / du;
+    gr = dv * 65536 - gq * du;
+    if (gr < 0) {
+        --gq;
+        gr += du;
+    }
+    t = lo - u1;
+    pos = v1 * 65536 + gq * t + (int64_t)((uint64_t)gr * (uint64_t)t / (uint64_t)du);
+    rem = (int64_t)((uint64_t)gr * (uint64_t)t % (uint64_t)du);
+
+    for (u = lo; u <= hi; ++u) {
+        int64_t iv = PAS_GFX__FIX_INT(pos);
+        uint8_t f = PAS_GFX__FIX_FRAC(pos);
+
+        if (steep) {
+            /* one row: two pixels side by side */
+            cov0[0] = (uint8_t)(255 - f);
+            cov0[1] = f;
+            pas_gfx__blend_row(fb, &c, iv, u, cov0, 2, color);
+        } else {
+            /* consecutive columns on the same row pair become one span per row */
+            if (run && (iv != run_v || run == PAS_GFX_AA_RUN)) {
+                pas_gfx__blend_row(fb, &c, run_u, run_v, cov0, run, color);
+                pas_gfx__blend_row(fb, &c, run_u, run_v + 1, cov1, run, color);
+                run = 0;
+            }
+            if (!run) {
+                run_u = u;
+                run_v = iv;
+            }
+            cov0[run] = (uint8_t)(255 - f);
+            cov1[run] = f;
+            ++run;
+        }
+        pos += gq;
+        rem += gr;
+        if (rem >= du) {
+            ++pos;
+            rem -= du;
+        }
+    }
+    if (run) {
+        pas_gfx__blend_row(fb, &c, run_u, run_v, cov0, run, color);
+        pas_gfx__blend_row(fb, &c, run_u, run_v + 1, cov1, run, color);
+    }
+}
+
+/*
+    One run of the circle's upper octant: columns i0 .. i0 + n - 1 where the arc sits
+    between rows iy and iy + 1 (inner coverage in, outer out), mirrored to all eight
+    octants. Mirrors that would land on a pixel twice (column 0, row 0, the diagonal)
+    are left out.
+*/
+static void pas_gfx__circle_run(pas_gfx_fb_t *fb, const pas_gfx_rect_t *c, int64_t cx, int64_t cy,
+                                int64_t i0, int64_t iy, const uint8_t *in, const uint8_t *out, int n, uint32_t color)
+{
+    uint8_t rin[PAS_GFX_AA_RUN], rout[PAS_GFX_AA_RUN], pair[2];
+    int k, skip = i0 == 0;
+
+    /* top and bottom: horizontal spans, reversed for the left half */
+    pas_gfx__blend_row(fb, c, cx + i0, cy - iy, in, n, color);
+    pas_gfx__blend_row(fb, c, cx + i0, cy - iy - 1, out, n, color);
+    pas_gfx__blend_row(fb, c, cx + i0, cy + iy, in, n, color);
+    pas_gfx__blend_row(fb, c, cx + i0, cy + iy + 1, out, n, color);
+    for (k = skip; k < n; ++k) {
+        rin[n - 1 - k] = in[k];
+        rout[n - 1 - k] = out[k];
+    }
+    if (n > skip) {
+        pas_gfx__blend_row(fb, c, cx - i0 - n + 1, cy - iy, rin, n - skip, color);
+        pas_gfx__blend_row(fb, c, cx - i0 - n + 1, cy - iy - 1, rout, n - skip, color);
+        pas_gfx__blend_row(fb, c, cx - i0 - n + 1, cy + iy, rin, n - skip, color);
+        pas_gfx__blend_row(fb, c, cx - i0 - n + 1, cy + iy + 1, rout, n - skip, color);
+    }
 
-    for (j = 0; j < h; ++j) {
-        int yy = y + j;
-        if ((unsigned)yy >= (unsigned)fb->height) continue;
-        for (i = 0; i < w; ++i) {
-            int xx = x + i;
-            uint8_t cov;
-            uint32_t *dst;
-            if ((unsigned)xx >= (unsigned)fb->width) continue;
-            cov = bitmap[j * w + i];
-            if (cov == 0) continue;
-            dst = &fb->pixels[yy * fb->pitch + xx];
-            *dst = pas_gfx__blend_rgba(*dst, color, cov);
+    /* left and right: the same points transposed, two pixels per row */
+    for (k = 0; k < n; ++k) {
+        int64_t i = i0 + k;
+        pair[0] = i == iy ? 0 : in[k];
+        pair[1] = out[k];
+        pas_gfx__blend_row(fb, c, cx + iy, cy + i, pair, 2, color);
+        if (i) pas_gfx__blend_row(fb, c, cx + iy, cy - i, pair, 2, color);
+        pair[0] = out[k];
+        pair[1] = i == iy ? 0 : in[k];
+        pas_gfx__blend_row(fb, c, cx - iy - 1, cy + i, pair, 2, color);
+        if (i) pas_gfx__blend_row(fb, c, cx - iy - 1, cy - i, pair, 2, color);
+    }
+}
+
+void pas_gfx_circle_aa(pas_gfx_fb_t *fb, int cx, int cy, int r, uint32_t color)
+{
+    uint8_t in[PAS_GFX_AA_RUN], out[PAS_GFX_AA_RUN];
+    pas_gfx_rect_t c;
+    int64_t i, iy, run_i = 0, run_y = 0, rr = (int64_t)r * r;
+    int run = 0;
+
+    if (pas_gfx__record(fb, PAS_GFX__OP_CIRCLE_AA, cx, cy, r, 0, 0, color, NULL, NULL)) return;
+    if (r <= 0 || r >= (1 << 24) || !fb || !fb->pixels) return;
+    c = pas_gfx_clip_get(fb);
+    pas_gfx__damage_clipped(fb, &c, (int64_t)cx - r, (int64_t)cy - r, (int64_t)cx + r + 1, (int64_t)cy + r + 1);
+    if ((int64_t)cx + r < c.x || (int64_t)cx - r >= (int64_t)c.x + c.w ||
+        (int64_t)cy + r < c.y || (int64_t)cy - r >= (int64_t)c.y + c.h) return;
+
+    /* columns i of the upper octant, arc height sqrt(r*r - i*i) in 8.8 fixed point */
+    for (i = 0;; ++i) {
+        uint64_t y8 = pas_gfx__isqrt((uint64_t)(rr - i * i) << 16);
+        iy = (int64_t)(y8 >> 8);
+        if (i > iy) break;
+        if (run && (iy != run_y || run == PAS_GFX_AA_RUN)) {
+            pas_gfx__circle_run(fb, &c, cx, cy, run_i, run_y, in, out, run, color);
+            run = 0;
+        }
+        if (!run) {
+            run_i = i;
+            run_y = iy;
         }
+        in[run] = (uint8_t)(255 - (y8 & 0xFF));
+        out[run] = (uint8_t)(y8 & 0xFF);
+        ++run;
     }
+    if (run) pas_gfx__circle_run(fb, &c, cx, cy, run_i, run_y, in, out, run, color);
 }
 
 /* --- Simple 6x8 monospace ASCII font for window/title/button text --- */
@@ -326,64 +1292,148 @@ static const uint8_t pas_gfx__font6x8[96][8] = {
     /* '~' (126)*/ { 0x28,0x54,0x00,0x00,0x00,0x00,0x00,0x00 }
 };
 
+/* Pixel masks of a 6-bit font row, leftmost pixel = bit 5: a row is six masked stores, no branches. */
+#define PAS_GFX__MB(b, k) (((b) >> (5 - (k)) & 1) ? 0xFFFFFFFFu : 0u)
+#define PAS_GFX__M1(b) { PAS_GFX__MB(b, 0), PAS_GFX__MB(b, 1), PAS_GFX__MB(b, 2), \
+                         PAS_GFX__MB(b, 3), PAS_GFX__MB(b, 4), PAS_GFX__MB(b, 5) }
+#define PAS_GFX__M8(b) PAS_GFX__M1(b), PAS_GFX__M1(b + 1), PAS_GFX__M1(b + 2), PAS_GFX__M1(b + 3), \
+                       PAS_GFX__M1(b + 4), PAS_GFX__M1(b + 5), PAS_GFX__M1(b + 6), PAS_GFX__M1(b + 7)
+
+static const uint32_t pas_gfx__mask6[64][6] = {
+    PAS_GFX__M8(0), PAS_GFX__M8(8), PAS_GFX__M8(16), PAS_GFX__M8(24),
+    PAS_GFX__M8(32), PAS_GFX__M8(40), PAS_GFX__M8(48), PAS_GFX__M8(56)
+};
+
+/*
+    Built-in font text, each glyph scaled by scale. The clip is read once; glyphs
+    wholly inside it are written a row at a time through pas_gfx__mask6 (scale 1)
+    or as spans (scaled), and only glyphs on the clip edge are trimmed. One damage
+    rect per line.
+*/
 static void pas_gfx__text_mono(pas_gfx_fb_t *fb, int x, int y,
-                               const char *text, uint32_t color)
+                               const char *text, uint32_t color, int scale)
 {
-    int pen_x = x;
-    int pen_y = y;
     const unsigned char *s = (const unsigned char *)text;
-    if (!fb || !fb->pixels || !text) return;
-
-    while (*s) {
-        unsigned char c = *s++;
-        int row;
-        if (c == '\n') {
+    int64_t pen_x = x, pen_y = y, line_x0 = 0, line_x1 = 0, cw = 6 * (int64_t)scale, ch = 8 * (int64_t)scale;
+    int64_t cx0, cy0, cx1, cy1;
+    pas_gfx_rect_t c;
+
+    if (!fb || !fb->pixels || !text || scale <= 0) return;
+    c = pas_gfx_clip_get(fb);
+    cx0 = c.x;
+    cy0 = c.y;
+    cx1 = cx0 + c.w;
+    cy1 = cy0 + c.h;
+
+    for (;; ++s) {
+        const uint8_t *glyph;
+        int64_t gy0, gy1;
+        int row, full;
+
+        if (*s == '\n' || !*s) {
+            /* the line's printed cells, as one rect */
+            if (line_x1 > line_x0) pas_gfx__damage_clipped(fb, &c, line_x0, pen_y, line_x1, pen_y + ch);
+            line_x0 = line_x1 = 0;
+            if (!*s) return;
             pen_x = x;
-            pen_y += 9;
+            pen_y += 9 * (int64_t)scale;
             continue;
         }
-        if (c < 32 || c > 126) {
-            pen_x += 6;
+        if (*s < 32 || *s > 126 || pen_x >= cx1 || pen_x + cw <= cx0 || pen_y >= cy1 || pen_y + ch <= cy0) {
+            pen_x += cw;
             continue;
         }
+        if (line_x1 == line_x0) line_x0 = pen_x;
+        line_x1 = pen_x + cw;
+        glyph = pas_gfx__font6x8[*s - 32];
+        full = pen_x >= cx0 && pen_x + cw <= cx1;
+
         for (row = 0; row < 8; ++row) {
-            uint8_t bits = pas_gfx__font6x8[c - 32][row];
-            int col;
-            for (col = 0; col < 6; ++col) {
-                if (bits & (1 << (5 - col))) {
-                    pas_gfx__put_pixel_clipped(fb, pen_x + col, pen_y + row, color);
+            unsigned bits = glyph[row] & 0x3Fu;   /* columns 0..5; the font has stray bits above */
+            int64_t py;
+
+            if (!bits) continue;
+            gy0 = pen_y + row * (int64_t)scale;
+            gy1 = gy0 + scale;
+            if (gy0 < cy0) gy0 = cy0;
+            if (gy1 > cy1) gy1 = cy1;
+            for (py = gy0; py < gy1; ++py) {
+                uint32_t *p = fb->pixels + (size_t)py * (size_t)fb->pitch;
+                if (scale == 1) {
+                    const uint32_t *m = pas_gfx__mask6[bits];
+                    int k0 = 0, k1 = 6, k;
+                    if (full) {
+                        p += pen_x;
+                        p[0] = (p[0] & ~m[0]) | (color & m[0]);
+                        p[1] = (p[1] & ~m[1]) | (color & m[1]);
+                        p[2] = (p[2] & ~m[2]) | (color & m[2]);
+                        p[3] = (p[3] & ~m[3]) | (color & m[3]);
+                        p[4] = (p[4] & ~m[4]) | (color & m[4]);
+                        p[5] = (p[5] & ~m[5]) | (color & m[5]);
+                        continue;
+                    }
+                    if (pen_x < cx0) k0 = (int)(cx0 - pen_x);
+                    if (pen_x + 6 > cx1) k1 = (int)(cx1 - pen_x);
+                    for (k = k0; k < k1; ++k) p[pen_x + k] = (p[pen_x + k] & ~m[k]) | (color & m[k]);
+                } else {
+                    /* runs of set bits become spans scale times as wide */
+                    int a = 0;
+                    while (a < 6) {
+                        int b;
+                        if (!(bits & (0x20u >> a))) {
+                            ++a;
+                            continue;
+                        }
+                        for (b = a + 1; b < 6 && (bits & (0x20u >> b)); ++b) {}
+                        pas_gfx__fill_row(fb, &c, pen_x + a * (int64_t)scale, pen_x + b * (int64_t)scale, py, color);
+                        a = b;
+                    }
                 }
             }
         }
-        pen_x += 6;
+        pen_x += cw;
     }
 }
 
+void pas_gfx_text_mono(pas_gfx_fb_t *fb, int x, int y, const char *text, uint32_t color, int scale)
+{
+    if (pas_gfx__record(fb, PAS_GFX__OP_TEXT_MONO, x, y, scale, 0, 0, color, text, NULL)) return;
+    pas_gfx__text_mono(fb, x, y, text, color, scale);
+}
+
 void pas_gfx_window_frame(pas_gfx_fb_t *fb, int x, int y, int w, int h,
                           const char *title, uint32_t bg_color)
 {
     int title_bar_h = 14;
     uint32_t border_color = PAS_GFX_WHITE;
     uint32_t title_color  = PAS_GFX_BLUE;
+    pas_gfx_damage_t *damage;
 
+    if (pas_gfx__record(fb, PAS_GFX__OP_FRAME, x, y, w, h, 0, bg_color, title, NULL)) return;
     if (!fb || !fb->pixels) return;
     if (w <= 2 || h <= 2) return;
 
+    /* one damage rect for the frame, not one per part; the title reports its own */
+    damage = fb->damage;
+    fb->damage = NULL;
+
     /* background */
     pas_gfx_rect(fb, x + 1, y + 1, w - 2, h - 2, bg_color);
 
     /* border */
-    pas_gfx_line(fb, x, y, x + w - 1, y, border_color);
-    pas_gfx_line(fb, x, y + h - 1, x + w - 1, y + h - 1, border_color);
-    pas_gfx_line(fb, x, y, x, y + h - 1, border_color);
-    pas_gfx_line(fb, x + w - 1, y, x + w - 1, y + h - 1, border_color);
+    pas_gfx_hline(fb, x, y, w, border_color);
+    pas_gfx_hline(fb, x, y + h - 1, w, border_color);
+    pas_gfx_vline(fb, x, y, h, border_color);
+    pas_gfx_vline(fb, x + w - 1, y, h, border_color);
 
     /* title bar */
     if (title_bar_h > h - 2) title_bar_h = h - 2;
     pas_gfx_rect(fb, x + 1, y + 1, w - 2, title_bar_h, title_color);
+    fb->damage = damage;
+    pas_gfx__damage(fb, x, y, w, h);
 
     if (title && *title) {
-        pas_gfx__text_mono(fb, x + 4, y + 4, title, PAS_GFX_WHITE);
+        pas_gfx__text_mono(fb, x + 4, y + 4, title, PAS_GFX_WHITE, 1);
     }
 }
 
@@ -396,25 +1446,32 @@ void pas_gfx_button(pas_gfx_fb_t *fb, int x, int y, int w, int h,
     int text_x, text_y;
     int label_len = 0;
     const char *s;
+    pas_gfx_damage_t *damage;
 
+    if (pas_gfx__record(fb, PAS_GFX__OP_BUTTON, x, y, w, h, pressed, 0, label, NULL)) return;
     if (!fb || !fb->pixels) return;
     if (w <= 2 || h <= 2) return;
 
+    damage = fb->damage;
+    fb->damage = NULL;
+
     /* fill */
     pas_gfx_rect(fb, x + 1, y + 1, w - 2, h - 2, bg);
 
     /* simple bevel border */
     if (!pressed) {
-        pas_gfx_line(fb, x, y, x + w - 1, y, border_light);
-        pas_gfx_line(fb, x, y, x, y + h - 1, border_light);
-        pas_gfx_line(fb, x + w - 1, y, x + w - 1, y + h - 1, border_dark);
-        pas_gfx_line(fb, x, y + h - 1, x + w - 1, y + h - 1, border_dark);
+        pas_gfx_hline(fb, x, y, w, border_light);
+        pas_gfx_vline(fb, x, y, h, border_light);
+        pas_gfx_vline(fb, x + w - 1, y, h, border_dark);
+        pas_gfx_hline(fb, x, y + h - 1, w, border_dark);
     } else {
-        pas_gfx_line(fb, x, y, x + w - 1, y, border_dark);
-        pas_gfx_line(fb, x, y, x, y + h - 1, border_dark);
-        pas_gfx_line(fb, x + w - 1, y, x + w - 1, y + h - 1, border_light);
-        pas_gfx_line(fb, x, y + h - 1, x + w - 1, y + h - 1, border_light);
+        pas_gfx_hline(fb, x, y, w, border_dark);
+        pas_gfx_vline(fb, x, y, h, border_dark);
+        pas_gfx_vline(fb, x + w - 1, y, h, border_light);
+        pas_gfx_hline(fb, x, y + h - 1, w, border_light);
     }
+    fb->damage = damage;
+    pas_gfx__damage(fb, x, y, w, h);
 
     if (!label) return;
     for (s = label; *s; ++s) ++label_len;
@@ -424,13 +1481,15 @@ void pas_gfx_button(pas_gfx_fb_t *fb, int x, int y, int w, int h,
     text_y = y + (h - 8) / 2;
     if (pressed) { text_x += 1; text_y += 1; }
 
-    pas_gfx__text_mono(fb, text_x, text_y, label, PAS_GFX_BLACK);
+    pas_gfx__text_mono(fb, text_x, text_y, label, PAS_GFX_BLACK, 1);
 }
 
 /* stb_truetype text rendering */
 
 #ifdef PAS_GFX_USE_STB_TRUETYPE
 
+#include "pas_unicode.h"
+
 static pas_font_t pas_gfx__global_font;
 
 pas_font_t *pas_gfx_font_open(const uint8_t *ttf_data, float size)
@@ -447,82 +1506,520 @@ pas_font_t *pas_gfx_font_open(const uint8_t *ttf_data, float size)
                           &pas_gfx__global_font.ascent,
                           &pas_gfx__global_font.descent,
                           &pas_gfx__global_font.line_gap);
+    pas_gfx__global_font.cache = NULL;
     return &pas_gfx__global_font;
 }
 
+void pas_gfx_glyph_cache_reset(pas_gfx_glyph_cache_t *cache)
+{
+    int i;
+    if (!cache) return;
+    for (i = 0; i < cache->capacity; ++i) {
+        cache->glyphs[i].font = NULL;
+        cache->glyphs[i].atlas_next = i + 1 < cache->capacity ? i + 1 : -1;
+    }
+    for (i = 0; i < PAS_GFX_GLYPH_HASH; ++i) cache->hash[i] = -1;
+    for (i = 0; i < PAS_GFX_KERN_CACHE; ++i) cache->kern[i].font = NULL;
+    cache->free_head = cache->capacity > 0 ? 0 : -1;
+    cache->atlas_head = -1;
+    cache->clock = 0;
+    cache->hits = cache->misses = cache->evictions = 0;
+}
+
+void pas_gfx_glyph_cache_init(pas_gfx_glyph_cache_t *cache, pas_gfx_glyph_t *glyphs, int count,
+                              uint8_t *atlas, size_t atlas_size)
+{
+    if (!cache) return;
+    cache->glyphs = glyphs;
+    cache->capacity = glyphs ? count : 0;
+    cache->atlas = atlas;
+    cache->atlas_size = atlas ? atlas_size : 0;
+    pas_gfx_glyph_cache_reset(cache);
+}
+
+/* Glyph index, advance and bitmap box of cp at the font's current size. */
+static void pas_gfx__glyph_metrics(const pas_font_t *font, uint32_t cp, pas_gfx_glyph_t *g)
+{
+    int gx0, gy0, gx1, gy1;
+
+    g->codepoint = cp;
+    g->index = stbtt_FindGlyphIndex(&font->info, (int)cp);
+    stbtt_GetGlyphHMetrics(&font->info, g->index, &g->advance, NULL);
+    stbtt_GetGlyphBitmapBox(&font->info, g->index, font->scale, font->scale, &gx0, &gy0, &gx1, &gy1);
+    g->x0 = gx0;
+    g->y0 = gy0;
+    g->w = gx1 > gx0 && gy1 > gy0 ? gx1 - gx0 : 0;
+    g->h = g->w ? gy1 - gy0 : 0;
+}
+
+static unsigned pas_gfx__glyph_hash(const pas_font_t *font, float size, uint32_t cp)
+{
+    uint32_t h = cp * 2654435761u;
+    h ^= (uint32_t)(size * 64.0f) * 40503u;
+    h ^= (uint32_t)((size_t)font >> 4);
+    return (unsigned)(h ^ (h >> 16)) & (PAS_GFX_GLYPH_HASH - 1);
+}
+
+/* Drops the least recently used glyph (only ones holding atlas space if pixels_only). */
+static int pas_gfx__glyph_evict(pas_gfx_glyph_cache_t *c, int pixels_only)
+{
+    int i, victim = -1, *link;
+    pas_gfx_glyph_t *g;
+
+    for (i = 0; i < c->capacity; ++i) {
+        g = &c->glyphs[i];
+        if (!g->font || (pixels_only && !g->w)) continue;
+        if (victim < 0 || (uint32_t)(c->clock - g->used) > (uint32_t)(c->clock - c->glyphs[victim].used))
+            victim = i;
+    }
+    if (victim < 0) return 0;
+    g = &c->glyphs[victim];
+    for (link = &c->hash[pas_gfx__glyph_hash(g->font, g->size, g->codepoint)]; *link != victim;
+         link = &c->glyphs[*link].hash_next) {}
+    *link = g->hash_next;
+    if (g->w) {
+        for (link = &c->atlas_head; *link != victim; link = &c->glyphs[*link].atlas_next) {}
+        *link = g->atlas_next;
+    }
+    g->font = NULL;
+    g->atlas_next = c->free_head;
+    c->free_head = victim;
+    c->evictions++;
+    return 1;
+}
+
+/* First gap of need bytes between live bitmaps; *link is where the new glyph goes in the list. */
+static int pas_gfx__atlas_find(pas_gfx_glyph_cache_t *c, size_t need, size_t *offset, int **link)
+{
+    size_t pos = 0;
+    int *l = &c->atlas_head;
+
+    for (;;) {
+        size_t end = *l >= 0 ? c->glyphs[*l].offset : c->atlas_size;
+        if (end - pos >= need) {
+            *offset = pos;
+            *link = l;
+            return 1;
+        }
+        if (*l < 0) return 0;
+        pos = c->glyphs[*l].offset + (size_t)c->glyphs[*l].w * (size_t)c->glyphs[*l].h;
+        l = &c->glyphs[*l].atlas_next;
+    }
+}
+
+/* Lookup only: nothing in the cache is written, so concurrent tile workers may call it. */
+static pas_gfx_glyph_t *pas_gfx__glyph_find(const pas_gfx_glyph_cache_t *c, const pas_font_t *font, uint32_t cp)
+{
+    int i;
+    for (i = c->hash[pas_gfx__glyph_hash(font, font->size, cp)]; i >= 0; i = c->glyphs[i].hash_next) {
+        pas_gfx_glyph_t *g = &c->glyphs[i];
+        if (g->codepoint == cp && g->font == font && g->size == font->size) return g;
+    }
+    return NULL;
+}
+
+/* Cached glyph for cp, rasterized into the atlas on a miss; NULL if it cannot be cached. */
+static pas_gfx_glyph_t *pas_gfx__glyph_get(pas_gfx_glyph_cache_t *c, const pas_font_t *font, uint32_t cp)
+{
+    unsigned h = pas_gfx__glyph_hash(font, font->size, cp);
+    pas_gfx_glyph_t tmp, *g;
+    size_t need, offset = 0;
+    int i, *link = NULL;
+
+    g = pas_gfx__glyph_find(c, font, cp);
+    if (g) {
+        g->used = ++c->clock;
+        c->hits++;
+        return g;
+    }
+    if (c->capacity <= 0) return NULL;
+
+    c->misses++;
+    pas_gfx__glyph_metrics(font, cp, &tmp);
+    need = (size_t)tmp.w * (size_t)tmp.h;
+    if (need > c->atlas_size) return NULL;
+    if (c->free_head < 0) (void)pas_gfx__glyph_evict(c, 0);
+    if (need) {
+        while (!pas_gfx__atlas_find(c, need, &offset, &link))
+            if (!pas_gfx__glyph_evict(c, 1)) return NULL;
+    }
+
+    i = c->free_head;
+    g = &c->glyphs[i];
+    c->free_head = g->atlas_next;
+    *g = tmp;
+    g->font = font;
+    g->size = font->size;
+    g->offset = offset;
+    g->used = ++c->clock;
+    g->hash_next = c->hash[h];
+    c->hash[h] = i;
+    g->atlas_next = -1;
+    if (need) {
+        g->atlas_next = *link;
+        *link = i;
+        stbtt_MakeGlyphBitmap(&font->info, c->atlas + offset, g->w, g->h, g->w, font->scale, font->scale, g->index);
+    }
+    return g;
+}
+
+static int pas_gfx__kern(pas_gfx_glyph_cache_t *c, const pas_font_t *font, int a, int b, int shared)
+{
+    pas_gfx_kern_t *k;
+
+    if (!c) return stbtt_GetGlyphKernAdvance(&font->info, a, b);
+    k = &c->kern[((unsigned)a * 31u + (unsigned)b) & (PAS_GFX_KERN_CACHE - 1)];
+    if (k->font != font || k->a != a || k->b != b) {
+        if (shared) return stbtt_GetGlyphKernAdvance(&font->info, a, b);
+        k->font = font;
+        k->a = a;
+        k->b = b;
+        k->kern = stbtt_GetGlyphKernAdvance(&font->info, a, b);
+    }
+    return k->kern;
+}
+
+#define PAS_GFX__GLYPH_BLOCK 128   /* side of the stack buffer uncached glyphs rasterize into */
+
+/* Draws an uncached glyph too big for buf as blocks of at most PAS_GFX__GLYPH_BLOCK
+   square, each rasterized at its offset into the glyph box; clipped-out blocks are skipped. */
+static void pas_gfx__glyph_blocks(pas_gfx_fb_t *fb, const pas_font_t *font, const pas_gfx_glyph_t *g,
+                                  int x, int y, uint32_t color, unsigned char *buf)
+{
+    stbtt_vertex *v = NULL;
+    int n = stbtt_GetGlyphShape(&font->info, g->index, &v), bx, by;
+
+    for (by = 0; n > 0 && by < g->h; by += PAS_GFX__GLYPH_BLOCK) {
+        for (bx = 0; bx < g->w; bx += PAS_GFX__GLYPH_BLOCK) {
+            stbtt__bitmap bm;
+            int cx = x + bx, cy = y + by, cw, ch;
+
+            bm.w = cw = g->w - bx < PAS_GFX__GLYPH_BLOCK ? g->w - bx : PAS_GFX__GLYPH_BLOCK;
+            bm.h = ch = g->h - by < PAS_GFX__GLYPH_BLOCK ? g->h - by : PAS_GFX__GLYPH_BLOCK;
+            bm.stride = bm.w;
+            bm.pixels = buf;
+            if (!pas_gfx__clip(fb, &cx, &cy, &cw, &ch)) continue;
+            stbtt_Rasterize(&bm, 0.35f, v, n, font->scale, font->scale, 0.0f, 0.0f,
+                            g->x0 + bx, g->y0 + by, 1, font->info.userdata);
+            pas_gfx_bitmap(fb, x + bx, y + by, buf, bm.w, bm.h, color);
+        }
+    }
+    stbtt_FreeShape(&font->info, v);
+}
+
+/* Restores fb->damage and reports the line's box, if any. */
+static void pas_gfx__text_damage(pas_gfx_fb_t *fb, pas_gfx_damage_t *damage, pas_gfx_rect_t *line)
+{
+    fb->damage = damage;
+    if (line->w) pas_gfx__damage(fb, line->x, line->y, line->w, line->h);
+    fb->damage = NULL;
+    line->w = 0;
+}
+
 void pas_gfx_text(pas_gfx_fb_t *fb, pas_font_t *font,
                   int x, int y, const char *text, uint32_t color)
 {
     int pen_x = x;
     int pen_y;
-    const unsigned char *s = (const unsigned char *)text;
-    unsigned char glyph_bitmap[128 * 128];
-
-    if (!fb || !fb->pixels || !font || !text) return;
+    int prev = -1, prev_advance = 0;
+    pas_gfx_rect_t line = { 0, 0, 0, 0 };
+    pas_gfx_damage_t *damage;
+    const pasu_uint8 *s = (const pasu_uint8 *)text;
+    pasu_size pos = 0, len = 0;
+    unsigned char glyph_bitmap[PAS_GFX__GLYPH_BLOCK * PAS_GFX__GLYPH_BLOCK];
+    int shared;
+
+    if (!text) return;
+    while (s[len]) ++len;
+    if (font && pas_gfx__record(fb, PAS_GFX__OP_TEXT, x, y, 0, 0, 0, color, text, font)) {
+        /* rasterize and kern now, so tile workers only ever read the cache */
+        while (font->cache && pos < len) {
+            pasu_codepoint cp;
+            pas_gfx_glyph_t *g;
+            (void)pasu_utf8_next(s, len, &pos, &cp);
+            if (cp == '\n') {
+                prev = -1;
+                continue;
+            }
+            g = pas_gfx__glyph_get(font->cache, font, cp);
+            if (!g) continue;
+            if (prev >= 0) (void)pas_gfx__kern(font->cache, font, prev, g->index, 0);
+            prev = g->index;
+        }
+        return;
+    }
+    if (!fb || !fb->pixels || !font) return;
+    shared = (fb->flags & PAS_GFX__FB_SHARED) != 0;
 
     pen_y = y + (int)(font->ascent * font->scale);
 
-    while (*s) {
-        int ch = *s++;
-        int gx0, gy0, gx1, gy1;
-        int gw, gh;
-        int x_off, y_off;
-        int advance, kern = 0;
-        int gy, gx;
+    /* glyph blits do not report; each line's ink box does */
+    damage = fb->damage;
+    fb->damage = NULL;
+
+    while (pos < len) {
+        pasu_codepoint cp;
+        pas_gfx_glyph_t tmp, *g = NULL;
 
-        if (ch == '\n') {
+        (void)pasu_utf8_next(s, len, &pos, &cp);   /* ill-formed bytes come back as U+FFFD */
+        if (cp == '\n') {
+            pas_gfx__text_damage(fb, damage, &line);
             pen_x = x;
             pen_y += (int)((font->ascent - font->descent + font->line_gap) * font->scale);
+            prev = -1;
             continue;
         }
 
-        stbtt_GetCodepointHMetrics(&font->info, ch, &advance, NULL);
+        if (font->cache)
+            g = shared ? pas_gfx__glyph_find(font->cache, font, cp) : pas_gfx__glyph_get(font->cache, font, cp);
+        if (!g) {
+            pas_gfx__glyph_metrics(font, cp, &tmp);
+            g = &tmp;
+        }
 
-        stbtt_GetCodepointBitmapBox(&font->info, ch,
-                                    font->scale, font->scale,
-                                    &gx0, &gy0, &gx1, &gy1);
-        gw = gx1 - gx0;
-        gh = gy1 - gy0;
-        if (gw <= 0 || gh <= 0) {
-            pen_x += (int)(advance * font->scale);
-            continue;
+        /* advance past the previous glyph, kerned against this one */
+        if (prev >= 0)
+            pen_x += (int)((prev_advance + pas_gfx__kern(font->cache, font, prev, g->index, shared)) * font->scale);
+        prev = g->index;
+        prev_advance = g->advance;
+
+        if (!g->w) continue;
+        if (damage) {
+            pas_gfx_rect_t r;
+            r.x = pen_x + g->x0;
+            r.y = pen_y + g->y0;
+            r.w = g->w;
+            r.h = g->h;
+            line = line.w ? pas_gfx__union(&line, &r) : r;
         }
-        if (gw > 128 || gh > 128) {
-            pen_x += (int)(advance * font->scale);
-            continue;
+        if (g != &tmp) {
+            pas_gfx_bitmap(fb, pen_x + g->x0, pen_y + g->y0, font->cache->atlas + g->offset, g->w, g->h, color);
+        } else if (g->w <= PAS_GFX__GLYPH_BLOCK && g->h <= PAS_GFX__GLYPH_BLOCK) {
+            stbtt_MakeGlyphBitmap(&font->info, glyph_bitmap, g->w, g->h, g->w, font->scale, font->scale, g->index);
+            pas_gfx_bitmap(fb, pen_x + g->x0, pen_y + g->y0, glyph_bitmap, g->w, g->h, color);
+        } else {
+            pas_gfx__glyph_blocks(fb, font, g, pen_x + g->x0, pen_y + g->y0, color, glyph_bitmap);
         }
+    }
+    pas_gfx__text_damage(fb, damage, &line);
+    fb->damage = damage;
+}
 
-        stbtt_MakeCodepointBitmap(&font->info,
-                                  glyph_bitmap, gw, gh, gw,
-                                  font->scale, font->scale, ch);
-
-        x_off = pen_x + gx0;
-        y_off = pen_y + gy0;
-
-        for (gy = 0; gy < gh; ++gy) {
-            int yy = y_off + gy;
-            if ((unsigned)yy >= (unsigned)fb->height) continue;
-            for (gx = 0; gx < gw; ++gx) {
-                int xx = x_off + gx;
-                uint8_t cov;
-                uint32_t *dst;
-                if ((unsigned)xx >= (unsigned)fb->width) continue;
-                cov = glyph_bitmap[gy * gw + gx];
-                if (cov == 0) continue;
-                dst = &fb->pixels[yy * fb->pitch + xx];
-                *dst = pas_gfx__blend_rgba(*dst, color, cov);
+#endif /* PAS_GFX_USE_STB_TRUETYPE */
+
+/* Command lists and tiled replay */
+
+void pas_gfx_cmdlist_init(pas_gfx_cmdlist_t *list, pas_gfx_cmd_t *cmds, int capacity)
+{
+    if (!list) return;
+    list->cmds = cmds;
+    list->capacity = cmds ? capacity : 0;
+    list->count = 0;
+    list->overflow = 0;
+}
+
+void pas_gfx_cmdlist_reset(pas_gfx_cmdlist_t *list)
+{
+    if (!list) return;
+    list->count = 0;
+    list->overflow = 0;
+}
+
+typedef struct pas_gfx__worker {
+    pas_gfx_fb_t             view;     /* fb copy whose clip is the current tile */
+    const pas_gfx_cmdlist_t *list;
+    pas_gfx_rect_t           area;     /* fb clip when replay started */
+    int                      depth;    /* fb clip depth when replay started */
+    int                      tile_w, tile_h, tiles_x, tiles, first, step;
+    pas_gfx_damage_t         damage;
+    pas_gfx_rect_t           rects[PAS_GFX_WORKER_DAMAGE];
+} pas_gfx__worker_t;
+
+/* Bounds of what a command can touch, for skipping tiles; 0 if not known up front. */
+static int pas_gfx__cmd_bounds(const pas_gfx_cmd_t *c, int *x, int *y, int *w, int *h)
+{
+    switch (c->op) {
+    case PAS_GFX__OP_PIXEL:  *x = c->a; *y = c->b; *w = 1; *h = 1; return 1;
+    case PAS_GFX__OP_RECT:
+    case PAS_GFX__OP_FILL_ROUND_RECT:
+    case PAS_GFX__OP_FILL_POLYGON:
+    case PAS_GFX__OP_HLINE:
+    case PAS_GFX__OP_VLINE:
+    case PAS_GFX__OP_BITMAP: *x = c->a; *y = c->b; *w = c->c; *h = c->d; return 1;
+    case PAS_GFX__OP_CIRCLE:
+    case PAS_GFX__OP_FILL_CIRCLE:
+    case PAS_GFX__OP_CIRCLE_AA: *x = c->a - c->c; *y = c->b - c->c; *w = 2 * c->c + 1; *h = *w; return 1;
+    case PAS_GFX__OP_LINE:
+    case PAS_GFX__OP_LINE_AA:
+        *x = c->a < c->c ? c->a : c->c;
+        *y = c->b < c->d ? c->b : c->d;
+        *w = (c->a < c->c ? c->c - c->a : c->a - c->c) + 1;
+        *h = (c->b < c->d ? c->d - c->b : c->b - c->d) + 1;
+        return 1;
+    default: return 0;
+    }
+}
+
+static void pas_gfx__replay_cmd(pas_gfx_fb_t *fb, const pas_gfx_cmd_t *c)
+{
+    switch (c->op) {
+    case PAS_GFX__OP_PIXEL:  pas_gfx_pixel(fb, c->a, c->b, c->color); break;
+    case PAS_GFX__OP_LINE:   pas_gfx_line(fb, c->a, c->b, c->c, c->d, c->color); break;
+    case PAS_GFX__OP_RECT:   pas_gfx_rect(fb, c->a, c->b, c->c, c->d, c->color); break;
+    case PAS_GFX__OP_HLINE:  pas_gfx_hline(fb, c->a, c->b, c->c, c->color); break;
+    case PAS_GFX__OP_VLINE:  pas_gfx_vline(fb, c->a, c->b, c->d, c->color); break;
+    case PAS_GFX__OP_CIRCLE: pas_gfx_circle(fb, c->a, c->b, c->c, c->color); break;
+    case PAS_GFX__OP_BITMAP:
+        pas_gfx_bitmap(fb, c->a, c->b, (const uint8_t *)c->p, c->c, c->d, c->color);
+        break;
+    case PAS_GFX__OP_FILL_CIRCLE:     pas_gfx_fill_circle(fb, c->a, c->b, c->c, c->color); break;
+    case PAS_GFX__OP_FILL_ROUND_RECT: pas_gfx_fill_round_rect(fb, c->a, c->b, c->c, c->d, c->e, c->color); break;
+    case PAS_GFX__OP_FILL_POLYGON:    pas_gfx_fill_polygon(fb, (const int *)c->p, c->e, c->color); break;
+    case PAS_GFX__OP_LINE_AA:         pas_gfx_line_aa(fb, c->a, c->b, c->c, c->d, c->color); break;
+    case PAS_GFX__OP_CIRCLE_AA:       pas_gfx_circle_aa(fb, c->a, c->b, c->c, c->color); break;
+#ifdef PAS_GFX_USE_STB_TRUETYPE
+    case PAS_GFX__OP_TEXT:
+        pas_gfx_text(fb, (pas_font_t *)c->q, c->a, c->b, (const char *)c->p, c->color);
+        break;
+#endif
+    case PAS_GFX__OP_TEXT_MONO: pas_gfx_text_mono(fb, c->a, c->b, (const char *)c->p, c->color, c->c); break;
+    case PAS_GFX__OP_FRAME:  pas_gfx_window_frame(fb, c->a, c->b, c->c, c->d, (const char *)c->p, c->color); break;
+    case PAS_GFX__OP_BUTTON: pas_gfx_button(fb, c->a, c->b, c->c, c->d, (const char *)c->p, c->e); break;
+    default: break;
+    }
+}
+
+static void pas_gfx__replay_tiles(pas_gfx__worker_t *w)
+{
+    int t, i;
+
+    for (t = w->first; t < w->tiles; t += w->step) {
+        int tx = w->area.x + (t % w->tiles_x) * w->tile_w;
+        int ty = w->area.y + (t / w->tiles_x) * w->tile_h;
+        int base, skipped = 0;
+
+        /* the tile, cut to the fb clip, goes on the fb's own stack in the extra level,
+           so the list nests as deep as it could drawing directly and cannot pop it */
+        w->view.clip_depth = w->depth;
+        (void)pas_gfx_clip_push(&w->view, tx, ty, w->tile_w, w->tile_h);
+        base = w->view.clip_depth;
+
+        for (i = 0; i < w->list->count; ++i) {
+            const pas_gfx_cmd_t *c = &w->list->cmds[i];
+            int bx, by, bw, bh;
+
+            if (c->op == PAS_GFX__OP_CLIP_PUSH) {
+                if (pas_gfx_clip_push(&w->view, c->a, c->b, c->c, c->d) != 0) ++skipped;
+                continue;
+            }
+            if (c->op == PAS_GFX__OP_CLIP_POP) {
+                if (skipped) --skipped;
+                else if (w->view.clip_depth > base) pas_gfx_clip_pop(&w->view);
+                continue;
             }
+            if (pas_gfx__cmd_bounds(c, &bx, &by, &bw, &bh) && !pas_gfx__clip(&w->view, &bx, &by, &bw, &bh))
+                continue;
+            pas_gfx__replay_cmd(&w->view, c);
         }
+    }
+}
 
-        if (*s) {
-            kern = stbtt_GetCodepointKernAdvance(&font->info, ch, *s);
+#ifdef PAS_GFX_USE_THREADS
+#ifdef _WIN32
+static DWORD WINAPI pas_gfx__worker_main(LPVOID arg)
+{
+    pas_gfx__replay_tiles((pas_gfx__worker_t *)arg);
+    return 0;
+}
+#else
+static void *pas_gfx__worker_main(void *arg)
+{
+    pas_gfx__replay_tiles((pas_gfx__worker_t *)arg);
+    return NULL;
+}
+#endif
+#endif
+
+int pas_gfx_replay(pas_gfx_fb_t *fb, const pas_gfx_cmdlist_t *list, int tile_w, int tile_h, int threads)
+{
+    pas_gfx__worker_t workers[PAS_GFX_MAX_THREADS];
+    pas_gfx_rect_t area;
+    int tiles_x, tiles, i, j;
+#ifdef PAS_GFX_USE_THREADS
+#ifdef _WIN32
+    HANDLE handles[PAS_GFX_MAX_THREADS];
+#else
+    pthread_t handles[PAS_GFX_MAX_THREADS];
+#endif
+    int started[PAS_GFX_MAX_THREADS];
+#endif
+
+    if (!fb || !fb->pixels || !list) return -1;
+    area = pas_gfx_clip_get(fb);
+    if (list->count > 0 && area.w > 0 && area.h > 0) {
+        if (tile_w <= 0) tile_w = PAS_GFX_TILE;
+        if (tile_h <= 0) tile_h = PAS_GFX_TILE;
+        tiles_x = (int)(((int64_t)area.w + tile_w - 1) / tile_w);
+        tiles = tiles_x * (int)(((int64_t)area.h + tile_h - 1) / tile_h);
+#ifndef PAS_GFX_USE_THREADS
+        threads = 1;
+#endif
+        if (threads > PAS_GFX_MAX_THREADS) threads = PAS_GFX_MAX_THREADS;
+        if (threads > tiles) threads = tiles;
+        if (threads < 1) threads = 1;
+
+        for (i = 0; i < threads; ++i) {
+            pas_gfx__worker_t *w = &workers[i];
+            w->view = *fb;
+            w->view.record = NULL;
+            w->view.flags |= PAS_GFX__FB_TILE;
+            if (threads > 1) w->view.flags |= PAS_GFX__FB_SHARED;
+            pas_gfx_damage_init(&w->damage, w->rects, PAS_GFX_WORKER_DAMAGE);
+            w->view.damage = fb->damage ? &w->damage : NULL;
+            w->list = list;
+            w->area = area;
+            w->depth = fb->clip_depth;
+            w->tile_w = tile_w;
+            w->tile_h = tile_h;
+            w->tiles_x = tiles_x;
+            w->tiles = tiles;
+            w->first = i;
+            w->step = threads;
+        }
+
+#ifdef PAS_GFX_USE_THREADS
+        for (i = 1; i < threads; ++i) {
+#ifdef _WIN32
+            handles[i] = CreateThread(NULL, 0, pas_gfx__worker_main, &workers[i], 0, NULL);
+            started[i] = handles[i] != NULL;
+#else
+            started[i] = pthread_create(&handles[i], NULL, pas_gfx__worker_main, &workers[i]) == 0;
+#endif
+            if (!started[i]) pas_gfx__replay_tiles(&workers[i]);   /* no thread: do its share here */
         }
-        pen_x += (int)((advance + kern) * font->scale);
+#endif
+        pas_gfx__replay_tiles(&workers[0]);
+#ifdef PAS_GFX_USE_THREADS
+        for (i = 1; i < threads; ++i) {
+            if (!started[i]) continue;
+#ifdef _WIN32
+            (void)WaitForSingleObject(handles[i], INFINITE);
+            (void)CloseHandle(handles[i]);
+#else
+            (void)pthread_join(handles[i], NULL);
+#endif
+        }
+#endif
+
+        /* per-worker damage into the fb's list */
+        for (i = 0; fb->damage && i < threads; ++i)
+            for (j = 0; j < workers[i].damage.count; ++j)
+                pas_gfx__damage(fb, workers[i].rects[j].x, workers[i].rects[j].y,
+                                workers[i].rects[j].w, workers[i].rects[j].h);
     }
+    return list->overflow ? -1 : 0;
 }
 
-#endif /* PAS_GFX_USE_STB_TRUETYPE */
-
 #endif /* PAS_GFX_IMPLEMENTATION */
 
 #endif /* PAS_GFX_H */
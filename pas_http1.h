@@ -4,6 +4,14 @@
     - No malloc: user provides response_buffer; all parsing points into it.
     - Uses OS sockets only (Winsock2 on Windows, BSD sockets on Unix).
     - GET and POST; URL parsing; request/response headers; timeouts.
+    - Responses framed by Content-Length or chunked encoding (decoded in place).
+    - Zero-copy header index with direct lookup of well-known headers.
+    - Caller request headers, serialized into your buffer or sent as iovecs.
+    - Optional client object with a caller-sized keep-alive connection pool.
+    - Streaming callbacks; pipelining; a poll-driven engine for many concurrent requests.
+    - IPv4 and IPv6 with a happy-eyeballs connect race and an optional DNS cache.
+    - Optional gzip / deflate response decoding through the pas_zip inflate backend.
+    - Per-request phase timing (DNS, connect, first byte, transfer) and byte counts.
 
     Usage:
         In ONE translation unit:
@@ -18,6 +26,13 @@
 #define PAS_HTTP1_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* gzip / deflate decoding uses the pas_zip backend when one is selected */
+#if defined(PAS_ZIP_USE_MINIZ) || defined(PAS_ZIP_USE_ZLIB)
+#include "pas_zip.h"
+#define PAS_HTTP_HAS_DECODE 1
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,6 +44,20 @@ extern "C" {
 #define PAS_HTTP_E_CONNECTION -2
 #define PAS_HTTP_E_TIMEOUT    -3
 #define PAS_HTTP_E_NOSPACE    -4
+#define PAS_HTTP_E_ABORTED    -5   /* a streaming callback returned non-zero */
+#define PAS_HTTP_E_DECODE     -6   /* a gzip / deflate body was corrupt or truncated */
+
+#define PAS_HTTP_MAX_HOST 256
+#define PAS_HTTP_DEFAULT_IDLE_MS 15000
+#define PAS_HTTP_MAX_ADDRS 4                 /* addresses kept per host:port */
+#define PAS_HTTP_DEFAULT_DNS_TTL_MS 60000
+#define PAS_HTTP_DEFAULT_STAGGER_MS 250      /* delay before racing the next address */
+
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+typedef uintptr_t pas_http_socket;   /* SOCKET */
+#else
+typedef int pas_http_socket;
+#endif
 
 typedef struct pas_http_response {
     int         status_code;   /* e.g. 200, 404 */
@@ -42,6 +71,9 @@ typedef struct pas_http_response {
     pas_http_get:
         Fetches url via GET, reads response into response_buffer (up to buffer_size).
         Fills out_response with status_code, headers, body (all pointing into response_buffer).
+        Reading stops once the message is complete (Content-Length, last chunk, or a
+        bodyless status); chunked bodies are decoded in place. Only responses with
+        neither header are read until the server closes.
         timeout_ms: send/recv timeout in milliseconds (0 = use implementation default).
         status: receives PAS_HTTP_OK or PAS_HTTP_E_*.
         Returns 0 on success, non-zero on error (same as *status).
@@ -54,7 +86,8 @@ int pas_http_get(const char *url,
 
 /*
     pas_http_post:
-        Sends body (body_len bytes) to url via POST.
+        Sends body (body_len bytes) to url via POST. body may be NULL only when
+        body_len is 0; a NULL body with a length gives PAS_HTTP_E_INVALID_URL.
         Same semantics as pas_http_get for response_buffer and out_response.
 */
 int pas_http_post(const char *url,
@@ -64,6 +97,402 @@ int pas_http_post(const char *url,
                   pas_http_response_t *out_response,
                   int *status);
 
+/*
+    Header index:
+        pas_http_headers_parse splits out_response->headers into (name, value)
+        slices in one pass; nothing is copied, everything points into the response
+        buffer. Well-known names are classified as PAS_HTTP_H_* so
+        pas_http_headers_get finds them by index; pas_http_headers_find takes any
+        name (case-insensitive) and pas_http_headers_next walks repeated headers.
+        Values are trimmed of surrounding whitespace. Returns PAS_HTTP_E_NOSPACE if
+        the response has more header lines than cap (the first cap are indexed).
+*/
+enum {
+    PAS_HTTP_H_OTHER = -1,
+    PAS_HTTP_H_CONTENT_LENGTH, PAS_HTTP_H_CONTENT_TYPE, PAS_HTTP_H_CONTENT_ENCODING,
+    PAS_HTTP_H_TRANSFER_ENCODING, PAS_HTTP_H_CONNECTION, PAS_HTTP_H_KEEP_ALIVE,
+    PAS_HTTP_H_LOCATION, PAS_HTTP_H_ETAG, PAS_HTTP_H_LAST_MODIFIED, PAS_HTTP_H_CACHE_CONTROL,
+    PAS_HTTP_H_EXPIRES, PAS_HTTP_H_DATE, PAS_HTTP_H_AGE, PAS_HTTP_H_VARY, PAS_HTTP_H_SET_COOKIE,
+    PAS_HTTP_H_SERVER, PAS_HTTP_H_CONTENT_RANGE, PAS_HTTP_H_ACCEPT_RANGES, PAS_HTTP_H_RETRY_AFTER,
+    PAS_HTTP_H_WWW_AUTHENTICATE, PAS_HTTP_H_HOST, PAS_HTTP_H_ACCEPT_ENCODING,
+    PAS_HTTP_H_COUNT
+};
+
+typedef struct pas_http_header {
+    const char *name;        /* points into your buffer; not null-terminated */
+    size_t      name_len;
+    const char *value;
+    size_t      value_len;
+    int         id;          /* PAS_HTTP_H_*, or PAS_HTTP_H_OTHER */
+} pas_http_header_t;
+
+typedef struct pas_http_headers {
+    pas_http_header_t *items;                    /* caller array, in response order */
+    size_t             count;
+    size_t             cap;
+    int                first[PAS_HTTP_H_COUNT];  /* index into items, -1 if absent */
+} pas_http_headers_t;
+
+int pas_http_headers_parse(pas_http_headers_t *headers, pas_http_header_t *items, size_t cap,
+                           const pas_http_response_t *response);
+
+/* First header with the given PAS_HTTP_H_* id, or NULL. */
+const pas_http_header_t *pas_http_headers_get(const pas_http_headers_t *headers, int id);
+
+/* First header named name (case-insensitive), or NULL. */
+const pas_http_header_t *pas_http_headers_find(const pas_http_headers_t *headers, const char *name);
+
+/* Next header after prev with the same name, or NULL. */
+const pas_http_header_t *pas_http_headers_next(const pas_http_headers_t *headers,
+                                               const pas_http_header_t *prev);
+
+/* PAS_HTTP_H_* id of a header name (case-insensitive), or PAS_HTTP_H_OTHER. */
+int pas_http_header_id(const char *name, size_t name_len);
+
+/*
+    DNS cache:
+        getaddrinfo results for host:port kept in caller-provided entries for ttl_ms
+        (the resolver does not report record TTLs). Addresses are stored IPv6 first,
+        alternating with IPv4. An entry is dropped when none of its addresses
+        connects; with every entry in use the least recently used one is replaced.
+        Share a cache between clients only from one thread.
+*/
+typedef struct pas_http_addr {
+    int      family;   /* AF_INET or AF_INET6 */
+    int      len;      /* bytes used in sa */
+    uint64_t sa[4];    /* struct sockaddr_in / sockaddr_in6 */
+} pas_http_addr_t;
+
+typedef struct pas_http_dns_entry {
+    char            host[PAS_HTTP_MAX_HOST];
+    int             port;
+    size_t          count;       /* 0 = free slot */
+    uint64_t        expires;     /* monotonic ms */
+    uint64_t        last_used;
+    pas_http_addr_t addrs[PAS_HTTP_MAX_ADDRS];
+} pas_http_dns_entry_t;
+
+typedef struct pas_http_dns_cache {
+    pas_http_dns_entry_t *entries;
+    size_t                count;
+    int                   ttl_ms;
+} pas_http_dns_cache_t;
+
+/* ttl_ms 0 = PAS_HTTP_DEFAULT_DNS_TTL_MS */
+void pas_http_dns_init(pas_http_dns_cache_t *cache, pas_http_dns_entry_t *entries, size_t count,
+                       int ttl_ms);
+
+/*
+    Timing:
+        Where a request spent its time. Timestamps are monotonic microseconds on
+        one clock (pas_http_now_us); a phase that did not happen is left 0, e.g.
+        resolved_us and connected_us when a pooled connection was reused
+        (connected_us is then the time it was taken), first_byte_us when nothing
+        came back. Subtract neighbours for the phases: DNS = resolved - start,
+        connect = connected - resolved, TTFB = first_byte - sent,
+        transfer = done - first_byte. Byte counts cover the whole request,
+        including a retried attempt. Client requests fill client->timing and call
+        client->on_timing when set; multi-engine requests fill req->timing.
+        Pipelines are not timed.
+*/
+typedef struct pas_http_timing {
+    uint64_t start_us;         /* request begun */
+    uint64_t resolved_us;      /* addresses looked up or taken from the DNS cache */
+    uint64_t connected_us;     /* connection established or taken from the pool */
+    uint64_t sent_us;          /* request head and body written */
+    uint64_t first_byte_us;    /* first response byte read */
+    uint64_t done_us;          /* response complete, or the request failed */
+    uint64_t bytes_sent;
+    uint64_t bytes_received;   /* as read from the socket (encoded, with framing) */
+    int      reused;           /* ran on an idle pooled connection */
+    int      retries;          /* fresh-connection retries after a pooled one failed */
+    int      status;           /* PAS_HTTP_OK or PAS_HTTP_E_* */
+} pas_http_timing_t;
+
+/* Called with the timing of every finished client request. */
+typedef void (*pas_http_timing_fn)(void *user, const pas_http_timing_t *timing);
+
+/* Monotonic clock of pas_http_timing_t, in microseconds. */
+uint64_t pas_http_now_us(void);
+
+/*
+    Keep-alive client:
+        The caller provides an array of pas_http_conn_t slots; pas_http_client_get /
+        pas_http_client_post reuse an open connection to the same host:port when one
+        is idle, and park the connection again once the response is fully read.
+        Responses must be framed (Content-Length, chunked, or no body) for the
+        connection to be reused; "Connection: close" or close-delimited bodies close it.
+        Idle connections older than idle_timeout_ms, or that the server has closed
+        or written to while idle, are dropped before reuse. If a reused connection
+        fails before any response byte arrives, the request is retried once on a
+        fresh connection. With no free slot, the least recently used idle connection
+        is closed. A client must not be used from two threads at once.
+        New connections race the resolved addresses (RFC 8305): the next one is
+        tried every connect_stagger_ms, or at once when an attempt fails, and the
+        first to complete wins. Set dns to a cache to skip repeated lookups.
+
+    Content decoding (PAS_ZIP_USE_MINIZ or PAS_ZIP_USE_ZLIB, pas_zip.h on the
+    include path, PAS_ZIP_IMPLEMENTATION in one translation unit):
+        With decode set, requests carry "Accept-Encoding: gzip, deflate" (unless
+        the caller passes an Accept-Encoding header) and a body with a single gzip,
+        x-gzip or deflate (zlib or raw) Content-Encoding is inflated. Buffered
+        responses are inflated after the message into the rest of response_buffer,
+        which must hold the compressed and the decoded body, and out_response->body
+        then points at the decoded bytes. Streamed bodies go through a
+        PAS_HTTP_DECODE_CHUNK stack buffer, so on_body sees decoded runs of at most
+        that size. The response headers are passed on unchanged (Content-Encoding
+        and Content-Length still describe the encoded body). A corrupt or truncated
+        body gives PAS_HTTP_E_DECODE. decode_work (PAS_ZIP_INFLATE_WORK_SIZE bytes)
+        holds the inflate state; NULL lets the backend allocate it. Pipelined and
+        multi-engine requests are not decoded. Without a backend decode is ignored.
+*/
+#ifndef PAS_HTTP_DECODE_CHUNK
+#define PAS_HTTP_DECODE_CHUNK 4096
+#endif
+
+typedef struct pas_http_conn {
+    char            host[PAS_HTTP_MAX_HOST];
+    int             port;
+    pas_http_socket sock;
+    int             open;
+    uint64_t        idle_since;   /* monotonic ms when parked */
+} pas_http_conn_t;
+
+typedef struct pas_http_client {
+    pas_http_conn_t      *conns;
+    size_t                conn_count;
+    int                   idle_timeout_ms;
+    pas_http_dns_cache_t *dns;                  /* NULL = resolve every new connection */
+    int                   connect_stagger_ms;   /* 0 = PAS_HTTP_DEFAULT_STAGGER_MS */
+    int                   decode;               /* inflate gzip / deflate bodies */
+    void                 *decode_work;
+    size_t                decode_work_size;
+    pas_http_timing_t    *timing;               /* optional: filled by every request */
+    pas_http_timing_fn    on_timing;            /* optional: called after every request */
+    void                 *timing_user;
+} pas_http_client_t;
+
+/* idle_timeout_ms 0 = PAS_HTTP_DEFAULT_IDLE_MS; dns, connect_stagger_ms, decode and the
+   timing fields start unset */
+void pas_http_client_init(pas_http_client_t *client, pas_http_conn_t *conns, size_t conn_count,
+                          int idle_timeout_ms);
+
+int pas_http_client_get(pas_http_client_t *client, const char *url,
+                        char *response_buffer, size_t buffer_size,
+                        int timeout_ms,
+                        pas_http_response_t *out_response,
+                        int *status);
+
+int pas_http_client_post(pas_http_client_t *client, const char *url,
+                         const void *body, size_t body_len,
+                         char *response_buffer, size_t buffer_size,
+                         int timeout_ms,
+                         pas_http_response_t *out_response,
+                         int *status);
+
+/* Closes every pooled connection. */
+void pas_http_client_close(pas_http_client_t *client);
+
+/*
+    Streaming responses:
+        The *_stream calls hand the response to callbacks as it arrives instead of
+        returning it in one buffer: on_status once, on_header for each header line,
+        then on_body for each run of body bytes (chunked bodies already decoded).
+        recv_buffer is reused for every read and only has to hold the status line
+        and headers (PAS_HTTP_E_NOSPACE otherwise); a few KB is enough. Any callback
+        may be NULL. A non-zero return from a callback stops the transfer with
+        PAS_HTTP_E_ABORTED and closes the connection. With a client of zero
+        connections, each call uses its own connection.
+*/
+typedef struct pas_http_callbacks {
+    int  (*on_status)(void *user, int status_code);
+    int  (*on_header)(void *user, const char *name, size_t name_len,
+                      const char *value, size_t value_len);
+    int  (*on_body)(void *user, const void *data, size_t len);
+    void  *user;
+} pas_http_callbacks_t;
+
+int pas_http_client_get_stream(pas_http_client_t *client, const char *url,
+                               const pas_http_callbacks_t *callbacks,
+                               char *recv_buffer, size_t recv_size,
+                               int timeout_ms,
+                               int *status);
+
+int pas_http_client_post_stream(pas_http_client_t *client, const char *url,
+                                const void *body, size_t body_len,
+                                const pas_http_callbacks_t *callbacks,
+                                char *recv_buffer, size_t recv_size,
+                                int timeout_ms,
+                                int *status);
+
+/*
+    Request headers:
+        Extra request headers are passed as an array of pas_http_header_t with name
+        and value set (name_len / value_len 0 = null-terminated; id is ignored).
+        They follow Host and come before the framing headers the library adds.
+        A Host, Content-Length, Transfer-Encoding, Connection or Accept-Encoding
+        header in the array replaces the one the library would add. Names or values holding CR
+        or LF give PAS_HTTP_E_INVALID_URL. The URL path has no length limit.
+
+        pas_http_client_request is the general call behind pas_http_client_get /
+        post and the *_stream variants: any method, headers, a body (NULL for none;
+        a Content-Length is sent otherwise, e.g. for a gzip-encoded upload), and
+        callbacks (NULL to return the response in response_buffer). The head goes
+        out as iovecs pointing at the URL, the header strings and the body, so
+        nothing is formatted or copied except the Content-Length digits.
+
+        pas_http_build_request serializes the same head (without a Connection
+        header) into buf. *out_len receives its length, also when buf is too small
+        (PAS_HTTP_E_NOSPACE), so a buffer can be sized with a first call.
+*/
+int pas_http_client_request(pas_http_client_t *client, const char *method, const char *url,
+                            const pas_http_header_t *headers, size_t header_count,
+                            const void *body, size_t body_len,
+                            const pas_http_callbacks_t *callbacks,
+                            char *response_buffer, size_t buffer_size,
+                            int timeout_ms,
+                            pas_http_response_t *out_response,
+                            int *status);
+
+int pas_http_build_request(char *buf, size_t size, const char *method, const char *url,
+                           const pas_http_header_t *headers, size_t header_count,
+                           const void *body, size_t body_len, size_t *out_len);
+
+/*
+    Pipelining:
+        pas_http_client_pipeline puts every item's request on one keep-alive
+        connection to their common host:port and reads the responses back in
+        order. Request heads and bodies are gathered into as few sendmsg / WSASend
+        calls as possible. Each item's buf first holds its formatted request (so it
+        must fit it) and then receives its response. Writing and reading overlap,
+        so a long pipeline does not stall against a server that answers while it
+        reads. If the server closes the connection part way, the unanswered items
+        keep PAS_HTTP_E_CONNECTION and may be submitted again. A reused connection
+        that fails before any response byte is retried once on a fresh one.
+        Returns PAS_HTTP_OK when every item succeeded, else the first item error
+        (or a setup error: URLs for different hosts, unusable buffers).
+        Zero the fields an item does not use (headers in particular).
+*/
+typedef struct pas_http_pipeline_item {
+    const char              *method;    /* "GET", "POST", ... */
+    const char              *url;
+    const pas_http_header_t *headers;   /* extra request headers, may be NULL */
+    size_t                   header_count;
+    const void              *body;      /* may be NULL */
+    size_t                   body_len;
+    char                    *buf;
+    size_t                   size;
+    /* results */
+    int                      status;
+    pas_http_response_t      response;
+    size_t                   req_len;   /* internal: formatted request length */
+} pas_http_pipeline_item_t;
+
+int pas_http_client_pipeline(pas_http_client_t *client,
+                             pas_http_pipeline_item_t *items, size_t count,
+                             int timeout_ms,
+                             int *status);
+
+/*
+    Multi-request engine:
+        Drives many requests from one thread. Each pas_http_request_t is a state
+        machine in caller memory; pas_http_request_init parses the URL and formats
+        the request into buf (which must hold it), and the same buf then receives
+        the response (or, with req->callbacks set, streams it). pas_http_multi_perform
+        resolves and starts new requests with a non-blocking connect, waits up to
+        timeout_ms (negative: until something happens) for socket activity with
+        poll / WSAPoll, advances every ready request, and fails those past their
+        deadline with PAS_HTTP_E_TIMEOUT. The deadline covers the whole request and
+        starts when it is first picked up. It returns the number of requests still
+        in flight; finished ones have done set and their result in status and
+        response. A finished slot may be initialised again and is picked up by the
+        next call. Each request uses its own connection (Connection: close).
+        At most PAS_HTTP_MULTI_MAX_FDS requests are polled per call; the rest wait.
+        Host names are resolved with a blocking getaddrinfo (or from multi->dns)
+        when a request starts; if a connect fails, the next address is tried.
+*/
+#ifndef PAS_HTTP_MULTI_MAX_FDS
+#define PAS_HTTP_MULTI_MAX_FDS 1024
+#endif
+
+/* Response framer state (internal; embedded in pas_http_request_t). */
+typedef struct pas_http__rx {
+    char    *buf;
+    size_t   cap;
+    size_t   len;          /* bytes received into buf */
+    size_t   scan;         /* where the blank-line search resumes */
+    size_t   head_len;     /* status line + headers + blank line; 0 until complete */
+    size_t   body;         /* start of the undelivered body (head_len until drained) */
+    size_t   body_len;     /* body bytes at buf + body */
+    uint64_t dropped;      /* body bytes delivered and drained */
+    size_t   extra;        /* bytes past the end of the message, at buf + len */
+    size_t   pos;          /* chunked: raw parse position */
+    size_t   out;          /* chunked: end of the decoded body */
+    uint64_t left;         /* LENGTH: body bytes outstanding; CHUNKED: bytes left in chunk */
+    int      digits;       /* chunked: hex digits seen in the size line */
+    int      framing;
+    int      chunk_state;
+    int      status_code;
+    int      keep_alive;   /* connection reusable once done */
+    int      coding;       /* Content-Encoding: PAS_HTTP__CODING_* */
+    int      head_req;     /* answer to HEAD: no body, whatever the headers say */
+    int      done;
+} pas_http__rx;
+
+typedef struct pas_http_request {
+    char                        host[PAS_HTTP_MAX_HOST];
+    int                         port;
+    const void                 *body;
+    size_t                      body_len;
+    const pas_http_callbacks_t *callbacks;   /* set after init to stream the response */
+    char                       *buf;
+    size_t                      size;
+    int                         timeout_ms;
+    /* results */
+    int                         done;
+    int                         status;      /* PAS_HTTP_OK or PAS_HTTP_E_* once done */
+    pas_http_response_t         response;    /* points into buf (not filled when streaming) */
+    pas_http_timing_t           timing;      /* phases of this request (reused, retries stay 0) */
+    /* engine state */
+    int                         state;
+    int                         head_sent;
+    pas_http_socket             sock;
+    uint64_t                    deadline;
+    size_t                      req_len;
+    size_t                      sent;        /* request head + body bytes written */
+    int                         head_req;    /* method is HEAD */
+    pas_http__rx                rx;
+    pas_http_addr_t             addrs[PAS_HTTP_MAX_ADDRS];
+    size_t                      addr_count;
+    size_t                      addr_next;   /* next address to try if the connect fails */
+} pas_http_request_t;
+
+typedef struct pas_http_multi {
+    pas_http_request_t   *reqs;
+    size_t                count;
+    pas_http_dns_cache_t *dns;   /* optional; set after pas_http_multi_init */
+} pas_http_multi_t;
+
+/* method "GET" / "POST" ...; body may be NULL. Returns PAS_HTTP_OK, or an error
+   (also stored in req->status with done set) if the URL or buf is unusable. */
+int pas_http_request_init(pas_http_request_t *req, const char *method, const char *url,
+                          const void *body, size_t body_len,
+                          char *buf, size_t size, int timeout_ms);
+
+/* Same, with extra request headers (see pas_http_client_request). */
+int pas_http_request_init_headers(pas_http_request_t *req, const char *method, const char *url,
+                                  const pas_http_header_t *headers, size_t header_count,
+                                  const void *body, size_t body_len,
+                                  char *buf, size_t size, int timeout_ms);
+
+/* reqs: caller array; slots never initialised must be zeroed. */
+void pas_http_multi_init(pas_http_multi_t *multi, pas_http_request_t *reqs, size_t count);
+
+int pas_http_multi_perform(pas_http_multi_t *multi, int timeout_ms);
+
+/* Closes the sockets of unfinished requests and marks them PAS_HTTP_E_ABORTED. */
+void pas_http_multi_cleanup(pas_http_multi_t *multi);
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,12 +510,16 @@ int pas_http_post(const char *url,
     #endif
     #include <winsock2.h>
     #include <ws2tcpip.h>
+    #include <windows.h>
     #pragma comment(lib, "ws2_32.lib")
     #define PAS_SOCKET_INVALID INVALID_SOCKET
     #define PAS_CLOSE_SOCKET(s) closesocket(s)
     #define PAS_ERRNO WSAGetLastError()
     #define PAS_EAGAIN WSAETIMEDOUT
     #define PAS_EWOULDBLOCK WSAEWOULDBLOCK
+    #define PAS_POLL(fds, n, ms) WSAPoll((fds), (ULONG)(n), (ms))
+    #define PAS_EINPROGRESS WSAEWOULDBLOCK
+    typedef WSAPOLLFD pas_http__pollfd;
 #else
     #include <sys/types.h>
     #include <sys/socket.h>
@@ -94,27 +527,42 @@ int pas_http_post(const char *url,
     #include <netdb.h>
     #include <unistd.h>
     #include <errno.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/time.h>
+    #include <sys/uio.h>
+    #include <time.h>
     typedef int SOCKET;
     #define PAS_SOCKET_INVALID (-1)
     #define PAS_CLOSE_SOCKET(s) close(s)
     #define PAS_ERRNO errno
     #define PAS_EAGAIN EAGAIN
     #define PAS_EWOULDBLOCK EWOULDBLOCK
+    #define PAS_POLL(fds, n, ms) poll((fds), (nfds_t)(n), (ms))
+    #define PAS_EINPROGRESS EINPROGRESS
+    typedef struct pollfd pas_http__pollfd;
+#endif
+
+#if defined(MSG_NOSIGNAL)
+#define PAS_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define PAS_SEND_FLAGS 0
 #endif
 
-#define PAS_HTTP_MAX_HOST 256
-#define PAS_HTTP_MAX_PATH 1024
 #define PAS_HTTP_DEFAULT_TIMEOUT_MS 30000
 
-static int pas_http_parse_url(const char *url, char *host_buf, size_t host_size,
-                              int *port, char *path_buf, size_t path_size)
+/* Splits an http:// URL. Only the host name is copied (getaddrinfo needs it
+   terminated); authority (host[:port], for the Host header) and path point into
+   url, and a missing path is "/". */
+static int pas_http__split_url(const char *url, char *host_buf, size_t host_size, int *port,
+                               const char **authority, size_t *authority_len,
+                               const char **path, size_t *path_len)
 {
     const char *p;
-    if (!url || !host_buf || host_size == 0 || !port || !path_buf || path_size == 0)
-        return -1;
+    size_t i = 0;
 
+    if (!url || !host_buf || host_size == 0) return -1;
     *port = 80;
-    if (path_size > 0) path_buf[0] = '\0';
 
     /* "http://" */
     if (url[0] != 'h' || url[1] != 't' || url[2] != 't' || url[3] != 'p')
@@ -125,14 +573,12 @@ static int pas_http_parse_url(const char *url, char *host_buf, size_t host_size,
     p = url + 7;
 
     /* host */
-    {
-        size_t i = 0;
-        while (*p && *p != ':' && *p != '/' && i < host_size - 1) {
-            host_buf[i++] = *p++;
-        }
-        host_buf[i] = '\0';
-        if (i == 0) return -1;
+    while (*p && *p != ':' && *p != '/') {
+        if (i == host_size - 1) return -1;
+        host_buf[i++] = *p++;
     }
+    host_buf[i] = '\0';
+    if (i == 0) return -1;
 
     /* port */
     if (*p == ':') {
@@ -144,20 +590,46 @@ static int pas_http_parse_url(const char *url, char *host_buf, size_t host_size,
             p++;
         }
     }
+    *authority = url + 7;
+    *authority_len = (size_t)(p - *authority);
 
     /* path */
-    if (*p == '\0' || *p != '/') {
-        if (path_size < 2) return -1;
-        path_buf[0] = '/';
-        path_buf[1] = '\0';
+    if (*p != '/') {
+        *path = "/";
+        *path_len = 1;
     } else {
-        size_t i = 0;
-        while (*p && i < path_size - 1) {
-            path_buf[i++] = *p++;
-        }
-        path_buf[i] = '\0';
+        *path = p;
+        *path_len = strlen(p);
+    }
+    return 0;
+}
+
+/* First '\n' in [p, end), or end. Eight bytes at a time: v ^ lf has a zero byte
+   where p has '\n', and (x - ones) & ~x & highs is non-zero iff x has one. */
+static const char *pas_http__find_lf(const char *p, const char *end)
+{
+    const uint64_t ones = ~(uint64_t)0 / 255, highs = ones * 0x80, lf = ones * '\n';
+
+    while ((size_t)(end - p) >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        v ^= lf;
+        if ((v - ones) & ~v & highs) break;
+        p += 8;
     }
+    while (p < end && *p != '\n') p++;
+    return p;
+}
+
+/* Offset just past the "\r\n\r\n" that ends a head starting the search at from,
+   or 0 if buf[0, len) does not hold one yet. */
+static size_t pas_http__head_end(const char *buf, size_t from, size_t len)
+{
+    const char *p, *end = buf + len;
 
+    if (len < from + 4) return 0;
+    for (p = buf + from + 3; (p = pas_http__find_lf(p, end)) < end; p++)
+        if (p[-1] == '\r' && p[-2] == '\n' && p[-3] == '\r') return (size_t)(p - buf) + 1;
     return 0;
 }
 
@@ -166,6 +638,7 @@ static int pas_http_parse_response(char *buf, size_t buf_len,
 {
     char *p = buf;
     char *end = buf + buf_len;
+    size_t head;
     if (buf_len < 12 || !out) return -1;
 
     out->headers = NULL;
@@ -187,79 +660,60 @@ static int pas_http_parse_response(char *buf, size_t buf_len,
         p++;
     }
 
-    /* find \r\n\r\n */
-    while (p + 4 <= end) {
-        if (p[0] == '\r' && p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
-            out->headers = buf + 0;
-            out->headers_len = (size_t)(p - buf);
-            out->body = p + 4;
-            out->body_len = (size_t)(end - (p + 4));
-            return 0;
-        }
-        p++;
-    }
-    return -1;
+    head = pas_http__head_end(buf, (size_t)(p - buf), buf_len);
+    if (!head) return -1;
+    out->headers = buf;
+    out->headers_len = head - 4;
+    out->body = buf + head;
+    out->body_len = buf_len - head;
+    return 0;
 }
 
-static int pas_http_do_request(const char *method, const char *host_buf, int port,
-                               const char *path_buf,
-                               const void *body, size_t body_len,
-                               char *response_buffer, size_t buffer_size,
-                               int timeout_ms,
-                               pas_http_response_t *out_response,
-                               int *status)
-{
-    SOCKET sock = PAS_SOCKET_INVALID;
-    struct addrinfo hints, *res = NULL;
-    char port_str[8];
-    char req_buf[2048];
-    int req_len;
-    size_t total_read = 0;
-    int r;
+/* --- Sockets and time --- */
 
+static int pas_http__startup(void)
+{
 #if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
     static int wsa_done;
     if (!wsa_done) {
         WSADATA wsa;
-        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
-            if (status) *status = PAS_HTTP_E_CONNECTION;
-            return PAS_HTTP_E_CONNECTION;
-        }
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return -1;
         wsa_done = 1;
     }
 #endif
+    return 0;
+}
 
-    if (status) *status = PAS_HTTP_OK;
-    if (out_response) {
-        out_response->status_code = 0;
-        out_response->headers = NULL;
-        out_response->headers_len = 0;
-        out_response->body = NULL;
-        out_response->body_len = 0;
-    }
-
-    if (buffer_size == 0 || !response_buffer) {
-        if (status) *status = PAS_HTTP_E_NOSPACE;
-        return PAS_HTTP_E_NOSPACE;
-    }
-
-    (void)snprintf(port_str, sizeof(port_str), "%d", port);
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-
-    if (getaddrinfo(host_buf, port_str, &hints, &res) != 0) {
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
-    }
+/* Monotonic milliseconds. */
+static uint64_t pas_http__now_ms(void)
+{
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+#endif
+}
 
-    sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (sock == PAS_SOCKET_INVALID) {
-        freeaddrinfo(res);
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
-    }
+uint64_t pas_http_now_us(void)
+{
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000u +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000u / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
 
+static void pas_http__set_timeouts(SOCKET sock, int timeout_ms)
+{
     if (timeout_ms <= 0) timeout_ms = PAS_HTTP_DEFAULT_TIMEOUT_MS;
 #if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
     {
@@ -276,151 +730,1887 @@ static int pas_http_do_request(const char *method, const char *host_buf, int por
         setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
     }
 #endif
+}
 
-    if (connect(sock, res->ai_addr, (int)res->ai_addrlen) != 0) {
-        PAS_CLOSE_SOCKET(sock);
-        freeaddrinfo(res);
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
+static int pas_http__would_block(void)
+{
+    int e = PAS_ERRNO;
+    return e == PAS_EAGAIN || e == PAS_EWOULDBLOCK;
+}
+
+static int pas_http__set_nonblocking(SOCKET sock, int on)
+{
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+    u_long arg = on ? 1 : 0;
+    return ioctlsocket(sock, FIONBIO, &arg) == 0 ? 0 : -1;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0) return -1;
+    flags = on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(sock, F_SETFL, flags) == 0 ? 0 : -1;
+#endif
+}
+
+/* --- Name resolution and connect --- */
+
+void pas_http_dns_init(pas_http_dns_cache_t *cache, pas_http_dns_entry_t *entries, size_t count,
+                       int ttl_ms)
+{
+    size_t i;
+    if (!cache) return;
+    cache->entries = entries;
+    cache->count = entries ? count : 0;
+    cache->ttl_ms = ttl_ms > 0 ? ttl_ms : PAS_HTTP_DEFAULT_DNS_TTL_MS;
+    for (i = 0; i < cache->count; i++) entries[i].count = 0;
+}
+
+static pas_http_dns_entry_t *pas_http__dns_find(pas_http_dns_cache_t *cache, const char *host, int port)
+{
+    size_t i;
+    if (!cache) return NULL;
+    for (i = 0; i < cache->count; i++) {
+        pas_http_dns_entry_t *e = &cache->entries[i];
+        if (e->count && e->port == port && strcmp(e->host, host) == 0) return e;
     }
-    freeaddrinfo(res);
-    res = NULL;
-
-    if (body && body_len > 0) {
-        req_len = snprintf(req_buf, sizeof(req_buf),
-            "%s %s HTTP/1.1\r\n"
-            "Host: %s\r\n"
-            "Connection: close\r\n"
-            "Content-Length: %zu\r\n"
-            "\r\n",
-            method, path_buf, host_buf, body_len);
-    } else {
-        req_len = snprintf(req_buf, sizeof(req_buf),
-            "%s %s HTTP/1.1\r\n"
-            "Host: %s\r\n"
-            "Connection: close\r\n"
-            "\r\n",
-            method, path_buf, host_buf);
+    return NULL;
+}
+
+/* Forgets host:port once none of its addresses connected. */
+static void pas_http__dns_forget(pas_http_dns_cache_t *cache, const char *host, int port)
+{
+    pas_http_dns_entry_t *e = pas_http__dns_find(cache, host, port);
+    if (e) e->count = 0;
+}
+
+/* Stores a lookup in a free, expired or least recently used entry. */
+static void pas_http__dns_store(pas_http_dns_cache_t *cache, pas_http_dns_entry_t *e, const char *host,
+                                int port, const pas_http_addr_t *addrs, size_t n, uint64_t now)
+{
+    size_t i, len = strlen(host);
+
+    if (len >= PAS_HTTP_MAX_HOST) return;
+    for (i = 0; !e && i < cache->count; i++)
+        if (!cache->entries[i].count || cache->entries[i].expires <= now) e = &cache->entries[i];
+    if (!e) {
+        e = &cache->entries[0];
+        for (i = 1; i < cache->count; i++)
+            if (cache->entries[i].last_used < e->last_used) e = &cache->entries[i];
     }
+    memcpy(e->host, host, len + 1);
+    e->port = port;
+    e->count = n;
+    memcpy(e->addrs, addrs, n * sizeof(addrs[0]));
+    e->expires = now + (uint64_t)cache->ttl_ms;
+    e->last_used = now;
+}
 
-    if (req_len <= 0 || (size_t)req_len >= sizeof(req_buf)) {
-        PAS_CLOSE_SOCKET(sock);
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
+/* Addresses for host:port, IPv6 and IPv4 interleaved (RFC 8305 section 4), from the
+   cache while fresh. Returns the count; 0 if the name does not resolve. */
+static size_t pas_http__resolve(pas_http_dns_cache_t *cache, const char *host, int port,
+                                pas_http_addr_t *out)
+{
+    struct addrinfo hints, *res = NULL, *ai;
+    pas_http_addr_t v6[PAS_HTTP_MAX_ADDRS], v4[PAS_HTTP_MAX_ADDRS];
+    size_t n6 = 0, n4 = 0, n = 0, i;
+    char port_str[8];
+    uint64_t now = pas_http__now_ms();
+    pas_http_dns_entry_t *e = pas_http__dns_find(cache, host, port);
+
+    if (e && now < e->expires) {
+        e->last_used = now;
+        memcpy(out, e->addrs, e->count * sizeof(out[0]));
+        return e->count;
     }
+    if (pas_http__startup() != 0) return 0;
 
-    if (send(sock, req_buf, (size_t)req_len, 0) != (size_t)req_len) {
-        PAS_CLOSE_SOCKET(sock);
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
+    (void)snprintf(port_str, sizeof(port_str), "%d", port);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+#if defined(AI_ADDRCONFIG)
+    hints.ai_flags = AI_ADDRCONFIG;
+#endif
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return 0;
+    for (ai = res; ai; ai = ai->ai_next) {
+        pas_http_addr_t *a;
+        if (ai->ai_addrlen > sizeof(v6[0].sa)) continue;
+        if (ai->ai_family == AF_INET6 && n6 < PAS_HTTP_MAX_ADDRS) a = &v6[n6++];
+        else if (ai->ai_family == AF_INET && n4 < PAS_HTTP_MAX_ADDRS) a = &v4[n4++];
+        else continue;
+        a->family = ai->ai_family;
+        a->len = (int)ai->ai_addrlen;
+        memcpy(a->sa, ai->ai_addr, ai->ai_addrlen);
+    }
+    freeaddrinfo(res);
+
+    for (i = 0; n < PAS_HTTP_MAX_ADDRS && (i < n6 || i < n4); i++) {
+        if (i < n6) out[n++] = v6[i];
+        if (i < n4 && n < PAS_HTTP_MAX_ADDRS) out[n++] = v4[i];
     }
+    if (n && cache && cache->count) pas_http__dns_store(cache, e, host, port, out, n, now);
+    return n;
+}
+
+/* Starts a non-blocking connect to a; returns the socket (state in *connected),
+   or PAS_SOCKET_INVALID if the attempt failed at once. */
+static SOCKET pas_http__connect_start(const pas_http_addr_t *a, int *connected)
+{
+    SOCKET sock = socket(a->family, SOCK_STREAM, 0);
 
-    if (body && body_len > 0) {
-        if (send(sock, (const char *)body, body_len, 0) != (int)body_len) {
-            PAS_CLOSE_SOCKET(sock);
-            if (status) *status = PAS_HTTP_E_CONNECTION;
-            return PAS_HTTP_E_CONNECTION;
+    *connected = 0;
+    if (sock == PAS_SOCKET_INVALID) return sock;
+    if (pas_http__set_nonblocking(sock, 1) == 0) {
+        if (connect(sock, (const struct sockaddr *)a->sa, a->len) == 0) {
+            *connected = 1;
+            return sock;
         }
+        if (PAS_ERRNO == PAS_EINPROGRESS || pas_http__would_block()) return sock;
     }
+    PAS_CLOSE_SOCKET(sock);
+    return PAS_SOCKET_INVALID;
+}
 
-    total_read = 0;
-    while (total_read < buffer_size) {
-        size_t to_read = buffer_size - total_read;
-#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
-        r = recv(sock, response_buffer + total_read, (int)to_read, 0);
-#else
-        r = (int)recv(sock, response_buffer + total_read, to_read, 0);
-#endif
-        if (r > 0) {
-            total_read += (size_t)r;
-        } else if (r == 0) {
-            break;
-        } else {
-            if (PAS_ERRNO == PAS_EAGAIN || PAS_ERRNO == PAS_EWOULDBLOCK) {
-                if (status) *status = PAS_HTTP_E_TIMEOUT;
-                PAS_CLOSE_SOCKET(sock);
-                return PAS_HTTP_E_TIMEOUT;
+/* 0 once a pending connect on sock has succeeded. */
+static int pas_http__connect_error(SOCKET sock)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char *)&err, &len) != 0) return -1;
+    return err;
+}
+
+/*
+    Happy eyeballs (RFC 8305): starts an attempt on addrs[0], and another on the
+    next address every stagger_ms or as soon as every running attempt has failed.
+    The first connect to complete wins; the others are closed.
+    Returns PAS_HTTP_OK, PAS_HTTP_E_TIMEOUT or PAS_HTTP_E_CONNECTION.
+*/
+static int pas_http__connect_race(const pas_http_addr_t *addrs, size_t n, int stagger_ms,
+                                  int timeout_ms, SOCKET *out)
+{
+    SOCKET socks[PAS_HTTP_MAX_ADDRS];
+    pas_http__pollfd fds[PAS_HTTP_MAX_ADDRS];
+    size_t map[PAS_HTTP_MAX_ADDRS];
+    size_t started = 0, live = 0, i;
+    uint64_t now = pas_http__now_ms();
+    uint64_t deadline = now + (uint64_t)timeout_ms, next_start = now;
+    SOCKET won = PAS_SOCKET_INVALID;
+    int st = PAS_HTTP_E_CONNECTION;
+
+    for (;;) {
+        size_t nfds = 0;
+        uint64_t wait;
+        int r;
+
+        now = pas_http__now_ms();
+        if (started < n && (now >= next_start || live == 0)) {
+            int connected;
+            socks[started] = pas_http__connect_start(&addrs[started], &connected);
+            if (connected) {
+                won = socks[started];
+                socks[started++] = PAS_SOCKET_INVALID;
+                break;
             }
+            if (socks[started] != PAS_SOCKET_INVALID) live++;
+            started++;
+            next_start = now + (uint64_t)stagger_ms;
+            continue;
+        }
+        if (live == 0) break;
+        if (now >= deadline) {
+            st = PAS_HTTP_E_TIMEOUT;
             break;
         }
+        for (i = 0; i < started; i++) {
+            if (socks[i] == PAS_SOCKET_INVALID) continue;
+            fds[nfds].fd = socks[i];
+            fds[nfds].events = POLLOUT;
+            fds[nfds].revents = 0;
+            map[nfds++] = i;
+        }
+        wait = deadline - now;
+        if (started < n && next_start - now < wait) wait = next_start - now;
+        r = PAS_POLL(fds, nfds, (int)wait);
+        if (r < 0) break;
+        for (i = 0; r > 0 && i < nfds && won == PAS_SOCKET_INVALID; i++) {
+            SOCKET s = socks[map[i]];
+            if (!fds[i].revents) continue;
+            socks[map[i]] = PAS_SOCKET_INVALID;
+            live--;
+            if (pas_http__connect_error(s) == 0 && !(fds[i].revents & POLLERR)) won = s;
+            else PAS_CLOSE_SOCKET(s);
+        }
+        if (won != PAS_SOCKET_INVALID) break;
     }
+    for (i = 0; i < started; i++)
+        if (socks[i] != PAS_SOCKET_INVALID) PAS_CLOSE_SOCKET(socks[i]);
+    if (won == PAS_SOCKET_INVALID) return st;
+    if (pas_http__set_nonblocking(won, 0) != 0) {
+        PAS_CLOSE_SOCKET(won);
+        return PAS_HTTP_E_CONNECTION;
+    }
+    *out = won;
+    return PAS_HTTP_OK;
+}
 
-    PAS_CLOSE_SOCKET(sock);
+/* Resolves host (through cache when given) and connects; returns PAS_HTTP_OK,
+   PAS_HTTP_E_TIMEOUT or PAS_HTTP_E_CONNECTION. tm, when given, receives the
+   lookup and connect times. */
+static int pas_http__open(pas_http_dns_cache_t *cache, const char *host, int port, int timeout_ms,
+                          int stagger_ms, pas_http_timing_t *tm, SOCKET *out)
+{
+    pas_http_addr_t addrs[PAS_HTTP_MAX_ADDRS];
+    size_t n;
+    int st;
 
-    if (total_read == 0) {
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
+    *out = PAS_SOCKET_INVALID;
+    if (timeout_ms <= 0) timeout_ms = PAS_HTTP_DEFAULT_TIMEOUT_MS;
+    if (stagger_ms <= 0) stagger_ms = PAS_HTTP_DEFAULT_STAGGER_MS;
+    n = pas_http__resolve(cache, host, port, addrs);
+    if (tm) tm->resolved_us = pas_http_now_us();
+    if (!n) return PAS_HTTP_E_CONNECTION;
+    st = pas_http__connect_race(addrs, n, stagger_ms, timeout_ms, out);
+    if (st != PAS_HTTP_OK) {
+        pas_http__dns_forget(cache, host, port);
+        return st;
     }
+    if (tm) tm->connected_us = pas_http_now_us();
+    pas_http__set_timeouts(*out, timeout_ms);
+    return PAS_HTTP_OK;
+}
 
-    if (total_read >= buffer_size && status)
-        *status = PAS_HTTP_E_NOSPACE;
+/* Scatter-gather sends: one sendmsg / WSASend covers up to PAS_HTTP__IOV_MAX slices. */
+#define PAS_HTTP__IOV_MAX 64
 
-    if (pas_http_parse_response(response_buffer, total_read, out_response) != 0) {
-        if (status) *status = PAS_HTTP_E_CONNECTION;
-        return PAS_HTTP_E_CONNECTION;
+typedef struct pas_http__slice {
+    const char *p;
+    size_t      n;
+} pas_http__slice;
+
+/* One gathered send; returns bytes written, 0 if it would block, -1 on error. */
+static long pas_http__sendv(SOCKET sock, const pas_http__slice *v, size_t n)
+{
+    size_t i;
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+    WSABUF b[PAS_HTTP__IOV_MAX];
+    DWORD sent = 0;
+
+    if (n > PAS_HTTP__IOV_MAX) n = PAS_HTTP__IOV_MAX;
+    for (i = 0; i < n; i++) {
+        b[i].buf = (char *)v[i].p;
+        b[i].len = (ULONG)(v[i].n > 0x40000000u ? 0x40000000u : v[i].n);
     }
+    if (WSASend(sock, b, (DWORD)n, &sent, 0, NULL, NULL) != 0)
+        return pas_http__would_block() ? 0 : -1;
+    return (long)sent;
+#else
+    struct iovec b[PAS_HTTP__IOV_MAX];
+    struct msghdr msg;
+    long r;
 
-    return (*status == PAS_HTTP_E_NOSPACE) ? PAS_HTTP_E_NOSPACE : 0;
+    if (n > PAS_HTTP__IOV_MAX) n = PAS_HTTP__IOV_MAX;
+    for (i = 0; i < n; i++) {
+        b[i].iov_base = (void *)v[i].p;
+        b[i].iov_len = v[i].n > 0x40000000u ? 0x40000000u : v[i].n;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = b;
+    msg.msg_iovlen = n;
+    r = (long)sendmsg(sock, &msg, PAS_SEND_FLAGS);
+    if (r < 0) return pas_http__would_block() ? 0 : -1;
+    return r;
+#endif
 }
 
-int pas_http_get(const char *url,
-                 char *response_buffer, size_t buffer_size,
-                 int timeout_ms,
-                 pas_http_response_t *out_response,
-                 int *status)
+/* Drops the first bytes of the slice list. */
+static void pas_http__slices_skip(pas_http__slice **v, size_t *n, size_t bytes)
 {
-    char host_buf[PAS_HTTP_MAX_HOST];
-    char path_buf[PAS_HTTP_MAX_PATH];
-    int port;
-
-    if (!url || !response_buffer || !out_response || !status) {
-        if (status) *status = PAS_HTTP_E_INVALID_URL;
-        return PAS_HTTP_E_INVALID_URL;
+    while (*n && (bytes || (*v)->n == 0)) {
+        if (bytes >= (*v)->n) {
+            bytes -= (*v)->n;
+            (*v)++;
+            (*n)--;
+        } else {
+            (*v)->p += bytes;
+            (*v)->n -= bytes;
+            bytes = 0;
+        }
     }
+}
 
-    if (pas_http_parse_url(url, host_buf, sizeof(host_buf), &port,
-                           path_buf, sizeof(path_buf)) != 0) {
-        *status = PAS_HTTP_E_INVALID_URL;
-        return PAS_HTTP_E_INVALID_URL;
+/* Writes every slice on a blocking socket (v is consumed). Returns 0 or -1. */
+static int pas_http__sendv_all(SOCKET sock, pas_http__slice *v, size_t n)
+{
+    pas_http__slices_skip(&v, &n, 0);
+    while (n > 0) {
+        long r = pas_http__sendv(sock, v, n);
+        if (r <= 0) return -1;   /* 0: the send timeout expired */
+        pas_http__slices_skip(&v, &n, (size_t)r);
     }
+    return 0;
+}
 
-    return pas_http_do_request("GET", host_buf, port, path_buf,
-                               NULL, 0,
-                               response_buffer, buffer_size,
-                               timeout_ms, out_response, status);
+static int pas_http__recv(SOCKET sock, char *buf, size_t n)
+{
+#if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__)
+    return recv(sock, buf, n > 0x40000000u ? 0x40000000 : (int)n, 0);
+#else
+    return (int)recv(sock, buf, n > 0x40000000u ? 0x40000000u : n, 0);
+#endif
 }
 
-int pas_http_post(const char *url,
-                  const void *body, size_t body_len,
-                  char *response_buffer, size_t buffer_size,
-                  int timeout_ms,
-                  pas_http_response_t *out_response,
-                  int *status)
+/* --- Request heads ---
+
+   A request head is a fixed run of slices: the request line from the URL, Host,
+   four slices per caller header, then Connection / Accept-Encoding /
+   Content-Length and the blank line. It is sent as iovecs or copied once into a buffer; only the
+   Content-Length digits are formatted. The body is the last slice. */
+
+typedef struct pas_http__head {
+    const char              *method;
+    const char              *authority;
+    size_t                   authority_len;
+    const char              *path;
+    size_t                   path_len;
+    const pas_http_header_t *headers;
+    size_t                   header_count;
+    const char              *body;
+    size_t                   body_len;
+    int                      add_host;
+    int                      add_close;
+    int                      add_accept;     /* Accept-Encoding: gzip, deflate */
+    int                      has_accept;     /* caller sent Accept-Encoding */
+    size_t                   length_len;     /* 0 = no Content-Length line */
+    char                     length_line[40];
+} pas_http__head;
+
+#define PAS_HTTP__HEAD_FIXED 7   /* request line (4) + Host (3) */
+#define PAS_HTTP__HEAD_TAIL  5   /* Connection, Accept-Encoding, Content-Length, blank line, body */
+
+static size_t pas_http__head_slices(const pas_http__head *h)
 {
-    char host_buf[PAS_HTTP_MAX_HOST];
-    char path_buf[PAS_HTTP_MAX_PATH];
-    int port;
+    return PAS_HTTP__HEAD_FIXED + 4 * h->header_count + PAS_HTTP__HEAD_TAIL;
+}
 
-    if (!url || !response_buffer || !out_response || !status) {
-        if (status) *status = PAS_HTTP_E_INVALID_URL;
-        return PAS_HTTP_E_INVALID_URL;
-    }
+static void pas_http__head_slice(const pas_http__head *h, size_t k, pas_http__slice *out)
+{
+    static const char close_line[] = "Connection: close\r\n";
+    static const char accept_line[] = "Accept-Encoding: gzip, deflate\r\n";
+    size_t tail = PAS_HTTP__HEAD_FIXED + 4 * h->header_count;
 
-    if (body_len > 0 && !body) {
-        if (status) *status = PAS_HTTP_E_INVALID_URL;
-        return PAS_HTTP_E_INVALID_URL;
+    out->p = "";
+    out->n = 0;
+    if (k < PAS_HTTP__HEAD_FIXED) {
+        switch (k) {
+        case 0: out->p = h->method; out->n = strlen(h->method); break;
+        case 1: out->p = " "; out->n = 1; break;
+        case 2: out->p = h->path; out->n = h->path_len; break;
+        case 3: out->p = " HTTP/1.1\r\n"; out->n = 11; break;
+        case 4: if (h->add_host) { out->p = "Host: "; out->n = 6; } break;
+        case 5: if (h->add_host) { out->p = h->authority; out->n = h->authority_len; } break;
+        default: if (h->add_host) { out->p = "\r\n"; out->n = 2; } break;
+        }
+    } else if (k < tail) {
+        const pas_http_header_t *hd = &h->headers[(k - PAS_HTTP__HEAD_FIXED) / 4];
+        switch ((k - PAS_HTTP__HEAD_FIXED) % 4) {
+        case 0: out->p = hd->name; out->n = hd->name_len ? hd->name_len : strlen(hd->name); break;
+        case 1: out->p = ": "; out->n = 2; break;
+        case 2: out->p = hd->value; out->n = hd->value_len ? hd->value_len : strlen(hd->value); break;
+        default: out->p = "\r\n"; out->n = 2; break;
+        }
+    } else {
+        switch (k - tail) {
+        case 0: if (h->add_close) { out->p = close_line; out->n = sizeof(close_line) - 1; } break;
+        case 1: if (h->add_accept) { out->p = accept_line; out->n = sizeof(accept_line) - 1; } break;
+        case 2: out->p = h->length_line; out->n = h->length_len; break;
+        case 3: out->p = "\r\n"; out->n = 2; break;
+        default: out->p = h->body; out->n = h->body_len; break;
+        }
     }
+}
 
-    if (pas_http_parse_url(url, host_buf, sizeof(host_buf), &port,
-                           path_buf, sizeof(path_buf)) != 0) {
-        *status = PAS_HTTP_E_INVALID_URL;
+/* Non-zero if s[0, n) holds CR or LF. */
+static int pas_http__has_crlf(const char *s, size_t n)
+{
+    return memchr(s, '\r', n) != NULL || memchr(s, '\n', n) != NULL;
+}
+
+/* Parses url into host_buf / port and describes the request head. has_body adds
+   Content-Length; keep_alive 0 adds Connection: close. Returns PAS_HTTP_OK or
+   PAS_HTTP_E_INVALID_URL. */
+static int pas_http__head_init(pas_http__head *h, const char *method, const char *url,
+                               const pas_http_header_t *headers, size_t header_count,
+                               const void *body, size_t body_len, int keep_alive,
+                               char *host_buf, size_t host_size, int *port)
+{
+    size_t i;
+    int has_length = 0;
+
+    memset(h, 0, sizeof(*h));
+    if (!method || !*method || (body_len > 0 && !body) || (header_count && !headers) ||
+        pas_http__has_crlf(method, strlen(method)) ||
+        pas_http__split_url(url, host_buf, host_size, port, &h->authority, &h->authority_len,
+                            &h->path, &h->path_len) != 0 ||
+        pas_http__has_crlf(h->path, h->path_len))
         return PAS_HTTP_E_INVALID_URL;
+    h->method = method;
+    h->headers = headers;
+    h->header_count = header_count;
+    h->body = (const char *)body;
+    h->body_len = body_len;
+    h->add_host = 1;
+    h->add_close = !keep_alive;
+    for (i = 0; i < header_count; i++) {
+        const pas_http_header_t *hd = &headers[i];
+        size_t nl, vl;
+        if (!hd->name || !hd->value) return PAS_HTTP_E_INVALID_URL;
+        nl = hd->name_len ? hd->name_len : strlen(hd->name);
+        vl = hd->value_len ? hd->value_len : strlen(hd->value);
+        if (!nl || memchr(hd->name, ':', nl) || pas_http__has_crlf(hd->name, nl) ||
+            pas_http__has_crlf(hd->value, vl))
+            return PAS_HTTP_E_INVALID_URL;
+        switch (pas_http_header_id(hd->name, nl)) {
+        case PAS_HTTP_H_HOST: h->add_host = 0; break;
+        case PAS_HTTP_H_CONNECTION: h->add_close = 0; break;
+        case PAS_HTTP_H_ACCEPT_ENCODING: h->has_accept = 1; break;
+        case PAS_HTTP_H_CONTENT_LENGTH:
+        case PAS_HTTP_H_TRANSFER_ENCODING: has_length = 1; break;
+        default: break;
+        }
+    }
+    if (body && !has_length) {
+        int n = snprintf(h->length_line, sizeof(h->length_line), "Content-Length: %zu\r\n", body_len);
+        h->length_len = n > 0 ? (size_t)n : 0;
     }
+    return PAS_HTTP_OK;
+}
 
-    return pas_http_do_request("POST", host_buf, port, path_buf,
-                               body, body_len,
-                               response_buffer, buffer_size,
-                               timeout_ms, out_response, status);
+/* Copies the head (not the body) into buf; returns its length, which may exceed size
+   (then nothing past size is written). */
+static size_t pas_http__head_write(const pas_http__head *h, char *buf, size_t size)
+{
+    size_t k, n = pas_http__head_slices(h) - 1, len = 0;
+
+    for (k = 0; k < n; k++) {
+        pas_http__slice v;
+        pas_http__head_slice(h, k, &v);
+        if (buf && len + v.n <= size) memcpy(buf + len, v.p, v.n);
+        len += v.n;
+    }
+    return len;
+}
+
+/* Writes head and body with gathered sends of up to PAS_HTTP__IOV_MAX slices. */
+static int pas_http__head_send(SOCKET sock, const pas_http__head *h)
+{
+    pas_http__slice v[PAS_HTTP__IOV_MAX];
+    size_t k = 0, total = pas_http__head_slices(h);
+
+    while (k < total) {
+        size_t n = 0;
+        for (; k < total && n < PAS_HTTP__IOV_MAX; n++) pas_http__head_slice(h, k++, &v[n]);
+        if (pas_http__sendv_all(sock, v, n) != 0) return -1;
+    }
+    return 0;
+}
+
+int pas_http_build_request(char *buf, size_t size, const char *method, const char *url,
+                           const pas_http_header_t *headers, size_t header_count,
+                           const void *body, size_t body_len, size_t *out_len)
+{
+    char host_buf[PAS_HTTP_MAX_HOST];
+    pas_http__head h;
+    size_t len;
+    int port, st;
+
+    if (out_len) *out_len = 0;
+    st = pas_http__head_init(&h, method, url, headers, header_count, body, body_len, 1,
+                             host_buf, sizeof(host_buf), &port);
+    if (st != PAS_HTTP_OK) return st;
+    len = pas_http__head_write(&h, buf, buf ? size : 0);
+    if (out_len) *out_len = len;
+    return len <= size && buf ? PAS_HTTP_OK : PAS_HTTP_E_NOSPACE;
+}
+
+/* --- Header helpers --- */
+
+static int pas_http__lower(int c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/* --- Header index --- */
+
+#define PAS_HTTP__KNOWN(name) { name, sizeof(name) - 1 }
+
+static const struct {
+    const char *name;
+    size_t      len;
+} pas_http__known[PAS_HTTP_H_COUNT] = {
+    PAS_HTTP__KNOWN("Content-Length"), PAS_HTTP__KNOWN("Content-Type"),
+    PAS_HTTP__KNOWN("Content-Encoding"), PAS_HTTP__KNOWN("Transfer-Encoding"),
+    PAS_HTTP__KNOWN("Connection"), PAS_HTTP__KNOWN("Keep-Alive"), PAS_HTTP__KNOWN("Location"),
+    PAS_HTTP__KNOWN("ETag"), PAS_HTTP__KNOWN("Last-Modified"), PAS_HTTP__KNOWN("Cache-Control"),
+    PAS_HTTP__KNOWN("Expires"), PAS_HTTP__KNOWN("Date"), PAS_HTTP__KNOWN("Age"),
+    PAS_HTTP__KNOWN("Vary"), PAS_HTTP__KNOWN("Set-Cookie"), PAS_HTTP__KNOWN("Server"),
+    PAS_HTTP__KNOWN("Content-Range"), PAS_HTTP__KNOWN("Accept-Ranges"),
+    PAS_HTTP__KNOWN("Retry-After"), PAS_HTTP__KNOWN("WWW-Authenticate"), PAS_HTTP__KNOWN("Host"),
+    PAS_HTTP__KNOWN("Accept-Encoding")
+};
+
+static int pas_http__name_eq(const char *a, const char *b, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++)
+        if (pas_http__lower((unsigned char)a[i]) != pas_http__lower((unsigned char)b[i])) return 0;
+    return 1;
+}
+
+int pas_http_header_id(const char *name, size_t name_len)
+{
+    int id;
+    if (!name) return PAS_HTTP_H_OTHER;
+    for (id = 0; id < PAS_HTTP_H_COUNT; id++)
+        if (pas_http__known[id].len == name_len && pas_http__name_eq(name, pas_http__known[id].name, name_len))
+            return id;
+    return PAS_HTTP_H_OTHER;
+}
+
+/* Next "name: value" line of head (status line + header lines) from *pos, which
+   starts at 0; the status line and lines without a name are skipped. Returns 0
+   after the last line. */
+static int pas_http__next_header(const char *head, size_t len, size_t *pos, pas_http_header_t *h)
+{
+    const char *end = head + len;
+
+    if (*pos == 0) *pos = (size_t)(pas_http__find_lf(head, end) - head) + 1;
+    while (*pos < len) {
+        const char *line = head + *pos, *eol = pas_http__find_lf(line, end), *colon, *value;
+
+        *pos = (size_t)(eol - head) + 1;
+        colon = (const char *)memchr(line, ':', (size_t)(eol - line));
+        if (!colon || colon == line) continue;
+        value = colon + 1;
+        while (value < eol && (*value == ' ' || *value == '\t')) value++;
+        while (eol > value && (eol[-1] == '\r' || eol[-1] == ' ' || eol[-1] == '\t')) eol--;
+        h->name = line;
+        h->name_len = (size_t)(colon - line);
+        h->value = value;
+        h->value_len = (size_t)(eol - value);
+        h->id = pas_http_header_id(line, h->name_len);
+        return 1;
+    }
+    return 0;
+}
+
+int pas_http_headers_parse(pas_http_headers_t *headers, pas_http_header_t *items, size_t cap,
+                           const pas_http_response_t *response)
+{
+    pas_http_header_t h;
+    size_t pos = 0;
+    int i;
+
+    if (!headers) return PAS_HTTP_E_NOSPACE;
+    headers->items = items;
+    headers->count = 0;
+    headers->cap = items ? cap : 0;
+    for (i = 0; i < PAS_HTTP_H_COUNT; i++) headers->first[i] = -1;
+    if (!response || !response->headers) return PAS_HTTP_OK;
+    while (pas_http__next_header(response->headers, response->headers_len, &pos, &h)) {
+        if (headers->count == headers->cap) return PAS_HTTP_E_NOSPACE;
+        if (h.id != PAS_HTTP_H_OTHER && headers->first[h.id] < 0) headers->first[h.id] = (int)headers->count;
+        headers->items[headers->count++] = h;
+    }
+    return PAS_HTTP_OK;
+}
+
+const pas_http_header_t *pas_http_headers_get(const pas_http_headers_t *headers, int id)
+{
+    if (!headers || id < 0 || id >= PAS_HTTP_H_COUNT || headers->first[id] < 0) return NULL;
+    return &headers->items[headers->first[id]];
+}
+
+const pas_http_header_t *pas_http_headers_find(const pas_http_headers_t *headers, const char *name)
+{
+    size_t i, len;
+    int id;
+
+    if (!headers || !name) return NULL;
+    len = strlen(name);
+    id = pas_http_header_id(name, len);
+    if (id != PAS_HTTP_H_OTHER) return pas_http_headers_get(headers, id);
+    for (i = 0; i < headers->count; i++)
+        if (headers->items[i].name_len == len && pas_http__name_eq(headers->items[i].name, name, len))
+            return &headers->items[i];
+    return NULL;
+}
+
+const pas_http_header_t *pas_http_headers_next(const pas_http_headers_t *headers,
+                                               const pas_http_header_t *prev)
+{
+    size_t i;
+
+    if (!headers || !prev || prev < headers->items || prev >= headers->items + headers->count) return NULL;
+    for (i = (size_t)(prev - headers->items) + 1; i < headers->count; i++) {
+        const pas_http_header_t *h = &headers->items[i];
+        if (prev->id != PAS_HTTP_H_OTHER ? h->id == prev->id
+                                         : (h->name_len == prev->name_len &&
+                                            pas_http__name_eq(h->name, prev->name, h->name_len)))
+            return h;
+    }
+    return NULL;
+}
+
+/* Non-zero if the comma-separated list v contains token (case-insensitive). */
+static int pas_http__has_token(const char *v, size_t n, const char *token)
+{
+    size_t tlen = strlen(token), i = 0;
+
+    while (i < n) {
+        size_t start, stop, k;
+        while (i < n && (v[i] == ' ' || v[i] == '\t' || v[i] == ',')) i++;
+        start = i;
+        while (i < n && v[i] != ',') i++;
+        stop = i;
+        while (stop > start && (v[stop - 1] == ' ' || v[stop - 1] == '\t')) stop--;
+        if (stop - start != tlen) continue;
+        for (k = 0; k < tlen; k++)
+            if (pas_http__lower((unsigned char)v[start + k]) != pas_http__lower((unsigned char)token[k])) break;
+        if (k == tlen) return 1;
+    }
+    return 0;
+}
+
+/* Non-zero if the last element of the comma-separated list v is token. */
+static int pas_http__last_token(const char *v, size_t n, const char *token)
+{
+    size_t start = n;
+    while (start > 0 && v[start - 1] != ',') start--;
+    return pas_http__has_token(v + start, n - start, token);
+}
+
+/* Folds one Content-Length value (possibly a list) into *out. found is the result
+   so far: 0 before the first value, 1 once *out is set. Returns 1, or -1 if the
+   value is malformed or disagrees with an earlier one. */
+static int pas_http__content_length(const char *v, size_t vlen, int found, uint64_t *out)
+{
+    size_t i = 0;
+
+    do {
+        uint64_t n = 0;
+        size_t digits = 0;
+        while (i < vlen && (v[i] == ' ' || v[i] == '\t')) i++;
+        for (; i < vlen && v[i] >= '0' && v[i] <= '9'; i++, digits++) {
+            if (n > (UINT64_MAX - 9) / 10) return -1;
+            n = n * 10 + (uint64_t)(v[i] - '0');
+        }
+        while (i < vlen && (v[i] == ' ' || v[i] == '\t')) i++;
+        if (!digits || (i < vlen && v[i] != ',')) return -1;
+        if (found && n != *out) return -1;
+        *out = n;
+        found = 1;
+    } while (i++ < vlen);
+    return found;
+}
+
+/* --- Response framing ---
+
+   pas_http__rx is fed the bytes as they arrive in buf and decides where the
+   message ends: after Content-Length bytes, after the last chunk, at once for
+   bodyless statuses and answers to HEAD, or at connection close. Chunked
+   bodies are decoded in place: data is moved down over the chunk markers as it
+   arrives, so the body is contiguous after the head and the free space stays
+   at the end of buf.
+   Interim 1xx responses (other than 101) are discarded. When streaming,
+   pas_http__rx_drain drops the head and every body byte already handed out,
+   so the buffer only ever holds what has not been delivered yet. */
+
+#define PAS_HTTP__FRAME_NONE    0   /* no body */
+#define PAS_HTTP__FRAME_LENGTH  1
+#define PAS_HTTP__FRAME_CHUNKED 2
+#define PAS_HTTP__FRAME_CLOSE   3   /* body ends when the peer closes */
+
+enum {
+    PAS_HTTP__CH_SIZE, PAS_HTTP__CH_EXT, PAS_HTTP__CH_SIZE_LF, PAS_HTTP__CH_DATA,
+    PAS_HTTP__CH_DATA_CR, PAS_HTTP__CH_DATA_LF, PAS_HTTP__CH_TRAILER, PAS_HTTP__CH_TRAILER_LINE,
+    PAS_HTTP__CH_END_LF
+};
+
+/* head_req: the request was HEAD, so the response has no body. */
+static void pas_http__rx_init(pas_http__rx *rx, char *buf, size_t cap, int head_req)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->buf = buf;
+    rx->cap = cap;
+    rx->head_req = head_req;
+}
+
+static int pas_http__is_head(const char *method)
+{
+    return method && strcmp(method, "HEAD") == 0;
+}
+
+static int pas_http__hex(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = pas_http__lower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+enum { PAS_HTTP__CODING_NONE, PAS_HTTP__CODING_GZIP, PAS_HTTP__CODING_DEFLATE };
+
+/* Content-Encoding value the client can undo: one gzip or deflate coding. */
+static int pas_http__coding(const char *v, size_t n)
+{
+    if (memchr(v, ',', n)) return PAS_HTTP__CODING_NONE;
+    if (pas_http__has_token(v, n, "gzip") || pas_http__has_token(v, n, "x-gzip")) return PAS_HTTP__CODING_GZIP;
+    if (pas_http__has_token(v, n, "deflate")) return PAS_HTTP__CODING_DEFLATE;
+    return PAS_HTTP__CODING_NONE;
+}
+
+/* Called once the blank line is found: status, keep-alive, framing. */
+static int pas_http__rx_head(pas_http__rx *rx)
+{
+    pas_http_response_t tmp;
+    pas_http_header_t h;
+    const char *te = NULL;
+    size_t pos = 0, te_len = 0;
+    uint64_t length = 0;
+    int http11, has_length = 0, conn_close = 0, conn_keep = 0, codings = 0;
+
+    if (pas_http_parse_response(rx->buf, rx->head_len, &tmp) != 0) return -1;
+    rx->status_code = tmp.status_code;
+    http11 = rx->buf[7] == '1';
+
+    /* one pass over the header lines */
+    while (pas_http__next_header(rx->buf, rx->head_len, &pos, &h)) {
+        switch (h.id) {
+        case PAS_HTTP_H_CONNECTION:
+            conn_close |= pas_http__has_token(h.value, h.value_len, "close");
+            conn_keep |= pas_http__has_token(h.value, h.value_len, "keep-alive");
+            break;
+        case PAS_HTTP_H_TRANSFER_ENCODING:
+            /* the last field holds the final coding */
+            te = h.value;
+            te_len = h.value_len;
+            break;
+        case PAS_HTTP_H_CONTENT_LENGTH:
+            if (has_length >= 0) has_length = pas_http__content_length(h.value, h.value_len, has_length, &length);
+            break;
+        case PAS_HTTP_H_CONTENT_ENCODING:
+            rx->coding = pas_http__coding(h.value, h.value_len);
+            codings++;
+            break;
+        default:
+            break;
+        }
+    }
+    rx->keep_alive = http11 ? !conn_close : conn_keep;
+    if (codings > 1) rx->coding = PAS_HTTP__CODING_NONE;   /* stacked codings are left alone */
+
+    if ((rx->status_code >= 100 && rx->status_code < 200) ||
+        rx->status_code == 204 || rx->status_code == 304 || rx->head_req) {
+        rx->framing = PAS_HTTP__FRAME_NONE;
+        if (rx->status_code == 101) rx->keep_alive = 0;
+        return 0;
+    }
+
+    if (te) {
+        /* Transfer-Encoding overrides Content-Length; a sender using both is
+           not trusted with the connection afterwards */
+        if (has_length) rx->keep_alive = 0;
+        if (pas_http__last_token(te, te_len, "chunked")) {
+            rx->framing = PAS_HTTP__FRAME_CHUNKED;
+            rx->chunk_state = PAS_HTTP__CH_SIZE;
+            rx->pos = rx->out = rx->body;
+            rx->left = 0;
+            rx->digits = 0;
+            return 0;
+        }
+    } else if (has_length < 0) {
+        return -1;
+    } else if (has_length) {
+        rx->framing = PAS_HTTP__FRAME_LENGTH;
+        rx->left = length;
+        return 0;
+    }
+    rx->framing = PAS_HTTP__FRAME_CLOSE;
+    rx->keep_alive = 0;
+    return 0;
+}
+
+/* Decodes chunked framing from rx->pos to rx->len. Returns 1 at the end of the message. */
+static int pas_http__rx_chunks(pas_http__rx *rx)
+{
+    int end = 0;
+
+    while (rx->pos < rx->len && !end) {
+        char c = rx->buf[rx->pos];
+
+        switch (rx->chunk_state) {
+        case PAS_HTTP__CH_SIZE: {
+            int h = pas_http__hex((unsigned char)c);
+            if (h >= 0) {
+                if (rx->left > (UINT64_MAX >> 4)) return -1;
+                rx->left = (rx->left << 4) | (uint64_t)h;
+                rx->digits++;
+            } else if (rx->digits && (c == ';' || c == ' ' || c == '\t')) {
+                rx->chunk_state = PAS_HTTP__CH_EXT;
+            } else if (rx->digits && c == '\r') {
+                rx->chunk_state = PAS_HTTP__CH_SIZE_LF;
+            } else {
+                return -1;
+            }
+            rx->pos++;
+            break;
+        }
+        case PAS_HTTP__CH_EXT:
+            if (c == '\r') rx->chunk_state = PAS_HTTP__CH_SIZE_LF;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_SIZE_LF:
+            if (c != '\n') return -1;
+            rx->chunk_state = rx->left ? PAS_HTTP__CH_DATA : PAS_HTTP__CH_TRAILER;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_DATA: {
+            size_t avail = rx->len - rx->pos;
+            size_t n = rx->left < avail ? (size_t)rx->left : avail;
+            if (rx->out != rx->pos) memmove(rx->buf + rx->out, rx->buf + rx->pos, n);
+            rx->out += n;
+            rx->pos += n;
+            rx->left -= n;
+            if (rx->left == 0) rx->chunk_state = PAS_HTTP__CH_DATA_CR;
+            break;
+        }
+        case PAS_HTTP__CH_DATA_CR:
+            if (c != '\r') return -1;
+            rx->chunk_state = PAS_HTTP__CH_DATA_LF;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_DATA_LF:
+            if (c != '\n') return -1;
+            rx->chunk_state = PAS_HTTP__CH_SIZE;
+            rx->digits = 0;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_TRAILER:
+            rx->chunk_state = (c == '\r') ? PAS_HTTP__CH_END_LF : PAS_HTTP__CH_TRAILER_LINE;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_TRAILER_LINE:
+            if (c == '\n') rx->chunk_state = PAS_HTTP__CH_TRAILER;
+            rx->pos++;
+            break;
+        case PAS_HTTP__CH_END_LF:
+            if (c != '\n') return -1;
+            rx->pos++;
+            end = 1;
+            break;
+        }
+    }
+
+    /* close the gap the markers left, so unread bytes follow the decoded body */
+    if (rx->pos != rx->out) {
+        memmove(rx->buf + rx->out, rx->buf + rx->pos, rx->len - rx->pos);
+        rx->len -= rx->pos - rx->out;
+        rx->pos = rx->out;
+    }
+    rx->body_len = rx->out - rx->body;
+    return end;
+}
+
+/* n more bytes were appended at buf + len. Returns 1 when the message is
+   complete, 0 if more is needed, -1 if it is malformed. */
+static int pas_http__rx_feed(pas_http__rx *rx, size_t n)
+{
+    rx->len += n;
+    while (!rx->head_len) {
+        size_t head = pas_http__head_end(rx->buf, rx->scan, rx->len);
+        if (!head) {
+            rx->scan = rx->len >= 3 ? rx->len - 3 : 0;
+            return 0;
+        }
+        rx->head_len = rx->body = head;
+        if (pas_http__rx_head(rx) != 0) return -1;
+        if (rx->status_code >= 100 && rx->status_code < 200 && rx->status_code != 101) {
+            /* interim response: drop it and parse the next head */
+            memmove(rx->buf, rx->buf + rx->head_len, rx->len - rx->head_len);
+            rx->len -= rx->head_len;
+            rx->head_len = 0;
+            rx->scan = 0;
+        }
+    }
+
+    switch (rx->framing) {
+    case PAS_HTTP__FRAME_NONE:
+        rx->extra = rx->len - rx->body;
+        rx->len = rx->body;
+        rx->done = 1;
+        break;
+    case PAS_HTTP__FRAME_LENGTH:
+        if (rx->dropped + (uint64_t)(rx->len - rx->body) >= rx->left) {
+            rx->body_len = (size_t)(rx->left - rx->dropped);
+            rx->extra = rx->len - (rx->body + rx->body_len);
+            rx->len = rx->body + rx->body_len;
+            rx->done = 1;
+        } else {
+            rx->body_len = rx->len - rx->body;
+        }
+        break;
+    case PAS_HTTP__FRAME_CHUNKED: {
+        int r = pas_http__rx_chunks(rx);
+        if (r < 0) return -1;
+        if (r > 0) {
+            rx->extra = rx->len - rx->out;
+            rx->len = rx->out;
+            rx->done = 1;
+        }
+        break;
+    }
+    default:
+        rx->body_len = rx->len - rx->body;
+        break;
+    }
+    return rx->done;
+}
+
+/* Drops the head and the body bytes at buf + body; unparsed bytes move to the front. */
+static void pas_http__rx_drain(pas_http__rx *rx)
+{
+    size_t n = rx->body + rx->body_len;
+
+    memmove(rx->buf, rx->buf + n, rx->len - n);
+    rx->len -= n;
+    if (rx->framing == PAS_HTTP__FRAME_CHUNKED) {
+        rx->pos -= n;
+        rx->out -= n;
+    }
+    rx->dropped += rx->body_len;
+    rx->body = 0;
+    rx->body_len = 0;
+}
+
+/* Streaming: reports the head once, then hands out and drains the body decoded
+   so far. Returns non-zero if a callback asked to stop. */
+static int pas_http__rx_deliver(pas_http__rx *rx, const pas_http_callbacks_t *cb, int *head_sent)
+{
+    if (!rx->head_len) return 0;
+    if (!*head_sent) {
+        pas_http_header_t h;
+        size_t pos = 0;
+
+        *head_sent = 1;
+        if (cb->on_status && cb->on_status(cb->user, rx->status_code) != 0) return 1;
+        while (cb->on_header && pas_http__next_header(rx->buf, rx->head_len, &pos, &h))
+            if (cb->on_header(cb->user, h.name, h.name_len, h.value, h.value_len) != 0) return 1;
+    }
+    if (rx->body_len && cb->on_body && cb->on_body(cb->user, rx->buf + rx->body, rx->body_len) != 0)
+        return 1;
+    pas_http__rx_drain(rx);
+    return 0;
+}
+
+/* Peer closed: only close-delimited bodies end this way. */
+static int pas_http__rx_eof(pas_http__rx *rx)
+{
+    if (rx->head_len && rx->framing == PAS_HTTP__FRAME_CLOSE) {
+        rx->done = 1;
+        return 1;
+    }
+    return 0;
+}
+
+static void pas_http__rx_response(const pas_http__rx *rx, pas_http_response_t *out)
+{
+    if (!out) return;
+    out->status_code = rx->status_code;
+    out->headers = rx->buf;
+    out->headers_len = rx->head_len >= 4 ? rx->head_len - 4 : 0;
+    out->body = rx->buf + rx->body;
+    out->body_len = rx->body_len;
+}
+
+/* --- Content decoding --- */
+
+#if defined(PAS_HTTP_HAS_DECODE)
+/* Streaming shim: forwards the head to the caller's callbacks and inflates body runs. */
+typedef struct pas_http__decoder {
+    const pas_http_callbacks_t *cb;
+    const pas_http__rx         *rx;
+    pas_zip_inflater_t          inf;
+    void                       *work;
+    size_t                      work_size;
+    unsigned char               lead[2];    /* first body bytes, before the format is known */
+    size_t                      lead_len;
+    int                         started;
+    int                         done;
+    int                         failed;     /* inflate error (not a caller stop) */
+} pas_http__decoder;
+
+static int pas_http__inflate_init(pas_zip_inflater_t *inf, int coding, void *work, size_t work_size)
+{
+    /* deflate is zlib-wrapped per RFC 9110, but raw streams are common enough to accept */
+    int format = coding == PAS_HTTP__CODING_GZIP ? PAS_ZIP_INFLATE_GZIP : PAS_ZIP_INFLATE_AUTO;
+    return pas_zip_inflate_init(inf, format, work, work_size) == PAS_ZIP_OK ? 0 : -1;
+}
+
+/* Buffered: inflates the complete body into the space after the message, then
+   moves it over the encoded body. */
+static int pas_http__decode_body(pas_http__rx *rx, void *work, size_t work_size)
+{
+    pas_zip_inflater_t inf;
+    pas_zip_status zs;
+    size_t at = rx->len + rx->extra, used = 0, n;
+    int done = 0;
+
+    if (!rx->body_len) return PAS_HTTP_OK;
+    if (pas_http__inflate_init(&inf, rx->coding, work, work_size) != 0) return PAS_HTTP_E_DECODE;
+    n = pas_zip_inflate(&inf, rx->buf + rx->body, rx->body_len, &used, rx->buf + at, rx->cap - at, &done, &zs);
+    pas_zip_inflate_end(&inf);
+    if (zs != PAS_ZIP_OK) return PAS_HTTP_E_DECODE;
+    if (!done) return n == rx->cap - at ? PAS_HTTP_E_NOSPACE : PAS_HTTP_E_DECODE;
+    memmove(rx->buf + rx->body, rx->buf + at, n);
+    rx->body_len = n;
+    rx->len = rx->body + n;
+    if (rx->extra) rx->keep_alive = 0;   /* bytes past the message were overwritten */
+    rx->extra = 0;
+    return PAS_HTTP_OK;
+}
+
+/* Inflates len bytes and hands the output to on_body in PAS_HTTP_DECODE_CHUNK runs. */
+static int pas_http__decoder_run(pas_http__decoder *d, const unsigned char *p, size_t len)
+{
+    unsigned char out[PAS_HTTP_DECODE_CHUNK];
+    size_t n = sizeof(out);
+
+    /* a full chunk can leave output pending with no input left */
+    while (!d->done && (len || n == sizeof(out))) {
+        size_t used = 0;
+        pas_zip_status zs;
+
+        n = pas_zip_inflate(&d->inf, p, len, &used, out, sizeof(out), &d->done, &zs);
+        if (zs != PAS_ZIP_OK) {
+            d->failed = 1;
+            return 1;
+        }
+        p += used;
+        len -= used;
+        if (n && d->cb->on_body && d->cb->on_body(d->cb->user, out, n) != 0) return 1;
+        if (!n && !used) break;
+    }
+    return 0;
+}
+
+static int pas_http__decoder_status(void *user, int status_code)
+{
+    const pas_http__decoder *d = (const pas_http__decoder *)user;
+    return d->cb->on_status(d->cb->user, status_code);
+}
+
+static int pas_http__decoder_header(void *user, const char *name, size_t name_len,
+                                    const char *value, size_t value_len)
+{
+    const pas_http__decoder *d = (const pas_http__decoder *)user;
+    return d->cb->on_header(d->cb->user, name, name_len, value, value_len);
+}
+
+static int pas_http__decoder_body(void *user, const void *data, size_t len)
+{
+    pas_http__decoder *d = (pas_http__decoder *)user;
+    const unsigned char *p = (const unsigned char *)data;
+
+    if (d->rx->coding == PAS_HTTP__CODING_NONE)
+        return d->cb->on_body ? d->cb->on_body(d->cb->user, data, len) : 0;
+    if (!d->started) {
+        /* the deflate format is told apart by the first two bytes */
+        while (len && d->lead_len < sizeof(d->lead)) {
+            d->lead[d->lead_len++] = *p++;
+            len--;
+        }
+        if (d->lead_len < sizeof(d->lead)) return 0;
+        if (pas_http__inflate_init(&d->inf, d->rx->coding, d->work, d->work_size) != 0) {
+            d->failed = 1;
+            return 1;
+        }
+        d->started = 1;
+        if (pas_http__decoder_run(d, d->lead, d->lead_len) != 0) return 1;
+    }
+    return pas_http__decoder_run(d, p, len);
+}
+
+/* Callbacks in dcb route through d to cb. */
+static void pas_http__decoder_init(pas_http__decoder *d, pas_http_callbacks_t *dcb,
+                                   const pas_http_callbacks_t *cb, const pas_http__rx *rx,
+                                   const pas_http_client_t *client)
+{
+    memset(d, 0, sizeof(*d));
+    d->cb = cb;
+    d->rx = rx;
+    d->work = client->decode_work;
+    d->work_size = client->decode_work_size;
+    dcb->on_status = cb->on_status ? pas_http__decoder_status : NULL;
+    dcb->on_header = cb->on_header ? pas_http__decoder_header : NULL;
+    dcb->on_body = pas_http__decoder_body;
+    dcb->user = d;
+}
+
+/* Status once the streamed message is over: PAS_HTTP_E_DECODE for an inflate
+   error or a body that ended early. */
+static int pas_http__decoder_finish(pas_http__decoder *d, int st)
+{
+    if (d->started) pas_zip_inflate_end(&d->inf);
+    if (d->failed) return PAS_HTTP_E_DECODE;
+    if (st == PAS_HTTP_OK && (d->lead_len || d->started) && !d->done) return PAS_HTTP_E_DECODE;
+    return st;
+}
+#endif /* PAS_HTTP_HAS_DECODE */
+
+/* --- Keep-alive client --- */
+
+void pas_http_client_init(pas_http_client_t *client, pas_http_conn_t *conns, size_t conn_count,
+                          int idle_timeout_ms)
+{
+    size_t i;
+    if (!client) return;
+    client->conns = conns;
+    client->conn_count = conns ? conn_count : 0;
+    client->idle_timeout_ms = idle_timeout_ms > 0 ? idle_timeout_ms : PAS_HTTP_DEFAULT_IDLE_MS;
+    client->dns = NULL;
+    client->connect_stagger_ms = 0;
+    client->decode = 0;
+    client->decode_work = NULL;
+    client->decode_work_size = 0;
+    client->timing = NULL;
+    client->on_timing = NULL;
+    client->timing_user = NULL;
+    for (i = 0; i < client->conn_count; i++) {
+        conns[i].open = 0;
+        conns[i].sock = (pas_http_socket)PAS_SOCKET_INVALID;
+        conns[i].host[0] = '\0';
+        conns[i].port = 0;
+        conns[i].idle_since = 0;
+    }
+}
+
+static void pas_http__conn_close(pas_http_conn_t *c)
+{
+    if (c->open) PAS_CLOSE_SOCKET((SOCKET)c->sock);
+    c->open = 0;
+    c->sock = (pas_http_socket)PAS_SOCKET_INVALID;
+}
+
+/* An idle connection is stale if the peer closed it or sent something unasked. */
+static int pas_http__conn_stale(const pas_http_conn_t *c)
+{
+    pas_http__pollfd pfd;
+    pfd.fd = (SOCKET)c->sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return PAS_POLL(&pfd, 1, 0) != 0;
+}
+
+/* Pooled connection for host:port: an idle open one (*reused = 1), or a slot to open. */
+static pas_http_conn_t *pas_http__pool_take(pas_http_client_t *client, const char *host, int port,
+                                            int *reused)
+{
+    uint64_t now = pas_http__now_ms();
+    pas_http_conn_t *free_slot = NULL, *lru = NULL;
+    size_t i;
+
+    *reused = 0;
+    for (i = 0; i < client->conn_count; i++) {
+        pas_http_conn_t *c = &client->conns[i];
+        if (c->open && now - c->idle_since >= (uint64_t)client->idle_timeout_ms)
+            pas_http__conn_close(c);
+        if (!c->open) {
+            if (!free_slot) free_slot = c;
+            continue;
+        }
+        if (c->port == port && strcmp(c->host, host) == 0) {
+            if (pas_http__conn_stale(c)) {
+                pas_http__conn_close(c);
+                if (!free_slot) free_slot = c;
+                continue;
+            }
+            *reused = 1;
+            return c;
+        }
+        if (!lru || c->idle_since < lru->idle_since) lru = c;
+    }
+    if (!free_slot && lru) {
+        pas_http__conn_close(lru);
+        free_slot = lru;
+    }
+    return free_slot;
+}
+
+/* Stamps the end of a client request and reports it. */
+static void pas_http__timing_done(const pas_http_client_t *client, pas_http_timing_t *tm, int st)
+{
+    tm->done_us = pas_http_now_us();
+    tm->status = st;
+    if (client->timing) *client->timing = *tm;
+    if (client->on_timing) client->on_timing(client->timing_user, tm);
+}
+
+/* One request on client. With cb, the response is streamed to the callbacks and
+   out_response is unused; otherwise it is returned in response_buffer. */
+int pas_http_client_request(pas_http_client_t *client, const char *method, const char *url,
+                            const pas_http_header_t *headers, size_t header_count,
+                            const void *body, size_t body_len,
+                            const pas_http_callbacks_t *cb,
+                            char *response_buffer, size_t buffer_size,
+                            int timeout_ms,
+                            pas_http_response_t *out_response,
+                            int *status)
+{
+    char host_buf[PAS_HTTP_MAX_HOST];
+    pas_http__head head;
+    pas_http_timing_t tm;
+    uint64_t head_bytes;
+    int port, attempt;
+    int st = PAS_HTTP_E_CONNECTION;
+
+    memset(&tm, 0, sizeof(tm));
+    tm.start_us = pas_http_now_us();
+    if (!client || !url || !response_buffer || !(out_response || cb) || !status) {
+        if (status) *status = PAS_HTTP_E_INVALID_URL;
+        return PAS_HTTP_E_INVALID_URL;
+    }
+    if (out_response) memset(out_response, 0, sizeof(*out_response));
+    if (pas_http__head_init(&head, method, url, headers, header_count, body, body_len,
+                            client->conn_count > 0, host_buf, sizeof(host_buf), &port) != PAS_HTTP_OK) {
+        *status = PAS_HTTP_E_INVALID_URL;
+        return PAS_HTTP_E_INVALID_URL;
+    }
+    if (buffer_size == 0) {
+        *status = PAS_HTTP_E_NOSPACE;
+        return PAS_HTTP_E_NOSPACE;
+    }
+#if defined(PAS_HTTP_HAS_DECODE)
+    head.add_accept = client->decode && !head.has_accept;
+#endif
+    head_bytes = (uint64_t)pas_http__head_write(&head, NULL, 0) + body_len;
+
+    for (attempt = 0; attempt < 2; attempt++) {
+        pas_http_conn_t scratch, *c;
+        pas_http__rx rx;
+        const pas_http_callbacks_t *rcb = cb;
+#if defined(PAS_HTTP_HAS_DECODE)
+        pas_http__decoder dec;
+        pas_http_callbacks_t dcb;
+#endif
+        size_t received = 0;
+        int reused = 0, head_sent = 0, r;
+
+        c = pas_http__pool_take(client, host_buf, port, &reused);
+        if (!c) {
+            /* no pool: one connection per request */
+            c = &scratch;
+            c->open = 0;
+        }
+        tm.reused = reused;
+        tm.resolved_us = tm.connected_us = tm.sent_us = tm.first_byte_us = 0;
+        if (reused) tm.connected_us = pas_http_now_us();
+        if (!c->open) {
+            SOCKET sock;
+            st = pas_http__open(client->dns, host_buf, port, timeout_ms,
+                                client->connect_stagger_ms, &tm, &sock);
+            if (st != PAS_HTTP_OK) break;
+            c->sock = (pas_http_socket)sock;
+            c->open = 1;
+            c->port = port;
+            (void)snprintf(c->host, sizeof(c->host), "%s", host_buf);
+        } else {
+            pas_http__set_timeouts((SOCKET)c->sock, timeout_ms);
+        }
+
+        if (pas_http__head_send((SOCKET)c->sock, &head) != 0) {
+            pas_http__conn_close(c);
+            st = PAS_HTTP_E_CONNECTION;
+            if (reused) {
+                tm.retries++;
+                continue;
+            }
+            break;
+        }
+        tm.sent_us = pas_http_now_us();
+        tm.bytes_sent += head_bytes;
+
+        pas_http__rx_init(&rx, response_buffer, buffer_size, pas_http__is_head(method));
+#if defined(PAS_HTTP_HAS_DECODE)
+        if (cb && client->decode) {
+            pas_http__decoder_init(&dec, &dcb, cb, &rx, client);
+            rcb = &dcb;
+        }
+#endif
+        st = PAS_HTTP_OK;
+        while (!rx.done) {
+            if (rx.len == rx.cap) {
+                st = PAS_HTTP_E_NOSPACE;
+                break;
+            }
+            r = pas_http__recv((SOCKET)c->sock, rx.buf + rx.len, rx.cap - rx.len);
+            if (r > 0) {
+                if (!received) tm.first_byte_us = pas_http_now_us();
+                received += (size_t)r;
+                if (pas_http__rx_feed(&rx, (size_t)r) < 0) {
+                    st = PAS_HTTP_E_CONNECTION;
+                    break;
+                }
+                if (rcb && pas_http__rx_deliver(&rx, rcb, &head_sent) != 0) {
+                    st = PAS_HTTP_E_ABORTED;
+                    break;
+                }
+            } else if (r == 0) {
+                if (!pas_http__rx_eof(&rx)) st = PAS_HTTP_E_CONNECTION;
+                break;
+            } else {
+                st = (PAS_ERRNO == PAS_EAGAIN || PAS_ERRNO == PAS_EWOULDBLOCK)
+                     ? PAS_HTTP_E_TIMEOUT : PAS_HTTP_E_CONNECTION;
+                break;
+            }
+        }
+#if defined(PAS_HTTP_HAS_DECODE)
+        if (rcb != cb) st = pas_http__decoder_finish(&dec, st);
+        else if (!cb && client->decode && st == PAS_HTTP_OK && rx.coding != PAS_HTTP__CODING_NONE)
+            st = pas_http__decode_body(&rx, client->decode_work, client->decode_work_size);
+#endif
+
+        if (rx.done && rx.keep_alive && st == PAS_HTTP_OK && c != &scratch) {
+            c->idle_since = pas_http__now_ms();
+        } else {
+            pas_http__conn_close(c);
+        }
+        tm.bytes_received += received;
+        /* the server dropped a reused connection before answering: retry fresh */
+        if (st == PAS_HTTP_E_CONNECTION && reused && received == 0) {
+            tm.retries++;
+            continue;
+        }
+        if (rx.head_len) {
+            if (!cb) pas_http__rx_response(&rx, out_response);
+        }
+        else if (st == PAS_HTTP_OK) st = PAS_HTTP_E_CONNECTION;
+        break;
+    }
+
+    pas_http__timing_done(client, &tm, st);
+    *status = st;
+    return st;
+}
+
+/* The one-shot calls are a client without a pool: Connection: close, but
+   reading stops as soon as the response is complete. */
+int pas_http_get(const char *url,
+                 char *response_buffer, size_t buffer_size,
+                 int timeout_ms,
+                 pas_http_response_t *out_response,
+                 int *status)
+{
+    pas_http_client_t one_shot;
+    pas_http_client_init(&one_shot, NULL, 0, 0);
+    return pas_http_client_request(&one_shot, "GET", url, NULL, 0, NULL, 0, NULL,
+                                   response_buffer, buffer_size,
+                                   timeout_ms, out_response, status);
+}
+
+int pas_http_post(const char *url,
+                  const void *body, size_t body_len,
+                  char *response_buffer, size_t buffer_size,
+                  int timeout_ms,
+                  pas_http_response_t *out_response,
+                  int *status)
+{
+    pas_http_client_t one_shot;
+    pas_http_client_init(&one_shot, NULL, 0, 0);
+    return pas_http_client_request(&one_shot, "POST", url, NULL, 0, body_len ? body : (const void *)"",
+                                   body_len, NULL, response_buffer, buffer_size,
+                                   timeout_ms, out_response, status);
+}
+
+int pas_http_client_get(pas_http_client_t *client, const char *url,
+                        char *response_buffer, size_t buffer_size,
+                        int timeout_ms,
+                        pas_http_response_t *out_response,
+                        int *status)
+{
+    return pas_http_client_request(client, "GET", url, NULL, 0, NULL, 0, NULL,
+                                   response_buffer, buffer_size,
+                                   timeout_ms, out_response, status);
+}
+
+int pas_http_client_post(pas_http_client_t *client, const char *url,
+                         const void *body, size_t body_len,
+                         char *response_buffer, size_t buffer_size,
+                         int timeout_ms,
+                         pas_http_response_t *out_response,
+                         int *status)
+{
+    return pas_http_client_request(client, "POST", url, NULL, 0, body_len ? body : "", body_len, NULL,
+                                   response_buffer, buffer_size,
+                                   timeout_ms, out_response, status);
+}
+
+int pas_http_client_get_stream(pas_http_client_t *client, const char *url,
+                               const pas_http_callbacks_t *callbacks,
+                               char *recv_buffer, size_t recv_size,
+                               int timeout_ms,
+                               int *status)
+{
+    return pas_http_client_request(client, "GET", url, NULL, 0, NULL, 0, callbacks,
+                                   recv_buffer, recv_size,
+                                   timeout_ms, NULL, status);
+}
+
+int pas_http_client_post_stream(pas_http_client_t *client, const char *url,
+                                const void *body, size_t body_len,
+                                const pas_http_callbacks_t *callbacks,
+                                char *recv_buffer, size_t recv_size,
+                                int timeout_ms,
+                                int *status)
+{
+    return pas_http_client_request(client, "POST", url, NULL, 0, body_len ? body : "", body_len, callbacks,
+                                   recv_buffer, recv_size,
+                                   timeout_ms, NULL, status);
+}
+
+/* Writes as much of the pipeline as one gathered send takes without blocking, from
+   item *si at offset *off (into its head + body). Returns 0, or -1 on error. */
+static int pas_http__pipeline_send(SOCKET sock, pas_http_pipeline_item_t *items, size_t count,
+                                   size_t *si, size_t *off)
+{
+    pas_http__slice v[PAS_HTTP__IOV_MAX], *pv = v;
+    size_t n = 0, i, skip = *off;
+    long r;
+
+    for (i = *si; i < count && n + 2 <= PAS_HTTP__IOV_MAX; i++) {
+        v[n].p = items[i].buf;
+        v[n++].n = items[i].req_len;
+        v[n].p = (const char *)items[i].body;
+        v[n++].n = items[i].body_len;
+    }
+    pas_http__slices_skip(&pv, &n, skip);
+    r = pas_http__sendv(sock, pv, n);
+    if (r < 0) return -1;
+
+    /* advance the cursor by r bytes */
+    skip += (size_t)r;
+    while (*si < count && skip >= items[*si].req_len + items[*si].body_len) {
+        skip -= items[*si].req_len + items[*si].body_len;
+        (*si)++;
+    }
+    *off = skip;
+    return 0;
+}
+
+int pas_http_client_pipeline(pas_http_client_t *client,
+                             pas_http_pipeline_item_t *items, size_t count,
+                             int timeout_ms,
+                             int *status)
+{
+    char host_buf[PAS_HTTP_MAX_HOST], item_host[PAS_HTTP_MAX_HOST];
+    int port = 0, item_port, attempt, st = PAS_HTTP_OK;
+    size_t i;
+
+    if (!client || !status || (count && !items)) {
+        if (status) *status = PAS_HTTP_E_INVALID_URL;
+        return PAS_HTTP_E_INVALID_URL;
+    }
+    for (i = 0; i < count; i++) {
+        pas_http_pipeline_item_t *it = &items[i];
+        pas_http__head head;
+
+        memset(&it->response, 0, sizeof(it->response));
+        it->status = PAS_HTTP_E_CONNECTION;
+        /* without a pool only the last request closes the connection */
+        if (pas_http__head_init(&head, it->method, it->url, it->headers, it->header_count, it->body,
+                                it->body_len, client->conn_count > 0 || i + 1 < count, i ? item_host : host_buf,
+                                sizeof(host_buf), i ? &item_port : &port) != PAS_HTTP_OK ||
+            (i && (item_port != port || strcmp(item_host, host_buf) != 0))) {
+            *status = it->status = PAS_HTTP_E_INVALID_URL;
+            return PAS_HTTP_E_INVALID_URL;
+        }
+        it->req_len = pas_http__head_write(&head, it->buf, it->buf ? it->size : 0);
+        if (!it->buf || it->req_len > it->size) {
+            *status = it->status = PAS_HTTP_E_NOSPACE;
+            return PAS_HTTP_E_NOSPACE;
+        }
+    }
+    if (count == 0) {
+        *status = PAS_HTTP_OK;
+        return PAS_HTTP_OK;
+    }
+
+    for (attempt = 0; attempt < 2; attempt++) {
+        pas_http_conn_t scratch, *c;
+        pas_http__rx rx;
+        const char *pending = NULL;   /* bytes read past a response: the next one's start */
+        size_t pending_len = 0, sent_items = 0, sent_off = 0, k = 0, received = 0;
+        int reused = 0, rx_ready = 0, keep = 1;
+
+        c = pas_http__pool_take(client, host_buf, port, &reused);
+        if (!c) {
+            c = &scratch;
+            c->open = 0;
+        }
+        if (!c->open) {
+            SOCKET sock;
+            st = pas_http__open(client->dns, host_buf, port, timeout_ms,
+                                client->connect_stagger_ms, NULL, &sock);
+            if (st != PAS_HTTP_OK) {
+                for (i = 0; i < count; i++) items[i].status = st;
+                break;
+            }
+            c->sock = (pas_http_socket)sock;
+            c->open = 1;
+            c->port = port;
+            (void)snprintf(c->host, sizeof(c->host), "%s", host_buf);
+        } else {
+            pas_http__set_timeouts((SOCKET)c->sock, timeout_ms);
+        }
+
+        /* non-blocking for the loop: a blocking send would stop reading until the
+           send timeout whenever the server answers faster than it reads */
+        st = pas_http__set_nonblocking((SOCKET)c->sock, 1) == 0 ? PAS_HTTP_OK : PAS_HTTP_E_CONNECTION;
+        while (k < count && st == PAS_HTTP_OK) {
+            /* a response may only be read into its buf once its request left it */
+            int can_read = k < sent_items;
+            pas_http__pollfd pfd;
+            int r;
+
+            if (can_read && !rx_ready) {
+                pas_http__rx_init(&rx, items[k].buf, items[k].size, pas_http__is_head(items[k].method));
+                rx_ready = 1;
+            }
+            if (can_read && pending_len) {
+                size_t n = pending_len < rx.cap - rx.len ? pending_len : rx.cap - rx.len;
+                memcpy(rx.buf + rx.len, pending, n);
+                r = pas_http__rx_feed(&rx, n);
+                /* whatever this response did not use is still pending */
+                n -= rx.done ? rx.extra : 0;
+                pending += n;
+                pending_len -= n;
+            } else {
+                pfd.fd = (SOCKET)c->sock;
+                pfd.events = (short)((can_read ? POLLIN : 0) | (sent_items < count ? POLLOUT : 0));
+                pfd.revents = 0;
+                r = PAS_POLL(&pfd, 1, timeout_ms > 0 ? timeout_ms : PAS_HTTP_DEFAULT_TIMEOUT_MS);
+                if (r <= 0) {
+                    st = r == 0 ? PAS_HTTP_E_TIMEOUT : PAS_HTTP_E_CONNECTION;
+                    break;
+                }
+                if ((pfd.revents & POLLOUT) ||
+                    (!can_read && (pfd.revents & (POLLERR | POLLHUP)))) {
+                    if (pas_http__pipeline_send((SOCKET)c->sock, items, count, &sent_items, &sent_off) != 0) {
+                        st = PAS_HTTP_E_CONNECTION;
+                        break;
+                    }
+                }
+                if (!can_read || !(pfd.revents & (POLLIN | POLLERR | POLLHUP))) continue;
+                if (rx.len == rx.cap) {
+                    r = -2;
+                } else {
+                    r = pas_http__recv((SOCKET)c->sock, rx.buf + rx.len, rx.cap - rx.len);
+                    if (r == 0 && pas_http__rx_eof(&rx)) {
+                        r = 1;
+                    } else if (r > 0) {
+                        received += (size_t)r;
+                        r = pas_http__rx_feed(&rx, (size_t)r);
+                        if (rx.done && rx.extra) {
+                            pending = rx.buf + rx.len;
+                            pending_len = rx.extra;
+                        }
+                    } else if (r < 0 && pas_http__would_block()) {
+                        continue;
+                    } else {
+                        r = -1;
+                    }
+                }
+            }
+
+            if (r < 0 || (!rx.done && rx.len == rx.cap)) {
+                items[k].status = (r == -2 || rx.len == rx.cap) ? PAS_HTTP_E_NOSPACE : PAS_HTTP_E_CONNECTION;
+                if (rx.head_len) pas_http__rx_response(&rx, &items[k].response);
+                st = items[k].status;
+                keep = 0;
+                break;
+            }
+            if (rx.done) {
+                items[k].status = PAS_HTTP_OK;
+                pas_http__rx_response(&rx, &items[k].response);
+                if (!rx.keep_alive) keep = 0;
+                k++;
+                rx_ready = 0;
+                if (!keep) break;
+            }
+        }
+
+        if (k == count && keep && c != &scratch && pas_http__set_nonblocking((SOCKET)c->sock, 0) == 0) {
+            c->idle_since = pas_http__now_ms();
+        } else {
+            pas_http__conn_close(c);
+        }
+        if (st != PAS_HTTP_OK && reused && received == 0 && k == 0) continue;
+        break;
+    }
+
+    *status = PAS_HTTP_OK;
+    for (i = 0; i < count; i++) {
+        if (items[i].status != PAS_HTTP_OK) {
+            *status = items[i].status;
+            break;
+        }
+    }
+    return *status;
+}
+
+void pas_http_client_close(pas_http_client_t *client)
+{
+    size_t i;
+    if (!client) return;
+    for (i = 0; i < client->conn_count; i++) pas_http__conn_close(&client->conns[i]);
+}
+
+/* --- Multi-request engine --- */
+
+enum {
+    PAS_HTTP__REQ_UNUSED, PAS_HTTP__REQ_START, PAS_HTTP__REQ_CONNECTING,
+    PAS_HTTP__REQ_SENDING, PAS_HTTP__REQ_RECEIVING, PAS_HTTP__REQ_DONE
+};
+
+int pas_http_request_init(pas_http_request_t *req, const char *method, const char *url,
+                          const void *body, size_t body_len,
+                          char *buf, size_t size, int timeout_ms)
+{
+    return pas_http_request_init_headers(req, method, url, NULL, 0, body, body_len, buf, size, timeout_ms);
+}
+
+int pas_http_request_init_headers(pas_http_request_t *req, const char *method, const char *url,
+                                  const pas_http_header_t *headers, size_t header_count,
+                                  const void *body, size_t body_len,
+                                  char *buf, size_t size, int timeout_ms)
+{
+    pas_http__head head;
+
+    if (!req) return PAS_HTTP_E_INVALID_URL;
+    memset(req, 0, sizeof(*req));
+    req->sock = (pas_http_socket)PAS_SOCKET_INVALID;
+    req->body = body;
+    req->body_len = body_len;
+    req->buf = buf;
+    req->size = size;
+    req->timeout_ms = timeout_ms > 0 ? timeout_ms : PAS_HTTP_DEFAULT_TIMEOUT_MS;
+    req->head_req = pas_http__is_head(method);
+    req->done = 1;
+    req->state = PAS_HTTP__REQ_DONE;
+
+    if (pas_http__head_init(&head, method, url, headers, header_count, body, body_len, 0,
+                            req->host, sizeof(req->host), &req->port) != PAS_HTTP_OK) {
+        req->status = PAS_HTTP_E_INVALID_URL;
+        return req->status;
+    }
+    req->req_len = pas_http__head_write(&head, buf, buf ? size : 0);
+    if (!buf || req->req_len > size) {
+        req->status = PAS_HTTP_E_NOSPACE;
+        return req->status;
+    }
+    req->done = 0;
+    req->state = PAS_HTTP__REQ_START;
+    return PAS_HTTP_OK;
+}
+
+void pas_http_multi_init(pas_http_multi_t *multi, pas_http_request_t *reqs, size_t count)
+{
+    if (!multi) return;
+    multi->reqs = reqs;
+    multi->count = reqs ? count : 0;
+    multi->dns = NULL;
+}
+
+static void pas_http__req_finish(pas_http_request_t *req, int status)
+{
+    if (req->sock != (pas_http_socket)PAS_SOCKET_INVALID) PAS_CLOSE_SOCKET((SOCKET)req->sock);
+    req->sock = (pas_http_socket)PAS_SOCKET_INVALID;
+    if (req->state == PAS_HTTP__REQ_RECEIVING && req->rx.head_len) {
+        if (!req->callbacks) pas_http__rx_response(&req->rx, &req->response);
+    } else if (status == PAS_HTTP_OK) {
+        status = PAS_HTTP_E_CONNECTION;
+    }
+    req->status = status;
+    req->state = PAS_HTTP__REQ_DONE;
+    req->done = 1;
+    req->timing.done_us = pas_http_now_us();
+    req->timing.status = status;
+}
+
+/* Starts a non-blocking connect to the next untried address; fails the request
+   (and forgets the cached lookup) once none is left. */
+static void pas_http__req_connect_next(pas_http_request_t *req, pas_http_dns_cache_t *cache)
+{
+    if (req->sock != (pas_http_socket)PAS_SOCKET_INVALID) PAS_CLOSE_SOCKET((SOCKET)req->sock);
+    req->sock = (pas_http_socket)PAS_SOCKET_INVALID;
+    while (req->addr_next < req->addr_count) {
+        int connected;
+        SOCKET sock = pas_http__connect_start(&req->addrs[req->addr_next++], &connected);
+        if (sock == PAS_SOCKET_INVALID) continue;
+        req->sock = (pas_http_socket)sock;
+        req->state = connected ? PAS_HTTP__REQ_SENDING : PAS_HTTP__REQ_CONNECTING;
+        return;
+    }
+    pas_http__dns_forget(cache, req->host, req->port);
+    pas_http__req_finish(req, PAS_HTTP_E_CONNECTION);
+}
+
+/* Resolves and starts a non-blocking connect. */
+static void pas_http__req_start(pas_http_request_t *req, pas_http_dns_cache_t *cache, uint64_t now)
+{
+    req->deadline = now + (uint64_t)req->timeout_ms;
+    req->timing.start_us = pas_http_now_us();
+    req->addr_count = pas_http__resolve(cache, req->host, req->port, req->addrs);
+    req->timing.resolved_us = pas_http_now_us();
+    req->addr_next = 0;
+    pas_http__req_connect_next(req, cache);
+}
+
+static void pas_http__req_send(pas_http_request_t *req)
+{
+    /* first call after the connect completed */
+    if (!req->timing.connected_us) req->timing.connected_us = pas_http_now_us();
+    while (req->sent < req->req_len + req->body_len) {
+        pas_http__slice v[2], *pv = v;
+        size_t n = 2;
+        long r;
+
+        /* head and body in one gathered send */
+        v[0].p = req->buf;
+        v[0].n = req->req_len;
+        v[1].p = (const char *)req->body;
+        v[1].n = req->body_len;
+        pas_http__slices_skip(&pv, &n, req->sent);
+        r = pas_http__sendv((SOCKET)req->sock, pv, n);
+        if (r == 0) return;
+        if (r < 0) {
+            pas_http__req_finish(req, PAS_HTTP_E_CONNECTION);
+            return;
+        }
+        req->sent += (size_t)r;
+        req->timing.bytes_sent += (uint64_t)r;
+    }
+    req->timing.sent_us = pas_http_now_us();
+    /* request written: the buffer now receives the response */
+    pas_http__rx_init(&req->rx, req->buf, req->size, req->head_req);
+    req->state = PAS_HTTP__REQ_RECEIVING;
+}
+
+static void pas_http__req_recv(pas_http_request_t *req)
+{
+    pas_http__rx *rx = &req->rx;
+
+    for (;;) {
+        int r;
+
+        if (rx->len == rx->cap) {
+            pas_http__req_finish(req, PAS_HTTP_E_NOSPACE);
+            return;
+        }
+        r = pas_http__recv((SOCKET)req->sock, rx->buf + rx->len, rx->cap - rx->len);
+        if (r > 0) {
+            if (!req->timing.bytes_received) req->timing.first_byte_us = pas_http_now_us();
+            req->timing.bytes_received += (uint64_t)r;
+            if (pas_http__rx_feed(rx, (size_t)r) < 0) {
+                pas_http__req_finish(req, PAS_HTTP_E_CONNECTION);
+                return;
+            }
+            if (req->callbacks && pas_http__rx_deliver(rx, req->callbacks, &req->head_sent) != 0) {
+                pas_http__req_finish(req, PAS_HTTP_E_ABORTED);
+                return;
+            }
+            if (rx->done) {
+                pas_http__req_finish(req, PAS_HTTP_OK);
+                return;
+            }
+        } else if (r == 0) {
+            pas_http__req_finish(req, pas_http__rx_eof(rx) ? PAS_HTTP_OK : PAS_HTTP_E_CONNECTION);
+            return;
+        } else {
+            if (!pas_http__would_block()) pas_http__req_finish(req, PAS_HTTP_E_CONNECTION);
+            return;
+        }
+    }
+}
+
+int pas_http_multi_perform(pas_http_multi_t *multi, int timeout_ms)
+{
+    pas_http__pollfd fds[PAS_HTTP_MULTI_MAX_FDS];
+    pas_http_request_t *polled[PAS_HTTP_MULTI_MAX_FDS];
+    uint64_t now, next = 0;
+    size_t i, nfds = 0;
+    int running = 0, wait = timeout_ms, r;
+
+    if (!multi) return 0;
+    now = pas_http__now_ms();
+    for (i = 0; i < multi->count; i++) {
+        pas_http_request_t *req = &multi->reqs[i];
+        if (req->state == PAS_HTTP__REQ_START) pas_http__req_start(req, multi->dns, now);
+        if (req->state == PAS_HTTP__REQ_SENDING) pas_http__req_send(req);
+    }
+
+    for (i = 0; i < multi->count && nfds < PAS_HTTP_MULTI_MAX_FDS; i++) {
+        pas_http_request_t *req = &multi->reqs[i];
+        if (req->state < PAS_HTTP__REQ_CONNECTING || req->state > PAS_HTTP__REQ_RECEIVING) continue;
+        fds[nfds].fd = (SOCKET)req->sock;
+        fds[nfds].events = req->state == PAS_HTTP__REQ_RECEIVING ? POLLIN : POLLOUT;
+        fds[nfds].revents = 0;
+        polled[nfds++] = req;
+        if (!next || req->deadline < next) next = req->deadline;
+    }
+
+    if (nfds) {
+        /* never sleep past the nearest deadline */
+        uint64_t until = next > now ? next - now : 0;
+        if (wait < 0 || (uint64_t)wait > until) wait = (int)(until < 0x7FFFFFFF ? until : 0x7FFFFFFF);
+        r = PAS_POLL(fds, nfds, wait);
+        if (r < 0) r = 0;
+        for (i = 0; r > 0 && i < nfds; i++) {
+            pas_http_request_t *req = polled[i];
+            if (!fds[i].revents) continue;
+            r--;
+            if (req->state == PAS_HTTP__REQ_CONNECTING) {
+                if (pas_http__connect_error((SOCKET)req->sock) != 0 || (fds[i].revents & (POLLERR | POLLHUP))) {
+                    pas_http__req_connect_next(req, multi->dns);
+                    continue;
+                }
+                req->state = PAS_HTTP__REQ_SENDING;
+            }
+            if (req->state == PAS_HTTP__REQ_SENDING) pas_http__req_send(req);
+            else if (req->state == PAS_HTTP__REQ_RECEIVING) pas_http__req_recv(req);
+        }
+    }
+
+    now = pas_http__now_ms();
+    for (i = 0; i < multi->count; i++) {
+        pas_http_request_t *req = &multi->reqs[i];
+        if (req->state < PAS_HTTP__REQ_START || req->state == PAS_HTTP__REQ_DONE) continue;
+        if (req->state != PAS_HTTP__REQ_START && now >= req->deadline)
+            pas_http__req_finish(req, PAS_HTTP_E_TIMEOUT);
+        else
+            running++;
+    }
+    return running;
+}
+
+void pas_http_multi_cleanup(pas_http_multi_t *multi)
+{
+    size_t i;
+    if (!multi) return;
+    for (i = 0; i < multi->count; i++) {
+        pas_http_request_t *req = &multi->reqs[i];
+        if (req->state >= PAS_HTTP__REQ_START && req->state != PAS_HTTP__REQ_DONE)
+            pas_http__req_finish(req, PAS_HTTP_E_ABORTED);
+    }
 }
 
 #endif /* PAS_HTTP1_IMPLEMENTATION */
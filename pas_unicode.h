@@ -188,6 +188,19 @@ PASU_INLINE pasu_status pasu_utf8_next(const pasu_uint8 *s, pasu_size len,
     return st;
 }
 
+/*
+    pasu_utf8_validate:
+      Checks a whole UTF-8 buffer at once.
+
+      Returns the length of the longest well-formed prefix: len when the
+      buffer is valid, otherwise the offset of the first bad sequence, with
+      *status (if non-NULL) set to what pasu_utf8_decode returns there.
+      ASCII runs are skipped 16/32 bytes at a time; with SSSE3 (implied by
+      -mavx2) non-ASCII blocks are checked with lookup tables.
+*/
+PASUDEF pasu_size pasu_utf8_validate(const pasu_uint8 *s, pasu_size len,
+                                     pasu_status *status);
+
 /* ==============================
    UTF-16 (LE/BE agnostic, uses 16-bit units)
    ============================== */
@@ -244,6 +257,11 @@ PASU_INLINE pasu_status pasu_utf16_next(const pasu_uint16 *s, pasu_size len,
       *status (if non-NULL) is set to:
         - PASU_E_INVALID / PASU_E_RANGE / PASU_E_SURROG on bad input
         - PASU_E_NOSPACE if dst_capacity is not enough
+
+      UTF-8 <-> UTF-16 / UTF-32 conversions work a block at a time where they
+      can (see "Bulk transcoding" in the implementation); the result is the
+      same as converting one character at a time, and nothing is stored in dst
+      past the returned count.
 */
 PASUDEF pasu_size pasu_utf8_to_utf16(const pasu_uint8 *src, pasu_size src_len,
                                      pasu_uint16 *dst, pasu_size dst_capacity,
@@ -317,10 +335,95 @@ PASUDEF pasu_size pasu_utf16_length(const pasu_uint16 *str, pasu_size len,
 PASUDEF pasu_size pasu_utf32_length(const pasu_codepoint *str, pasu_size len,
                                     pasu_status *status);
 
+/*
+    Output sizes:
+      pasu_X_to_Y_size returns the count pasu_X_to_Y would return with a dst
+      of unlimited capacity, and sets *status the same way: the exact output
+      size of well-formed input, or the size of the part before the first bad
+      sequence. Nothing is decoded into code points; UTF-8 input is validated
+      and its lead bytes counted, UTF-16 / UTF-32 input a block at a time.
+      The UTF-32 targets are the pasu_utf8_length / pasu_utf16_length counts.
+*/
+PASUDEF pasu_size pasu_utf8_to_utf16_size(const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_status *status);
+
+PASUDEF pasu_size pasu_utf16_to_utf8_size(const pasu_uint16 *src, pasu_size src_len,
+                                          pasu_status *status);
+
+PASUDEF pasu_size pasu_utf8_to_utf32_size(const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_status *status);
+
+PASUDEF pasu_size pasu_utf32_to_utf8_size(const pasu_codepoint *src, pasu_size src_len,
+                                          pasu_status *status);
+
+PASUDEF pasu_size pasu_utf16_to_utf32_size(const pasu_uint16 *src, pasu_size src_len,
+                                           pasu_status *status);
+
+PASUDEF pasu_size pasu_utf32_to_utf16_size(const pasu_codepoint *src, pasu_size src_len,
+                                           pasu_status *status);
+
+/*
+    Streaming (chunked input):
+      A pasu_decoder carries a UTF-8 sequence or a UTF-16 surrogate pair cut
+      by the end of one chunk over to the next, so a stream can be converted
+      chunk by chunk as it arrives, without gathering it first. One decoder
+      per stream; use it for one source encoding only.
+
+        pasu_decoder d;
+        pasu_decoder_init(&d);
+        while (next_chunk(&buf, &len))
+            n = pasu_utf8_to_utf16_feed(&d, buf, len, out, cap, &used, &st);
+        st = pasu_decoder_finish(&d);
+
+      _feed converts one chunk and returns the units written to dst, like the
+      buffer conversions. *src_used (if non-NULL) receives the bytes / units
+      of src consumed:
+        - PASU_OK: all of src (a cut-off tail is held in d)
+        - PASU_E_NOSPACE: what was converted; call again with the rest once
+          dst has been drained
+        - other errors: the offset of the bad sequence in src, 0 if it began
+          in an earlier chunk; the stream cannot go on (pasu_decoder_init)
+      pasu_decoder_finish ends the stream: PASU_E_TRUNC if a sequence was left
+      incomplete, else PASU_OK; d is ready for a new stream either way.
+
+      Output and statuses, concatenated over the chunks, are those of the
+      buffer conversion of the whole stream.
+*/
+typedef struct pasu_decoder {
+    pasu_uint8  bytes[4];   /* UTF-8: start of a sequence cut by the chunk end */
+    pasu_uint16 unit;       /* UTF-16: high surrogate waiting for its pair */
+    pasu_uint8  pending;    /* bytes / units held */
+} pasu_decoder;
+
+PASU_INLINE void pasu_decoder_init(pasu_decoder *d)
+{
+    d->pending = 0;
+}
+
+PASUDEF pasu_size pasu_utf8_to_utf16_feed(pasu_decoder *d, const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_uint16 *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status);
+
+PASUDEF pasu_size pasu_utf8_to_utf32_feed(pasu_decoder *d, const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_codepoint *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status);
+
+PASUDEF pasu_size pasu_utf16_to_utf8_feed(pasu_decoder *d, const pasu_uint16 *src, pasu_size src_len,
+                                          pasu_uint8 *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status);
+
+PASUDEF pasu_size pasu_utf16_to_utf32_feed(pasu_decoder *d, const pasu_uint16 *src, pasu_size src_len,
+                                           pasu_codepoint *dst, pasu_size dst_capacity,
+                                           pasu_size *src_used, pasu_status *status);
+
+PASUDEF pasu_status pasu_decoder_finish(pasu_decoder *d);
+
 /*
     C-string helpers for UTF-8 / UTF-16:
       These work with null-terminated strings and always try to keep
       dst null-terminated (when dst_capacity > 0), even on error.
+      The terminator is found during the conversion itself (one pass over
+      src); the result is the same as measuring src first.
 */
 PASUDEF pasu_size pasu_utf8_to_utf16_cstr(const pasu_uint8 *src,
                                           pasu_uint16 *dst, pasu_size dst_capacity,
@@ -407,6 +510,76 @@ PASUDEF pasu_size pasu_utf32_length_cstr_c11(const char32_t *src,
 
 #ifdef PAS_UNICODE_IMPLEMENTATION
 
+/*
+    SIMD selection: SSE2 (x86-64 baseline), SSSE3 and AVX2 when the compiler
+    targets them, NEON on AArch64. Define PASU_NO_SIMD for the portable loops.
+*/
+#if !defined(PASU_NO_SIMD)
+    #if defined(__AVX2__)
+        #define PASU__AVX2 1
+        #include <immintrin.h>
+    #endif
+    #if defined(__SSSE3__) || defined(__AVX2__)
+        #define PASU__SSSE3 1
+        #include <tmmintrin.h>
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define PASU__SSE2 1
+        #include <emmintrin.h>
+    #elif defined(__aarch64__) && defined(__ARM_NEON)
+        #define PASU__NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define PASU__CTZ(x) ((unsigned)__builtin_ctz(x))
+#else
+static unsigned pasu__ctz(unsigned x)
+{
+    unsigned n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+}
+    #define PASU__CTZ(x) pasu__ctz(x)
+#endif
+
+/* --- ASCII runs --- */
+
+/* Number of leading bytes of s below 0x80. */
+static pasu_size pasu__ascii_prefix(const pasu_uint8 *s, pasu_size len)
+{
+    pasu_size i = 0;
+
+#if defined(PASU__AVX2)
+    for (; i + 32 <= len; i += 32) {
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(const void *)(s + i)));
+        if (m) return i + PASU__CTZ(m);
+    }
+#endif
+#if defined(PASU__SSE2)
+    for (; i + 16 <= len; i += 16) {
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(const void *)(s + i)));
+        if (m) return i + PASU__CTZ(m);
+    }
+#elif defined(PASU__NEON)
+    for (; i + 16 <= len; i += 16)
+        if (vmaxvq_u8(vld1q_u8(s + i)) >= 0x80u) break;
+#elif (defined(__GNUC__) || defined(__clang__)) && !(defined(_MSC_VER) && (_MSC_VER < 1600))
+    /* SWAR: eight bytes per test */
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        __builtin_memcpy(&w, s + i, 8);   /* one unaligned load */
+        if (w & (((uint64_t)0x80808080u << 32) | 0x80808080u)) break;
+    }
+#else
+    for (; i + 4 <= len; i += 4)
+        if ((s[i] | s[i + 1] | s[i + 2] | s[i + 3]) & 0x80u) break;
+#endif
+    while (i < len && s[i] < 0x80u) ++i;
+    return i;
+}
+
 /* --- UTF-8 helpers --- */
 
 PASUDEF pasu_status pasu_utf8_decode(const pasu_uint8 *s, pasu_size len,
@@ -565,6 +738,427 @@ PASUDEF pasu_status pasu_utf8_encode(pasu_codepoint cp,
     }
 }
 
+/* --- Bulk validation --- */
+
+#if defined(PASU__SSSE3)
+/*
+    Keiser-Lemire check of 16 bytes following prev. Three 16-entry tables, indexed
+    by the previous byte's high and low nibble and this byte's high nibble, AND to
+    a non-zero value exactly for the ill-formed byte pairs (too short, too long,
+    overlong, surrogate, above U+10FFFF, stray continuation); continuation bytes
+    expected 2 or 3 places after a lead are matched against prev2/prev3.
+    Non-zero lanes mark the byte where a defect shows.
+*/
+static __m128i pasu__utf8_errors(__m128i in, __m128i prev)
+{
+    const __m128i b1h = _mm_setr_epi8(2, 2, 2, 2, 2, 2, 2, 2, -128, -128, -128, -128, 33, 1, 21, 73);
+    const __m128i b1l = _mm_setr_epi8(-25, -93, -125, -125, -117, -53, -53, -53,
+                                      -53, -53, -53, -53, -53, -37, -53, -53);
+    const __m128i b2h = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, -26, -82, -70, -70, 1, 1, 1, 1);
+    const __m128i nib = _mm_set1_epi8(0x0F);
+    __m128i p1 = _mm_alignr_epi8(in, prev, 15);
+    __m128i p2 = _mm_alignr_epi8(in, prev, 14);
+    __m128i p3 = _mm_alignr_epi8(in, prev, 13);
+    __m128i sc, must23;
+
+    sc = _mm_and_si128(_mm_and_si128(
+             _mm_shuffle_epi8(b1h, _mm_and_si128(_mm_srli_epi16(p1, 4), nib)),
+             _mm_shuffle_epi8(b1l, _mm_and_si128(p1, nib))),
+             _mm_shuffle_epi8(b2h, _mm_and_si128(_mm_srli_epi16(in, 4), nib)));
+    must23 = _mm_or_si128(_mm_subs_epu8(p2, _mm_set1_epi8(0x60)), _mm_subs_epu8(p3, _mm_set1_epi8(0x70)));
+    return _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8(-128)), sc);
+}
+
+/*
+    Validates 16 bytes per step. Returns a character boundary b with s[0..b) well
+    formed; the caller decodes from there, so every status and position still
+    comes from pasu_utf8_decode.
+*/
+static pasu_size pasu__utf8_valid_blocks(const pasu_uint8 *s, pasu_size len)
+{
+    /* the last three bytes of a block may not be leads needing more than the block */
+    const __m128i tail = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -17, -33, -65);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i prev = zero, incomplete = zero;
+    pasu_size i, k;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+
+        if (!_mm_movemask_epi8(in)) {
+            /* ASCII block: only a sequence left open by the previous one can be wrong */
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(incomplete, zero)) != 0xFFFF) break;
+            prev = in;
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(pasu__utf8_errors(in, prev), zero)) != 0xFFFF) break;
+        incomplete = _mm_subs_epu8(in, tail);
+        prev = in;
+    }
+
+    /* back to the lead of a sequence that may run past i */
+    for (k = 1; k <= 3 && k <= i; ++k) {
+        if (s[i - k] < 0x80u) break;
+        if (s[i - k] >= 0xC0u) return i - k;
+    }
+    return i;
+}
+#endif
+
+PASUDEF pasu_size pasu_utf8_validate(const pasu_uint8 *s, pasu_size len,
+                                     pasu_status *status)
+{
+    pasu_size i = 0;
+
+    if (status)
+        *status = PASU_OK;
+
+    if (len && !s) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+#if defined(PASU__SSSE3)
+    i = pasu__utf8_valid_blocks(s, len);
+#endif
+    while (i < len) {
+        pasu_size used = 0;
+        pasu_status st;
+
+        if (s[i] < 0x80u) {
+            i += pasu__ascii_prefix(s + i, len - i);
+            continue;
+        }
+        st = pasu_utf8_decode(s + i, len - i, NULL, &used);
+        if (st != PASU_OK) {
+            if (status) *status = st;
+            return i;
+        }
+        i += used;
+    }
+
+    return len;
+}
+
+/* --- Bulk transcoding --- */
+
+/*
+    ASCII runs are widened or narrowed a vector at a time. With SSSE3, mixed text
+    goes through block coders: a 16-byte UTF-8 block of 1..3-byte characters
+    becomes up to 15 UTF-16 units, 8 UTF-16 units below U+0800 become up to 16
+    UTF-8 bytes. Blocks with anything else (4-byte sequences, surrogates, errors,
+    too little room) are left to the per-character loops, so results are the same
+    on every path. Stores never touch dst past the units actually produced.
+*/
+
+/* dst[k] = src[k] for n bytes below 0x80 */
+static void pasu__widen16(pasu_uint16 *dst, const pasu_uint8 *src, pasu_size n)
+{
+    pasu_size k = 0;
+
+#if defined(PASU__AVX2)
+    for (; k + 16 <= n; k += 16)
+        _mm256_storeu_si256((__m256i *)(void *)(dst + k),
+                            _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(src + k))));
+#elif defined(PASU__SSE2)
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(src + k));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k), _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+    }
+#elif defined(PASU__NEON)
+    for (; k + 16 <= n; k += 16) {
+        uint8x16_t v = vld1q_u8(src + k);
+        vst1q_u16(dst + k, vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(dst + k + 8, vmovl_u8(vget_high_u8(v)));
+    }
+#endif
+    for (; k < n; ++k) dst[k] = src[k];
+}
+
+static void pasu__widen32(pasu_codepoint *dst, const pasu_uint8 *src, pasu_size n)
+{
+    pasu_size k = 0;
+
+#if defined(PASU__AVX2)
+    for (; k + 8 <= n; k += 8)
+        _mm256_storeu_si256((__m256i *)(void *)(dst + k),
+                            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)(src + k))));
+#elif defined(PASU__SSE2)
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(src + k)), z = _mm_setzero_si128();
+        __m128i lo = _mm_unpacklo_epi8(v, z), hi = _mm_unpackhi_epi8(v, z);
+        _mm_storeu_si128((__m128i *)(void *)(dst + k), _mm_unpacklo_epi16(lo, z));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k + 4), _mm_unpackhi_epi16(lo, z));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k + 8), _mm_unpacklo_epi16(hi, z));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k + 12), _mm_unpackhi_epi16(hi, z));
+    }
+#elif defined(PASU__NEON)
+    for (; k + 8 <= n; k += 8) {
+        uint16x8_t v = vmovl_u8(vld1_u8(src + k));
+        vst1q_u32(dst + k, vmovl_u16(vget_low_u16(v)));
+        vst1q_u32(dst + k + 4, vmovl_u16(vget_high_u16(v)));
+    }
+#endif
+    for (; k < n; ++k) dst[k] = src[k];
+}
+
+/* Number of leading UTF-16 units below 0x80. */
+static pasu_size pasu__ascii_prefix16(const pasu_uint16 *s, pasu_size len)
+{
+    pasu_size i = 0;
+
+#if defined(PASU__SSE2)
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i *)(const void *)(s + i)), _mm_set1_epi16(-128));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128())) ^ 0xFFFFu;
+        if (m) return i + PASU__CTZ(m) / 2;
+    }
+#elif defined(PASU__NEON)
+    for (; i + 8 <= len; i += 8)
+        if (vmaxvq_u16(vld1q_u16(s + i)) >= 0x80u) break;
+#endif
+    while (i < len && s[i] < 0x80u) ++i;
+    return i;
+}
+
+static pasu_size pasu__ascii_prefix32(const pasu_codepoint *s, pasu_size len)
+{
+    pasu_size i = 0;
+
+#if defined(PASU__SSE2)
+    for (; i + 4 <= len; i += 4) {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i *)(const void *)(s + i)), _mm_set1_epi32(-128));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128())) ^ 0xFFFFu;
+        if (m) return i + PASU__CTZ(m) / 4;
+    }
+#elif defined(PASU__NEON)
+    for (; i + 4 <= len; i += 4)
+        if (vmaxvq_u32(vld1q_u32(s + i)) >= 0x80u) break;
+#endif
+    while (i < len && s[i] < 0x80u) ++i;
+    return i;
+}
+
+/* dst[k] = src[k] for n units below 0x80 */
+static void pasu__narrow16(pasu_uint8 *dst, const pasu_uint16 *src, pasu_size n)
+{
+    pasu_size k = 0;
+
+#if defined(PASU__SSE2)
+    for (; k + 16 <= n; k += 16)
+        _mm_storeu_si128((__m128i *)(void *)(dst + k),
+                         _mm_packus_epi16(_mm_loadu_si128((const __m128i *)(const void *)(src + k)),
+                                          _mm_loadu_si128((const __m128i *)(const void *)(src + k + 8))));
+#elif defined(PASU__NEON)
+    for (; k + 8 <= n; k += 8)
+        vst1_u8(dst + k, vmovn_u16(vld1q_u16(src + k)));
+#endif
+    for (; k < n; ++k) dst[k] = (pasu_uint8)src[k];
+}
+
+static void pasu__narrow32(pasu_uint8 *dst, const pasu_codepoint *src, pasu_size n)
+{
+    pasu_size k = 0;
+
+#if defined(PASU__SSE2)
+    for (; k + 16 <= n; k += 16) {
+        const __m128i *v = (const __m128i *)(const void *)(src + k);
+        __m128i lo = _mm_packs_epi32(_mm_loadu_si128(v), _mm_loadu_si128(v + 1));
+        __m128i hi = _mm_packs_epi32(_mm_loadu_si128(v + 2), _mm_loadu_si128(v + 3));
+        _mm_storeu_si128((__m128i *)(void *)(dst + k), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(PASU__NEON)
+    for (; k + 8 <= n; k += 8)
+        vst1_u8(dst + k, vmovn_u16(vcombine_u16(vmovn_u32(vld1q_u32(src + k)), vmovn_u32(vld1q_u32(src + k + 4)))));
+#endif
+    for (; k < n; ++k) dst[k] = (pasu_uint8)src[k];
+}
+
+#if defined(PASU__SSSE3)
+/* Left-packing shuffles: nibble k of entry m is the position of the k-th set bit of m. */
+static const pasu_uint32 pasu__pack8[256] = {
+    0x00000000u, 0x00000000u, 0x00000001u, 0x00000010u, 0x00000002u, 0x00000020u,
+    0x00000021u, 0x00000210u, 0x00000003u, 0x00000030u, 0x00000031u, 0x00000310u,
+    0x00000032u, 0x00000320u, 0x00000321u, 0x00003210u, 0x00000004u, 0x00000040u,
+    0x00000041u, 0x00000410u, 0x00000042u, 0x00000420u, 0x00000421u, 0x00004210u,
+    0x00000043u, 0x00000430u, 0x00000431u, 0x00004310u, 0x00000432u, 0x00004320u,
+    0x00004321u, 0x00043210u, 0x00000005u, 0x00000050u, 0x00000051u, 0x00000510u,
+    0x00000052u, 0x00000520u, 0x00000521u, 0x00005210u, 0x00000053u, 0x00000530u,
+    0x00000531u, 0x00005310u, 0x00000532u, 0x00005320u, 0x00005321u, 0x00053210u,
+    0x00000054u, 0x00000540u, 0x00000541u, 0x00005410u, 0x00000542u, 0x00005420u,
+    0x00005421u, 0x00054210u, 0x00000543u, 0x00005430u, 0x00005431u, 0x00054310u,
+    0x00005432u, 0x00054320u, 0x00054321u, 0x00543210u, 0x00000006u, 0x00000060u,
+    0x00000061u, 0x00000610u, 0x00000062u, 0x00000620u, 0x00000621u, 0x00006210u,
+    0x00000063u, 0x00000630u, 0x00000631u, 0x00006310u, 0x00000632u, 0x00006320u,
+    0x00006321u, 0x00063210u, 0x00000064u, 0x00000640u, 0x00000641u, 0x00006410u,
+    0x00000642u, 0x00006420u, 0x00006421u, 0x00064210u, 0x00000643u, 0x00006430u,
+    0x00006431u, 0x00064310u, 0x00006432u, 0x00064320u, 0x00064321u, 0x00643210u,
+    0x00000065u, 0x00000650u, 0x00000651u, 0x00006510u, 0x00000652u, 0x00006520u,
+    0x00006521u, 0x00065210u, 0x00000653u, 0x00006530u, 0x00006531u, 0x00065310u,
+    0x00006532u, 0x00065320u, 0x00065321u, 0x00653210u, 0x00000654u, 0x00006540u,
+    0x00006541u, 0x00065410u, 0x00006542u, 0x00065420u, 0x00065421u, 0x00654210u,
+    0x00006543u, 0x00065430u, 0x00065431u, 0x00654310u, 0x00065432u, 0x00654320u,
+    0x00654321u, 0x06543210u, 0x00000007u, 0x00000070u, 0x00000071u, 0x00000710u,
+    0x00000072u, 0x00000720u, 0x00000721u, 0x00007210u, 0x00000073u, 0x00000730u,
+    0x00000731u, 0x00007310u, 0x00000732u, 0x00007320u, 0x00007321u, 0x00073210u,
+    0x00000074u, 0x00000740u, 0x00000741u, 0x00007410u, 0x00000742u, 0x00007420u,
+    0x00007421u, 0x00074210u, 0x00000743u, 0x00007430u, 0x00007431u, 0x00074310u,
+    0x00007432u, 0x00074320u, 0x00074321u, 0x00743210u, 0x00000075u, 0x00000750u,
+    0x00000751u, 0x00007510u, 0x00000752u, 0x00007520u, 0x00007521u, 0x00075210u,
+    0x00000753u, 0x00007530u, 0x00007531u, 0x00075310u, 0x00007532u, 0x00075320u,
+    0x00075321u, 0x00753210u, 0x00000754u, 0x00007540u, 0x00007541u, 0x00075410u,
+    0x00007542u, 0x00075420u, 0x00075421u, 0x00754210u, 0x00007543u, 0x00075430u,
+    0x00075431u, 0x00754310u, 0x00075432u, 0x00754320u, 0x00754321u, 0x07543210u,
+    0x00000076u, 0x00000760u, 0x00000761u, 0x00007610u, 0x00000762u, 0x00007620u,
+    0x00007621u, 0x00076210u, 0x00000763u, 0x00007630u, 0x00007631u, 0x00076310u,
+    0x00007632u, 0x00076320u, 0x00076321u, 0x00763210u, 0x00000764u, 0x00007640u,
+    0x00007641u, 0x00076410u, 0x00007642u, 0x00076420u, 0x00076421u, 0x00764210u,
+    0x00007643u, 0x00076430u, 0x00076431u, 0x00764310u, 0x00076432u, 0x00764320u,
+    0x00764321u, 0x07643210u, 0x00000765u, 0x00007650u, 0x00007651u, 0x00076510u,
+    0x00007652u, 0x00076520u, 0x00076521u, 0x00765210u, 0x00007653u, 0x00076530u,
+    0x00076531u, 0x00765310u, 0x00076532u, 0x00765320u, 0x00765321u, 0x07653210u,
+    0x00007654u, 0x00076540u, 0x00076541u, 0x00765410u, 0x00076542u, 0x00765420u,
+    0x00765421u, 0x07654210u, 0x00076543u, 0x00765430u, 0x00765431u, 0x07654310u,
+    0x00765432u, 0x07654320u, 0x07654321u, 0x76543210u
+};
+
+static __m128i pasu__pack_index(unsigned m)
+{
+    __m128i t = _mm_cvtsi32_si128((int)pasu__pack8[m]), nib = _mm_set1_epi8(0x0F);
+    return _mm_unpacklo_epi8(_mm_and_si128(t, nib), _mm_and_si128(_mm_srli_epi16(t, 4), nib));
+}
+
+static unsigned pasu__popcount8(unsigned m)
+{
+    m = m - ((m >> 1) & 0x55u);
+    m = (m & 0x33u) + ((m >> 2) & 0x33u);
+    return (m + (m >> 4)) & 0x0Fu;
+}
+
+/* Left-packs the 16-bit lanes of v selected by the 8-bit mask m. */
+static __m128i pasu__pack16(__m128i v, unsigned m)
+{
+    __m128i d = pasu__pack_index(m);
+    d = _mm_add_epi8(d, d);
+    return _mm_shuffle_epi8(v, _mm_unpacklo_epi8(d, _mm_add_epi8(d, _mm_set1_epi8(1))));
+}
+
+/*
+    Stores the first n lanes of v and old (the bytes at dst before anything was
+    stored this step) in the rest.
+*/
+static void pasu__store_n8(pasu_uint8 *dst, __m128i v, int n, __m128i old)
+{
+    __m128i keep = _mm_cmpgt_epi8(_mm_set1_epi8((char)n),
+                                  _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    _mm_storeu_si128((__m128i *)(void *)dst, _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, old)));
+}
+
+static void pasu__store_n16(pasu_uint16 *dst, __m128i v, int n, __m128i old)
+{
+    __m128i keep = _mm_cmpgt_epi16(_mm_set1_epi16((short)n), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+    _mm_storeu_si128((__m128i *)(void *)dst, _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, old)));
+}
+
+/* The 8 16-bit lanes of v, zero-extended. */
+static void pasu__store32(pasu_codepoint *dst, __m128i v)
+{
+    _mm_storeu_si128((__m128i *)(void *)dst, _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    _mm_storeu_si128((__m128i *)(void *)(dst + 4), _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+}
+
+/* First n of them, old0/old1 in the rest. */
+static void pasu__store_n32(pasu_codepoint *dst, __m128i v, int n, __m128i old0, __m128i old1)
+{
+    const __m128i lane = _mm_setr_epi32(0, 1, 2, 3), z = _mm_setzero_si128();
+    __m128i keep;
+
+    keep = _mm_cmpgt_epi32(_mm_set1_epi32(n), lane);
+    _mm_storeu_si128((__m128i *)(void *)dst,
+                     _mm_or_si128(_mm_and_si128(keep, _mm_unpacklo_epi16(v, z)), _mm_andnot_si128(keep, old0)));
+    keep = _mm_cmpgt_epi32(_mm_set1_epi32(n - 4), lane);
+    _mm_storeu_si128((__m128i *)(void *)(dst + 4),
+                     _mm_or_si128(_mm_and_si128(keep, _mm_unpackhi_epi16(v, z)), _mm_andnot_si128(keep, old1)));
+}
+
+/*
+    Decodes the whole characters in s[0..16) (s starts on a character boundary)
+    when they are well formed and at most 3 bytes long. Each byte's value is built
+    from it and the two bytes before it; the values at character ends are packed
+    into *lo (*n_lo units from bytes 0..7) and *hi (*n_hi units from bytes 8..14).
+    Returns the bytes decoded, or 0 to leave the next character to the scalar loop.
+*/
+static pasu_size pasu__utf8_block(const pasu_uint8 *s, __m128i *lo, __m128i *hi, int *n_lo, int *n_hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i in = _mm_loadu_si128((const __m128i *)(const void *)s);
+    __m128i cont = _mm_cmplt_epi8(in, _mm_set1_epi8(-64));
+    __m128i c1, low, mid, top;
+    unsigned cm = (unsigned)_mm_movemask_epi8(cont), big, bad, ends;
+    pasu_size c = 15;
+
+    if (!_mm_movemask_epi8(in)) return 0;   /* all ASCII: widened by the caller */
+    while (c > 0 && (cm >> c) & 1u) --c;   /* s[c] starts the first character not taken */
+    if (c == 0) return 0;
+    big = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(in, _mm_set1_epi8(-17)), zero)) ^ 0xFFFFu;
+    bad = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(pasu__utf8_errors(in, zero), zero)) ^ 0xFFFFu;
+    bad &= (2u << c) - 1;     /* a defect showing at s[c] still belongs to s[0..c) */
+    bad |= big & ((1u << c) - 1);   /* 4-byte sequences need surrogate pairs */
+    if (bad) return 0;
+
+    /* value = low bits | bits of the byte before << 6 | bits of the one before that << 12 */
+    c1 = _mm_slli_si128(cont, 1);
+    low = _mm_and_si128(in, _mm_xor_si128(_mm_set1_epi8(0x7F), _mm_and_si128(cont, _mm_set1_epi8(0x40))));
+    mid = _mm_and_si128(cont, _mm_and_si128(_mm_slli_si128(in, 1),
+                                            _mm_xor_si128(_mm_set1_epi8(0x1F), _mm_and_si128(c1, _mm_set1_epi8(0x20)))));
+    top = _mm_and_si128(_mm_and_si128(cont, c1), _mm_and_si128(_mm_slli_si128(in, 2), _mm_set1_epi8(0x0F)));
+
+    ends = ~(cm >> 1) & ((1u << c) - 1);
+    *lo = _mm_or_si128(_mm_or_si128(_mm_unpacklo_epi8(low, zero), _mm_slli_epi16(_mm_unpacklo_epi8(mid, zero), 6)),
+                       _mm_slli_epi16(_mm_unpacklo_epi8(top, zero), 12));
+    *hi = _mm_or_si128(_mm_or_si128(_mm_unpackhi_epi8(low, zero), _mm_slli_epi16(_mm_unpackhi_epi8(mid, zero), 6)),
+                       _mm_slli_epi16(_mm_unpackhi_epi8(top, zero), 12));
+    *lo = pasu__pack16(*lo, ends & 0xFFu);
+    *hi = pasu__pack16(*hi, ends >> 8);
+    *n_lo = (int)pasu__popcount8(ends & 0xFFu);
+    *n_hi = (int)pasu__popcount8(ends >> 8);
+    return c;
+}
+
+/*
+    Encodes 8 UTF-16 units into dst (which has room for 24 bytes) when all are
+    below U+0800. Each unit gives its lead byte (or ASCII byte) and a continuation
+    byte; the ones needed are packed per half, the second store covering whatever
+    the first wrote past its bytes. Returns the bytes written, 0 if a unit needs
+    the scalar loop.
+*/
+static pasu_size pasu__utf16_block(const pasu_uint16 *s, pasu_uint8 *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_loadu_si128((const __m128i *)(const void *)s);
+    __m128i two, b0, b1, w, old;
+    unsigned keep;
+    int n_lo;
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-2048)), zero)) != 0xFFFF)
+        return 0;
+    two = _mm_xor_si128(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-128)), zero), _mm_set1_epi16(-1));
+    b0 = _mm_or_si128(_mm_and_si128(two, _mm_or_si128(_mm_srli_epi16(v, 6), _mm_set1_epi16(0xC0))),
+                      _mm_andnot_si128(two, v));
+    b1 = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+    w = _mm_or_si128(b0, _mm_slli_epi16(b1, 8));
+
+    keep = ((unsigned)_mm_movemask_epi8(two) & 0xAAAAu) | 0x5555u;
+    n_lo = (int)pasu__popcount8(keep & 0xFFu);
+    old = _mm_loadu_si128((const __m128i *)(const void *)(dst + n_lo));
+    _mm_storeu_si128((__m128i *)(void *)dst, _mm_shuffle_epi8(w, pasu__pack_index(keep & 0xFFu)));
+    pasu__store_n8(dst + n_lo, _mm_shuffle_epi8(w, _mm_add_epi8(pasu__pack_index(keep >> 8), _mm_set1_epi8(8))),
+                   (int)pasu__popcount8(keep >> 8), old);
+    return (pasu_size)n_lo + pasu__popcount8(keep >> 8);
+}
+#endif
+
 /* --- UTF-16 helpers --- */
 
 PASUDEF pasu_status pasu_utf16_decode(const pasu_uint16 *s, pasu_size len,
@@ -646,144 +1240,357 @@ PASUDEF pasu_status pasu_utf16_encode(pasu_codepoint cp,
     }
 }
 
-/* --- Conversions and length helpers --- */
-
-PASUDEF pasu_size pasu_utf8_to_utf16(const pasu_uint8 *src, pasu_size src_len,
-                                     pasu_uint16 *dst, pasu_size dst_capacity,
-                                     pasu_status *status)
-{
-    pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
-
-    if (status)
-        *status = PASU_OK;
-
-    if (src_len && !src) {
-        if (status) *status = PASU_E_INVALID;
-        return 0;
-    }
+/* --- NUL-terminated sources --- */
 
-    while (i < src_len) {
-        pasu_codepoint cp;
-        pasu_size used8 = 0;
-        pasu_uint16 tmp[2];
-        pasu_size used16 = 0;
+/*
+    The _cstr conversions find the terminator in the same pass as the conversion
+    (z != 0 below: src_len is unused and the source ends at its first 0 unit).
+    Vector loads may read past the terminator then, but never across a 4 KiB page
+    boundary, so never into memory that is not mapped; sanitizer builds read the
+    source unit by unit instead.
+*/
+#if defined(__SANITIZE_ADDRESS__)
+    #define PASU__NO_OVERREAD 1
+#elif defined(__has_feature)
+    #if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+        #define PASU__NO_OVERREAD 1
+    #endif
+#endif
 
-        st = pasu_utf8_decode(src + i, src_len - i, &cp, &used8);
-        if (st != PASU_OK) {
-            if (status) *status = st;
-            return j;
-        }
-        i += used8;
+#if (defined(PASU__SSE2) || defined(PASU__NEON)) && !defined(PASU__NO_OVERREAD)
+    #define PASU__Z_SIMD 1
+    #define PASU__PAGE_SAFE(p) (((size_t)(const void *)(p) & 4095u) <= 4096u - 16u)
+#endif
 
-        st = pasu_utf16_encode(cp, tmp, &used16);
-        if (st != PASU_OK) {
-            if (status) *status = st;
-            return j;
+/* Leading bytes of s in 0x01..0x7F. */
+static pasu_size pasu__ascii_prefix_z(const pasu_uint8 *s)
+{
+    pasu_size i = 0, k;
+
+    for (;;) {
+#if defined(PASU__Z_SIMD)
+        while (PASU__PAGE_SAFE(s + i)) {
+    #if defined(PASU__SSE2)
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+            unsigned m = (unsigned)(_mm_movemask_epi8(v) | _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+            if (m) return i + PASU__CTZ(m);
+    #else
+            uint8x16_t v = vld1q_u8(s + i);
+            if (vmaxvq_u8(v) >= 0x80u || vminvq_u8(v) == 0) break;
+    #endif
+            i += 16;
         }
+#endif
+        for (k = 0; k < 16; ++k, ++i)
+            if (s[i] == 0 || s[i] >= 0x80u) return i;
+    }
+}
 
-        if (j + used16 > dst_capacity) {
-            if (status) *status = PASU_E_NOSPACE;
-            return j;
+/* Leading units of s in 0x01..0x7F. */
+static pasu_size pasu__ascii_prefix16_z(const pasu_uint16 *s)
+{
+    pasu_size i = 0, k;
+
+    for (;;) {
+#if defined(PASU__Z_SIMD)
+        while (PASU__PAGE_SAFE(s + i)) {
+    #if defined(PASU__SSE2)
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i)), z = _mm_setzero_si128();
+            unsigned m = (unsigned)(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-128)), z)) &
+                                    ~_mm_movemask_epi8(_mm_cmpeq_epi16(v, z))) ^ 0xFFFFu;
+            if (m) return i + PASU__CTZ(m) / 2;
+    #else
+            uint16x8_t v = vld1q_u16(s + i);
+            if (vmaxvq_u16(v) >= 0x80u || vminvq_u16(v) == 0) break;
+    #endif
+            i += 8;
         }
-
-        dst[j++] = tmp[0];
-        if (used16 == 2)
-            dst[j++] = tmp[1];
+#endif
+        for (k = 0; k < 8; ++k, ++i)
+            if (s[i] == 0 || s[i] >= 0x80u) return i;
     }
-
-    return j;
 }
 
-PASUDEF pasu_size pasu_utf16_to_utf8(const pasu_uint16 *src, pasu_size src_len,
-                                     pasu_uint8 *dst, pasu_size dst_capacity,
-                                     pasu_status *status)
+static pasu_size pasu__ascii_prefix32_z(const pasu_codepoint *s)
 {
     pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
+    while (s[i] != 0 && s[i] < 0x80u) ++i;
+    return i;
+}
 
-    if (status)
-        *status = PASU_OK;
+#if defined(PASU__SSSE3)
+/* 16 bytes at p that may be read and hold no terminator (no 0 byte / no 0 unit). */
+static int pasu__z_block8(const pasu_uint8 *p)
+{
+    #if defined(PASU__Z_SIMD)
+    return PASU__PAGE_SAFE(p) &&
+           !_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(const void *)p), _mm_setzero_si128()));
+    #else
+    (void)p;
+    return 0;
+    #endif
+}
 
-    if (src_len && !src) {
-        if (status) *status = PASU_E_INVALID;
-        return 0;
-    }
+static int pasu__z_block16(const pasu_uint16 *p)
+{
+    #if defined(PASU__Z_SIMD)
+    return PASU__PAGE_SAFE(p) &&
+           !_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(const void *)p), _mm_setzero_si128()));
+    #else
+    (void)p;
+    return 0;
+    #endif
+}
+#endif
 
-    while (i < src_len) {
-        pasu_codepoint cp;
-        pasu_size used16 = 0;
-        pasu_uint8 tmp[4];
-        pasu_size used8 = 0;
+/* Bytes of s before its terminator, up to max. */
+static pasu_size pasu__strnlen8(const pasu_uint8 *s, pasu_size max)
+{
+    pasu_size i = 0;
 
-        st = pasu_utf16_decode(src + i, src_len - i, &cp, &used16);
-        if (st != PASU_OK) {
-            if (status) *status = st;
-            return j;
+    while (i < max) {
+#if defined(PASU__Z_SIMD)
+        if (PASU__PAGE_SAFE(s + i) && max - i >= 16) {
+    #if defined(PASU__SSE2)
+            unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(const void *)(s + i)),
+                                                                    _mm_setzero_si128()));
+            if (m) return i + PASU__CTZ(m);
+            i += 16;
+            continue;
+    #else
+            if (vminvq_u8(vld1q_u8(s + i)) != 0) {
+                i += 16;
+                continue;
+            }
+    #endif
         }
-        i += used16;
+#endif
+        if (s[i] == 0) return i;
+        ++i;
+    }
+    return max;
+}
 
-        st = pasu_utf8_encode(cp, tmp, &used8);
+/* What pasu_utf8_decode / pasu_utf16_decode may look at from s[i] on (s[i] != 0). */
+static pasu_size pasu__rem8_z(const pasu_uint8 *s)
+{
+    pasu_size r = 1;
+    while (r < 4 && s[r]) ++r;
+    return r;
+}
+
+#define PASU__REM16_Z(s) ((s)[1] ? 2u : 1u)
+
+/* --- Counting --- */
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define PASU__POPCOUNT16(m) ((unsigned)__builtin_popcount(m))
+#elif defined(PASU__SSE2)
+static unsigned pasu__popcount16(unsigned m)
+{
+    m = m - ((m >> 1) & 0x5555u);
+    m = (m & 0x3333u) + ((m >> 2) & 0x3333u);
+    m = (m + (m >> 4)) & 0x0F0Fu;
+    return (m + (m >> 8)) & 0x1Fu;
+}
+    #define PASU__POPCOUNT16(m) pasu__popcount16(m)
+#endif
+
+/*
+    Characters in n bytes of well-formed UTF-8 (bytes that are not continuation
+    bytes), plus the 4-byte leads when with4 is set: the UTF-16 length.
+*/
+static pasu_size pasu__utf8_count(const pasu_uint8 *s, pasu_size n, int with4)
+{
+    pasu_size i = 0, count = 0;
+
+#if defined(PASU__SSE2)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65)));
+        count += PASU__POPCOUNT16(m);
+        if (with4) {
+            m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(v, _mm_set1_epi8(-17)), _mm_setzero_si128()));
+            count += 16 - PASU__POPCOUNT16(m);
+        }
+    }
+#elif defined(PASU__NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(s + i);
+        count += vaddvq_u8(vshrq_n_u8(vcgtq_s8(vreinterpretq_s8_u8(v), vdupq_n_s8(-65)), 7));
+        if (with4) count += vaddvq_u8(vshrq_n_u8(vcgeq_u8(v, vdupq_n_u8(0xF0)), 7));
+    }
+#endif
+    for (; i < n; ++i) {
+        count += (s[i] & 0xC0u) != 0x80u;
+        if (with4) count += s[i] >= 0xF0u;
+    }
+    return count;
+}
+
+/* --- Conversions and length helpers --- */
+
+static pasu_size pasu__utf8_to_utf16(const pasu_uint8 *src, pasu_size src_len, int z,
+                                     pasu_uint16 *dst, pasu_size dst_capacity,
+                                     pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
+        pasu_codepoint cp;
+        pasu_size used8 = 0;
+
+#if defined(PASU__SSSE3)
+        /* mixed text, short ASCII runs included */
+        if ((z ? pasu__z_block8(src + i) : src_len - i >= 16) && dst_capacity - j >= 16) {
+            __m128i lo, hi;
+            int n_lo, n_hi;
+            pasu_size n = pasu__utf8_block(src + i, &lo, &hi, &n_lo, &n_hi);
+            if (n) {
+                __m128i old = _mm_loadu_si128((const __m128i *)(const void *)(dst + j + n_lo));
+                _mm_storeu_si128((__m128i *)(void *)(dst + j), lo);   /* the second store covers the spare lanes */
+                pasu__store_n16(dst + j + n_lo, hi, n_hi, old);
+                i += n;
+                j += (pasu_size)(n_lo + n_hi);
+                continue;
+            }
+        }
+#endif
+
+        if (src[i] < 0x80u) {
+            /* ASCII run: widened as is */
+            pasu_size n = z ? pasu__ascii_prefix_z(src + i) : pasu__ascii_prefix(src + i, src_len - i);
+            int full = n > dst_capacity - j;
+            if (full) n = dst_capacity - j;
+            pasu__widen16(dst + j, src + i, n);
+            i += n;
+            j += n;
+            if (full) {
+                if (status) *status = PASU_E_NOSPACE;
+                break;
+            }
+            continue;
+        }
+
+        st = pasu_utf8_decode(src + i, z ? pasu__rem8_z(src + i) : src_len - i, &cp, &used8);
         if (st != PASU_OK) {
             if (status) *status = st;
-            return j;
+            break;
         }
 
-        if (j + used8 > dst_capacity) {
+        /* decoded scalars always encode: written in place, no staging */
+        if (j + (cp >= 0x10000u ? 2u : 1u) > dst_capacity) {
             if (status) *status = PASU_E_NOSPACE;
-            return j;
+            break;
+        }
+        i += used8;
+        if (cp >= 0x10000u) {
+            cp -= 0x10000u;
+            dst[j++] = (pasu_uint16)(0xD800u + (cp >> 10));
+            dst[j++] = (pasu_uint16)(0xDC00u + (cp & 0x3FFu));
+        } else {
+            dst[j++] = (pasu_uint16)cp;
         }
-
-        dst[j++] = tmp[0];
-        if (used8 > 1) dst[j++] = tmp[1];
-        if (used8 > 2) dst[j++] = tmp[2];
-        if (used8 > 3) dst[j++] = tmp[3];
     }
 
+    if (src_used) *src_used = i;
     return j;
 }
 
-PASUDEF pasu_size pasu_utf8_length(const pasu_uint8 *str, pasu_size len,
-                                   pasu_status *status)
+PASUDEF pasu_size pasu_utf8_to_utf16(const pasu_uint8 *src, pasu_size src_len,
+                                     pasu_uint16 *dst, pasu_size dst_capacity,
+                                     pasu_status *status)
 {
-    pasu_size pos = 0;
-    pasu_size count = 0;
-    pasu_status st = PASU_OK;
-
     if (status)
         *status = PASU_OK;
 
-    if (len && !str) {
+    if (src_len && !src) {
         if (status) *status = PASU_E_INVALID;
         return 0;
     }
 
-    while (pos < len) {
+    return pasu__utf8_to_utf16(src, src_len, 0, dst, dst_capacity, NULL, status);
+}
+
+static pasu_size pasu__utf16_to_utf8(const pasu_uint16 *src, pasu_size src_len, int z,
+                                     pasu_uint8 *dst, pasu_size dst_capacity,
+                                     pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
         pasu_codepoint cp;
-        pasu_size used = 0;
+        pasu_size used16 = 0;
+        pasu_size used8 = 0;
+
+        if (src[i] < 0x80u) {
+            pasu_size n = z ? pasu__ascii_prefix16_z(src + i) : pasu__ascii_prefix16(src + i, src_len - i);
+            int full = n > dst_capacity - j;
+            if (full) n = dst_capacity - j;
+            pasu__narrow16(dst + j, src + i, n);
+            i += n;
+            j += n;
+            if (full) {
+                if (status) *status = PASU_E_NOSPACE;
+                break;
+            }
+            continue;
+        }
+
+#if defined(PASU__SSSE3)
+        if ((z ? pasu__z_block16(src + i) : src_len - i >= 8) && dst_capacity - j >= 24) {
+            pasu_size n = pasu__utf16_block(src + i, dst + j);
+            if (n) {
+                i += 8;
+                j += n;
+                continue;
+            }
+        }
+#endif
 
-        st = pasu_utf8_decode(str + pos, len - pos, &cp, &used);
+        st = pasu_utf16_decode(src + i, z ? PASU__REM16_Z(src + i) : src_len - i, &cp, &used16);
         if (st != PASU_OK) {
             if (status) *status = st;
-            return count;
+            break;
         }
 
-        pos += used;
-        ++count;
+        /* decoded scalars always encode: written in place once they fit */
+        used8 = cp < 0x80u ? 1 : cp < 0x800u ? 2 : cp < 0x10000u ? 3 : 4;
+        if (j + used8 > dst_capacity) {
+            if (status) *status = PASU_E_NOSPACE;
+            break;
+        }
+        i += used16;
+        (void)pasu_utf8_encode(cp, dst + j, &used8);
+        j += used8;
     }
 
-    return count;
+    if (src_used) *src_used = i;
+    return j;
 }
 
-PASUDEF pasu_size pasu_utf16_length(const pasu_uint16 *str, pasu_size len,
-                                    pasu_status *status)
+PASUDEF pasu_size pasu_utf16_to_utf8(const pasu_uint16 *src, pasu_size src_len,
+                                     pasu_uint8 *dst, pasu_size dst_capacity,
+                                     pasu_status *status)
 {
-    pasu_size pos = 0;
-    pasu_size count = 0;
-    pasu_status st = PASU_OK;
+    if (status)
+        *status = PASU_OK;
 
+    if (src_len && !src) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    return pasu__utf16_to_utf8(src, src_len, 0, dst, dst_capacity, NULL, status);
+}
+
+PASUDEF pasu_size pasu_utf8_length(const pasu_uint8 *str, pasu_size len,
+                                   pasu_status *status)
+{
     if (status)
         *status = PASU_OK;
 
@@ -792,69 +1599,132 @@ PASUDEF pasu_size pasu_utf16_length(const pasu_uint16 *str, pasu_size len,
         return 0;
     }
 
-    while (pos < len) {
+    /* characters of the well-formed prefix: its lead and ASCII bytes */
+    return pasu__utf8_count(str, pasu_utf8_validate(str, len, status), 0);
+}
+
+/* Characters (to8 == 0) or UTF-8 bytes (to8 != 0) of the well-formed prefix of s. */
+static pasu_size pasu__utf16_count(const pasu_uint16 *s, pasu_size len, int to8, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size count = 0;
+    pasu_status st = PASU_OK;
+
+    while (i < len) {
         pasu_codepoint cp;
         pasu_size used = 0;
 
-        st = pasu_utf16_decode(str + pos, len - pos, &cp, &used);
+#if defined(PASU__SSE2)
+        if (len - i >= 8) {
+            /* no surrogates: one character per unit, 1..3 bytes each */
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i)), z = _mm_setzero_si128();
+            __m128i top = _mm_and_si128(v, _mm_set1_epi16(-2048));
+            if (!_mm_movemask_epi8(_mm_cmpeq_epi16(top, _mm_set1_epi16(-10240)))) {
+                count += 8;
+                if (to8) {
+                    unsigned m2 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-128)), z));
+                    unsigned m3 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(top, z));
+                    count += 16 - (PASU__POPCOUNT16(m2) + PASU__POPCOUNT16(m3)) / 2;
+                }
+                i += 8;
+                continue;
+            }
+        }
+#endif
+
+        st = pasu_utf16_decode(s + i, len - i, &cp, &used);
         if (st != PASU_OK) {
             if (status) *status = st;
             return count;
         }
 
-        pos += used;
-        ++count;
+        i += used;
+        count += !to8 ? 1 : cp < 0x80u ? 1 : cp < 0x800u ? 2 : cp < 0x10000u ? 3 : 4;
     }
 
     return count;
 }
 
-PASUDEF pasu_size pasu_utf8_to_utf32(const pasu_uint8 *src, pasu_size src_len,
-                                     pasu_codepoint *dst, pasu_size dst_capacity,
-                                     pasu_status *status)
+PASUDEF pasu_size pasu_utf16_length(const pasu_uint16 *str, pasu_size len,
+                                    pasu_status *status)
 {
-    pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
-
     if (status)
         *status = PASU_OK;
 
-    if (src_len && !src) {
+    if (len && !str) {
         if (status) *status = PASU_E_INVALID;
         return 0;
     }
 
-    while (i < src_len) {
+    return pasu__utf16_count(str, len, 0, status);
+}
+
+static pasu_size pasu__utf8_to_utf32(const pasu_uint8 *src, pasu_size src_len, int z,
+                                     pasu_codepoint *dst, pasu_size dst_capacity,
+                                     pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
         pasu_codepoint cp;
         pasu_size used8 = 0;
 
-        st = pasu_utf8_decode(src + i, src_len - i, &cp, &used8);
+#if defined(PASU__SSSE3)
+        /* mixed text, short ASCII runs included */
+        if ((z ? pasu__z_block8(src + i) : src_len - i >= 16) && dst_capacity - j >= 16) {
+            __m128i lo, hi;
+            int n_lo, n_hi;
+            pasu_size n = pasu__utf8_block(src + i, &lo, &hi, &n_lo, &n_hi);
+            if (n) {
+                __m128i old0 = _mm_loadu_si128((const __m128i *)(const void *)(dst + j + n_lo));
+                __m128i old1 = _mm_loadu_si128((const __m128i *)(const void *)(dst + j + n_lo + 4));
+                pasu__store32(dst + j, lo);   /* the second store covers the spare lanes */
+                pasu__store_n32(dst + j + n_lo, hi, n_hi, old0, old1);
+                i += n;
+                j += (pasu_size)(n_lo + n_hi);
+                continue;
+            }
+        }
+#endif
+
+        if (src[i] < 0x80u) {
+            pasu_size n = z ? pasu__ascii_prefix_z(src + i) : pasu__ascii_prefix(src + i, src_len - i);
+            int full = n > dst_capacity - j;
+            if (full) n = dst_capacity - j;
+            pasu__widen32(dst + j, src + i, n);
+            i += n;
+            j += n;
+            if (full) {
+                if (status) *status = PASU_E_NOSPACE;
+                break;
+            }
+            continue;
+        }
+
+        st = pasu_utf8_decode(src + i, z ? pasu__rem8_z(src + i) : src_len - i, &cp, &used8);
         if (st != PASU_OK) {
             if (status) *status = st;
-            return j;
+            break;
         }
-        i += used8;
 
         if (j >= dst_capacity) {
             if (status) *status = PASU_E_NOSPACE;
-            return j;
+            break;
         }
-
+        i += used8;
         dst[j++] = cp;
     }
 
+    if (src_used) *src_used = i;
     return j;
 }
 
-PASUDEF pasu_size pasu_utf32_to_utf8(const pasu_codepoint *src, pasu_size src_len,
-                                     pasu_uint8 *dst, pasu_size dst_capacity,
+PASUDEF pasu_size pasu_utf8_to_utf32(const pasu_uint8 *src, pasu_size src_len,
+                                     pasu_codepoint *dst, pasu_size dst_capacity,
                                      pasu_status *status)
 {
-    pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
-
     if (status)
         *status = PASU_OK;
 
@@ -863,11 +1733,37 @@ PASUDEF pasu_size pasu_utf32_to_utf8(const pasu_codepoint *src, pasu_size src_le
         return 0;
     }
 
-    while (i < src_len) {
-        pasu_codepoint cp = src[i++];
+    return pasu__utf8_to_utf32(src, src_len, 0, dst, dst_capacity, NULL, status);
+}
+
+static pasu_size pasu__utf32_to_utf8(const pasu_codepoint *src, pasu_size src_len, int z,
+                                     pasu_uint8 *dst, pasu_size dst_capacity,
+                                     pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
+        pasu_codepoint cp;
         pasu_uint8 tmp[4];
         pasu_size used8 = 0;
 
+        if (src[i] < 0x80u) {
+            pasu_size n = z ? pasu__ascii_prefix32_z(src + i) : pasu__ascii_prefix32(src + i, src_len - i);
+            int full = n > dst_capacity - j;
+            if (full) n = dst_capacity - j;
+            pasu__narrow32(dst + j, src + i, n);
+            i += n;
+            j += n;
+            if (full) {
+                if (status) *status = PASU_E_NOSPACE;
+                return j;
+            }
+            continue;
+        }
+
+        cp = src[i++];
         st = pasu_utf8_encode(cp, tmp, &used8);
         if (st != PASU_OK) {
             if (status) *status = st;
@@ -888,14 +1784,10 @@ PASUDEF pasu_size pasu_utf32_to_utf8(const pasu_codepoint *src, pasu_size src_le
     return j;
 }
 
-PASUDEF pasu_size pasu_utf16_to_utf32(const pasu_uint16 *src, pasu_size src_len,
-                                      pasu_codepoint *dst, pasu_size dst_capacity,
-                                      pasu_status *status)
+PASUDEF pasu_size pasu_utf32_to_utf8(const pasu_codepoint *src, pasu_size src_len,
+                                     pasu_uint8 *dst, pasu_size dst_capacity,
+                                     pasu_status *status)
 {
-    pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
-
     if (status)
         *status = PASU_OK;
 
@@ -904,36 +1796,43 @@ PASUDEF pasu_size pasu_utf16_to_utf32(const pasu_uint16 *src, pasu_size src_len,
         return 0;
     }
 
-    while (i < src_len) {
+    return pasu__utf32_to_utf8(src, src_len, 0, dst, dst_capacity, status);
+}
+
+static pasu_size pasu__utf16_to_utf32(const pasu_uint16 *src, pasu_size src_len, int z,
+                                      pasu_codepoint *dst, pasu_size dst_capacity,
+                                      pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
         pasu_codepoint cp;
         pasu_size used16 = 0;
 
-        st = pasu_utf16_decode(src + i, src_len - i, &cp, &used16);
+        st = pasu_utf16_decode(src + i, z ? PASU__REM16_Z(src + i) : src_len - i, &cp, &used16);
         if (st != PASU_OK) {
             if (status) *status = st;
-            return j;
+            break;
         }
-        i += used16;
 
         if (j >= dst_capacity) {
             if (status) *status = PASU_E_NOSPACE;
-            return j;
+            break;
         }
-
+        i += used16;
         dst[j++] = cp;
     }
 
+    if (src_used) *src_used = i;
     return j;
 }
 
-PASUDEF pasu_size pasu_utf32_to_utf16(const pasu_codepoint *src, pasu_size src_len,
-                                      pasu_uint16 *dst, pasu_size dst_capacity,
+PASUDEF pasu_size pasu_utf16_to_utf32(const pasu_uint16 *src, pasu_size src_len,
+                                      pasu_codepoint *dst, pasu_size dst_capacity,
                                       pasu_status *status)
 {
-    pasu_size i = 0;
-    pasu_size j = 0;
-    pasu_status st = PASU_OK;
-
     if (status)
         *status = PASU_OK;
 
@@ -942,7 +1841,18 @@ PASUDEF pasu_size pasu_utf32_to_utf16(const pasu_codepoint *src, pasu_size src_l
         return 0;
     }
 
-    while (i < src_len) {
+    return pasu__utf16_to_utf32(src, src_len, 0, dst, dst_capacity, NULL, status);
+}
+
+static pasu_size pasu__utf32_to_utf16(const pasu_codepoint *src, pasu_size src_len, int z,
+                                      pasu_uint16 *dst, pasu_size dst_capacity,
+                                      pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_status st = PASU_OK;
+
+    while (z ? src[i] != 0 : i < src_len) {
         pasu_codepoint cp = src[i++];
         pasu_uint16 tmp[2];
         pasu_size used16 = 0;
@@ -966,6 +1876,27 @@ PASUDEF pasu_size pasu_utf32_to_utf16(const pasu_codepoint *src, pasu_size src_l
     return j;
 }
 
+PASUDEF pasu_size pasu_utf32_to_utf16(const pasu_codepoint *src, pasu_size src_len,
+                                      pasu_uint16 *dst, pasu_size dst_capacity,
+                                      pasu_status *status)
+{
+    if (status)
+        *status = PASU_OK;
+
+    if (src_len && !src) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    return pasu__utf32_to_utf16(src, src_len, 0, dst, dst_capacity, status);
+}
+
+/* Status of a UTF-32 value pasu_is_valid_scalar refuses. */
+static pasu_status pasu__utf32_error(pasu_codepoint cp)
+{
+    return (cp >= 0xD800u && cp <= 0xDFFFu) ? PASU_E_SURROG : PASU_E_RANGE;
+}
+
 PASUDEF pasu_size pasu_utf32_length(const pasu_codepoint *str, pasu_size len,
                                     pasu_status *status)
 {
@@ -983,14 +1914,7 @@ PASUDEF pasu_size pasu_utf32_length(const pasu_codepoint *str, pasu_size len,
         pasu_codepoint cp = str[i];
 
         if (!pasu_is_valid_scalar(cp)) {
-            if (status) {
-                if (cp > 0x10FFFFu)
-                    *status = PASU_E_RANGE;
-                else if (cp >= 0xD800u && cp <= 0xDFFFu)
-                    *status = PASU_E_SURROG;
-                else
-                    *status = PASU_E_RANGE;
-            }
+            if (status) *status = pasu__utf32_error(cp);
             return i;
         }
 
@@ -1000,13 +1924,391 @@ PASUDEF pasu_size pasu_utf32_length(const pasu_codepoint *str, pasu_size len,
     return len;
 }
 
+/* --- Output sizes --- */
+
+PASUDEF pasu_size pasu_utf8_to_utf16_size(const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_status *status)
+{
+    if (status)
+        *status = PASU_OK;
+
+    if (src_len && !src) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    /* one unit per character, two for the 4-byte ones */
+    return pasu__utf8_count(src, pasu_utf8_validate(src, src_len, status), 1);
+}
+
+PASUDEF pasu_size pasu_utf8_to_utf32_size(const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_status *status)
+{
+    return pasu_utf8_length(src, src_len, status);
+}
+
+PASUDEF pasu_size pasu_utf16_to_utf8_size(const pasu_uint16 *src, pasu_size src_len,
+                                          pasu_status *status)
+{
+    if (status)
+        *status = PASU_OK;
+
+    if (src_len && !src) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    return pasu__utf16_count(src, src_len, 1, status);
+}
+
+PASUDEF pasu_size pasu_utf16_to_utf32_size(const pasu_uint16 *src, pasu_size src_len,
+                                           pasu_status *status)
+{
+    return pasu_utf16_length(src, src_len, status);
+}
+
+/* UTF-8 bytes (to8 != 0) or UTF-16 units of the valid prefix of s. */
+static pasu_size pasu__utf32_count(const pasu_codepoint *s, pasu_size len, int to8, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size count = 0;
+
+    if (status)
+        *status = PASU_OK;
+
+    if (len && !s) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    while (i < len) {
+        pasu_codepoint cp;
+
+#if defined(PASU__SSE2)
+        if (len - i >= 4) {
+            /* four scalars: 1 + (>= 0x80) + (>= 0x800) + (>= 0x10000) bytes, 1 + (>= 0x10000) units */
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+            __m128i bad = _mm_or_si128(
+                _mm_cmpgt_epi32(_mm_xor_si128(v, _mm_set1_epi32((int)0x80000000u)), _mm_set1_epi32((int)0x8010FFFFu)),
+                _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(-2048)), _mm_set1_epi32(0xD800)));
+            if (!_mm_movemask_epi8(bad)) {
+                __m128i n = _mm_cmpgt_epi32(v, _mm_set1_epi32(0xFFFF));
+                if (to8)
+                    n = _mm_add_epi32(_mm_add_epi32(n, _mm_cmpgt_epi32(v, _mm_set1_epi32(0x7F))),
+                                      _mm_cmpgt_epi32(v, _mm_set1_epi32(0x7FF)));
+                n = _mm_add_epi32(n, _mm_shuffle_epi32(n, 0x4E));
+                n = _mm_add_epi32(n, _mm_shuffle_epi32(n, 0xB1));
+                count += 4 + (pasu_size)-_mm_cvtsi128_si32(n);
+                i += 4;
+                continue;
+            }
+        }
+#endif
+
+        cp = s[i++];
+        if (!pasu_is_valid_scalar(cp)) {
+            if (status) *status = pasu__utf32_error(cp);
+            return count;
+        }
+        count += cp < 0x80u ? 1 : !to8 ? (cp < 0x10000u ? 1 : 2) : cp < 0x800u ? 2 : cp < 0x10000u ? 3 : 4;
+    }
+
+    return count;
+}
+
+PASUDEF pasu_size pasu_utf32_to_utf8_size(const pasu_codepoint *src, pasu_size src_len,
+                                          pasu_status *status)
+{
+    return pasu__utf32_count(src, src_len, 1, status);
+}
+
+PASUDEF pasu_size pasu_utf32_to_utf16_size(const pasu_codepoint *src, pasu_size src_len,
+                                           pasu_status *status)
+{
+    return pasu__utf32_count(src, src_len, 0, status);
+}
+
+/* --- Streaming --- */
+
+/*
+    Completes the UTF-8 sequence held in d with the first bytes of src
+    (*take of them). PASU_E_TRUNC when src runs out first: src is then held
+    in d as well.
+*/
+static pasu_status pasu__utf8_resume(pasu_decoder *d, const pasu_uint8 *src, pasu_size src_len,
+                                     pasu_codepoint *cp, pasu_size *take)
+{
+    pasu_uint8 seq[4];
+    pasu_size n = d->pending;
+    pasu_size need = d->bytes[0] >= 0xF0u ? 4 : d->bytes[0] >= 0xE0u ? 3 : 2;
+    pasu_size k, used = 0;
+    pasu_status st;
+
+    *take = need - n < src_len ? need - n : src_len;
+    for (k = 0; k < n; ++k) seq[k] = d->bytes[k];
+    for (k = 0; k < *take; ++k) seq[n + k] = src[k];
+
+    st = pasu_utf8_decode(seq, n + *take, cp, &used);
+    if (st == PASU_E_TRUNC) {
+        for (k = 0; k < *take; ++k) d->bytes[n + k] = src[k];
+        d->pending = (pasu_uint8)(n + *take);
+    }
+    return st;
+}
+
+/* Holds the cut-off tail of a chunk (at most 3 bytes, the conversion said PASU_E_TRUNC). */
+static void pasu__utf8_hold(pasu_decoder *d, const pasu_uint8 *s, pasu_size n)
+{
+    pasu_size k;
+    for (k = 0; k < n; ++k) d->bytes[k] = s[k];
+    d->pending = (pasu_uint8)n;
+}
+
+/* Pairs the high surrogate held in d with src[0]. */
+static pasu_status pasu__utf16_resume(pasu_decoder *d, const pasu_uint16 *src, pasu_size src_len,
+                                      pasu_codepoint *cp, pasu_size *take)
+{
+    pasu_uint16 pair[2];
+    pasu_size used = 0;
+
+    *take = 0;
+    if (src_len == 0)
+        return PASU_E_TRUNC;
+
+    pair[0] = d->unit;
+    pair[1] = src[0];
+    *take = 1;
+    return pasu_utf16_decode(pair, 2, cp, &used);
+}
+
+PASUDEF pasu_size pasu_utf8_to_utf16_feed(pasu_decoder *d, const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_uint16 *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_size used = 0;
+    pasu_codepoint cp;
+    pasu_status st = PASU_OK;
+
+    if (status)
+        *status = PASU_OK;
+    if (src_used)
+        *src_used = 0;
+
+    if (!d || (src_len && !src)) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    if (d->pending) {
+        st = pasu__utf8_resume(d, src, src_len, &cp, &i);
+        if (st == PASU_E_TRUNC) {
+            if (src_used) *src_used = src_len;
+            return 0;
+        }
+        if (st == PASU_OK && dst_capacity < (cp >= 0x10000u ? 2u : 1u))
+            st = PASU_E_NOSPACE;
+        if (st != PASU_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+        if (cp >= 0x10000u) {
+            cp -= 0x10000u;
+            dst[j++] = (pasu_uint16)(0xD800u + (cp >> 10));
+            dst[j++] = (pasu_uint16)(0xDC00u + (cp & 0x3FFu));
+        } else {
+            dst[j++] = (pasu_uint16)cp;
+        }
+        d->pending = 0;
+    }
+
+    if (i < src_len) {
+        j += pasu__utf8_to_utf16(src + i, src_len - i, 0, dst + j, dst_capacity - j, &used, &st);
+        i += used;
+        if (st == PASU_E_TRUNC) {
+            pasu__utf8_hold(d, src + i, src_len - i);
+            i = src_len;
+            st = PASU_OK;
+        }
+    }
+
+    if (src_used) *src_used = i;
+    if (status) *status = st;
+    return j;
+}
+
+PASUDEF pasu_size pasu_utf8_to_utf32_feed(pasu_decoder *d, const pasu_uint8 *src, pasu_size src_len,
+                                          pasu_codepoint *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_size used = 0;
+    pasu_codepoint cp;
+    pasu_status st = PASU_OK;
+
+    if (status)
+        *status = PASU_OK;
+    if (src_used)
+        *src_used = 0;
+
+    if (!d || (src_len && !src)) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    if (d->pending) {
+        st = pasu__utf8_resume(d, src, src_len, &cp, &i);
+        if (st == PASU_E_TRUNC) {
+            if (src_used) *src_used = src_len;
+            return 0;
+        }
+        if (st == PASU_OK && dst_capacity == 0)
+            st = PASU_E_NOSPACE;
+        if (st != PASU_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+        dst[j++] = cp;
+        d->pending = 0;
+    }
+
+    if (i < src_len) {
+        j += pasu__utf8_to_utf32(src + i, src_len - i, 0, dst + j, dst_capacity - j, &used, &st);
+        i += used;
+        if (st == PASU_E_TRUNC) {
+            pasu__utf8_hold(d, src + i, src_len - i);
+            i = src_len;
+            st = PASU_OK;
+        }
+    }
+
+    if (src_used) *src_used = i;
+    if (status) *status = st;
+    return j;
+}
+
+PASUDEF pasu_size pasu_utf16_to_utf8_feed(pasu_decoder *d, const pasu_uint16 *src, pasu_size src_len,
+                                          pasu_uint8 *dst, pasu_size dst_capacity,
+                                          pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_size used = 0;
+    pasu_codepoint cp;
+    pasu_status st = PASU_OK;
+
+    if (status)
+        *status = PASU_OK;
+    if (src_used)
+        *src_used = 0;
+
+    if (!d || (src_len && !src)) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    if (d->pending) {
+        st = pasu__utf16_resume(d, src, src_len, &cp, &i);
+        if (st == PASU_E_TRUNC)
+            return 0;
+        if (st == PASU_OK && dst_capacity < 4)   /* a pair is always 4 bytes */
+            st = PASU_E_NOSPACE;
+        if (st != PASU_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+        (void)pasu_utf8_encode(cp, dst, &j);
+        d->pending = 0;
+    }
+
+    if (i < src_len) {
+        j += pasu__utf16_to_utf8(src + i, src_len - i, 0, dst + j, dst_capacity - j, &used, &st);
+        i += used;
+        if (st == PASU_E_TRUNC) {
+            d->unit = src[i];
+            d->pending = 1;
+            i = src_len;
+            st = PASU_OK;
+        }
+    }
+
+    if (src_used) *src_used = i;
+    if (status) *status = st;
+    return j;
+}
+
+PASUDEF pasu_size pasu_utf16_to_utf32_feed(pasu_decoder *d, const pasu_uint16 *src, pasu_size src_len,
+                                           pasu_codepoint *dst, pasu_size dst_capacity,
+                                           pasu_size *src_used, pasu_status *status)
+{
+    pasu_size i = 0;
+    pasu_size j = 0;
+    pasu_size used = 0;
+    pasu_codepoint cp;
+    pasu_status st = PASU_OK;
+
+    if (status)
+        *status = PASU_OK;
+    if (src_used)
+        *src_used = 0;
+
+    if (!d || (src_len && !src)) {
+        if (status) *status = PASU_E_INVALID;
+        return 0;
+    }
+
+    if (d->pending) {
+        st = pasu__utf16_resume(d, src, src_len, &cp, &i);
+        if (st == PASU_E_TRUNC)
+            return 0;
+        if (st == PASU_OK && dst_capacity == 0)
+            st = PASU_E_NOSPACE;
+        if (st != PASU_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+        dst[j++] = cp;
+        d->pending = 0;
+    }
+
+    if (i < src_len) {
+        j += pasu__utf16_to_utf32(src + i, src_len - i, 0, dst + j, dst_capacity - j, &used, &st);
+        i += used;
+        if (st == PASU_E_TRUNC) {
+            d->unit = src[i];
+            d->pending = 1;
+            i = src_len;
+            st = PASU_OK;
+        }
+    }
+
+    if (src_used) *src_used = i;
+    if (status) *status = st;
+    return j;
+}
+
+PASUDEF pasu_status pasu_decoder_finish(pasu_decoder *d)
+{
+    pasu_status st = PASU_OK;
+
+    if (!d)
+        return PASU_E_INVALID;
+
+    if (d->pending)
+        st = PASU_E_TRUNC;   /* what the buffer conversions report for a cut-off tail */
+
+    d->pending = 0;
+    return st;
+}
+
 /* --- C-string helpers (UTF-8 / UTF-16) --- */
 
 PASUDEF pasu_size pasu_utf8_to_utf16_cstr(const pasu_uint8 *src,
                                           pasu_uint16 *dst, pasu_size dst_capacity,
                                           pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1024,11 +2326,7 @@ PASUDEF pasu_size pasu_utf8_to_utf16_cstr(const pasu_uint8 *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1039,9 +2337,9 @@ PASUDEF pasu_size pasu_utf8_to_utf16_cstr(const pasu_uint8 *src,
         return 0;
     }
 
-    written = pasu_utf8_to_utf16(src, src_len,
-                                 dst, dst_capacity - 1,
-                                 &st);
+    written = pasu__utf8_to_utf16(src, 0, 1,
+                                  dst, dst_capacity - 1,
+                                  NULL, &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1058,7 +2356,6 @@ PASUDEF pasu_size pasu_utf16_to_utf8_cstr(const pasu_uint16 *src,
                                           pasu_uint8 *dst, pasu_size dst_capacity,
                                           pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1076,11 +2373,7 @@ PASUDEF pasu_size pasu_utf16_to_utf8_cstr(const pasu_uint16 *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1091,9 +2384,9 @@ PASUDEF pasu_size pasu_utf16_to_utf8_cstr(const pasu_uint16 *src,
         return 0;
     }
 
-    written = pasu_utf16_to_utf8(src, src_len,
-                                 dst, dst_capacity - 1,
-                                 &st);
+    written = pasu__utf16_to_utf8(src, 0, 1,
+                                  dst, dst_capacity - 1,
+                                  NULL, &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1109,7 +2402,9 @@ PASUDEF pasu_size pasu_utf16_to_utf8_cstr(const pasu_uint16 *src,
 PASUDEF pasu_size pasu_utf8_length_cstr(const pasu_uint8 *src,
                                         pasu_status *status)
 {
-    pasu_size len = 0;
+    pasu_size pos = 0;
+    pasu_size count = 0;
+    pasu_status st = PASU_OK;
 
     if (status)
         *status = PASU_OK;
@@ -1119,11 +2414,19 @@ PASUDEF pasu_size pasu_utf8_length_cstr(const pasu_uint8 *src,
         return 0;
     }
 
-    while (src[len] != 0) {
-        ++len;
+    /* validated and counted a chunk at a time, while it is in cache */
+    for (;;) {
+        pasu_size n = pasu__strnlen8(src + pos, 256);
+        pasu_size valid = pasu_utf8_validate(src + pos, n, &st);
+
+        count += pasu__utf8_count(src + pos, valid, 0);
+        pos += valid;
+        if (n < 256 || (st != PASU_OK && st != PASU_E_TRUNC)) break;
+        /* OK, or a sequence cut by the chunk end: go on from there */
     }
 
-    return pasu_utf8_length(src, len, status);
+    if (status) *status = st;
+    return count;
 }
 
 /* --- C-string helpers for UTF-32 --- */
@@ -1132,7 +2435,6 @@ PASUDEF pasu_size pasu_utf8_to_utf32_cstr(const pasu_uint8 *src,
                                            pasu_codepoint *dst, pasu_size dst_capacity,
                                            pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1150,11 +2452,7 @@ PASUDEF pasu_size pasu_utf8_to_utf32_cstr(const pasu_uint8 *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1165,9 +2463,9 @@ PASUDEF pasu_size pasu_utf8_to_utf32_cstr(const pasu_uint8 *src,
         return 0;
     }
 
-    written = pasu_utf8_to_utf32(src, src_len,
-                                 dst, dst_capacity - 1,
-                                 &st);
+    written = pasu__utf8_to_utf32(src, 0, 1,
+                                  dst, dst_capacity - 1,
+                                  NULL, &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1184,7 +2482,6 @@ PASUDEF pasu_size pasu_utf32_to_utf8_cstr(const pasu_codepoint *src,
                                           pasu_uint8 *dst, pasu_size dst_capacity,
                                           pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1202,11 +2499,7 @@ PASUDEF pasu_size pasu_utf32_to_utf8_cstr(const pasu_codepoint *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1217,9 +2510,9 @@ PASUDEF pasu_size pasu_utf32_to_utf8_cstr(const pasu_codepoint *src,
         return 0;
     }
 
-    written = pasu_utf32_to_utf8(src, src_len,
-                                 dst, dst_capacity - 1,
-                                 &st);
+    written = pasu__utf32_to_utf8(src, 0, 1,
+                                  dst, dst_capacity - 1,
+                                  &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1236,7 +2529,6 @@ PASUDEF pasu_size pasu_utf16_to_utf32_cstr(const pasu_uint16 *src,
                                            pasu_codepoint *dst, pasu_size dst_capacity,
                                            pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1254,11 +2546,7 @@ PASUDEF pasu_size pasu_utf16_to_utf32_cstr(const pasu_uint16 *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1269,9 +2557,9 @@ PASUDEF pasu_size pasu_utf16_to_utf32_cstr(const pasu_uint16 *src,
         return 0;
     }
 
-    written = pasu_utf16_to_utf32(src, src_len,
-                                 dst, dst_capacity - 1,
-                                 &st);
+    written = pasu__utf16_to_utf32(src, 0, 1,
+                                   dst, dst_capacity - 1,
+                                   NULL, &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1288,7 +2576,6 @@ PASUDEF pasu_size pasu_utf32_to_utf16_cstr(const pasu_codepoint *src,
                                            pasu_uint16 *dst, pasu_size dst_capacity,
                                            pasu_status *status)
 {
-    pasu_size src_len = 0;
     pasu_size written = 0;
     pasu_status st = PASU_OK;
 
@@ -1306,11 +2593,7 @@ PASUDEF pasu_size pasu_utf32_to_utf16_cstr(const pasu_codepoint *src,
         return 0;
     }
 
-    while (src[src_len] != 0) {
-        ++src_len;
-    }
-
-    if (src_len == 0) {
+    if (src[0] == 0) {
         dst[0] = 0;
         return 0;
     }
@@ -1321,9 +2604,9 @@ PASUDEF pasu_size pasu_utf32_to_utf16_cstr(const pasu_codepoint *src,
         return 0;
     }
 
-    written = pasu_utf32_to_utf16(src, src_len,
-                                  dst, dst_capacity - 1,
-                                  &st);
+    written = pasu__utf32_to_utf16(src, 0, 1,
+                                   dst, dst_capacity - 1,
+                                   &st);
 
     if (written >= dst_capacity)
         written = dst_capacity - 1;
@@ -1339,7 +2622,7 @@ PASUDEF pasu_size pasu_utf32_to_utf16_cstr(const pasu_codepoint *src,
 PASUDEF pasu_size pasu_utf32_length_cstr(const pasu_codepoint *src,
                                          pasu_status *status)
 {
-    pasu_size len = 0;
+    pasu_size i = 0;
 
     if (status)
         *status = PASU_OK;
@@ -1349,11 +2632,14 @@ PASUDEF pasu_size pasu_utf32_length_cstr(const pasu_codepoint *src,
         return 0;
     }
 
-    while (src[len] != 0) {
-        ++len;
+    for (; src[i] != 0; ++i) {
+        if (!pasu_is_valid_scalar(src[i])) {
+            if (status) *status = pasu__utf32_error(src[i]);
+            return i;
+        }
     }
 
-    return pasu_utf32_length(src, len, status);
+    return i;
 }
 
 #if defined(PASU_USE_C11_TYPES)
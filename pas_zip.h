@@ -2,9 +2,9 @@
     pas_zip.h - single-header ZIP reader/writer (stb-style)
 
     - No malloc: all APIs use user-provided buffers
-    - Read ZIP from memory: Central Directory parsing
+    - Read ZIP from memory: Central Directory parsing, ZIP64
     - Extract: Store (always), Deflate (optional via PAS_ZIP_USE_MINIZ or PAS_ZIP_USE_ZLIB)
-    - Write ZIP: Store only (optional)
+    - Write ZIP: Store in one call, or streamed to a sink with Store/Deflate and CRC-32
     - UTF-8 filenames: optional via pas_unicode.h
 
     Usage:
@@ -30,6 +30,18 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* The streaming state embeds the backend's stream struct, so the backend
+   header is needed by every translation unit, not only the implementation. */
+#if defined(PAS_ZIP_USE_MINIZ)
+#include "miniz.h"
+#elif defined(PAS_ZIP_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(PAS_ZIP_USE_MINIZ) || defined(PAS_ZIP_USE_ZLIB)
+#define PAS_ZIP_HAS_INFLATE 1
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +52,7 @@ extern "C" {
 #define PAS_ZIP_E_COMPRESSED -3  /* deflate needed */
 #define PAS_ZIP_E_NOSPACE   -4
 #define PAS_ZIP_E_ZLIB      -5
+#define PAS_ZIP_E_WRITE     -6  /* sink accepted fewer bytes than given */
 
 #define PAS_ZIP_METHOD_STORE  0
 #define PAS_ZIP_METHOD_DEFLATE 8
@@ -52,32 +65,222 @@ typedef struct pas_zip_file pas_zip_file_t;
 struct pas_zip {
     const uint8_t *data;
     size_t         size;
-    uint32_t       cd_offset;
-    uint16_t       num_entries;
+    uint64_t       cd_offset;
+    uint64_t       num_entries;  /* from the ZIP64 end record when present */
+    const uint32_t *index;       /* optional name index, see pas_zip_index_build */
+    uint32_t        index_mask;  /* index slot count - 1 */
 };
 
 struct pas_zip_file {
-    const char *name;
-    size_t      compressed_size;
-    size_t      uncompressed_size;
-    uint16_t    compression_method;
-    uint32_t    local_header_offset;
+    const char      *name;
+    size_t           compressed_size;
+    size_t           uncompressed_size;
+    uint16_t         compression_method;
+    uint32_t         crc;         /* CRC-32 of the uncompressed data */
+    uint64_t         local_header_offset;
+    uint16_t         name_len;    /* bytes in name, excluding any NUL */
+    const pas_zip_t *zip;         /* archive the entry belongs to */
 };
 
-/* Open ZIP from memory. data/size must remain valid. */
+/* Open ZIP from memory. data/size must remain valid.
+   Returns a pointer to static storage: one archive at a time, not thread-safe.
+   Prefer pas_zip_init for new code. */
 pas_zip_t *pas_zip_open(const void *data, size_t size, pas_zip_status *status);
 
-/* Find file by name (case-sensitive). Returns NULL if not found. */
+/* Find file by name (case-sensitive). Returns NULL if not found.
+   Result and its name live in static storage, overwritten by the next call. */
 pas_zip_file_t *pas_zip_find(pas_zip_t *zip, const char *name);
 
+/* Reentrant API: the caller owns all pas_zip_t / pas_zip_file_t storage.
+   Any number of archives may be open, and threads may search and extract
+   concurrently as long as each uses its own pas_zip_file_t.
+   Entry names point into the archive data and are NOT null-terminated;
+   use pas_zip_name_len() for their length. */
+pas_zip_status pas_zip_init(pas_zip_t *zip, const void *data, size_t size);
+pas_zip_status pas_zip_find_file(const pas_zip_t *zip, const char *name, pas_zip_file_t *out);
+
+/* Optional name index for O(1) lookup, built once into caller memory (no malloc).
+   pas_zip_index_size returns the bytes needed for zip. mem must be 4-byte aligned
+   and stay valid while zip is in use; pas_zip_find / pas_zip_find_file then do a
+   hash probe instead of walking the central directory. Re-opening clears the index. */
+size_t         pas_zip_index_size(const pas_zip_t *zip);
+pas_zip_status pas_zip_index_build(pas_zip_t *zip, void *mem, size_t mem_size);
+
 /* File info */
 const char *pas_zip_name(pas_zip_file_t *file);
+size_t      pas_zip_name_len(const pas_zip_file_t *file);
 size_t      pas_zip_size(pas_zip_file_t *file);
 int         pas_zip_is_compressed(pas_zip_file_t *file);
 
 /* Extract file to buffer. Returns bytes written or 0 on error. */
 size_t pas_zip_extract(pas_zip_file_t *file, void *buffer, size_t buffer_size, pas_zip_status *status);
 
+/* Zero-copy access to a Store entry: returns a pointer into the archive data
+   (valid as long as the archive is) and sets *size to the entry size.
+   Returns NULL with PAS_ZIP_E_COMPRESSED for Deflate entries. */
+const void *pas_zip_view(const pas_zip_file_t *file, size_t *size, pas_zip_status *status);
+
+/* --- Streaming inflate ---
+
+   pas_zip_inflater_t is a thin wrapper over the miniz/zlib stream. All backend
+   memory comes from the caller's work area (PAS_ZIP_INFLATE_WORK_SIZE bytes is
+   always enough); pass work = NULL to let the backend use its own allocator.
+   Without PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB, init returns PAS_ZIP_E_COMPRESSED. */
+
+#define PAS_ZIP_INFLATE_WORK_SIZE (64u * 1024u)
+
+#define PAS_ZIP_INFLATE_RAW   0   /* raw deflate, as stored in ZIP entries */
+#define PAS_ZIP_INFLATE_ZLIB  1   /* zlib-wrapped (RFC 1950) */
+#define PAS_ZIP_INFLATE_AUTO  2   /* zlib if the first two bytes are a zlib header, else raw */
+#define PAS_ZIP_INFLATE_GZIP  3   /* gzip member (RFC 1952); CRC-32 and length are checked */
+
+/* bump allocator over a caller work area; backend frees are no-ops */
+typedef struct pas_zip__arena {
+    unsigned char *base;
+    size_t         size;
+    size_t         used;
+} pas_zip__arena;
+
+typedef struct pas_zip_inflater {
+#if defined(PAS_ZIP_USE_MINIZ)
+    mz_stream      strm;
+#elif defined(PAS_ZIP_USE_ZLIB)
+    z_stream       strm;
+#endif
+    pas_zip__arena arena;
+    int            format;
+    int            started;   /* backend stream initialised */
+    int            done;      /* end of deflate stream reached */
+    /* gzip wrapper */
+    int            gz_state;
+    unsigned       gz_flags;
+    unsigned       gz_have;   /* bytes collected in gz_buf */
+    unsigned       gz_skip;   /* FEXTRA bytes left */
+    uint32_t       gz_crc;
+    uint32_t       gz_size;   /* uncompressed length mod 2^32 */
+    unsigned char  gz_buf[10];
+} pas_zip_inflater_t;
+
+pas_zip_status pas_zip_inflate_init(pas_zip_inflater_t *inf, int format, void *work, size_t work_size);
+
+/* Inflates from in/in_len into out/out_cap. *in_used receives the input bytes
+   consumed; returns the bytes written. *done is set once the stream ends.
+   Call again with the remaining input and/or more output space until done. */
+size_t pas_zip_inflate(pas_zip_inflater_t *inf, const void *in, size_t in_len, size_t *in_used,
+                       void *out, size_t out_cap, int *done, pas_zip_status *status);
+
+void pas_zip_inflate_end(pas_zip_inflater_t *inf);
+
+/* --- Incremental entry reader ---
+
+   Reads a Store or Deflate entry in caller-sized chunks, so entries of any size
+   can be processed with a small buffer. work/work_size is only used for Deflate
+   entries (see PAS_ZIP_INFLATE_WORK_SIZE). */
+
+typedef struct pas_zip_reader {
+    pas_zip_file_t      file;
+    const uint8_t      *src;        /* remaining compressed payload */
+    size_t              src_left;
+    size_t              produced;   /* uncompressed bytes returned so far */
+    int                 done;
+    pas_zip_inflater_t  inf;
+} pas_zip_reader_t;
+
+pas_zip_status pas_zip_reader_open(pas_zip_reader_t *r, const pas_zip_file_t *file,
+                                   void *work, size_t work_size);
+
+/* Returns bytes written to buf (at most buf_size); 0 with PAS_ZIP_OK at end of entry. */
+size_t pas_zip_reader_read(pas_zip_reader_t *r, void *buf, size_t buf_size, pas_zip_status *status);
+
+void pas_zip_reader_close(pas_zip_reader_t *r);
+
+/* --- Ranged reads ---
+
+   pas_zip_read_at copies bytes [offset, offset + size) of an entry into buf and
+   returns how many it copied (fewer at the end of the entry). Store entries are
+   sliced directly. Deflate entries are inflated from the start, unless an access
+   index built once with pas_zip_access_build is passed: decoding then resumes at
+   the nearest access point, so a read costs at most one span of inflate.
+   Each point keeps a 32 KiB window; pas_zip_access_size(file, span) gives the
+   memory needed (8-byte aligned, kept alive by the caller). Access points need zlib (PAS_ZIP_USE_ZLIB); elsewhere build
+   returns PAS_ZIP_E_COMPRESSED and reads fall back to inflating from the start.
+   work/work_size as for the inflater (one per concurrent read). */
+
+#define PAS_ZIP_WINDOW_SIZE 32768u
+
+typedef struct pas_zip_access_point {
+    uint64_t      out;          /* uncompressed offset of this point */
+    uint64_t      in;           /* compressed offset of the next whole byte */
+    int           bits;         /* bits of the byte before in still to decode */
+    uint32_t      window_len;
+    unsigned char window[PAS_ZIP_WINDOW_SIZE];
+} pas_zip_access_point_t;
+
+typedef struct pas_zip_access {
+    pas_zip_access_point_t *points;
+    size_t                  count;
+} pas_zip_access_t;
+
+size_t         pas_zip_access_size(const pas_zip_file_t *file, uint64_t span);
+pas_zip_status pas_zip_access_build(pas_zip_access_t *ax, const pas_zip_file_t *file, uint64_t span,
+                                    void *mem, size_t mem_size, void *work, size_t work_size);
+
+size_t pas_zip_read_at(const pas_zip_file_t *file, const pas_zip_access_t *ax, uint64_t offset,
+                       void *buf, size_t size, void *work, size_t work_size, pas_zip_status *status);
+
+/* --- Batch extraction ---
+
+   Extracts many entries across threads the caller owns. Fill an array of jobs
+   (pas_zip_entries gives every entry in one central directory walk), call
+   pas_zip_batch_init, then either run pas_zip_batch_work on each of your
+   worker threads, or hand pas_zip_batch_submit a callback that queues tasks
+   on your pool. Workers claim jobs one at a time with an atomic counter, so
+   large and small entries balance out; each job gets its own status and the
+   result does not depend on which thread ran it. The batch is finished when
+   pas_zip_batch_remaining returns 0 (or when your workers have joined).
+   Without compiler atomics (PAS_ZIP_HAS_ATOMICS undefined) only one worker
+   may run at a time. */
+
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define PAS_ZIP_HAS_ATOMICS 1
+#endif
+
+typedef struct pas_zip_job {
+    pas_zip_file_t  file;       /* entry to extract */
+    void           *dst;        /* destination, at least pas_zip_size(&file) bytes */
+    size_t          dst_size;
+    size_t          written;    /* out: bytes extracted */
+    pas_zip_status  status;     /* out: per-entry result */
+} pas_zip_job_t;
+
+typedef struct pas_zip_batch {
+    pas_zip_job_t *jobs;
+    long           count;
+    volatile long  next;        /* next job to claim */
+    volatile long  remaining;   /* jobs not yet finished */
+} pas_zip_batch_t;
+
+typedef void (*pas_zip_task_fn)(void *arg);
+/* Queues fn(arg) on a worker; returns 0 on success. */
+typedef int (*pas_zip_submit_fn)(void *user, pas_zip_task_fn fn, void *arg);
+
+/* Copies up to max entries into out in central directory order; *count gets
+   the number of entries in the archive. PAS_ZIP_E_NOSPACE if max is smaller. */
+pas_zip_status pas_zip_entries(const pas_zip_t *zip, pas_zip_file_t *out, size_t max, size_t *count);
+
+pas_zip_status pas_zip_batch_init(pas_zip_batch_t *b, pas_zip_job_t *jobs, size_t count);
+
+/* Runs jobs until none are left to claim; work (PAS_ZIP_INFLATE_WORK_SIZE bytes,
+   private to this worker) or NULL for the backend allocator. Returns the number
+   of jobs this call completed. */
+size_t pas_zip_batch_work(pas_zip_batch_t *b, void *work, size_t work_size);
+
+/* Submits tasks tasks that each run pas_zip_batch_work(b, NULL, 0). If a
+   submission fails the remaining work runs on the calling thread. */
+pas_zip_status pas_zip_batch_submit(pas_zip_batch_t *b, pas_zip_submit_fn submit, void *user, int tasks);
+
+size_t pas_zip_batch_remaining(const pas_zip_batch_t *b);
+
 /* List all files. callback(name, uncompressed_size, user) */
 int pas_zip_list(pas_zip_t *zip, void (*callback)(const char *name, size_t size, void *user), void *user);
 
@@ -85,6 +288,68 @@ int pas_zip_list(pas_zip_t *zip, void (*callback)(const char *name, size_t size,
 size_t pas_zip_create(const char **filenames, const void **datas, const size_t *sizes,
                       int file_count, void *buffer, size_t buffer_size, pas_zip_status *status);
 
+/* CRC-32 (ZIP / zlib polynomial). Start with crc = 0 and feed chunks in order.
+   Uses the backend's routine when PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB is set. */
+uint32_t pas_zip_crc32(uint32_t crc, const void *data, size_t len);
+
+/* --- Streaming writer ---
+
+   Builds an archive incrementally and hands every byte to sink(user, data, size)
+   in order; sink returns the bytes it accepted (like fwrite), anything short
+   fails with PAS_ZIP_E_WRITE. Entries are written with data descriptors, so
+   neither sizes nor CRC need to be known up front. The central directory is
+   collected in cd_buf until finish: each entry needs PAS_ZIP_WRITER_CD_SIZE(name_len)
+   bytes of it. Deflate entries (PAS_ZIP_METHOD_DEFLATE, needs miniz/zlib) take a
+   work area of PAS_ZIP_DEFLATE_WORK_SIZE bytes for the compressor; pass NULL to
+   let the backend allocate. Errors are sticky: after one, every call returns it. */
+
+#define PAS_ZIP_WRITER_CD_SIZE(name_len) (46u + (size_t)(name_len) + 28u)
+#define PAS_ZIP_DEFLATE_WORK_SIZE (512u * 1024u)
+
+typedef size_t (*pas_zip_sink_fn)(void *user, const void *data, size_t size);
+
+typedef struct pas_zip_writer {
+    pas_zip_sink_fn sink;
+    void           *user;
+    uint8_t        *cd;          /* central directory records collected so far */
+    size_t          cd_cap;
+    size_t          cd_len;
+    uint64_t        offset;      /* bytes handed to the sink */
+    uint64_t        count;       /* finished entries */
+    pas_zip_status  error;
+    /* entry in progress */
+    int             in_entry;
+    uint16_t        method;
+    uint16_t        name_len;
+    uint32_t        crc;
+    uint64_t        comp_size;
+    uint64_t        uncomp_size;
+    uint64_t        entry_offset;
+#if defined(PAS_ZIP_USE_MINIZ)
+    mz_stream       strm;
+#elif defined(PAS_ZIP_USE_ZLIB)
+    z_stream        strm;
+#endif
+    pas_zip__arena  arena;
+    int             started;     /* backend deflate stream initialised */
+} pas_zip_writer_t;
+
+pas_zip_status pas_zip_writer_begin(pas_zip_writer_t *w, pas_zip_sink_fn sink, void *user,
+                                    void *cd_buf, size_t cd_buf_size);
+
+/* Starts an entry; method is PAS_ZIP_METHOD_STORE or PAS_ZIP_METHOD_DEFLATE. */
+pas_zip_status pas_zip_writer_entry_begin(pas_zip_writer_t *w, const char *name, int method,
+                                          void *work, size_t work_size);
+pas_zip_status pas_zip_writer_entry_write(pas_zip_writer_t *w, const void *data, size_t size);
+pas_zip_status pas_zip_writer_entry_end(pas_zip_writer_t *w);
+
+/* begin + write + end for data already in memory. */
+pas_zip_status pas_zip_writer_add(pas_zip_writer_t *w, const char *name, const void *data, size_t size,
+                                  int method, void *work, size_t work_size);
+
+/* Writes the central directory and end records. w->offset is then the archive size. */
+pas_zip_status pas_zip_writer_finish(pas_zip_writer_t *w);
+
 #ifdef __cplusplus
 }
 #endif
@@ -95,20 +360,22 @@ size_t pas_zip_create(const char **filenames, const void **datas, const size_t *
 
 #include <string.h>
 
-#ifdef PAS_ZIP_USE_MINIZ
-#include "miniz.h"
-#endif
-#ifdef PAS_ZIP_USE_ZLIB
-#include <zlib.h>
-#endif
-
 #define PAS_ZIP_EOCD_SIG  0x06054b50u
 #define PAS_ZIP_CDH_SIG   0x02014b50u
 #define PAS_ZIP_LFH_SIG   0x04034b50u
+#define PAS_ZIP_EOCD64_SIG 0x06064b50u
+#define PAS_ZIP_LOC64_SIG  0x07064b50u
+
+#define PAS_ZIP_DD_SIG     0x08074b50u
+
+#define PAS_ZIP_EXTRA_ZIP64 0x0001u
+#define PAS_ZIP_U32_MAX     0xFFFFFFFFu
+
+#define PAS_ZIP_NAME_MAX  512
 
 static pas_zip_t pas_zip__handle;
 static pas_zip_file_t pas_zip__current_file;
-static char pas_zip__name_buf[512];
+static char pas_zip__name_buf[PAS_ZIP_NAME_MAX];
 
 static uint32_t read_u32_le(const uint8_t *p) {
     return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
@@ -116,8 +383,40 @@ static uint32_t read_u32_le(const uint8_t *p) {
 static uint16_t read_u16_le(const uint8_t *p) {
     return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
 }
+static uint64_t read_u64_le(const uint8_t *p) {
+    return (uint64_t)read_u32_le(p) | ((uint64_t)read_u32_le(p + 4) << 32);
+}
+
+static void write_u16_le(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+}
+static void write_u32_le(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static void write_u64_le(uint8_t *p, uint64_t v) {
+    write_u32_le(p, (uint32_t)v);
+    write_u32_le(p + 4, (uint32_t)(v >> 32));
+}
 
-static int find_eocd(const uint8_t *data, size_t size, uint32_t *cd_offset, uint16_t *num_entries) {
+/* Reads the ZIP64 end record through the locator that precedes the classic
+   EOCD at eocd. Returns 0 if there is none. */
+static int find_eocd64(const uint8_t *data, size_t size, size_t eocd,
+                       uint64_t *cd_offset, uint64_t *num_entries) {
+    const uint8_t *loc;
+    uint64_t rec;
+
+    if (eocd < 20) return 0;
+    loc = data + eocd - 20;
+    if (read_u32_le(loc) != PAS_ZIP_LOC64_SIG) return 0;
+    rec = read_u64_le(loc + 8);
+    if (rec > size || size - rec < 56) return 0;
+    if (read_u32_le(data + rec) != PAS_ZIP_EOCD64_SIG) return 0;
+    *num_entries = read_u64_le(data + rec + 32);
+    *cd_offset = read_u64_le(data + rec + 48);
+    return 1;
+}
+
+static int find_eocd(const uint8_t *data, size_t size, uint64_t *cd_offset, uint64_t *num_entries) {
     size_t i;
     size_t search_end;
 
@@ -127,8 +426,10 @@ static int find_eocd(const uint8_t *data, size_t size, uint32_t *cd_offset, uint
     for (i = size - 22; ; i--) {
         if (i + 22 > size) continue;
         if (read_u32_le(data + i) == PAS_ZIP_EOCD_SIG) {
-            *num_entries = read_u16_le(data + i + 8);
-            *cd_offset = read_u32_le(data + i + 16);
+            if (!find_eocd64(data, size, i, cd_offset, num_entries)) {
+                *num_entries = read_u16_le(data + i + 8);
+                *cd_offset = read_u32_le(data + i + 16);
+            }
             if (*cd_offset >= size) return 0;
             return 1;
         }
@@ -137,28 +438,34 @@ static int find_eocd(const uint8_t *data, size_t size, uint32_t *cd_offset, uint
     return 0;
 }
 
-pas_zip_t *pas_zip_open(const void *data, size_t size, pas_zip_status *status) {
-    uint32_t cd_offset;
-    uint16_t num_entries;
+pas_zip_status pas_zip_init(pas_zip_t *zip, const void *data, size_t size) {
+    uint64_t cd_offset;
+    uint64_t num_entries;
 
-    if (status) *status = PAS_ZIP_E_INVALID;
-    if (!data || size < 22) return NULL;
+    if (!zip) return PAS_ZIP_E_INVALID;
+    memset(zip, 0, sizeof(*zip));
+    if (!data || size < 22) return PAS_ZIP_E_INVALID;
 
-    if (!find_eocd((const uint8_t *)data, size, &cd_offset, &num_entries)) {
-        if (status) *status = PAS_ZIP_E_INVALID;
-        return NULL;
-    }
+    if (!find_eocd((const uint8_t *)data, size, &cd_offset, &num_entries))
+        return PAS_ZIP_E_INVALID;
+
+    zip->data = (const uint8_t *)data;
+    zip->size = size;
+    zip->cd_offset = cd_offset;
+    zip->num_entries = num_entries;
+    return PAS_ZIP_OK;
+}
 
-    pas_zip__handle.data = (const uint8_t *)data;
-    pas_zip__handle.size = size;
-    pas_zip__handle.cd_offset = cd_offset;
-    pas_zip__handle.num_entries = num_entries;
+pas_zip_t *pas_zip_open(const void *data, size_t size, pas_zip_status *status) {
+    pas_zip_status st = pas_zip_init(&pas_zip__handle, data, size);
 
-    if (status) *status = PAS_ZIP_OK;
-    return &pas_zip__handle;
+    if (status) *status = st;
+    return (st == PAS_ZIP_OK) ? &pas_zip__handle : NULL;
 }
 
-static int parse_cd_entry(const uint8_t *p, const uint8_t *end, pas_zip_file_t *out) {
+/* Fills out from the central directory header at p. out->name points into
+   the archive (not null-terminated). */
+static int parse_cd_entry(const pas_zip_t *zip, const uint8_t *p, const uint8_t *end, pas_zip_file_t *out) {
     uint16_t fn_len, extra_len, comment_len;
     size_t need;
 
@@ -171,33 +478,68 @@ static int parse_cd_entry(const uint8_t *p, const uint8_t *end, pas_zip_file_t *
     need = 46 + fn_len + extra_len + comment_len;
     if (p + need > end) return 0;
 
+    {
+        uint64_t comp = read_u32_le(p + 20);
+        uint64_t uncomp = read_u32_le(p + 24);
+        uint64_t offset = read_u32_le(p + 42);
+
+        if (comp == PAS_ZIP_U32_MAX || uncomp == PAS_ZIP_U32_MAX || offset == PAS_ZIP_U32_MAX) {
+            /* ZIP64 extra field: 8-byte values for exactly the saturated fields, in this order */
+            const uint8_t *x = p + 46 + fn_len;
+            const uint8_t *x_end = x + extra_len;
+            int found = 0;
+            while (x + 4 <= x_end) {
+                uint16_t tag = read_u16_le(x);
+                uint16_t len = read_u16_le(x + 2);
+                const uint8_t *v = x + 4;
+                const uint8_t *v_end = v + len;
+                if (v_end > x_end) return 0;
+                if (tag == PAS_ZIP_EXTRA_ZIP64) {
+                    if (uncomp == PAS_ZIP_U32_MAX) { if (v + 8 > v_end) return 0; uncomp = read_u64_le(v); v += 8; }
+                    if (comp == PAS_ZIP_U32_MAX)   { if (v + 8 > v_end) return 0; comp = read_u64_le(v); v += 8; }
+                    if (offset == PAS_ZIP_U32_MAX) { if (v + 8 > v_end) return 0; offset = read_u64_le(v); }
+                    found = 1;
+                    break;
+                }
+                x = v_end;
+            }
+            if (!found) return 0;
+        }
+        if (comp > (size_t)-1 || uncomp > (size_t)-1) return 0;
+        out->compressed_size = (size_t)comp;
+        out->uncompressed_size = (size_t)uncomp;
+        out->local_header_offset = offset;
+    }
     out->compression_method = read_u16_le(p + 10);
-    out->compressed_size = (size_t)read_u32_le(p + 20);
-    out->uncompressed_size = (size_t)read_u32_le(p + 24);
-    out->local_header_offset = read_u32_le(p + 42);
-
-    if (fn_len >= sizeof(pas_zip__name_buf)) fn_len = (uint16_t)(sizeof(pas_zip__name_buf) - 1);
-    memcpy(pas_zip__name_buf, p + 46, fn_len);
-    pas_zip__name_buf[fn_len] = '\0';
-    out->name = pas_zip__name_buf;
+    out->crc = read_u32_le(p + 16);
+    out->name = (const char *)(p + 46);
+    out->name_len = fn_len;
+    out->zip = zip;
 
     return 1;
 }
 
-static int cd_iterate(pas_zip_t *zip, const char *find_name,
+static int cd_iterate(const pas_zip_t *zip, const char *find_name,
                       pas_zip_file_t *out, void (*cb)(const char *, size_t, void *), void *user) {
     const uint8_t *p = zip->data + zip->cd_offset;
     const uint8_t *end = zip->data + zip->size;
-    uint16_t n = zip->num_entries;
+    uint64_t n = zip->num_entries;
+    size_t find_len = find_name ? strlen(find_name) : 0;
 
     while (n-- && p < end) {
         pas_zip_file_t entry;
-        if (!parse_cd_entry(p, end, &entry)) return 0;
+        if (!parse_cd_entry(zip, p, end, &entry)) return 0;
 
         if (cb) {
-            cb(entry.name, entry.uncompressed_size, user);
+            char name[PAS_ZIP_NAME_MAX];
+            size_t len = entry.name_len;
+            if (len >= sizeof(name)) len = sizeof(name) - 1;
+            memcpy(name, entry.name, len);
+            name[len] = '\0';
+            cb(name, entry.uncompressed_size, user);
         }
-        if (find_name && strcmp(entry.name, find_name) == 0) {
+        if (find_name && entry.name_len == find_len &&
+            memcmp(entry.name, find_name, find_len) == 0) {
             *out = entry;
             return 1;
         }
@@ -207,24 +549,124 @@ static int cd_iterate(pas_zip_t *zip, const char *find_name,
     return find_name ? 0 : 1;
 }
 
+/* --- Name index: open-addressed table of (FNV-1a hash, CD offset + 1) pairs --- */
+
+static uint32_t pas_zip__hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* 0 if the archive has too many entries for a 32-bit slot count */
+static uint32_t pas_zip__index_slots(const pas_zip_t *zip) {
+    uint32_t slots = 4;
+    if (zip->num_entries > 0x40000000u) return 0;
+    while (slots < 2u * (uint32_t)zip->num_entries) slots <<= 1;
+    return slots;
+}
+
+size_t pas_zip_index_size(const pas_zip_t *zip) {
+    if (!zip || !zip->data) return 0;
+    return (size_t)pas_zip__index_slots(zip) * 2 * sizeof(uint32_t);
+}
+
+pas_zip_status pas_zip_index_build(pas_zip_t *zip, void *mem, size_t mem_size) {
+    uint32_t *table = (uint32_t *)mem;
+    uint32_t slots, mask;
+    const uint8_t *cd, *p, *end;
+    uint64_t n;
+
+    if (!zip || !zip->data || !mem) return PAS_ZIP_E_INVALID;
+    if (((uintptr_t)mem & 3u) != 0 || pas_zip__index_slots(zip) == 0) return PAS_ZIP_E_INVALID;
+    if (mem_size < pas_zip_index_size(zip)) return PAS_ZIP_E_NOSPACE;
+
+    zip->index = NULL;
+    zip->index_mask = 0;
+    slots = pas_zip__index_slots(zip);
+    mask = slots - 1;
+    memset(table, 0, (size_t)slots * 2 * sizeof(uint32_t));
+
+    cd = zip->data + zip->cd_offset;
+    end = zip->data + zip->size;
+    p = cd;
+    for (n = zip->num_entries; n; n--) {
+        pas_zip_file_t entry;
+        uint32_t h, i;
+
+        if (!parse_cd_entry(zip, p, end, &entry)) return PAS_ZIP_E_INVALID;
+        if ((size_t)(p - cd) >= 0xFFFFFFFFu) return PAS_ZIP_E_INVALID;
+        h = pas_zip__hash(entry.name, entry.name_len);
+        /* linear probing; duplicates keep CD order so the first entry wins, as in the scan */
+        for (i = h & mask; table[2 * i + 1] != 0; i = (i + 1) & mask) {}
+        table[2 * i] = h;
+        table[2 * i + 1] = (uint32_t)(p - cd) + 1;
+
+        p += 46 + read_u16_le(p + 28) + read_u16_le(p + 30) + read_u16_le(p + 32);
+    }
+
+    zip->index = table;
+    zip->index_mask = mask;
+    return PAS_ZIP_OK;
+}
+
+static int pas_zip__index_find(const pas_zip_t *zip, const char *name, pas_zip_file_t *out) {
+    size_t len = strlen(name);
+    uint32_t h = pas_zip__hash(name, len);
+    uint32_t i;
+    const uint8_t *cd = zip->data + zip->cd_offset;
+    const uint8_t *end = zip->data + zip->size;
+
+    for (i = h & zip->index_mask; zip->index[2 * i + 1] != 0; i = (i + 1) & zip->index_mask) {
+        pas_zip_file_t entry;
+        if (zip->index[2 * i] != h) continue;
+        if (!parse_cd_entry(zip, cd + zip->index[2 * i + 1] - 1, end, &entry)) return 0;
+        if (entry.name_len == len && memcmp(entry.name, name, len) == 0) {
+            *out = entry;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+pas_zip_status pas_zip_find_file(const pas_zip_t *zip, const char *name, pas_zip_file_t *out) {
+    int found;
+
+    if (!zip || !zip->data || !name || !out) return PAS_ZIP_E_INVALID;
+    if (zip->index)
+        found = pas_zip__index_find(zip, name, out);
+    else
+        found = cd_iterate(zip, name, out, NULL, NULL);
+    return found ? PAS_ZIP_OK : PAS_ZIP_E_NOT_FOUND;
+}
+
 pas_zip_file_t *pas_zip_find(pas_zip_t *zip, const char *name) {
-    pas_zip_file_t ent;
+    size_t len;
+
+    if (pas_zip_find_file(zip, name, &pas_zip__current_file) != PAS_ZIP_OK) return NULL;
 
-    if (!zip || !name) return NULL;
-    if (!cd_iterate(zip, name, &ent, NULL, NULL)) return NULL;
-    pas_zip__current_file = ent;
+    /* legacy API hands out a null-terminated copy of the name */
+    len = pas_zip__current_file.name_len;
+    if (len >= sizeof(pas_zip__name_buf)) len = sizeof(pas_zip__name_buf) - 1;
+    memcpy(pas_zip__name_buf, pas_zip__current_file.name, len);
+    pas_zip__name_buf[len] = '\0';
+    pas_zip__current_file.name = pas_zip__name_buf;
     return &pas_zip__current_file;
 }
 
 const char *pas_zip_name(pas_zip_file_t *file) { return file ? file->name : NULL; }
+size_t pas_zip_name_len(const pas_zip_file_t *file) { return file ? file->name_len : 0; }
 size_t pas_zip_size(pas_zip_file_t *file) { return file ? file->uncompressed_size : 0; }
 int pas_zip_is_compressed(pas_zip_file_t *file) { return file && file->compression_method != PAS_ZIP_METHOD_STORE; }
 
-static size_t skip_local_header(const uint8_t *data, size_t size, uint32_t offset) {
+static size_t skip_local_header(const uint8_t *data, size_t size, uint64_t offset) {
     const uint8_t *p;
     uint16_t fn_len, extra_len;
 
-    if (offset + 30 > size) return 0;
+    if (size < 30 || offset > size - 30) return 0;
     p = data + offset;
     if (read_u32_le(p) != PAS_ZIP_LFH_SIG) return 0;
     fn_len = read_u16_le(p + 26);
@@ -232,23 +674,51 @@ static size_t skip_local_header(const uint8_t *data, size_t size, uint32_t offse
     return 30 + fn_len + extra_len;
 }
 
-size_t pas_zip_extract(pas_zip_file_t *file, void *buffer, size_t buffer_size, pas_zip_status *status) {
-    const uint8_t *data;
-    size_t data_size;
-    size_t payload_offset;
+/* Returns the entry's compressed payload inside the archive, or NULL if the
+   local header or payload range is invalid. */
+static const uint8_t *pas_zip__payload(const pas_zip_file_t *file) {
+    const uint8_t *data = file->zip->data;
+    size_t data_size = file->zip->size;
+    size_t hdr_len, payload_offset;
+
+    hdr_len = skip_local_header(data, data_size, file->local_header_offset);
+    if (hdr_len == 0) return NULL;
+    payload_offset = (size_t)file->local_header_offset + hdr_len;
+    if (payload_offset > data_size || file->compressed_size > data_size - payload_offset) return NULL;
+    return data + payload_offset;
+}
 
-    if (status) *status = PAS_ZIP_E_INVALID;
-    if (!file || !buffer) return 0;
+const void *pas_zip_view(const pas_zip_file_t *file, size_t *size, pas_zip_status *status) {
+    const uint8_t *payload;
 
-    data = pas_zip__handle.data;
-    data_size = pas_zip__handle.size;
+    if (size) *size = 0;
+    if (status) *status = PAS_ZIP_E_INVALID;
+    if (!file || !file->zip) return NULL;
 
-    {
-        size_t hdr_len = skip_local_header(data, data_size, file->local_header_offset);
-        if (hdr_len == 0) return 0;
-        payload_offset = file->local_header_offset + hdr_len;
+    if (file->compression_method != PAS_ZIP_METHOD_STORE) {
+        if (status && file->compression_method == PAS_ZIP_METHOD_DEFLATE)
+            *status = PAS_ZIP_E_COMPRESSED;
+        return NULL;
     }
-    if (payload_offset + file->compressed_size > data_size) return 0;
+    if (file->compressed_size != file->uncompressed_size) return NULL;
+
+    payload = pas_zip__payload(file);
+    if (!payload) return NULL;
+
+    if (size) *size = file->uncompressed_size;
+    if (status) *status = PAS_ZIP_OK;
+    return payload;
+}
+
+static size_t pas_zip__extract(const pas_zip_file_t *file, void *buffer, size_t buffer_size,
+                               pas_zip_status *status, void *work, size_t work_size) {
+    const uint8_t *payload;
+
+    if (status) *status = PAS_ZIP_E_INVALID;
+    if (!file || !file->zip || !buffer) return 0;
+
+    payload = pas_zip__payload(file);
+    if (!payload) return 0;
 
     if (buffer_size < file->uncompressed_size) {
         if (status) *status = PAS_ZIP_E_NOSPACE;
@@ -256,36 +726,733 @@ size_t pas_zip_extract(pas_zip_file_t *file, void *buffer, size_t buffer_size, p
     }
 
     if (file->compression_method == PAS_ZIP_METHOD_STORE) {
-        memcpy(buffer, data + payload_offset, file->compressed_size);
+        memcpy(buffer, payload, file->compressed_size);
         if (status) *status = PAS_ZIP_OK;
         return file->uncompressed_size;
     }
 
     if (file->compression_method == PAS_ZIP_METHOD_DEFLATE) {
-#if defined(PAS_ZIP_USE_MINIZ) || defined(PAS_ZIP_USE_ZLIB)
-        unsigned long dest_len = (unsigned long)file->uncompressed_size;
-        int r;
+        pas_zip_inflater_t inf;
+        pas_zip_status st;
+        size_t in_used = 0;
+        size_t n;
+        int done = 0;
+
+        st = pas_zip_inflate_init(&inf, PAS_ZIP_INFLATE_AUTO, work, work_size);
+        if (st != PAS_ZIP_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+        n = pas_zip_inflate(&inf, payload, file->compressed_size, &in_used,
+                            buffer, buffer_size, &done, &st);
+        pas_zip_inflate_end(&inf);
+        if (st != PAS_ZIP_OK || !done) {
+            if (status) *status = (st == PAS_ZIP_OK) ? PAS_ZIP_E_ZLIB : st;
+            return 0;
+        }
+        if (status) *status = PAS_ZIP_OK;
+        return n;
+    }
+
+    if (status) *status = PAS_ZIP_E_INVALID;
+    return 0;
+}
+
+size_t pas_zip_extract(pas_zip_file_t *file, void *buffer, size_t buffer_size, pas_zip_status *status) {
+    return pas_zip__extract(file, buffer, buffer_size, status, NULL, 0);
+}
+
+/* --- Streaming inflate --- */
+
+#if defined(PAS_ZIP_USE_MINIZ)
+typedef mz_stream pas_zip__zstream;
+#define PAS_ZIP__Z_OK          MZ_OK
+#define PAS_ZIP__Z_STREAM_END  MZ_STREAM_END
+#define PAS_ZIP__Z_BUF_ERROR   MZ_BUF_ERROR
+#define PAS_ZIP__Z_NO_FLUSH    MZ_NO_FLUSH
+#define pas_zip__inflate_init2 mz_inflateInit2
+#define pas_zip__inflate_step  mz_inflate
+#define pas_zip__inflate_free  mz_inflateEnd
+#define PAS_ZIP__Z_FINISH      MZ_FINISH
+#define pas_zip__deflate_init2(s) mz_deflateInit2((s), MZ_DEFAULT_LEVEL, MZ_DEFLATED, -15, 8, MZ_DEFAULT_STRATEGY)
+#define pas_zip__deflate_step  mz_deflate
+#define pas_zip__deflate_free  mz_deflateEnd
+#elif defined(PAS_ZIP_USE_ZLIB)
+typedef z_stream pas_zip__zstream;
+#define PAS_ZIP__Z_OK          Z_OK
+#define PAS_ZIP__Z_STREAM_END  Z_STREAM_END
+#define PAS_ZIP__Z_BUF_ERROR   Z_BUF_ERROR
+#define PAS_ZIP__Z_NO_FLUSH    Z_NO_FLUSH
+#define pas_zip__inflate_init2 inflateInit2
+#define pas_zip__inflate_step  inflate
+#define pas_zip__inflate_free  inflateEnd
+#define PAS_ZIP__Z_FINISH      Z_FINISH
+#define pas_zip__deflate_init2(s) deflateInit2((s), Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)
+#define pas_zip__deflate_step  deflate
+#define pas_zip__deflate_free  deflateEnd
+#endif
+
+/* backend stream counters are 32-bit on some platforms */
+#define PAS_ZIP__CHUNK_MAX ((size_t)1 << 30)
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+
+static int pas_zip__is_zlib_header(const uint8_t *p, size_t len) {
+    /* CM = 8, CINFO <= 7, FCHECK makes the 16-bit header a multiple of 31.
+       Raw deflate can only collide by starting with a stored block whose
+       padding bits are non-zero, which encoders do not emit. */
+    if (len < 2) return 0;
+    if ((p[0] & 0x0F) != 8 || (p[0] >> 4) > 7) return 0;
+    return (((unsigned)p[0] << 8) | p[1]) % 31 == 0;
+}
+
 #if defined(PAS_ZIP_USE_MINIZ)
-        r = mz_uncompress((unsigned char *)buffer, &dest_len,
-                          data + payload_offset, (mz_ulong)file->compressed_size);
+static void *pas_zip__zalloc(void *opaque, size_t items, size_t size)
 #else
-        r = uncompress((Bytef *)buffer, &dest_len,
-                       data + payload_offset, (uLong)file->compressed_size);
+static voidpf pas_zip__zalloc(voidpf opaque, uInt items, uInt size)
 #endif
-        if (r != 0) {
+{
+    pas_zip__arena *a = (pas_zip__arena *)opaque;
+    size_t need = (size_t)items * (size_t)size;
+    unsigned char *p;
+
+    if (size && need / size != items) return NULL;
+    need = (need + 15u) & ~(size_t)15u;
+    if (need > a->size - a->used) return NULL;
+    p = a->base + a->used;
+    a->used += need;
+    return p;
+}
+
+#if defined(PAS_ZIP_USE_MINIZ)
+static void pas_zip__zfree(void *opaque, void *address)
+#else
+static void pas_zip__zfree(voidpf opaque, voidpf address)
+#endif
+{
+    /* work area is released as a whole */
+    (void)opaque;
+    (void)address;
+}
+
+static pas_zip_status pas_zip__arena_init(pas_zip__arena *a, void *work, size_t work_size) {
+    /* align the bump allocator's base to 16 bytes */
+    size_t skew = (size_t)(-(intptr_t)work & 15);
+
+    if (work_size < skew) return PAS_ZIP_E_NOSPACE;
+    a->base = (unsigned char *)work + skew;
+    a->size = work_size - skew;
+    a->used = 0;
+    return PAS_ZIP_OK;
+}
+
+#endif /* PAS_ZIP_HAS_INFLATE */
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+/* gzip wrapper states */
+enum {
+    PAS_ZIP__GZ_FIXED, PAS_ZIP__GZ_XLEN, PAS_ZIP__GZ_EXTRA, PAS_ZIP__GZ_NAME, PAS_ZIP__GZ_COMMENT,
+    PAS_ZIP__GZ_HCRC, PAS_ZIP__GZ_BODY, PAS_ZIP__GZ_TRAILER, PAS_ZIP__GZ_DONE
+};
+
+#define PAS_ZIP__GZ_FHCRC    0x02
+#define PAS_ZIP__GZ_FEXTRA   0x04
+#define PAS_ZIP__GZ_FNAME    0x08
+#define PAS_ZIP__GZ_FCOMMENT 0x10
+
+/* Consumes gzip header bytes until the deflate data starts; returns the bytes
+   used, or (size_t)-1 if the header is invalid. */
+static size_t pas_zip__gzip_header(pas_zip_inflater_t *inf, const uint8_t *p, size_t len) {
+    size_t i = 0;
+
+    while (inf->gz_state < PAS_ZIP__GZ_BODY) {
+        switch (inf->gz_state) {
+        case PAS_ZIP__GZ_FIXED:
+            while (i < len && inf->gz_have < 10) inf->gz_buf[inf->gz_have++] = p[i++];
+            if (inf->gz_have < 10) return i;
+            if (inf->gz_buf[0] != 0x1f || inf->gz_buf[1] != 0x8b || inf->gz_buf[2] != 8 || (inf->gz_buf[3] & 0xe0))
+                return (size_t)-1;
+            inf->gz_flags = inf->gz_buf[3];
+            inf->gz_have = 0;
+            inf->gz_state = (inf->gz_flags & PAS_ZIP__GZ_FEXTRA) ? PAS_ZIP__GZ_XLEN : PAS_ZIP__GZ_NAME;
+            break;
+        case PAS_ZIP__GZ_XLEN:
+            while (i < len && inf->gz_have < 2) inf->gz_buf[inf->gz_have++] = p[i++];
+            if (inf->gz_have < 2) return i;
+            inf->gz_skip = inf->gz_buf[0] | ((unsigned)inf->gz_buf[1] << 8);
+            inf->gz_have = 0;
+            inf->gz_state = PAS_ZIP__GZ_EXTRA;
+            break;
+        case PAS_ZIP__GZ_EXTRA: {
+            size_t n = len - i < inf->gz_skip ? len - i : inf->gz_skip;
+            i += n;
+            inf->gz_skip -= (unsigned)n;
+            if (inf->gz_skip) return i;
+            inf->gz_state = PAS_ZIP__GZ_NAME;
+            break;
+        }
+        case PAS_ZIP__GZ_NAME:
+        case PAS_ZIP__GZ_COMMENT:
+            if (inf->gz_flags & (inf->gz_state == PAS_ZIP__GZ_NAME ? PAS_ZIP__GZ_FNAME : PAS_ZIP__GZ_FCOMMENT)) {
+                while (i < len && p[i] != 0) i++;
+                if (i == len) return i;
+                i++;   /* terminator */
+            }
+            inf->gz_state++;
+            break;
+        default:   /* PAS_ZIP__GZ_HCRC */
+            if (inf->gz_flags & PAS_ZIP__GZ_FHCRC) {
+                while (i < len && inf->gz_have < 2) { inf->gz_have++; i++; }
+                if (inf->gz_have < 2) return i;
+                inf->gz_have = 0;
+            }
+            inf->gz_state = PAS_ZIP__GZ_BODY;
+            break;
+        }
+    }
+    return i;
+}
+
+/* Collects the CRC-32 / ISIZE trailer; returns the bytes used, or (size_t)-1 on a mismatch. */
+static size_t pas_zip__gzip_trailer(pas_zip_inflater_t *inf, const uint8_t *p, size_t len) {
+    size_t i = 0;
+    uint32_t crc, size;
+
+    while (i < len && inf->gz_have < 8) inf->gz_buf[inf->gz_have++] = p[i++];
+    if (inf->gz_have < 8) return i;
+    crc = read_u32_le(inf->gz_buf);
+    size = read_u32_le(inf->gz_buf + 4);
+    if (crc != inf->gz_crc || size != inf->gz_size) return (size_t)-1;
+    inf->gz_state = PAS_ZIP__GZ_DONE;
+    inf->done = 1;
+    return i;
+}
+#endif /* PAS_ZIP_HAS_INFLATE */
+
+pas_zip_status pas_zip_inflate_init(pas_zip_inflater_t *inf, int format, void *work, size_t work_size) {
+    if (!inf) return PAS_ZIP_E_INVALID;
+    memset(inf, 0, sizeof(*inf));
+    if (format != PAS_ZIP_INFLATE_RAW && format != PAS_ZIP_INFLATE_ZLIB && format != PAS_ZIP_INFLATE_AUTO &&
+        format != PAS_ZIP_INFLATE_GZIP)
+        return PAS_ZIP_E_INVALID;
+#if defined(PAS_ZIP_HAS_INFLATE)
+    if (work && pas_zip__arena_init(&inf->arena, work, work_size) != PAS_ZIP_OK)
+        return PAS_ZIP_E_NOSPACE;
+    inf->format = format;
+    return PAS_ZIP_OK;
+#else
+    (void)work;
+    (void)work_size;
+    return PAS_ZIP_E_COMPRESSED;
+#endif
+}
+
+size_t pas_zip_inflate(pas_zip_inflater_t *inf, const void *in, size_t in_len, size_t *in_used,
+                       void *out, size_t out_cap, int *done, pas_zip_status *status) {
+#if defined(PAS_ZIP_HAS_INFLATE)
+    const uint8_t *src = (const uint8_t *)in;
+    uint8_t *dst = (uint8_t *)out;
+    size_t consumed = 0, produced = 0;
+
+    if (in_used) *in_used = 0;
+    if (status) *status = PAS_ZIP_E_INVALID;
+    if (!inf || (!in && in_len) || (!out && out_cap)) return 0;
+
+    if (inf->done) {
+        if (done) *done = 1;
+        if (status) *status = PAS_ZIP_OK;
+        return 0;
+    }
+
+    if (inf->format == PAS_ZIP_INFLATE_GZIP && inf->gz_state != PAS_ZIP__GZ_BODY) {
+        consumed = inf->gz_state < PAS_ZIP__GZ_BODY ? pas_zip__gzip_header(inf, src, in_len)
+                                                    : pas_zip__gzip_trailer(inf, src, in_len);
+        if (consumed == (size_t)-1) {
             if (status) *status = PAS_ZIP_E_ZLIB;
             return 0;
         }
+        if (inf->gz_state != PAS_ZIP__GZ_BODY) {
+            if (in_used) *in_used = consumed;
+            if (done) *done = inf->done;
+            if (status) *status = PAS_ZIP_OK;
+            return 0;
+        }
+    }
+    /* AUTO decides on the first two bytes; wait for both */
+    if (!inf->started && inf->format == PAS_ZIP_INFLATE_AUTO && in_len < 2) {
+        if (done) *done = 0;
         if (status) *status = PAS_ZIP_OK;
-        return (size_t)dest_len;
+        return 0;
+    }
+
+    if (!inf->started) {
+        int zlib_wrapped = inf->format == PAS_ZIP_INFLATE_ZLIB ||
+                           (inf->format == PAS_ZIP_INFLATE_AUTO && pas_zip__is_zlib_header(src, in_len));
+        pas_zip__zstream *strm = &inf->strm;
+        memset(strm, 0, sizeof(*strm));
+        if (inf->arena.base) {
+            strm->zalloc = pas_zip__zalloc;
+            strm->zfree = pas_zip__zfree;
+            strm->opaque = &inf->arena;
+        }
+        if (pas_zip__inflate_init2(strm, zlib_wrapped ? 15 : -15) != PAS_ZIP__Z_OK) {
+            if (status) *status = inf->arena.base ? PAS_ZIP_E_NOSPACE : PAS_ZIP_E_ZLIB;
+            return 0;
+        }
+        inf->started = 1;
+    }
+
+    for (;;) {
+        size_t in_chunk = in_len - consumed;
+        size_t out_chunk = out_cap - produced;
+        size_t in_before, out_before;
+        int r;
+
+        if (in_chunk > PAS_ZIP__CHUNK_MAX) in_chunk = PAS_ZIP__CHUNK_MAX;
+        if (out_chunk > PAS_ZIP__CHUNK_MAX) out_chunk = PAS_ZIP__CHUNK_MAX;
+        inf->strm.next_in = (unsigned char *)(src + consumed);
+        inf->strm.avail_in = (unsigned)in_chunk;
+        inf->strm.next_out = dst + produced;
+        inf->strm.avail_out = (unsigned)out_chunk;
+        in_before = in_chunk;
+        out_before = out_chunk;
+
+        r = pas_zip__inflate_step(&inf->strm, PAS_ZIP__Z_NO_FLUSH);
+        consumed += in_before - inf->strm.avail_in;
+        produced += out_before - inf->strm.avail_out;
+
+        if (r == PAS_ZIP__Z_STREAM_END) {
+            if (inf->format != PAS_ZIP_INFLATE_GZIP) inf->done = 1;
+            else inf->gz_state = PAS_ZIP__GZ_TRAILER;
+            break;
+        }
+        if (r == PAS_ZIP__Z_BUF_ERROR) break;  /* needs more input or output */
+        if (r != PAS_ZIP__Z_OK) {
+            if (in_used) *in_used = consumed;
+            if (status) *status = PAS_ZIP_E_ZLIB;
+            return produced;
+        }
+        if (consumed == in_len || produced == out_cap) break;
+    }
+
+    if (inf->format == PAS_ZIP_INFLATE_GZIP) {
+        inf->gz_crc = pas_zip_crc32(inf->gz_crc, dst, produced);
+        inf->gz_size += (uint32_t)produced;
+        if (inf->gz_state == PAS_ZIP__GZ_TRAILER) {
+            size_t n = pas_zip__gzip_trailer(inf, src + consumed, in_len - consumed);
+            if (n == (size_t)-1) {
+                if (in_used) *in_used = consumed;
+                if (status) *status = PAS_ZIP_E_ZLIB;
+                return produced;
+            }
+            consumed += n;
+        }
+    }
+
+    if (in_used) *in_used = consumed;
+    if (done) *done = inf->done;
+    if (status) *status = PAS_ZIP_OK;
+    return produced;
 #else
-        if (status) *status = PAS_ZIP_E_COMPRESSED;
+    (void)inf; (void)in; (void)in_len; (void)out; (void)out_cap; (void)done;
+    if (in_used) *in_used = 0;
+    if (status) *status = PAS_ZIP_E_COMPRESSED;
+    return 0;
+#endif
+}
+
+void pas_zip_inflate_end(pas_zip_inflater_t *inf) {
+    if (!inf) return;
+#if defined(PAS_ZIP_HAS_INFLATE)
+    if (inf->started) pas_zip__inflate_free(&inf->strm);
+#endif
+    inf->started = 0;
+}
+
+/* --- Incremental entry reader --- */
+
+pas_zip_status pas_zip_reader_open(pas_zip_reader_t *r, const pas_zip_file_t *file,
+                                   void *work, size_t work_size) {
+    const uint8_t *payload;
+
+    if (!r) return PAS_ZIP_E_INVALID;
+    memset(r, 0, sizeof(*r));
+    if (!file || !file->zip) return PAS_ZIP_E_INVALID;
+    if (file->compression_method != PAS_ZIP_METHOD_STORE &&
+        file->compression_method != PAS_ZIP_METHOD_DEFLATE) return PAS_ZIP_E_INVALID;
+
+    payload = pas_zip__payload(file);
+    if (!payload) return PAS_ZIP_E_INVALID;
+
+    r->file = *file;
+    r->src = payload;
+    r->src_left = file->compressed_size;
+    if (file->compression_method == PAS_ZIP_METHOD_DEFLATE)
+        return pas_zip_inflate_init(&r->inf, PAS_ZIP_INFLATE_AUTO, work, work_size);
+    return PAS_ZIP_OK;
+}
+
+size_t pas_zip_reader_read(pas_zip_reader_t *r, void *buf, size_t buf_size, pas_zip_status *status) {
+    size_t n;
+
+    if (status) *status = PAS_ZIP_E_INVALID;
+    if (!r || !r->src || (!buf && buf_size)) return 0;
+    if (r->done || buf_size == 0) {
+        if (status) *status = PAS_ZIP_OK;
         return 0;
+    }
+
+    if (r->file.compression_method == PAS_ZIP_METHOD_STORE) {
+        n = (r->src_left < buf_size) ? r->src_left : buf_size;
+        memcpy(buf, r->src, n);
+        r->src += n;
+        r->src_left -= n;
+        if (r->src_left == 0) r->done = 1;
+    } else {
+        size_t in_used = 0;
+        pas_zip_status st;
+        int done = 0;
+
+        n = pas_zip_inflate(&r->inf, r->src, r->src_left, &in_used, buf, buf_size, &done, &st);
+        r->src += in_used;
+        r->src_left -= in_used;
+        if (st != PAS_ZIP_OK) {
+            if (status) *status = st;
+            return n;
+        }
+        if (done) r->done = 1;
+        else if (n == 0) {
+            /* input exhausted before the deflate stream ended */
+            if (status) *status = PAS_ZIP_E_ZLIB;
+            return 0;
+        }
+    }
+
+    r->produced += n;
+    if (r->produced > r->file.uncompressed_size ||
+        (r->done && r->produced != r->file.uncompressed_size)) {
+        if (status) *status = PAS_ZIP_E_INVALID;
+        return n;
+    }
+    if (status) *status = PAS_ZIP_OK;
+    return n;
+}
+
+void pas_zip_reader_close(pas_zip_reader_t *r) {
+    if (!r) return;
+    if (r->file.compression_method == PAS_ZIP_METHOD_DEFLATE) pas_zip_inflate_end(&r->inf);
+    memset(r, 0, sizeof(*r));
+}
+
+pas_zip_status pas_zip_entries(const pas_zip_t *zip, pas_zip_file_t *out, size_t max, size_t *count) {
+    const uint8_t *p, *end;
+    uint64_t i;
+
+    if (count) *count = 0;
+    if (!zip || !zip->data || (!out && max)) return PAS_ZIP_E_INVALID;
+    if (zip->num_entries > (size_t)-1) return PAS_ZIP_E_INVALID;
+    if (count) *count = (size_t)zip->num_entries;
+    if (max < zip->num_entries) return PAS_ZIP_E_NOSPACE;
+
+    p = zip->data + zip->cd_offset;
+    end = zip->data + zip->size;
+    for (i = 0; i < zip->num_entries; i++) {
+        if (!parse_cd_entry(zip, p, end, &out[i])) return PAS_ZIP_E_INVALID;
+        p += 46 + read_u16_le(p + 28) + read_u16_le(p + 30) + read_u16_le(p + 32);
+    }
+    return PAS_ZIP_OK;
+}
+
+/* --- Ranged reads --- */
+
+#define PAS_ZIP__SCRATCH 4096u
+
+/* Deflate payload past a zlib wrapper, if the entry has one; data is then raw. */
+static const uint8_t *pas_zip__raw_deflate(const pas_zip_file_t *file, size_t *len) {
+    const uint8_t *payload = pas_zip__payload(file);
+
+    if (!payload) return NULL;
+    *len = file->compressed_size;
+#if defined(PAS_ZIP_HAS_INFLATE)
+    if (pas_zip__is_zlib_header(payload, *len)) {
+        *len -= 2;
+        return payload + 2;
+    }
 #endif
+    return payload;
+}
+
+size_t pas_zip_access_size(const pas_zip_file_t *file, uint64_t span) {
+    uint64_t points;
+
+    if (!file || span == 0) return 0;
+    points = file->uncompressed_size / span + 1;
+    if (points > ((size_t)-1) / sizeof(pas_zip_access_point_t)) return 0;
+    return (size_t)points * sizeof(pas_zip_access_point_t);
+}
+
+pas_zip_status pas_zip_access_build(pas_zip_access_t *ax, const pas_zip_file_t *file, uint64_t span,
+                                    void *mem, size_t mem_size, void *work, size_t work_size) {
+#if defined(PAS_ZIP_USE_ZLIB)
+    pas_zip_access_point_t *pts = (pas_zip_access_point_t *)mem;
+    size_t cap = mem_size / sizeof(pas_zip_access_point_t);
+    pas_zip_inflater_t inf;
+    const uint8_t *src;
+    size_t src_len, consumed = 0;
+    uint64_t out_total = 0, last = 0;
+    unsigned char scratch[PAS_ZIP__SCRATCH];
+    pas_zip_status st = PAS_ZIP_OK;
+
+    if (!ax) return PAS_ZIP_E_INVALID;
+    ax->points = NULL;
+    ax->count = 0;
+    if (!file || !file->zip || span == 0 || !mem) return PAS_ZIP_E_INVALID;
+    if (file->compression_method != PAS_ZIP_METHOD_DEFLATE) return PAS_ZIP_E_INVALID;
+    if (((uintptr_t)mem & 7) != 0) return PAS_ZIP_E_INVALID;
+    src = pas_zip__raw_deflate(file, &src_len);
+    if (!src) return PAS_ZIP_E_INVALID;
+    if (cap == 0) return PAS_ZIP_E_NOSPACE;
+
+    /* point 0 is the start of the stream */
+    memset(&pts[0], 0, sizeof(pts[0]) - PAS_ZIP_WINDOW_SIZE);
+    ax->count = 1;
+
+    if (pas_zip_inflate_init(&inf, PAS_ZIP_INFLATE_RAW, work, work_size) != PAS_ZIP_OK) return PAS_ZIP_E_NOSPACE;
+    if (inf.arena.base) {
+        inf.strm.zalloc = pas_zip__zalloc;
+        inf.strm.zfree = pas_zip__zfree;
+        inf.strm.opaque = &inf.arena;
     }
+    if (inflateInit2(&inf.strm, -15) != Z_OK) return inf.arena.base ? PAS_ZIP_E_NOSPACE : PAS_ZIP_E_ZLIB;
+
+    for (;;) {
+        size_t in_chunk = src_len - consumed;
+        int r;
+
+        if (in_chunk > PAS_ZIP__CHUNK_MAX) in_chunk = PAS_ZIP__CHUNK_MAX;
+        inf.strm.next_in = (unsigned char *)(src + consumed);
+        inf.strm.avail_in = (uInt)in_chunk;
+        inf.strm.next_out = scratch;
+        inf.strm.avail_out = sizeof(scratch);
+
+        /* Z_BLOCK stops at every deflate block boundary */
+        r = inflate(&inf.strm, Z_BLOCK);
+        consumed += in_chunk - inf.strm.avail_in;
+        out_total += sizeof(scratch) - inf.strm.avail_out;
+
+        if (r == Z_STREAM_END) break;
+        if (r != Z_OK) {
+            st = PAS_ZIP_E_ZLIB;  /* corrupt, or input ended before the last block */
+            break;
+        }
+        if ((inf.strm.data_type & 128) && !(inf.strm.data_type & 64) && out_total - last >= span) {
+            pas_zip_access_point_t *pt;
+            uInt wlen = PAS_ZIP_WINDOW_SIZE;
+
+            if (ax->count == cap) {
+                st = PAS_ZIP_E_NOSPACE;
+                break;
+            }
+            pt = &pts[ax->count];
+            pt->out = out_total;
+            pt->in = consumed;
+            pt->bits = inf.strm.data_type & 7;
+            if (inflateGetDictionary(&inf.strm, pt->window, &wlen) != Z_OK) {
+                st = PAS_ZIP_E_ZLIB;
+                break;
+            }
+            pt->window_len = (uint32_t)wlen;
+            ax->count++;
+            last = out_total;
+        }
+    }
+    inflateEnd(&inf.strm);
+    if (st == PAS_ZIP_OK && out_total != file->uncompressed_size) st = PAS_ZIP_E_INVALID;
+    if (st != PAS_ZIP_OK) {
+        ax->count = 0;
+        return st;
+    }
+    ax->points = pts;
+    return PAS_ZIP_OK;
+#else
+    (void)file; (void)span; (void)mem; (void)mem_size; (void)work; (void)work_size;
+    if (ax) {
+        ax->points = NULL;
+        ax->count = 0;
+    }
+    return PAS_ZIP_E_COMPRESSED;
+#endif
+}
+
+size_t pas_zip_read_at(const pas_zip_file_t *file, const pas_zip_access_t *ax, uint64_t offset,
+                       void *buf, size_t size, void *work, size_t work_size, pas_zip_status *status) {
+    const uint8_t *src;
+    size_t src_len;
 
     if (status) *status = PAS_ZIP_E_INVALID;
-    return 0;
+    if (!file || !file->zip || (!buf && size)) return 0;
+    if (offset > file->uncompressed_size) return 0;
+    if (size > file->uncompressed_size - offset) size = (size_t)(file->uncompressed_size - offset);
+
+    if (file->compression_method == PAS_ZIP_METHOD_STORE) {
+        if (file->compressed_size != file->uncompressed_size) return 0;
+        src = pas_zip__payload(file);
+        if (!src) return 0;
+        memcpy(buf, src + (size_t)offset, size);
+        if (status) *status = PAS_ZIP_OK;
+        return size;
+    }
+    if (file->compression_method != PAS_ZIP_METHOD_DEFLATE) return 0;
+
+    src = pas_zip__raw_deflate(file, &src_len);
+    if (!src) return 0;
+    if (size == 0) {
+        if (status) *status = PAS_ZIP_OK;
+        return 0;
+    }
+
+    {
+        pas_zip_inflater_t inf;
+        unsigned char scratch[PAS_ZIP__SCRATCH];
+        uint64_t pos = 0;
+        size_t got = 0, in_pos = 0;
+        pas_zip_status st;
+
+        st = pas_zip_inflate_init(&inf, PAS_ZIP_INFLATE_RAW, work, work_size);
+        if (st != PAS_ZIP_OK) {
+            if (status) *status = st;
+            return 0;
+        }
+#if defined(PAS_ZIP_USE_ZLIB)
+        if (ax && ax->points && ax->count > 1) {
+            /* last access point at or before offset */
+            size_t lo = 0, hi = ax->count;
+            const pas_zip_access_point_t *pt;
+
+            while (hi - lo > 1) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (ax->points[mid].out <= offset) lo = mid; else hi = mid;
+            }
+            pt = &ax->points[lo];
+            if (lo > 0) {
+                if (pt->in > src_len || (pt->bits && pt->in == 0)) return 0;
+                if (inf.arena.base) {
+                    inf.strm.zalloc = pas_zip__zalloc;
+                    inf.strm.zfree = pas_zip__zfree;
+                    inf.strm.opaque = &inf.arena;
+                }
+                if (inflateInit2(&inf.strm, -15) != Z_OK) {
+                    if (status) *status = inf.arena.base ? PAS_ZIP_E_NOSPACE : PAS_ZIP_E_ZLIB;
+                    return 0;
+                }
+                inf.started = 1;
+                if ((pt->bits && inflatePrime(&inf.strm, pt->bits, src[pt->in - 1] >> (8 - pt->bits)) != Z_OK) ||
+                    inflateSetDictionary(&inf.strm, pt->window, pt->window_len) != Z_OK) {
+                    pas_zip_inflate_end(&inf);
+                    if (status) *status = PAS_ZIP_E_ZLIB;
+                    return 0;
+                }
+                pos = pt->out;
+                in_pos = (size_t)pt->in;
+            }
+        }
+#else
+        (void)ax;
+#endif
+        while (got < size) {
+            size_t in_used = 0, n;
+            int done = 0;
+
+            if (pos < offset) {
+                uint64_t skip = offset - pos;
+                n = pas_zip_inflate(&inf, src + in_pos, src_len - in_pos, &in_used, scratch,
+                                    skip < sizeof(scratch) ? (size_t)skip : sizeof(scratch), &done, &st);
+                pos += n;
+            } else {
+                n = pas_zip_inflate(&inf, src + in_pos, src_len - in_pos, &in_used,
+                                    (uint8_t *)buf + got, size - got, &done, &st);
+                got += n;
+            }
+            in_pos += in_used;
+            if (st != PAS_ZIP_OK) break;
+            if (done || (n == 0 && in_used == 0)) {
+                if (got < size) st = PAS_ZIP_E_ZLIB;  /* stream shorter than the entry */
+                break;
+            }
+        }
+        pas_zip_inflate_end(&inf);
+        if (status) *status = st;
+        return got;
+    }
+}
+
+/* --- Batch extraction --- */
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define pas_zip__atomic_add(p, v) _InterlockedExchangeAdd((volatile long *)(p), (v))
+#define pas_zip__atomic_load(p)   _InterlockedCompareExchange((volatile long *)(p), 0, 0)
+#elif defined(PAS_ZIP_HAS_ATOMICS)
+#define pas_zip__atomic_add(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define pas_zip__atomic_load(p)   __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#else
+static long pas_zip__atomic_add(volatile long *p, long v) { long old = *p; *p = old + v; return old; }
+#define pas_zip__atomic_load(p)   (*(p))
+#endif
+
+pas_zip_status pas_zip_batch_init(pas_zip_batch_t *b, pas_zip_job_t *jobs, size_t count) {
+    size_t i;
+
+    if (!b) return PAS_ZIP_E_INVALID;
+    memset(b, 0, sizeof(*b));
+    if ((!jobs && count) || count > 0x7FFFFFFFu) return PAS_ZIP_E_INVALID;
+    for (i = 0; i < count; i++) {
+        jobs[i].written = 0;
+        jobs[i].status = PAS_ZIP_E_INVALID;
+    }
+    b->jobs = jobs;
+    b->count = (long)count;
+    b->remaining = (long)count;
+    return PAS_ZIP_OK;
+}
+
+size_t pas_zip_batch_work(pas_zip_batch_t *b, void *work, size_t work_size) {
+    size_t done = 0;
+
+    if (!b) return 0;
+    for (;;) {
+        long i = pas_zip__atomic_add(&b->next, 1);
+        pas_zip_job_t *job;
+
+        if (i >= b->count) break;
+        job = &b->jobs[i];
+        job->written = pas_zip__extract(&job->file, job->dst, job->dst_size, &job->status, work, work_size);
+        pas_zip__atomic_add(&b->remaining, -1);
+        done++;
+    }
+    return done;
+}
+
+static void pas_zip__batch_task(void *arg) {
+    (void)pas_zip_batch_work((pas_zip_batch_t *)arg, NULL, 0);
+}
+
+pas_zip_status pas_zip_batch_submit(pas_zip_batch_t *b, pas_zip_submit_fn submit, void *user, int tasks) {
+    int i;
+
+    if (!b || !submit || tasks <= 0) return PAS_ZIP_E_INVALID;
+    for (i = 0; i < tasks; i++) {
+        if (submit(user, pas_zip__batch_task, b) != 0) {
+            pas_zip__batch_task(b);
+            break;
+        }
+    }
+    return PAS_ZIP_OK;
+}
+
+size_t pas_zip_batch_remaining(const pas_zip_batch_t *b) {
+    if (!b) return 0;
+    return (size_t)pas_zip__atomic_load(&((pas_zip_batch_t *)b)->remaining);
 }
 
 int pas_zip_list(pas_zip_t *zip, void (*callback)(const char *name, size_t size, void *user), void *user) {
@@ -293,90 +1460,476 @@ int pas_zip_list(pas_zip_t *zip, void (*callback)(const char *name, size_t size,
     return cd_iterate(zip, NULL, NULL, callback, user) ? 0 : -1;
 }
 
-/* Create ZIP (Store only) */
+/* Create ZIP (Store only). Entries, offsets or counts past the 32-bit / 16-bit
+   limits get ZIP64 extra fields and the ZIP64 end records. */
 size_t pas_zip_create(const char **filenames, const void **datas, const size_t *sizes,
                       int file_count, void *buffer, size_t buffer_size, pas_zip_status *status) {
     uint8_t *out = (uint8_t *)buffer;
     size_t written = 0;
-    uint32_t cd_offset;
-    uint32_t cd_size = 0;
-    uint16_t n;
+    uint64_t cd_offset, cd_size, local_off;
+    int zip64_end;
     int i;
 
     if (status) *status = PAS_ZIP_E_INVALID;
     if (!filenames || !datas || !sizes || !buffer || file_count <= 0) return 0;
 
     for (i = 0; i < file_count; i++) {
-        uint16_t fn_len = (uint16_t)strlen(filenames[i]);
-        uint32_t sz = (uint32_t)sizes[i];
-        size_t need = 30 + fn_len + sz;
-        if (fn_len != strlen(filenames[i])) return 0; /* overflow */
-        if (written + need > buffer_size) {
+        size_t fn_len = strlen(filenames[i]);
+        uint64_t sz = (uint64_t)sizes[i];
+        int big = sz >= PAS_ZIP_U32_MAX;
+        size_t hdr = 30 + fn_len + (big ? 20 : 0);
+        uint8_t *p;
+
+        if (fn_len > 0xFFFF) return 0; /* overflow */
+        if (!datas[i] && sz) return 0;
+        if (hdr > buffer_size - written || sizes[i] > buffer_size - written - hdr) {
             if (status) *status = PAS_ZIP_E_NOSPACE;
             return 0;
         }
-        out[written++] = 0x50; out[written++] = 0x4b; out[written++] = 0x03; out[written++] = 0x04;
-        out[written++] = 20; out[written++] = 0;  out[written++] = 0; out[written++] = 0;
-        out[written++] = 0; out[written++] = 0;  /* store */
-        for (n = 0; n < 8; n++) out[written++] = 0;  /* mod time, mod date, crc */
-        out[written++] = (uint8_t)(sz); out[written++] = (uint8_t)(sz>>8);
-        out[written++] = (uint8_t)(sz>>16); out[written++] = (uint8_t)(sz>>24);
-        out[written++] = (uint8_t)(sz); out[written++] = (uint8_t)(sz>>8);
-        out[written++] = (uint8_t)(sz>>16); out[written++] = (uint8_t)(sz>>24);
-        out[written++] = (uint8_t)(fn_len); out[written++] = (uint8_t)(fn_len>>8);
-        out[written++] = 0; out[written++] = 0;  /* extra len */
-        memcpy(out + written, filenames[i], fn_len); written += fn_len;
-        memcpy(out + written, datas[i], sz); written += sz;
-    }
-
-    cd_offset = (uint32_t)written;
+        p = out + written;
+        write_u32_le(p, PAS_ZIP_LFH_SIG);
+        write_u16_le(p + 4, big ? 45 : 20);     /* version needed */
+        write_u16_le(p + 6, 0);                 /* flags */
+        write_u16_le(p + 8, PAS_ZIP_METHOD_STORE);
+        write_u32_le(p + 10, 0);                /* mod time, mod date */
+        write_u32_le(p + 14, pas_zip_crc32(0, datas[i], sizes[i]));
+        write_u32_le(p + 18, big ? PAS_ZIP_U32_MAX : (uint32_t)sz);
+        write_u32_le(p + 22, big ? PAS_ZIP_U32_MAX : (uint32_t)sz);
+        write_u16_le(p + 26, (uint16_t)fn_len);
+        write_u16_le(p + 28, big ? 20 : 0);     /* extra len */
+        memcpy(p + 30, filenames[i], fn_len);
+        if (big) {
+            uint8_t *x = p + 30 + fn_len;
+            write_u16_le(x, PAS_ZIP_EXTRA_ZIP64);
+            write_u16_le(x + 2, 16);
+            write_u64_le(x + 4, sz);
+            write_u64_le(x + 12, sz);
+        }
+        written += hdr;
+        if (sz) memcpy(out + written, datas[i], sizes[i]);
+        written += sizes[i];
+    }
+
+    cd_offset = written;
+    local_off = 0;
     for (i = 0; i < file_count; i++) {
-        uint16_t fn_len = (uint16_t)strlen(filenames[i]);
-        uint32_t sz = (uint32_t)sizes[i];
-        uint32_t local_off = 0;
-        size_t j;
-        for (j = 0; j < (size_t)i; j++)
-            local_off += 30 + (uint32_t)strlen(filenames[j]) + (uint32_t)sizes[j];
-        if (written + 46 + fn_len > buffer_size) {
+        size_t fn_len = strlen(filenames[i]);
+        uint64_t sz = (uint64_t)sizes[i];
+        int big = sz >= PAS_ZIP_U32_MAX;
+        int far = local_off >= PAS_ZIP_U32_MAX;
+        size_t extra = (big ? 16 : 0) + (far ? 8 : 0);
+        size_t need;
+        uint8_t *p;
+
+        if (extra) extra += 4;
+        need = 46 + fn_len + extra;
+        if (need > buffer_size - written) {
             if (status) *status = PAS_ZIP_E_NOSPACE;
             return 0;
         }
-        cd_size += 46 + fn_len;
-        out[written++] = 0x50; out[written++] = 0x4b; out[written++] = 0x01; out[written++] = 0x02;
-        out[written++] = 20; out[written++] = 0; out[written++] = 20; out[written++] = 0;
-        out[written++] = 0; out[written++] = 0; out[written++] = 0; out[written++] = 0;
-        for (n = 0; n < 8; n++) out[written++] = 0;
-        out[written++] = (uint8_t)(sz); out[written++] = (uint8_t)(sz>>8);
-        out[written++] = (uint8_t)(sz>>16); out[written++] = (uint8_t)(sz>>24);
-        out[written++] = (uint8_t)(sz); out[written++] = (uint8_t)(sz>>8);
-        out[written++] = (uint8_t)(sz>>16); out[written++] = (uint8_t)(sz>>24);
-        out[written++] = (uint8_t)(fn_len); out[written++] = (uint8_t)(fn_len>>8);
-        out[written++] = 0; out[written++] = 0; out[written++] = 0; out[written++] = 0;
-        out[written++] = 0; out[written++] = 0; out[written++] = 0; out[written++] = 0;
-        out[written++] = 0; out[written++] = 0; out[written++] = 0; out[written++] = 0;  /* extra, comment, disk, internal, external */
-        out[written++] = (uint8_t)(local_off); out[written++] = (uint8_t)(local_off>>8);
-        out[written++] = (uint8_t)(local_off>>16); out[written++] = (uint8_t)(local_off>>24);
-        memcpy(out + written, filenames[i], fn_len); written += fn_len;
-    }
-
-    if (written + 22 > buffer_size) {
+        p = out + written;
+        write_u32_le(p, PAS_ZIP_CDH_SIG);
+        write_u16_le(p + 4, extra ? 45 : 20);   /* version made by */
+        write_u16_le(p + 6, extra ? 45 : 20);   /* version needed */
+        write_u16_le(p + 8, 0);                 /* flags */
+        write_u16_le(p + 10, PAS_ZIP_METHOD_STORE);
+        write_u32_le(p + 12, 0);                /* mod time, mod date */
+        write_u32_le(p + 16, read_u32_le(out + (size_t)local_off + 14));  /* crc from the local header */
+        write_u32_le(p + 20, big ? PAS_ZIP_U32_MAX : (uint32_t)sz);
+        write_u32_le(p + 24, big ? PAS_ZIP_U32_MAX : (uint32_t)sz);
+        write_u16_le(p + 28, (uint16_t)fn_len);
+        write_u16_le(p + 30, (uint16_t)extra);
+        write_u16_le(p + 32, 0);                /* comment */
+        write_u16_le(p + 34, 0);                /* disk */
+        write_u16_le(p + 36, 0);                /* internal attrs */
+        write_u32_le(p + 38, 0);                /* external attrs */
+        write_u32_le(p + 42, far ? PAS_ZIP_U32_MAX : (uint32_t)local_off);
+        memcpy(p + 46, filenames[i], fn_len);
+        if (extra) {
+            uint8_t *x = p + 46 + fn_len;
+            write_u16_le(x, PAS_ZIP_EXTRA_ZIP64);
+            write_u16_le(x + 2, (uint16_t)(extra - 4));
+            x += 4;
+            if (big) { write_u64_le(x, sz); write_u64_le(x + 8, sz); x += 16; }
+            if (far) write_u64_le(x, local_off);
+        }
+        written += need;
+        local_off += 30 + fn_len + (big ? 20 : 0) + sz;
+    }
+    cd_size = written - cd_offset;
+
+    zip64_end = file_count >= 0xFFFF || cd_size >= PAS_ZIP_U32_MAX || cd_offset >= PAS_ZIP_U32_MAX;
+    if ((zip64_end ? 56 + 20 + 22 : 22) > buffer_size - written) {
         if (status) *status = PAS_ZIP_E_NOSPACE;
         return 0;
     }
-    out[written++] = 0x50; out[written++] = 0x4b; out[written++] = 0x05; out[written++] = 0x06;
-    for (n = 0; n < 4; n++) out[written++] = 0;
-    out[written++] = (uint8_t)file_count; out[written++] = (uint8_t)(file_count>>8);
-    out[written++] = (uint8_t)file_count; out[written++] = (uint8_t)(file_count>>8);
-    out[written++] = (uint8_t)(cd_size); out[written++] = (uint8_t)(cd_size>>8);
-    out[written++] = (uint8_t)(cd_size>>16); out[written++] = (uint8_t)(cd_size>>24);
-    out[written++] = (uint8_t)(cd_offset); out[written++] = (uint8_t)(cd_offset>>8);
-    out[written++] = (uint8_t)(cd_offset>>16); out[written++] = (uint8_t)(cd_offset>>24);
-    out[written++] = 0; out[written++] = 0;
+    if (zip64_end) {
+        uint8_t *p = out + written;
+        uint64_t rec_offset = written;
+
+        write_u32_le(p, PAS_ZIP_EOCD64_SIG);
+        write_u64_le(p + 4, 44);                /* size of the rest of the record */
+        write_u16_le(p + 12, 45);               /* version made by */
+        write_u16_le(p + 14, 45);               /* version needed */
+        write_u32_le(p + 16, 0);                /* this disk */
+        write_u32_le(p + 20, 0);                /* disk with CD */
+        write_u64_le(p + 24, (uint64_t)file_count);
+        write_u64_le(p + 32, (uint64_t)file_count);
+        write_u64_le(p + 40, cd_size);
+        write_u64_le(p + 48, cd_offset);
+        p += 56;
+        write_u32_le(p, PAS_ZIP_LOC64_SIG);
+        write_u32_le(p + 4, 0);                 /* disk with ZIP64 end record */
+        write_u64_le(p + 8, rec_offset);
+        write_u32_le(p + 16, 1);                /* total disks */
+        written += 56 + 20;
+    }
+    {
+        uint8_t *p = out + written;
+        uint16_t count = (file_count >= 0xFFFF) ? 0xFFFF : (uint16_t)file_count;
+
+        write_u32_le(p, PAS_ZIP_EOCD_SIG);
+        write_u32_le(p + 4, 0);                 /* disk numbers */
+        write_u16_le(p + 8, count);
+        write_u16_le(p + 10, count);
+        write_u32_le(p + 12, cd_size >= PAS_ZIP_U32_MAX ? PAS_ZIP_U32_MAX : (uint32_t)cd_size);
+        write_u32_le(p + 16, cd_offset >= PAS_ZIP_U32_MAX ? PAS_ZIP_U32_MAX : (uint32_t)cd_offset);
+        write_u16_le(p + 20, 0);                /* comment len */
+        written += 22;
+    }
 
     if (status) *status = PAS_ZIP_OK;
     return written;
 }
 
+/* --- CRC-32 --- */
+
+#if !defined(PAS_ZIP_HAS_INFLATE)
+static const uint32_t pas_zip__crc_table[256] = {
+    0x00000000u, 0x77073096u, 0xee0e612cu, 0x990951bau, 0x076dc419u, 0x706af48fu,
+    0xe963a535u, 0x9e6495a3u, 0x0edb8832u, 0x79dcb8a4u, 0xe0d5e91eu, 0x97d2d988u,
+    0x09b64c2bu, 0x7eb17cbdu, 0xe7b82d07u, 0x90bf1d91u, 0x1db71064u, 0x6ab020f2u,
+    0xf3b97148u, 0x84be41deu, 0x1adad47du, 0x6ddde4ebu, 0xf4d4b551u, 0x83d385c7u,
+    0x136c9856u, 0x646ba8c0u, 0xfd62f97au, 0x8a65c9ecu, 0x14015c4fu, 0x63066cd9u,
+    0xfa0f3d63u, 0x8d080df5u, 0x3b6e20c8u, 0x4c69105eu, 0xd56041e4u, 0xa2677172u,
+    0x3c03e4d1u, 0x4b04d447u, 0xd20d85fdu, 0xa50ab56bu, 0x35b5a8fau, 0x42b2986cu,
+    0xdbbbc9d6u, 0xacbcf940u, 0x32d86ce3u, 0x45df5c75u, 0xdcd60dcfu, 0xabd13d59u,
+    0x26d930acu, 0x51de003au, 0xc8d75180u, 0xbfd06116u, 0x21b4f4b5u, 0x56b3c423u,
+    0xcfba9599u, 0xb8bda50fu, 0x2802b89eu, 0x5f058808u, 0xc60cd9b2u, 0xb10be924u,
+    0x2f6f7c87u, 0x58684c11u, 0xc1611dabu, 0xb6662d3du, 0x76dc4190u, 0x01db7106u,
+    0x98d220bcu, 0xefd5102au, 0x71b18589u, 0x06b6b51fu, 0x9fbfe4a5u, 0xe8b8d433u,
+    0x7807c9a2u, 0x0f00f934u, 0x9609a88eu, 0xe10e9818u, 0x7f6a0dbbu, 0x086d3d2du,
+    0x91646c97u, 0xe6635c01u, 0x6b6b51f4u, 0x1c6c6162u, 0x856530d8u, 0xf262004eu,
+    0x6c0695edu, 0x1b01a57bu, 0x8208f4c1u, 0xf50fc457u, 0x65b0d9c6u, 0x12b7e950u,
+    0x8bbeb8eau, 0xfcb9887cu, 0x62dd1ddfu, 0x15da2d49u, 0x8cd37cf3u, 0xfbd44c65u,
+    0x4db26158u, 0x3ab551ceu, 0xa3bc0074u, 0xd4bb30e2u, 0x4adfa541u, 0x3dd895d7u,
+    0xa4d1c46du, 0xd3d6f4fbu, 0x4369e96au, 0x346ed9fcu, 0xad678846u, 0xda60b8d0u,
+    0x44042d73u, 0x33031de5u, 0xaa0a4c5fu, 0xdd0d7cc9u, 0x5005713cu, 0x270241aau,
+    0xbe0b1010u, 0xc90c2086u, 0x5768b525u, 0x206f85b3u, 0xb966d409u, 0xce61e49fu,
+    0x5edef90eu, 0x29d9c998u, 0xb0d09822u, 0xc7d7a8b4u, 0x59b33d17u, 0x2eb40d81u,
+    0xb7bd5c3bu, 0xc0ba6cadu, 0xedb88320u, 0x9abfb3b6u, 0x03b6e20cu, 0x74b1d29au,
+    0xead54739u, 0x9dd277afu, 0x04db2615u, 0x73dc1683u, 0xe3630b12u, 0x94643b84u,
+    0x0d6d6a3eu, 0x7a6a5aa8u, 0xe40ecf0bu, 0x9309ff9du, 0x0a00ae27u, 0x7d079eb1u,
+    0xf00f9344u, 0x8708a3d2u, 0x1e01f268u, 0x6906c2feu, 0xf762575du, 0x806567cbu,
+    0x196c3671u, 0x6e6b06e7u, 0xfed41b76u, 0x89d32be0u, 0x10da7a5au, 0x67dd4accu,
+    0xf9b9df6fu, 0x8ebeeff9u, 0x17b7be43u, 0x60b08ed5u, 0xd6d6a3e8u, 0xa1d1937eu,
+    0x38d8c2c4u, 0x4fdff252u, 0xd1bb67f1u, 0xa6bc5767u, 0x3fb506ddu, 0x48b2364bu,
+    0xd80d2bdau, 0xaf0a1b4cu, 0x36034af6u, 0x41047a60u, 0xdf60efc3u, 0xa867df55u,
+    0x316e8eefu, 0x4669be79u, 0xcb61b38cu, 0xbc66831au, 0x256fd2a0u, 0x5268e236u,
+    0xcc0c7795u, 0xbb0b4703u, 0x220216b9u, 0x5505262fu, 0xc5ba3bbeu, 0xb2bd0b28u,
+    0x2bb45a92u, 0x5cb36a04u, 0xc2d7ffa7u, 0xb5d0cf31u, 0x2cd99e8bu, 0x5bdeae1du,
+    0x9b64c2b0u, 0xec63f226u, 0x756aa39cu, 0x026d930au, 0x9c0906a9u, 0xeb0e363fu,
+    0x72076785u, 0x05005713u, 0x95bf4a82u, 0xe2b87a14u, 0x7bb12baeu, 0x0cb61b38u,
+    0x92d28e9bu, 0xe5d5be0du, 0x7cdcefb7u, 0x0bdbdf21u, 0x86d3d2d4u, 0xf1d4e242u,
+    0x68ddb3f8u, 0x1fda836eu, 0x81be16cdu, 0xf6b9265bu, 0x6fb077e1u, 0x18b74777u,
+    0x88085ae6u, 0xff0f6a70u, 0x66063bcau, 0x11010b5cu, 0x8f659effu, 0xf862ae69u,
+    0x616bffd3u, 0x166ccf45u, 0xa00ae278u, 0xd70dd2eeu, 0x4e048354u, 0x3903b3c2u,
+    0xa7672661u, 0xd06016f7u, 0x4969474du, 0x3e6e77dbu, 0xaed16a4au, 0xd9d65adcu,
+    0x40df0b66u, 0x37d83bf0u, 0xa9bcae53u, 0xdebb9ec5u, 0x47b2cf7fu, 0x30b5ffe9u,
+    0xbdbdf21cu, 0xcabac28au, 0x53b39330u, 0x24b4a3a6u, 0xbad03605u, 0xcdd70693u,
+    0x54de5729u, 0x23d967bfu, 0xb3667a2eu, 0xc4614ab8u, 0x5d681b02u, 0x2a6f2b94u,
+    0xb40bbe37u, 0xc30c8ea1u, 0x5a05df1bu, 0x2d02ef8du
+};
+#endif
+
+uint32_t pas_zip_crc32(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+
+    if (!p || len == 0) return crc;
+#if defined(PAS_ZIP_USE_MINIZ)
+    return (uint32_t)mz_crc32((mz_ulong)crc, p, len);
+#elif defined(PAS_ZIP_USE_ZLIB)
+    while (len) {
+        size_t n = len > PAS_ZIP__CHUNK_MAX ? PAS_ZIP__CHUNK_MAX : len;
+        crc = (uint32_t)crc32((uLong)crc, p, (uInt)n);
+        p += n;
+        len -= n;
+    }
+    return crc;
+#else
+    crc = ~crc;
+    while (len--) crc = pas_zip__crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+#endif
+}
+
+/* --- Streaming writer --- */
+
+#define PAS_ZIP__WRITER_CHUNK 4096u
+
+static pas_zip_status pas_zip__emit(pas_zip_writer_t *w, const void *data, size_t size) {
+    if (w->error) return w->error;
+    if (size && w->sink(w->user, data, size) != size) {
+        w->error = PAS_ZIP_E_WRITE;
+        return w->error;
+    }
+    w->offset += size;
+    return PAS_ZIP_OK;
+}
+
+static pas_zip_status pas_zip__writer_fail(pas_zip_writer_t *w, pas_zip_status st) {
+    if (!w->error) w->error = st;
+    return w->error;
+}
+
+pas_zip_status pas_zip_writer_begin(pas_zip_writer_t *w, pas_zip_sink_fn sink, void *user,
+                                    void *cd_buf, size_t cd_buf_size) {
+    if (!w) return PAS_ZIP_E_INVALID;
+    memset(w, 0, sizeof(*w));
+    if (!sink || (!cd_buf && cd_buf_size)) return PAS_ZIP_E_INVALID;
+    w->sink = sink;
+    w->user = user;
+    w->cd = (uint8_t *)cd_buf;
+    w->cd_cap = cd_buf_size;
+    return PAS_ZIP_OK;
+}
+
+pas_zip_status pas_zip_writer_entry_begin(pas_zip_writer_t *w, const char *name, int method,
+                                          void *work, size_t work_size) {
+    uint8_t hdr[30];
+    size_t name_len;
+
+    if (!w || !w->sink) return PAS_ZIP_E_INVALID;
+    if (w->error) return w->error;
+    if (w->in_entry || !name) return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+    name_len = strlen(name);
+    if (name_len > 0xFFFF) return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+    if (method != PAS_ZIP_METHOD_STORE && method != PAS_ZIP_METHOD_DEFLATE)
+        return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+    /* the CD record is filled at entry_end; reserve it (and store the name) now */
+    if (PAS_ZIP_WRITER_CD_SIZE(name_len) > w->cd_cap - w->cd_len)
+        return pas_zip__writer_fail(w, PAS_ZIP_E_NOSPACE);
+
+    w->method = (uint16_t)method;
+    w->name_len = (uint16_t)name_len;
+    w->crc = 0;
+    w->comp_size = 0;
+    w->uncomp_size = 0;
+    w->entry_offset = w->offset;
+    w->started = 0;
+
+    if (method == PAS_ZIP_METHOD_DEFLATE) {
+#if defined(PAS_ZIP_HAS_INFLATE)
+        memset(&w->strm, 0, sizeof(w->strm));
+        w->arena.base = NULL;
+        if (work) {
+            if (pas_zip__arena_init(&w->arena, work, work_size) != PAS_ZIP_OK)
+                return pas_zip__writer_fail(w, PAS_ZIP_E_NOSPACE);
+            w->strm.zalloc = pas_zip__zalloc;
+            w->strm.zfree = pas_zip__zfree;
+            w->strm.opaque = &w->arena;
+        }
+        if (pas_zip__deflate_init2(&w->strm) != PAS_ZIP__Z_OK)
+            return pas_zip__writer_fail(w, work ? PAS_ZIP_E_NOSPACE : PAS_ZIP_E_ZLIB);
+        w->started = 1;
+#else
+        (void)work;
+        (void)work_size;
+        return pas_zip__writer_fail(w, PAS_ZIP_E_COMPRESSED);
+#endif
+    }
+
+    write_u32_le(hdr, PAS_ZIP_LFH_SIG);
+    write_u16_le(hdr + 4, 20);                  /* version needed */
+    write_u16_le(hdr + 6, 0x0008);              /* sizes and crc follow in a data descriptor */
+    write_u16_le(hdr + 8, (uint16_t)method);
+    write_u32_le(hdr + 10, 0);                  /* mod time, mod date */
+    write_u32_le(hdr + 14, 0);                  /* crc */
+    write_u32_le(hdr + 18, 0);                  /* compressed size */
+    write_u32_le(hdr + 22, 0);                  /* uncompressed size */
+    write_u16_le(hdr + 26, (uint16_t)name_len);
+    write_u16_le(hdr + 28, 0);                  /* extra len */
+    memcpy(w->cd + w->cd_len + 46, name, name_len);
+    w->in_entry = 1;
+    if (pas_zip__emit(w, hdr, sizeof(hdr)) != PAS_ZIP_OK) return w->error;
+    return pas_zip__emit(w, name, name_len);
+}
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+/* Runs the compressor over in/size with the given flush mode, sinking output. */
+static pas_zip_status pas_zip__writer_deflate(pas_zip_writer_t *w, const uint8_t *in, size_t size, int flush) {
+    uint8_t out[PAS_ZIP__WRITER_CHUNK];
+
+    for (;;) {
+        size_t chunk = size > PAS_ZIP__CHUNK_MAX ? PAS_ZIP__CHUNK_MAX : size;
+        size_t made;
+        int last = chunk == size;
+        int r;
+
+        w->strm.next_in = (unsigned char *)in;
+        w->strm.avail_in = (unsigned)chunk;
+        do {
+            w->strm.next_out = out;
+            w->strm.avail_out = sizeof(out);
+            r = pas_zip__deflate_step(&w->strm, last ? flush : PAS_ZIP__Z_NO_FLUSH);
+            if (r != PAS_ZIP__Z_OK && r != PAS_ZIP__Z_STREAM_END && r != PAS_ZIP__Z_BUF_ERROR)
+                return pas_zip__writer_fail(w, PAS_ZIP_E_ZLIB);
+            made = sizeof(out) - w->strm.avail_out;
+            w->comp_size += made;
+            if (pas_zip__emit(w, out, made) != PAS_ZIP_OK) return w->error;
+        } while (w->strm.avail_out == 0 || (flush == PAS_ZIP__Z_FINISH && last && r != PAS_ZIP__Z_STREAM_END));
+        in += chunk;
+        size -= chunk;
+        if (last) return PAS_ZIP_OK;
+    }
+}
+#endif
+
+pas_zip_status pas_zip_writer_entry_write(pas_zip_writer_t *w, const void *data, size_t size) {
+    if (!w || !w->sink) return PAS_ZIP_E_INVALID;
+    if (w->error) return w->error;
+    if (!w->in_entry || (!data && size)) return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+    if (size == 0) return PAS_ZIP_OK;
+
+    w->crc = pas_zip_crc32(w->crc, data, size);
+    w->uncomp_size += size;
+#if defined(PAS_ZIP_HAS_INFLATE)
+    if (w->method == PAS_ZIP_METHOD_DEFLATE)
+        return pas_zip__writer_deflate(w, (const uint8_t *)data, size, PAS_ZIP__Z_NO_FLUSH);
+#endif
+    w->comp_size += size;
+    return pas_zip__emit(w, data, size);
+}
+
+pas_zip_status pas_zip_writer_entry_end(pas_zip_writer_t *w) {
+    uint8_t dd[24];
+    uint8_t *p;
+    size_t extra;
+    int big, far;
+
+    if (!w || !w->sink) return PAS_ZIP_E_INVALID;
+    if (w->error) return w->error;
+    if (!w->in_entry) return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+    if (w->method == PAS_ZIP_METHOD_DEFLATE) {
+        pas_zip_status st = pas_zip__writer_deflate(w, NULL, 0, PAS_ZIP__Z_FINISH);
+        pas_zip__deflate_free(&w->strm);
+        w->started = 0;
+        if (st != PAS_ZIP_OK) return st;
+    }
+#endif
+
+    /* Data descriptor; sizes widen to 8 bytes once either passes 32 bits,
+       which readers that take sizes from the central directory accept. */
+    big = w->comp_size >= PAS_ZIP_U32_MAX || w->uncomp_size >= PAS_ZIP_U32_MAX;
+    write_u32_le(dd, PAS_ZIP_DD_SIG);
+    write_u32_le(dd + 4, w->crc);
+    if (big) {
+        write_u64_le(dd + 8, w->comp_size);
+        write_u64_le(dd + 16, w->uncomp_size);
+    } else {
+        write_u32_le(dd + 8, (uint32_t)w->comp_size);
+        write_u32_le(dd + 12, (uint32_t)w->uncomp_size);
+    }
+    if (pas_zip__emit(w, dd, big ? 24 : 16) != PAS_ZIP_OK) return w->error;
+
+    far = w->entry_offset >= PAS_ZIP_U32_MAX;
+    extra = (big ? 16 : 0) + (far ? 8 : 0);
+    if (extra) extra += 4;
+
+    p = w->cd + w->cd_len;
+    write_u32_le(p, PAS_ZIP_CDH_SIG);
+    write_u16_le(p + 4, extra ? 45 : 20);       /* version made by */
+    write_u16_le(p + 6, extra ? 45 : 20);       /* version needed */
+    write_u16_le(p + 8, 0x0008);                /* flags */
+    write_u16_le(p + 10, w->method);
+    write_u32_le(p + 12, 0);                    /* mod time, mod date */
+    write_u32_le(p + 16, w->crc);
+    write_u32_le(p + 20, big ? PAS_ZIP_U32_MAX : (uint32_t)w->comp_size);
+    write_u32_le(p + 24, big ? PAS_ZIP_U32_MAX : (uint32_t)w->uncomp_size);
+    write_u16_le(p + 28, w->name_len);
+    write_u16_le(p + 30, (uint16_t)extra);
+    write_u16_le(p + 32, 0);                    /* comment */
+    write_u16_le(p + 34, 0);                    /* disk */
+    write_u16_le(p + 36, 0);                    /* internal attrs */
+    write_u32_le(p + 38, 0);                    /* external attrs */
+    write_u32_le(p + 42, far ? PAS_ZIP_U32_MAX : (uint32_t)w->entry_offset);
+    if (extra) {
+        uint8_t *x = p + 46 + w->name_len;
+        write_u16_le(x, PAS_ZIP_EXTRA_ZIP64);
+        write_u16_le(x + 2, (uint16_t)(extra - 4));
+        x += 4;
+        if (big) { write_u64_le(x, w->uncomp_size); write_u64_le(x + 8, w->comp_size); x += 16; }
+        if (far) write_u64_le(x, w->entry_offset);
+    }
+    w->cd_len += 46 + w->name_len + extra;
+    w->count++;
+    w->in_entry = 0;
+    return PAS_ZIP_OK;
+}
+
+pas_zip_status pas_zip_writer_add(pas_zip_writer_t *w, const char *name, const void *data, size_t size,
+                                  int method, void *work, size_t work_size) {
+    pas_zip_status st = pas_zip_writer_entry_begin(w, name, method, work, work_size);
+
+    if (st == PAS_ZIP_OK) st = pas_zip_writer_entry_write(w, data, size);
+    if (st == PAS_ZIP_OK) st = pas_zip_writer_entry_end(w);
+    return st;
+}
+
+pas_zip_status pas_zip_writer_finish(pas_zip_writer_t *w) {
+    uint8_t end[56 + 20 + 22];
+    uint8_t *p = end;
+    uint64_t cd_offset, cd_size;
+
+    if (!w || !w->sink) return PAS_ZIP_E_INVALID;
+    if (w->error) return w->error;
+    if (w->in_entry) return pas_zip__writer_fail(w, PAS_ZIP_E_INVALID);
+
+    cd_offset = w->offset;
+    cd_size = w->cd_len;
+    if (pas_zip__emit(w, w->cd, w->cd_len) != PAS_ZIP_OK) return w->error;
+
+    if (w->count >= 0xFFFF || cd_size >= PAS_ZIP_U32_MAX || cd_offset >= PAS_ZIP_U32_MAX) {
+        write_u32_le(p, PAS_ZIP_EOCD64_SIG);
+        write_u64_le(p + 4, 44);                /* size of the rest of the record */
+        write_u16_le(p + 12, 45);               /* version made by */
+        write_u16_le(p + 14, 45);               /* version needed */
+        write_u32_le(p + 16, 0);                /* this disk */
+        write_u32_le(p + 20, 0);                /* disk with CD */
+        write_u64_le(p + 24, w->count);
+        write_u64_le(p + 32, w->count);
+        write_u64_le(p + 40, cd_size);
+        write_u64_le(p + 48, cd_offset);
+        p += 56;
+        write_u32_le(p, PAS_ZIP_LOC64_SIG);
+        write_u32_le(p + 4, 0);                 /* disk with ZIP64 end record */
+        write_u64_le(p + 8, cd_offset + cd_size);
+        write_u32_le(p + 16, 1);                /* total disks */
+        p += 20;
+    }
+    write_u32_le(p, PAS_ZIP_EOCD_SIG);
+    write_u32_le(p + 4, 0);                     /* disk numbers */
+    write_u16_le(p + 8, w->count >= 0xFFFF ? 0xFFFF : (uint16_t)w->count);
+    write_u16_le(p + 10, w->count >= 0xFFFF ? 0xFFFF : (uint16_t)w->count);
+    write_u32_le(p + 12, cd_size >= PAS_ZIP_U32_MAX ? PAS_ZIP_U32_MAX : (uint32_t)cd_size);
+    write_u32_le(p + 16, cd_offset >= PAS_ZIP_U32_MAX ? PAS_ZIP_U32_MAX : (uint32_t)cd_offset);
+    write_u16_le(p + 20, 0);                    /* comment len */
+    p += 22;
+    return pas_zip__emit(w, end, (size_t)(p - end));
+}
+
 #endif /* PAS_ZIP_IMPLEMENTATION */
 
 #endif /* PAS_ZIP_H */
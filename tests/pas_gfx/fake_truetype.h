@@ -0,0 +1,156 @@
+/*
+    fake_truetype.h - Deterministic stand-in for the parts of stb_truetype pas_gfx.h uses,
+    so the TTF text paths can be tested without a font file. Counts rasterizations and kerning lookups.
+    Glyph index = code point; units per em 100; 'A' followed by 'V' kerns by -20.
+*/
+
+#ifndef FAKE_TRUETYPE_H
+#define FAKE_TRUETYPE_H
+
+#include <stdlib.h>
+
+typedef struct stbtt_fontinfo {
+    void                *userdata;
+    const unsigned char *data;
+    int                  fontstart;
+} stbtt_fontinfo;
+
+/* Shapes carry only their glyph index: x holds the low 15 bits, y the rest. */
+typedef struct {
+    short x, y, cx, cy, cx1, cy1;
+    unsigned char type, padding;
+} stbtt_vertex;
+
+typedef struct {
+    int w, h, stride;
+    unsigned char *pixels;
+} stbtt__bitmap;
+
+static int g_fake_raster, g_fake_kern;
+
+/* test_tiles.c calls in from several threads */
+#if defined(__GNUC__)
+#define FAKE_TRUETYPE_COUNT(n) ((void)__atomic_fetch_add(&(n), 1, __ATOMIC_RELAXED))
+#else
+#define FAKE_TRUETYPE_COUNT(n) ((void)++(n))
+#endif
+
+static int stbtt_GetFontOffsetForIndex(const unsigned char *data, int index)
+{
+    (void)data;
+    return index == 0 ? 0 : -1;
+}
+
+static int stbtt_InitFont(stbtt_fontinfo *info, const unsigned char *data, int offset)
+{
+    info->data = data;
+    info->fontstart = offset;
+    return 1;
+}
+
+static float stbtt_ScaleForPixelHeight(const stbtt_fontinfo *info, float height)
+{
+    (void)info;
+    return height / 100.0f;
+}
+
+static void stbtt_GetFontVMetrics(const stbtt_fontinfo *info, int *ascent, int *descent, int *line_gap)
+{
+    (void)info;
+    *ascent = 80;
+    *descent = -20;
+    *line_gap = 10;
+}
+
+static int stbtt_FindGlyphIndex(const stbtt_fontinfo *info, int cp)
+{
+    (void)info;
+    return cp;
+}
+
+static void stbtt_GetGlyphHMetrics(const stbtt_fontinfo *info, int g, int *advance, int *lsb)
+{
+    (void)info;
+    if (advance) *advance = 60 + g % 3 * 10;
+    if (lsb) *lsb = 5;
+}
+
+static void fake_glyph_units(int g, int *w, int *h)
+{
+    *w = g == ' ' ? 0 : g == 0x1F600 ? 800 : 40 + g % 5 * 10;
+    *h = g == ' ' ? 0 : g == 0x1F600 ? 700 : 80;
+}
+
+static void stbtt_GetGlyphBitmapBox(const stbtt_fontinfo *info, int g, float sx, float sy,
+                                    int *x0, int *y0, int *x1, int *y1)
+{
+    int w, h;
+    (void)info;
+    fake_glyph_units(g, &w, &h);
+    if (!w) {
+        *x0 = *y0 = *x1 = *y1 = 0;
+        return;
+    }
+    *x0 = (int)(5 * sx);
+    *y0 = -(int)(h * sy);
+    *x1 = *x0 + (int)(w * sx);
+    *y1 = 1;
+}
+
+/* Coverage of glyph g at (x, y) in its bitmap box. */
+static unsigned char fake_glyph_pixel(int g, int x, int y)
+{
+    return (unsigned char)(x == 0 ? 0 : y == 0 ? 255 : g * 7 + x * 37 + y * 11);
+}
+
+static void stbtt_MakeGlyphBitmap(const stbtt_fontinfo *info, unsigned char *out, int w, int h, int stride,
+                                  float sx, float sy, int g)
+{
+    int x, y;
+    (void)info; (void)sx; (void)sy;
+    FAKE_TRUETYPE_COUNT(g_fake_raster);
+    for (y = 0; y < h; ++y)
+        for (x = 0; x < w; ++x)
+            out[y * stride + x] = fake_glyph_pixel(g, x, y);
+}
+
+static int stbtt_GetGlyphShape(const stbtt_fontinfo *info, int g, stbtt_vertex **vertices)
+{
+    stbtt_vertex *v = (stbtt_vertex *)calloc(1, sizeof(*v));
+    (void)info;
+    *vertices = v;
+    if (!v) return 0;
+    v->x = (short)(g & 0x7FFF);
+    v->y = (short)(g >> 15);
+    return 1;
+}
+
+static void stbtt_FreeShape(const stbtt_fontinfo *info, stbtt_vertex *v)
+{
+    (void)info;
+    free(v);
+}
+
+/* The w x h window of the glyph bitmap at (x_off, y_off) in pixel space, as if the box
+   started at the glyph's stbtt_GetGlyphBitmapBox origin. */
+static void stbtt_Rasterize(stbtt__bitmap *result, float flatness, stbtt_vertex *v, int n,
+                            float sx, float sy, float shift_x, float shift_y,
+                            int x_off, int y_off, int invert, void *userdata)
+{
+    int g = v[0].x | v[0].y << 15, x0, y0, x1, y1, x, y;
+    (void)flatness; (void)n; (void)shift_x; (void)shift_y; (void)invert; (void)userdata;
+    FAKE_TRUETYPE_COUNT(g_fake_raster);
+    stbtt_GetGlyphBitmapBox(NULL, g, sx, sy, &x0, &y0, &x1, &y1);
+    for (y = 0; y < result->h; ++y)
+        for (x = 0; x < result->w; ++x)
+            result->pixels[y * result->stride + x] = fake_glyph_pixel(g, x + x_off - x0, y + y_off - y0);
+}
+
+static int stbtt_GetGlyphKernAdvance(const stbtt_fontinfo *info, int a, int b)
+{
+    (void)info;
+    FAKE_TRUETYPE_COUNT(g_fake_kern);
+    return a == 'A' && b == 'V' ? -20 : 0;
+}
+
+#endif /* FAKE_TRUETYPE_H */
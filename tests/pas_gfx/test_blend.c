@@ -0,0 +1,203 @@
+/*
+    test_blend.c - Test pas_gfx_bitmap blending against a per-pixel reference with divisions:
+    straight and premultiplied alpha, random coverage and colors, opaque runs, clipping.
+    From repo root: gcc -o tests/pas_gfx/test_blend tests/pas_gfx/test_blend.c -I.
+*/
+
+#define PAS_GFX_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W     45
+#define H     9
+#define PITCH 48
+
+/* The original blend: straight alpha, three divisions. */
+static uint32_t ref_straight(uint32_t dst, uint32_t src, uint32_t cov)
+{
+    uint32_t a = ((src >> 24) * cov + 127) / 255, inv = 255 - a, out[3];
+    int k;
+    for (k = 0; k < 3; ++k)
+        out[k] = (((src >> (8 * k)) & 0xFF) * a + ((dst >> (8 * k)) & 0xFF) * inv + 127) / 255;
+    return PAS_GFX_RGBA((dst >> 24) | a, out[2], out[1], out[0]);
+}
+
+/* Premultiplied "over" with coverage. */
+static uint32_t ref_premul(uint32_t dst, uint32_t src, uint32_t cov)
+{
+    uint32_t a = ((src >> 24) * cov + 127) / 255, inv = 255 - a, out[4];
+    int k;
+    for (k = 0; k < 4; ++k)
+        out[k] = (((src >> (8 * k)) & 0xFF) * cov + ((dst >> (8 * k)) & 0xFF) * inv + 127) / 255;
+    return PAS_GFX_RGBA(out[3], out[2], out[1], out[0]);
+}
+
+static unsigned g_seed = 777u;
+
+static uint32_t rnd(void)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return g_seed >> 8;
+}
+
+/* Coverage with long zero and full runs, like rasterized glyphs. */
+static uint8_t rnd_cov(void)
+{
+    uint32_t r = rnd() % 8;
+    if (r < 2) return 0;
+    if (r < 4) return 255;
+    return (uint8_t)rnd();
+}
+
+static void run_random(int premul, int *ok)
+{
+    static uint32_t got[H * PITCH], want[H * PITCH];
+    uint8_t mask[W * H + 64];
+    pas_gfx_fb_t *fb;
+    int n, i;
+
+    fb = pas_gfx_init(got, W, H, PITCH);
+    fb->flags = premul ? PAS_GFX_FB_PREMULTIPLIED : 0;
+    for (i = 0; i < H * PITCH; ++i) got[i] = rnd() ^ (rnd() << 16);
+    if (premul)
+        for (i = 0; i < H * PITCH; ++i) got[i] = pas_gfx_premultiply(got[i]);
+
+    for (n = 0; n < 3000 && *ok; ++n) {
+        int x = (int)(rnd() % (W + 20)) - 10, y = (int)(rnd() % (H + 4)) - 2;
+        int w = (int)(rnd() % 40) + 1, h = (int)(rnd() % 4) + 1, j;
+        uint32_t color = rnd() ^ (rnd() << 16);
+
+        if (n % 5 == 0) color |= 0xFF000000u;   /* opaque: the store-only path */
+        if (premul) color = pas_gfx_premultiply(color);
+        for (i = 0; i < w * h; ++i) mask[i] = rnd_cov();
+
+        memcpy(want, got, sizeof(got));
+        for (j = 0; j < h; ++j)
+            for (i = 0; i < w; ++i) {
+                int xx = x + i, yy = y + j;
+                uint32_t *d;
+                if (xx < 0 || xx >= W || yy < 0 || yy >= H || !mask[j * w + i]) continue;
+                d = &want[yy * PITCH + xx];
+                *d = premul ? ref_premul(*d, color, mask[j * w + i]) : ref_straight(*d, color, mask[j * w + i]);
+            }
+        pas_gfx_bitmap(fb, x, y, mask, w, h, color);
+        *ok = memcmp(got, want, sizeof(got)) == 0;
+    }
+}
+
+static void test_random(void)
+{
+    int ok = 1;
+    run_random(0, &ok);
+    ASSERT(ok);
+    ok = 1;
+    run_random(1, &ok);
+    ASSERT(ok);
+}
+
+/* Every (channel, alpha, coverage) combination through the vector and scalar paths. */
+static void test_exhaustive(void)
+{
+    static uint32_t row[256];
+    static uint8_t cov[256];
+    pas_gfx_fb_t *fb;
+    uint32_t a, c, i;
+    int ok = 1, pm_ok = 1;
+
+    fb = pas_gfx_init(row, 256, 1, 256);
+    for (i = 0; i < 256; ++i) cov[i] = (uint8_t)i;
+    for (a = 0; a < 256 && ok; a += 5)
+        for (c = 0; c < 256 && ok; c += 3) {
+            uint32_t color = PAS_GFX_RGBA(a, c, 255 - c, c / 2);
+            uint32_t dst = PAS_GFX_RGBA(255 - a, 255 - c, c, 200);
+            for (i = 0; i < 256; ++i) row[i] = dst;
+            pas_gfx_bitmap(fb, 0, 0, cov, 256, 1, color);
+            for (i = 1; i < 256; ++i) ok &= row[i] == ref_straight(dst, color, i);
+            ok &= row[0] == dst;
+        }
+    ASSERT(ok);
+
+    fb->flags = PAS_GFX_FB_PREMULTIPLIED;
+    for (a = 0; a < 256 && pm_ok; a += 5)
+        for (c = 0; c <= a && pm_ok; c += 3) {
+            uint32_t color = PAS_GFX_RGBA(a, c, a - c, c / 2);
+            uint32_t dst = pas_gfx_premultiply(PAS_GFX_RGBA(255 - a, 255, c, 200));
+            for (i = 0; i < 256; ++i) row[i] = dst;
+            pas_gfx_bitmap(fb, 0, 0, cov, 256, 1, color);
+            for (i = 0; i < 256; ++i) pm_ok &= row[i] == ref_premul(dst, color, i);
+        }
+    ASSERT(pm_ok);
+}
+
+static void test_cases(void)
+{
+    uint32_t buf[8 * 4];
+    uint8_t mask[16];
+    pas_gfx_fb_t *fb;
+    int i, ok = 1;
+
+    /* opaque over anything at full coverage: the color itself */
+    fb = pas_gfx_init(buf, 8, 4, 8);
+    for (i = 0; i < 32; ++i) buf[i] = 0x12345678u;
+    memset(mask, 255, sizeof(mask));
+    pas_gfx_bitmap(fb, 0, 0, mask, 8, 2, PAS_GFX_RED);
+    for (i = 0; i < 16; ++i) ok &= buf[i] == PAS_GFX_RED;
+    ASSERT(ok);
+    ASSERT_EQ(buf[16], 0x12345678u);
+
+    /* zero coverage leaves dst untouched, alpha included */
+    memset(mask, 0, sizeof(mask));
+    buf[0] = 0x00ABCDEFu;
+    pas_gfx_bitmap(fb, 0, 0, mask, 8, 2, PAS_GFX_RED);
+    ASSERT_EQ(buf[0], 0x00ABCDEFu);
+
+    /* negative origin: the mask is entered at the clipped offset */
+    for (i = 0; i < 16; ++i) mask[i] = (uint8_t)(i == 5 ? 255 : 0);
+    for (i = 0; i < 32; ++i) buf[i] = 0;
+    pas_gfx_bitmap(fb, -1, -1, mask, 4, 4, PAS_GFX_WHITE);   /* mask (1,1) lands on (0,0) */
+    ASSERT_EQ(buf[0], PAS_GFX_WHITE);
+    ASSERT_EQ(buf[1], 0u);
+
+    /* premultiplied: half red over transparent black stays premultiplied */
+    ASSERT_EQ(pas_gfx_premultiply(PAS_GFX_RGBA(128, 255, 100, 0)), PAS_GFX_RGBA(128, 128, 50, 0));
+    ASSERT_EQ(pas_gfx_premultiply(PAS_GFX_RGBA(0, 255, 255, 255)), 0u);
+    fb->flags = PAS_GFX_FB_PREMULTIPLIED;
+    buf[0] = 0;
+    mask[0] = 255;
+    pas_gfx_bitmap(fb, 0, 0, mask, 1, 1, pas_gfx_premultiply(PAS_GFX_RGBA(128, 255, 100, 0)));
+    ASSERT_EQ(buf[0], PAS_GFX_RGBA(128, 128, 50, 0));
+
+    /* channels above alpha are clamped, not overflowed */
+    buf[0] = PAS_GFX_WHITE;
+    pas_gfx_bitmap(fb, 0, 0, mask, 1, 1, PAS_GFX_RGBA(0, 255, 255, 255));
+    ASSERT_EQ(buf[0], PAS_GFX_WHITE);
+
+    pas_gfx_bitmap(NULL, 0, 0, mask, 1, 1, PAS_GFX_RED);
+    pas_gfx_bitmap(fb, 0, 0, NULL, 1, 1, PAS_GFX_RED);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_random();
+    test_exhaustive();
+    test_cases();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
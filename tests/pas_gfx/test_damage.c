@@ -0,0 +1,181 @@
+/*
+    test_damage.c - Test fb->damage: every primitive reports what it changed, rects merge,
+    the list never passes its capacity, reset and manual add.
+    Uses tests/pas_gfx/fake_truetype.h in place of stb_truetype for the text primitive.
+    From repo root: gcc -o tests/pas_gfx/test_damage tests/pas_gfx/test_damage.c -I.
+*/
+
+#define PAS_GFX_USE_STB_TRUETYPE
+#define PAS_GFX_STB_TRUETYPE_PATH "tests/pas_gfx/fake_truetype.h"
+#define PAS_GFX_IMPLEMENTATION
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W 90
+#define H 60
+
+static int rect_is(const pas_gfx_rect_t *r, int x, int y, int w, int h)
+{
+    return r->x == x && r->y == y && r->w == w && r->h == h;
+}
+
+/* Pixels that differ between before and after all lie inside some damage rect, each inside the fb. */
+static int covered(const uint32_t *before, const uint32_t *after, const pas_gfx_damage_t *d)
+{
+    int x, y, i;
+    for (i = 0; i < d->count; ++i) {
+        const pas_gfx_rect_t *r = &d->rects[i];
+        if (r->x < 0 || r->y < 0 || r->w <= 0 || r->h <= 0 || r->x + r->w > W || r->y + r->h > H) return 0;
+    }
+    for (y = 0; y < H; ++y)
+        for (x = 0; x < W; ++x) {
+            int in = 0;
+            if (before[y * W + x] == after[y * W + x]) continue;
+            for (i = 0; i < d->count && !in; ++i) {
+                const pas_gfx_rect_t *r = &d->rects[i];
+                in = x >= r->x && x < r->x + r->w && y >= r->y && y < r->y + r->h;
+            }
+            if (!in) return 0;
+        }
+    return 1;
+}
+
+static unsigned g_seed = 4242u;
+
+static int rnd(int lo, int hi)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return lo + (int)((g_seed >> 8) % (unsigned)(hi - lo + 1));
+}
+
+static void test_every_primitive(void)
+{
+    static uint32_t px[W * H], before[W * H];
+    static unsigned char ttf[4];
+    static uint8_t mask[20 * 20];
+    pas_gfx_rect_t rects[6];
+    pas_gfx_damage_t damage;
+    pas_gfx_fb_t *fb;
+    pas_font_t *font;
+    int n, i, ok = 1, bounded = 1;
+
+    for (i = 0; i < (int)sizeof(mask); ++i) mask[i] = (uint8_t)(i * 7);
+    font = pas_gfx_font_open(ttf, 14.0f);
+    fb = pas_gfx_init(px, W, H, W);
+    pas_gfx_damage_init(&damage, rects, 6);
+    fb->damage = &damage;
+
+    for (n = 0; n < 600 && ok; ++n) {
+        int x = rnd(-30, W), y = rnd(-20, H), w = rnd(3, 40), h = rnd(3, 30);
+        uint32_t c = (uint32_t)rnd(0, 0xFFFFFF) | 0x80000000u;
+
+        if (n % 4 == 0) {
+            memset(px, 0, sizeof(px));
+            pas_gfx_damage_reset(&damage);
+        }
+        memcpy(before, px, sizeof(px));
+        switch (n % 10) {
+        case 0: pas_gfx_rect(fb, x, y, w, h, c); break;
+        case 1: pas_gfx_line(fb, x, y, rnd(-30, W + 30), rnd(-20, H + 20), c); break;
+        case 2: pas_gfx_line(fb, x, y, x + w, y, c); break;
+        case 3: pas_gfx_pixel(fb, x, y, c); break;
+        case 4: pas_gfx_circle(fb, x, y, w / 2, c); break;
+        case 5: pas_gfx_bitmap(fb, x, y, mask, 20, 20, c); break;
+        case 6: pas_gfx_window_frame(fb, x, y, w + 20, h + 20, "A long window title", c); break;
+        case 7: pas_gfx_button(fb, x, y, w, h, rnd(0, 1) ? "OK" : "Cancel button", rnd(0, 1)); break;
+        case 8: pas_gfx_text(fb, font, x, y, "Hi AV\nthere", c); break;
+        default: pas_gfx_vline(fb, x, y, h, c); break;
+        }
+        ok = covered(before, px, &damage);
+        bounded &= damage.count <= 6;
+    }
+    ASSERT(ok);
+    ASSERT(bounded);
+    ASSERT(fb->damage == &damage);   /* compound primitives restore it */
+}
+
+static void test_merging(void)
+{
+    static uint32_t px[W * H];
+    pas_gfx_rect_t rects[3];
+    pas_gfx_damage_t damage;
+    pas_gfx_fb_t *fb;
+
+    fb = pas_gfx_init(px, W, H, W);
+    ASSERT(fb->damage == NULL);
+    pas_gfx_rect(fb, 0, 0, 4, 4, PAS_GFX_RED);   /* untracked */
+    pas_gfx_damage_init(&damage, rects, 3);
+    fb->damage = &damage;
+
+    /* clipped to the fb; nothing drawn, nothing reported */
+    pas_gfx_rect(fb, -5, -5, 10, 8, PAS_GFX_RED);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 0, 0, 5, 3));
+    pas_gfx_rect(fb, W + 1, 0, 10, 10, PAS_GFX_RED);
+    pas_gfx_rect(fb, 3, 3, 0, 10, PAS_GFX_RED);
+    ASSERT_EQ(damage.count, 1);
+
+    /* contained: absorbed; side by side: one rect */
+    pas_gfx_pixel(fb, 1, 1, PAS_GFX_RED);
+    ASSERT_EQ(damage.count, 1);
+    pas_gfx_rect(fb, 5, 0, 5, 3, PAS_GFX_RED);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 0, 0, 10, 3));
+
+    /* far apart: kept separate */
+    pas_gfx_rect(fb, 50, 40, 4, 4, PAS_GFX_RED);
+    pas_gfx_rect(fb, 80, 2, 4, 4, PAS_GFX_RED);
+    ASSERT_EQ(damage.count, 3);
+
+    /* full: merged into the one it grows least */
+    pas_gfx_rect(fb, 56, 40, 4, 4, PAS_GFX_RED);
+    ASSERT_EQ(damage.count, 3);
+    ASSERT(rect_is(&rects[0], 0, 0, 10, 3) && rect_is(&rects[1], 80, 2, 4, 4) && rect_is(&rects[2], 50, 40, 10, 4));
+
+    /* a union that swallows others cascades */
+    pas_gfx_rect(fb, 0, 0, W, H, PAS_GFX_BLUE);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 0, 0, W, H));
+
+    /* compound primitives report once */
+    pas_gfx_damage_reset(&damage);
+    ASSERT_EQ(damage.count, 0);
+    pas_gfx_window_frame(fb, 10, 10, 60, 40, "Hi", PAS_GFX_GRAY);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 10, 10, 60, 40));
+    pas_gfx_damage_reset(&damage);
+    pas_gfx_button(fb, 5, 5, 30, 12, "OK", 0);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 5, 5, 30, 12));
+
+    /* manual add for pixels written directly */
+    pas_gfx_damage_reset(&damage);
+    pas_gfx_damage_add(fb, 20, 20, 3, 3);
+    ASSERT(damage.count == 1 && rect_is(&rects[0], 20, 20, 3, 3));
+
+    /* no capacity: ignored */
+    pas_gfx_damage_init(&damage, NULL, 5);
+    pas_gfx_rect(fb, 0, 0, 4, 4, PAS_GFX_RED);
+    ASSERT_EQ(damage.count, 0);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_every_primitive();
+    test_merging();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
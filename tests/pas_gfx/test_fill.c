@@ -0,0 +1,177 @@
+/*
+    test_fill.c - Test span fills: pas_gfx_rect, pas_gfx_hline, pas_gfx_vline and axis-aligned pas_gfx_line
+    against a per-pixel reference, with clipping, odd alignments and a pitch wider than the fb.
+    From repo root: gcc -o tests/pas_gfx/test_fill tests/pas_gfx/test_fill.c -I.
+*/
+
+#define PAS_GFX_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W     37
+#define H     23
+#define PITCH 41
+#define FILL  0xDEADBEEFu
+
+/* Per-pixel reference: the old rect loop, with the pad columns out of bounds. */
+static void ref_rect(uint32_t *px, int x, int y, int w, int h, uint32_t color)
+{
+    int i, j;
+    for (j = 0; j < h; ++j)
+        for (i = 0; i < w; ++i)
+            if (x + i >= 0 && x + i < W && y + j >= 0 && y + j < H) px[(y + j) * PITCH + x + i] = color;
+}
+
+static unsigned g_seed = 12345u;
+
+static int rnd(int lo, int hi)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return lo + (int)((g_seed >> 8) % (unsigned)(hi - lo + 1));
+}
+
+static void test_random(void)
+{
+    static uint32_t got[H * PITCH], want[H * PITCH];
+    pas_gfx_fb_t *fb;
+    int n, ok = 1;
+
+    fb = pas_gfx_init(got, W, H, PITCH);
+    for (n = 0; n < 2000 && ok; ++n) {
+        int x = rnd(-10, W + 2), y = rnd(-10, H + 2), w = rnd(-2, W + 12), h = rnd(-2, H + 12);
+        uint32_t color = (uint32_t)n * 2654435761u;
+        int kind = n % 3;
+
+        memcpy(want, got, sizeof(got));
+        if (kind == 0) {
+            pas_gfx_rect(fb, x, y, w, h, color);
+            ref_rect(want, x, y, w, h, color);
+        } else if (kind == 1) {
+            pas_gfx_hline(fb, x, y, w, color);
+            ref_rect(want, x, y, w, 1, color);
+        } else {
+            pas_gfx_vline(fb, x, y, h, color);
+            ref_rect(want, x, y, 1, h, color);
+        }
+        ok = memcmp(got, want, sizeof(got)) == 0;
+    }
+    ASSERT(ok);
+}
+
+static void test_edges(void)
+{
+    static uint32_t buf[H * PITCH], want[H * PITCH];
+    uint32_t full[16 * 16];
+    pas_gfx_fb_t *fb;
+    int i, pad_ok = 1, ok = 1;
+
+    for (i = 0; i < H * PITCH; ++i) buf[i] = FILL;
+    fb = pas_gfx_init(buf, W, H, PITCH);
+
+    /* whole fb: every visible pixel, no pad column */
+    pas_gfx_rect(fb, -5, -5, W + 10, H + 10, PAS_GFX_BLUE);
+    for (i = 0; i < H * PITCH; ++i) {
+        if (i % PITCH < W) ok &= buf[i] == PAS_GFX_BLUE;
+        else pad_ok &= buf[i] == FILL;
+    }
+    ASSERT(ok);
+    ASSERT(pad_ok);
+
+    /* coordinates that overflow x + w */
+    memcpy(want, buf, sizeof(buf));
+    pas_gfx_rect(fb, INT_MAX - 3, 0, INT_MAX, 5, PAS_GFX_RED);
+    pas_gfx_rect(fb, INT_MIN, 0, 10, 5, PAS_GFX_RED);
+    pas_gfx_hline(fb, 2, 2, 0, PAS_GFX_RED);
+    pas_gfx_vline(fb, 2, 2, -4, PAS_GFX_RED);
+    ASSERT(memcmp(want, buf, sizeof(buf)) == 0);
+    pas_gfx_rect(fb, 1, INT_MIN + 1, 2, INT_MAX, PAS_GFX_RED);   /* ends at y = 0 */
+    ASSERT(memcmp(want, buf, sizeof(buf)) == 0);
+    pas_gfx_hline(fb, INT_MIN, 0, INT_MAX, PAS_GFX_RED);
+    ASSERT(memcmp(want, buf, sizeof(buf)) == 0);
+    pas_gfx_hline(fb, INT_MIN + 2, 1, INT_MAX, PAS_GFX_RED);     /* ends at x = 1 */
+    ASSERT(buf[PITCH] == PAS_GFX_RED && buf[PITCH + 1] == PAS_GFX_BLUE);
+
+    /* pitch == width: rows filled as one span */
+    fb = pas_gfx_init(full, 16, 16, 16);
+    memset(full, 0, sizeof(full));
+    pas_gfx_rect(fb, 0, 3, 16, 5, PAS_GFX_GREEN);
+    ASSERT(full[2 * 16 + 15] == 0 && full[3 * 16] == PAS_GFX_GREEN);
+    ASSERT(full[7 * 16 + 15] == PAS_GFX_GREEN && full[8 * 16] == 0);
+
+    /* NULL fb and pixels are ignored */
+    pas_gfx_rect(NULL, 0, 0, 4, 4, PAS_GFX_RED);
+    pas_gfx_hline(NULL, 0, 0, 4, PAS_GFX_RED);
+    pas_gfx_vline(NULL, 0, 0, 4, PAS_GFX_RED);
+}
+
+/* Axis-aligned lines take the span path and match Bresenham's endpoints */
+static void test_lines(void)
+{
+    uint32_t buf[16 * 16];
+    pas_gfx_fb_t *fb;
+    int i, ok = 1;
+
+    fb = pas_gfx_init(buf, 16, 16, 16);
+    memset(buf, 0, sizeof(buf));
+    pas_gfx_line(fb, 12, 4, 3, 4, PAS_GFX_WHITE);      /* right to left */
+    for (i = 0; i < 16; ++i) ok &= buf[4 * 16 + i] == ((i >= 3 && i <= 12) ? PAS_GFX_WHITE : 0u);
+    ASSERT(ok);
+    pas_gfx_line(fb, 6, 14, 6, -20, PAS_GFX_RED);      /* bottom to top, clipped */
+    ok = 1;
+    for (i = 0; i < 16; ++i) ok &= buf[i * 16 + 6] == (i <= 14 ? PAS_GFX_RED : 0u);
+    ASSERT(ok);
+    pas_gfx_line(fb, 9, 9, 9, 9, PAS_GFX_GREEN);       /* single point */
+    ASSERT_EQ(buf[9 * 16 + 9], PAS_GFX_GREEN);
+    ASSERT_EQ(buf[9 * 16 + 10], 0u);
+}
+
+/* window_frame and button borders through the span path */
+static void test_frames(void)
+{
+    uint32_t buf[64 * 48];
+    pas_gfx_fb_t *fb;
+    int i, ok = 1;
+
+    fb = pas_gfx_init(buf, 64, 48, 64);
+    memset(buf, 0, sizeof(buf));
+    pas_gfx_window_frame(fb, -4, 2, 40, 30, NULL, PAS_GFX_GRAY);
+    for (i = 0; i < 36; ++i) ok &= buf[2 * 64 + i] == PAS_GFX_WHITE && buf[31 * 64 + i] == PAS_GFX_WHITE;
+    for (i = 2; i < 32; ++i) ok &= buf[i * 64 + 35] == PAS_GFX_WHITE;
+    ASSERT(ok);
+    ASSERT_EQ(buf[2 * 64 + 36], 0u);
+
+    memset(buf, 0, sizeof(buf));
+    pas_gfx_button(fb, 50, 40, 20, 12, NULL, 0);
+    ASSERT_EQ(buf[40 * 64 + 50], PAS_GFX_WHITE);
+    ASSERT_EQ(buf[40 * 64 + 63], PAS_GFX_WHITE);
+    ASSERT_EQ(buf[47 * 64 + 50], PAS_GFX_WHITE);
+    ASSERT_EQ(buf[39 * 64 + 50], 0u);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_random();
+    test_edges();
+    test_lines();
+    test_frames();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
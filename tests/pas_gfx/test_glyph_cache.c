@@ -0,0 +1,215 @@
+/*
+    test_glyph_cache.c - Test pas_gfx_text with and without the glyph cache: identical output,
+    no re-rasterization on hits, LRU eviction by slots and by atlas space, kerning memo, UTF-8, sizes.
+    Uses tests/pas_gfx/fake_truetype.h in place of stb_truetype.
+    From repo root: gcc -o tests/pas_gfx/test_glyph_cache tests/pas_gfx/test_glyph_cache.c -I.
+*/
+
+#define PAS_GFX_USE_STB_TRUETYPE
+#define PAS_GFX_STB_TRUETYPE_PATH "tests/pas_gfx/fake_truetype.h"
+#define PAS_GFX_IMPLEMENTATION
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W 320
+#define H 120
+
+static uint32_t g_plain[W * H], g_cached[W * H];
+static const unsigned char g_ttf[4];
+
+/* Draws text uncached into g_plain and through cache into g_cached; 1 if they match. */
+static int same_output(pas_font_t *font, pas_gfx_glyph_cache_t *cache, const char *text)
+{
+    pas_gfx_fb_t *fb;
+
+    memset(g_plain, 0, sizeof(g_plain));
+    memset(g_cached, 0, sizeof(g_cached));
+    fb = pas_gfx_init(g_plain, W, H, W);
+    font->cache = NULL;
+    pas_gfx_text(fb, font, 3, 2, text, PAS_GFX_WHITE);
+    fb = pas_gfx_init(g_cached, W, H, W);
+    font->cache = cache;
+    pas_gfx_text(fb, font, 3, 2, text, PAS_GFX_WHITE);
+    return memcmp(g_plain, g_cached, sizeof(g_plain)) == 0;
+}
+
+static int cached(const pas_gfx_glyph_cache_t *c, uint32_t cp)
+{
+    int i;
+    for (i = 0; i < c->capacity; ++i)
+        if (c->glyphs[i].font && c->glyphs[i].codepoint == cp) return 1;
+    return 0;
+}
+
+static int lit(const uint32_t *px)
+{
+    int i;
+    for (i = 0; i < W * H; ++i)
+        if (px[i]) return 1;
+    return 0;
+}
+
+static void test_cache(void)
+{
+    static pas_gfx_glyph_cache_t cache;
+    static pas_gfx_glyph_t glyphs[32];
+    static uint8_t atlas[64 * 1024];
+    pas_font_t *font;
+    unsigned long misses;
+    int raster;
+
+    font = pas_gfx_font_open(g_ttf, 20.0f);
+    ASSERT(font != NULL && font->cache == NULL);
+    pas_gfx_glyph_cache_init(&cache, glyphs, 32, atlas, sizeof(atlas));
+
+    /* same pixels as the uncached path, multiline and kerned */
+    ASSERT(same_output(font, &cache, "Hello AVA\nWorld"));
+    ASSERT(lit(g_cached));
+
+    /* second draw: every glyph a hit, nothing rasterized, kerning memoised */
+    raster = g_fake_raster;
+    misses = cache.misses;
+    g_fake_kern = 0;
+    pas_gfx_text(pas_gfx_init(g_cached, W, H, W), font, 3, 2, "Hello AVA\nWorld", PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster);
+    ASSERT_EQ(cache.misses, misses);
+    ASSERT(cache.hits >= 14);
+    ASSERT_EQ(g_fake_kern, 0);
+
+    /* UTF-8: one glyph per code point; an ill-formed byte is U+FFFD */
+    ASSERT(same_output(font, &cache, "caf\xC3\xA9 \xFF!"));
+    ASSERT(cached(&cache, 0xE9) && cached(&cache, 0xFFFD));
+    ASSERT(!cached(&cache, 0xC3) && !cached(&cache, 0xA9));
+
+    /* key includes the size */
+    raster = g_fake_raster;
+    font = pas_gfx_font_open(g_ttf, 30.0f);
+    font->cache = &cache;
+    pas_gfx_text(pas_gfx_init(g_cached, W, H, W), font, 0, 0, "H", PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster + 1);
+    font->size = 20.0f;
+    font->scale = 0.2f;
+    raster = g_fake_raster;
+    pas_gfx_text(pas_gfx_init(g_cached, W, H, W), font, 0, 0, "H", PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster);
+
+    /* glyphs past 128x128 are drawn from the atlas, and uncached in blocks */
+    ASSERT(same_output(font, &cache, "\xF0\x9F\x98\x80"));   /* U+1F600, 160x140 */
+    ASSERT(lit(g_cached));
+}
+
+/* A 320x281 glyph: cached whole, uncached or too big for the atlas in 128x128 blocks, same pixels. */
+static void test_big_glyph(void)
+{
+    static uint32_t ref[400 * 320], px[400 * 320];
+    static pas_gfx_glyph_cache_t cache;
+    static pas_gfx_glyph_t glyphs[4];
+    static uint8_t atlas[128 * 1024];
+    static const char smile[] = "\xF0\x9F\x98\x80";
+    pas_gfx_fb_t fb;
+    pas_font_t *font;
+    int raster;
+
+    font = pas_gfx_font_open(g_ttf, 40.0f);
+    pas_gfx_glyph_cache_init(&cache, glyphs, 4, atlas, sizeof(atlas));
+    font->cache = &cache;
+    memset(ref, 0, sizeof(ref));
+    pas_gfx_text(pas_gfx_fb_init(&fb, ref, 400, 320, 400), font, 0, 260, smile, PAS_GFX_WHITE);
+    ASSERT(cached(&cache, 0x1F600));
+    ASSERT(ref[12 * 400 + 3] != 0 && ref[290 * 400 + 300] != 0);   /* ink in the first and last blocks */
+
+    /* no cache */
+    font->cache = NULL;
+    memset(px, 0, sizeof(px));
+    raster = g_fake_raster;
+    pas_gfx_text(pas_gfx_fb_init(&fb, px, 400, 320, 400), font, 0, 260, smile, PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster + 9);
+    ASSERT(memcmp(ref, px, sizeof(ref)) == 0);
+
+    /* bigger than the atlas */
+    pas_gfx_glyph_cache_init(&cache, glyphs, 4, atlas, 4096);
+    font->cache = &cache;
+    memset(px, 0, sizeof(px));
+    pas_gfx_text(pas_gfx_fb_init(&fb, px, 400, 320, 400), font, 0, 260, smile, PAS_GFX_WHITE);
+    ASSERT(!cached(&cache, 0x1F600));
+    ASSERT(memcmp(ref, px, sizeof(ref)) == 0);
+
+    /* blocks outside the clip are not rasterized */
+    memset(px, 0, sizeof(px));
+    raster = g_fake_raster;
+    (void)pas_gfx_fb_init(&fb, px, 400, 320, 400);
+    (void)pas_gfx_clip_push(&fb, 200, 200, 20, 20);
+    pas_gfx_text(&fb, font, 0, 260, smile, PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster + 1);
+    ASSERT(px[210 * 400 + 210] == ref[210 * 400 + 210] && px[210 * 400 + 199] == 0);
+}
+
+static void test_lru(void)
+{
+    static pas_gfx_glyph_cache_t cache;
+    static pas_gfx_glyph_t glyphs[3];
+    static uint8_t atlas[16 * 1024];
+    pas_font_t *font;
+    int raster;
+
+    font = pas_gfx_font_open(g_ttf, 20.0f);
+    pas_gfx_glyph_cache_init(&cache, glyphs, 3, atlas, sizeof(atlas));
+
+    /* slots: the least recently used goes */
+    ASSERT(same_output(font, &cache, "ABC"));
+    ASSERT(same_output(font, &cache, "A"));        /* A now newest, B oldest */
+    ASSERT(same_output(font, &cache, "D"));
+    ASSERT(cached(&cache, 'A') && !cached(&cache, 'B') && cached(&cache, 'C') && cached(&cache, 'D'));
+    ASSERT_EQ(cache.evictions, 1ul);
+
+    /* more distinct glyphs than slots in one string still draws right */
+    ASSERT(same_output(font, &cache, "The quick brown fox"));
+
+    /* atlas space: K, L, M are 16 px tall and 8, 10, 12 wide; K + M fit in 400 bytes, K + L + M do not */
+    pas_gfx_glyph_cache_init(&cache, glyphs, 3, atlas, 400);
+    ASSERT(same_output(font, &cache, "KL"));
+    ASSERT(same_output(font, &cache, "K"));
+    ASSERT(same_output(font, &cache, "M"));   /* needs L's space */
+    ASSERT(cached(&cache, 'K') && !cached(&cache, 'L') && cached(&cache, 'M'));
+    ASSERT(same_output(font, &cache, "KLMNOP KLMNOP"));   /* spaces take no atlas */
+
+    /* a glyph bigger than the atlas is drawn uncached, every time */
+    raster = g_fake_raster;
+    pas_gfx_glyph_cache_init(&cache, glyphs, 3, atlas, 100);
+    font->cache = &cache;
+    pas_gfx_text(pas_gfx_init(g_cached, W, H, W), font, 0, 0, "WW", PAS_GFX_WHITE);
+    ASSERT_EQ(g_fake_raster, raster + 2);
+    ASSERT(lit(g_cached) && !cached(&cache, 'W'));
+
+    /* no slots: plain uncached drawing */
+    pas_gfx_glyph_cache_init(&cache, NULL, 0, NULL, 0);
+    ASSERT(same_output(font, &cache, "AV"));
+    ASSERT_EQ(cache.misses, 0ul);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_cache();
+    test_lru();
+    test_big_glyph();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
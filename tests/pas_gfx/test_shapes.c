@@ -0,0 +1,388 @@
+/*
+    test_shapes.c - Test filled and anti-aliased shapes: pas_gfx_fill_circle, pas_gfx_fill_round_rect
+    and pas_gfx_fill_polygon against per-pixel references; pas_gfx_line_aa and pas_gfx_circle_aa
+    coverage, symmetry and clipping; damage for all of them.
+    From repo root: gcc -o tests/pas_gfx/test_shapes tests/pas_gfx/test_shapes.c -I.
+*/
+
+#define PAS_GFX_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W     61
+#define H     47
+#define PITCH 64
+#define BG    0x12345678u
+#define INK   0xFFFFFFFFu
+
+static unsigned g_seed = 4242u;
+
+static int rnd(int lo, int hi)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return lo + (int)((g_seed >> 8) % (unsigned)(hi - lo + 1));
+}
+
+static void clear(uint32_t *px, uint32_t v)
+{
+    int i;
+    for (i = 0; i < H * PITCH; ++i) px[i] = v;
+}
+
+/* Inside a rounded rect (r already clamped); a disc is the 2r+1 square. */
+static int in_round(long px, long py, long x, long y, long w, long h, long r)
+{
+    long qx, qy;
+    if (px < x || px >= x + w || py < y || py >= y + h) return 0;
+    qx = px < x + r ? x + r - px : px > x + w - 1 - r ? px - (x + w - 1 - r) : 0;
+    qy = py < y + r ? y + r - py : py > y + h - 1 - r ? py - (y + h - 1 - r) : 0;
+    return qx * qx + qy * qy <= r * r + r;
+}
+
+static void test_round(void)
+{
+    static uint32_t got[H * PITCH], outline[H * PITCH];
+    pas_gfx_fb_t fb, fo;
+    pas_gfx_rect_t c;
+    int n, x, y, ok = 1, covers = 1;
+
+    pas_gfx_fb_init(&fb, got, W, H, PITCH);
+    pas_gfx_fb_init(&fo, outline, W, H, PITCH);
+    for (n = 0; n < 1500 && ok; ++n) {
+        int disc = n & 1, clipped = (n & 2) != 0;
+        int cx = rnd(-20, W + 20), cy = rnd(-20, H + 20), r = rnd(-1, 30);
+        int rx = rnd(-20, W), ry = rnd(-20, H), rw = rnd(-1, 50), rh = rnd(-1, 40), rr = rnd(-2, 25);
+        long bx, by, bw, bh, br;
+
+        clear(got, BG);
+        if (clipped) (void)pas_gfx_clip_push(&fb, rnd(0, W / 2), rnd(0, H / 2), rnd(1, W), rnd(1, H));
+        c = pas_gfx_clip_get(&fb);
+        if (disc) {
+            pas_gfx_fill_circle(&fb, cx, cy, r, INK);
+            bx = cx - r; by = cy - r; bw = 2L * r + 1; bh = bw; br = r;
+        } else {
+            pas_gfx_fill_round_rect(&fb, rx, ry, rw, rh, rr, INK);
+            br = rr;
+            if (br > (rw - 1) / 2) br = (rw - 1) / 2;
+            if (br > (rh - 1) / 2) br = (rh - 1) / 2;
+            if (br < 0) br = 0;
+            bx = rx; by = ry; bw = rw; bh = rh;
+        }
+        if (clipped) pas_gfx_clip_pop(&fb);
+        for (y = 0; y < H; ++y)
+            for (x = 0; x < PITCH; ++x) {
+                int in = x >= c.x && x < c.x + c.w && y >= c.y && y < c.y + c.h &&
+                         (disc ? r >= 0 : 1) && in_round(x, y, bx, by, bw, bh, br);
+                ok &= got[y * PITCH + x] == (in ? INK : BG);
+            }
+
+        /* the disc covers the outline circle */
+        if (disc && !clipped && r > 0) {
+            clear(outline, 0);
+            pas_gfx_circle(&fo, cx, cy, r, INK);
+            for (x = 0; x < H * PITCH; ++x) covers &= !outline[x] || got[x] == INK;
+        }
+    }
+    ASSERT(ok);
+    ASSERT(covers);
+
+    /* r 0 is a pixel, or a plain rect; a huge radius is clamped */
+    clear(got, BG);
+    pas_gfx_fill_circle(&fb, 5, 5, 0, INK);
+    ASSERT(got[5 * PITCH + 5] == INK && got[5 * PITCH + 6] == BG && got[4 * PITCH + 5] == BG);
+    clear(got, BG);
+    clear(outline, BG);
+    pas_gfx_fill_round_rect(&fb, 3, 4, 20, 9, 0, INK);
+    pas_gfx_rect(&fo, 3, 4, 20, 9, INK);
+    ASSERT(memcmp(got, outline, sizeof(got)) == 0);
+    clear(got, BG);
+    clear(outline, BG);
+    pas_gfx_fill_round_rect(&fb, 3, 4, 11, 11, 1000, INK);
+    pas_gfx_fill_circle(&fo, 8, 9, 5, INK);
+    ASSERT(memcmp(got, outline, sizeof(got)) == 0);
+}
+
+/* Twice the signed area of (a, b, p) with p a pixel center: its sign tells the side of edge ab. */
+static long edge2(int ax, int ay, int bx, int by, int px, int py)
+{
+    return (long)(2 * bx - 2 * ax) * (2 * py + 1 - 2 * ay) - (long)(2 * by - 2 * ay) * (2 * px + 1 - 2 * ax);
+}
+
+static int convex(const int *q, int n)
+{
+    int i, pos = 0, neg = 0;
+    for (i = 0; i < n; ++i) {
+        const int *a = q + 2 * i, *b = q + 2 * ((i + 1) % n), *d = q + 2 * ((i + 2) % n);
+        long cr = (long)(b[0] - a[0]) * (d[1] - b[1]) - (long)(b[1] - a[1]) * (d[0] - b[0]);
+        pos |= cr > 0;
+        neg |= cr < 0;
+    }
+    return pos != neg;
+}
+
+static void test_polygon(void)
+{
+    static uint32_t a[H * PITCH], b[H * PITCH], q[H * PITCH];
+    static const int flat[6] = { 2, 5, 30, 5, 12, 5 };
+    pas_gfx_fb_t fa, fb, fq;
+    pas_gfx_rect_t r;
+    pas_gfx_damage_t damage;
+    int n, i, ok = 1, once = 1, inside = 1, damaged = 1;
+
+    pas_gfx_fb_init(&fa, a, W, H, PITCH);
+    pas_gfx_fb_init(&fb, b, W, H, PITCH);
+    pas_gfx_fb_init(&fq, q, W, H, PITCH);
+
+    /* an axis-aligned polygon is exactly the rect, in either winding */
+    for (n = 0; n < 500 && ok; ++n) {
+        int x = rnd(-10, W), y = rnd(-10, H), w = rnd(1, 40), h = rnd(1, 30);
+        int cw[8], ccw[8];
+        cw[0] = x;     cw[1] = y;     cw[2] = x + w; cw[3] = y;
+        cw[4] = x + w; cw[5] = y + h; cw[6] = x;     cw[7] = y + h;
+        for (i = 0; i < 4; ++i) {
+            ccw[2 * i] = cw[2 * (3 - i)];
+            ccw[2 * i + 1] = cw[2 * (3 - i) + 1];
+        }
+        clear(a, BG);
+        clear(b, BG);
+        clear(q, BG);
+        pas_gfx_fill_polygon(&fa, cw, 4, INK);
+        pas_gfx_fill_polygon(&fb, ccw, 4, INK);
+        pas_gfx_rect(&fq, x, y, w, h, INK);
+        ok &= memcmp(a, q, sizeof(a)) == 0 && memcmp(b, q, sizeof(b)) == 0;
+    }
+    ASSERT(ok);
+
+    /* a convex quad split along a diagonal: every pixel of the quad in exactly one half */
+    pas_gfx_damage_init(&damage, &r, 1);
+    for (n = 0; n < 400; ++n) {
+        int quad[8], t1[6], t2[6];
+        for (i = 0; i < 8; i += 2) {
+            quad[i] = rnd(-15, W + 15);
+            quad[i + 1] = rnd(-15, H + 15);
+        }
+        if (!convex(quad, 4)) {
+            --n;
+            continue;
+        }
+        memcpy(t1, quad, 6 * sizeof(int));
+        t2[0] = quad[4]; t2[1] = quad[5]; t2[2] = quad[6]; t2[3] = quad[7]; t2[4] = quad[0]; t2[5] = quad[1];
+        clear(a, 0);
+        clear(b, 0);
+        clear(q, 0);
+        fa.damage = &damage;
+        pas_gfx_damage_reset(&damage);
+        pas_gfx_fill_polygon(&fa, t1, 3, INK);
+        fa.damage = NULL;
+        pas_gfx_fill_polygon(&fb, t2, 3, INK);
+        pas_gfx_fill_polygon(&fq, quad, 4, INK);
+        for (i = 0; i < H * PITCH; ++i) {
+            int x = i % PITCH, y = i / PITCH;
+            long e0, e1, e2;
+            once &= (a[i] != 0) + (b[i] != 0) == (q[i] != 0);
+            if (a[i]) damaged &= damage.count == 1 && x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h;
+            if (x >= W) continue;
+            /* centers strictly inside are filled, strictly outside are not */
+            e0 = edge2(t1[0], t1[1], t1[2], t1[3], x, y);
+            e1 = edge2(t1[2], t1[3], t1[4], t1[5], x, y);
+            e2 = edge2(t1[4], t1[5], t1[0], t1[1], x, y);
+            if ((e0 > 0 && e1 > 0 && e2 > 0) || (e0 < 0 && e1 < 0 && e2 < 0)) inside &= a[i] == INK;
+            if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0)) inside &= a[i] == 0;
+        }
+    }
+    ASSERT(once);
+    ASSERT(inside);
+    ASSERT(damaged);
+
+    /* degenerate input draws nothing */
+    clear(a, BG);
+    pas_gfx_fill_polygon(&fa, NULL, 3, INK);
+    pas_gfx_fill_polygon(&fa, flat, 2, INK);
+    pas_gfx_fill_polygon(&fa, flat, 3, INK);
+    ok = 1;
+    for (i = 0; i < H * PITCH; ++i) ok &= a[i] == BG;
+    ASSERT(ok);
+}
+
+#define RED(p) ((int)(((p) >> 16) & 0xFF))
+
+/* x-major: each column's two coverages sum to 255 and their centroid is the exact line */
+static int columns_exact(const uint32_t *px, int x1, int y1, int x2, int y2)
+{
+    int x, y, ok = 1;
+    for (x = x1 < x2 ? x1 : x2; x <= (x1 < x2 ? x2 : x1); ++x) {
+        long sum = 0, moment = 0, ideal;
+        for (y = 0; y < H; ++y) {
+            sum += RED(px[y * PITCH + x]);
+            moment += (long)y * RED(px[y * PITCH + x]);
+        }
+        /* 255 * (y1 + (y2 - y1) * (x - x1) / (x2 - x1)), scaled by 2 * (x2 - x1) to stay integral */
+        ideal = 255L * (2L * y1 * (x2 - x1) + 2L * (y2 - y1) * (x - x1));
+        ok &= sum == 255;
+        ok &= labs(2L * moment * (x2 - x1) - ideal) <= 2L * labs(x2 - x1);   /* within 1/255 of a pixel */
+    }
+    return ok;
+}
+
+static void test_line_aa(void)
+{
+    static uint32_t a[H * PITCH], b[H * PITCH], full[H * PITCH], orig[H * PITCH];
+    pas_gfx_fb_t fa, fb, ff;
+    pas_gfx_rect_t c;
+    int n, i, ok = 1, sym = 1, exact = 1, masked = 1;
+
+    pas_gfx_fb_init(&fa, a, W, H, PITCH);
+    pas_gfx_fb_init(&fb, b, W, H, PITCH);
+    pas_gfx_fb_init(&ff, full, W, H, PITCH);
+
+    /* axis-aligned lines are plain spans; a 45 degree line is fully covered on the diagonal */
+    clear(a, BG);
+    clear(b, BG);
+    pas_gfx_line_aa(&fa, 40, 7, 3, 7, INK);
+    pas_gfx_line_aa(&fa, 9, 30, 9, 2, INK);
+    pas_gfx_line_aa(&fa, 14, 14, 14, 14, INK);
+    pas_gfx_hline(&fb, 3, 7, 38, INK);
+    pas_gfx_vline(&fb, 9, 2, 29, INK);
+    pas_gfx_pixel(&fb, 14, 14, INK);
+    ASSERT(memcmp(a, b, sizeof(a)) == 0);
+    clear(a, 0);
+    pas_gfx_line_aa(&fa, 5, 30, 25, 10, INK);
+    for (i = 0; i < H * PITCH; ++i) {
+        int x = i % PITCH, y = i / PITCH, on = x >= 5 && x <= 25 && x + y == 35;
+        ok &= a[i] == (on ? INK : 0u);
+    }
+    ASSERT(ok);
+
+    for (n = 0; n < 600; ++n) {
+        int x1 = rnd(0, W - 1), y1 = rnd(0, H - 1), x2 = rnd(0, W - 1), y2 = rnd(0, H - 1);
+        clear(a, 0);
+        clear(b, 0);
+        pas_gfx_line_aa(&fa, x1, y1, x2, y2, INK);
+        pas_gfx_line_aa(&fb, x2, y2, x1, y1, INK);
+        sym &= memcmp(a, b, sizeof(a)) == 0;
+        sym &= a[y1 * PITCH + x1] == INK && a[y2 * PITCH + x2] == INK;
+        if (abs(x2 - x1) >= abs(y2 - y1) && x1 != x2) exact &= columns_exact(a, x1, y1, x2, y2);
+    }
+    ASSERT(sym);
+    ASSERT(exact);
+
+    /* clipped, and starting far off the fb: the unclipped image masked to the clip */
+    for (n = 0; n < 600; ++n) {
+        int x1 = rnd(-3000, 3000), y1 = rnd(-200, H + 200), x2 = rnd(-100, W + 100), y2 = rnd(-3000, 3000);
+        uint32_t color = (uint32_t)n * 2654435761u;
+        for (i = 0; i < H * PITCH; ++i) orig[i] = (uint32_t)i * 40503u;
+        memcpy(full, orig, sizeof(orig));
+        memcpy(a, orig, sizeof(orig));
+        if (n & 1) {
+            x1 = rnd(-20, W + 20);
+            y1 = rnd(-20, H + 20);
+            x2 = rnd(-20, W + 20);
+            y2 = rnd(-20, H + 20);
+        }
+        pas_gfx_line_aa(&ff, x1, y1, x2, y2, color);
+        (void)pas_gfx_clip_push(&fa, rnd(-5, W), rnd(-5, H), rnd(1, W), rnd(1, H));
+        c = pas_gfx_clip_get(&fa);
+        pas_gfx_line_aa(&fa, x1, y1, x2, y2, color);
+        pas_gfx_clip_pop(&fa);
+        for (i = 0; i < H * PITCH; ++i) {
+            int x = i % PITCH, y = i / PITCH;
+            int in = x >= c.x && x < c.x + c.w && y >= c.y && y < c.y + c.h;
+            masked &= a[i] == (in ? full[i] : orig[i]);
+        }
+    }
+    ASSERT(masked);
+}
+
+static void test_circle_aa(void)
+{
+    static uint32_t a[H * PITCH], full[H * PITCH], orig[H * PITCH];
+    pas_gfx_fb_t fa, ff;
+    pas_gfx_rect_t c, rects[4];
+    pas_gfx_damage_t damage;
+    int n, i, r, x, y, sym = 1, ring = 1, sums = 1, masked = 1, damaged = 1;
+
+    pas_gfx_fb_init(&fa, a, W, H, PITCH);
+    pas_gfx_fb_init(&ff, full, W, H, PITCH);
+    pas_gfx_damage_init(&damage, rects, 4);
+    for (r = 1; r <= 22; ++r) {
+        int cx = 30, cy = 23;
+        clear(a, 0);
+        fa.damage = &damage;
+        pas_gfx_damage_reset(&damage);
+        pas_gfx_circle_aa(&fa, cx, cy, r, INK);
+        fa.damage = NULL;
+        ASSERT(a[cy * PITCH + cx + r] == INK && a[(cy - r) * PITCH + cx] == INK);
+        for (y = cy - 23; y <= cy + 23; ++y)
+            for (x = cx - 23; x <= cx + 23; ++x) {
+                uint32_t p;
+                long d2 = (long)(x - cx) * (x - cx) + (long)(y - cy) * (y - cy);
+                if (x < 0 || x >= W || y < 0 || y >= H) continue;
+                p = a[y * PITCH + x];
+                /* eight-fold symmetric, within a pixel of the radius */
+                if (2 * cx - x < W) sym &= p == a[y * PITCH + 2 * cx - x];
+                if (2 * cy - y < H) sym &= p == a[(2 * cy - y) * PITCH + x];
+                if (y - cy + cx >= 0 && y - cy + cx < W && x - cx + cy >= 0 && x - cx + cy < H)
+                    sym &= p == a[(x - cx + cy) * PITCH + y - cy + cx];
+                if (p) ring &= d2 > (long)(r - 1) * (r - 1) && d2 < (long)(r + 1) * (r + 1);
+                if (p) damaged &= damage.count == 1 && x >= rects[0].x && x < rects[0].x + rects[0].w &&
+                                  y >= rects[0].y && y < rects[0].y + rects[0].h;
+            }
+        /* away from the diagonal each column of the top arc holds 255 coverage in all */
+        for (x = cx; 2 * (x - cx) * (x - cx) + 4 * r < r * r; ++x) {
+            long sum = 0;
+            for (y = 0; y <= cy; ++y) sum += RED(a[y * PITCH + x]);
+            sums &= sum == 255;
+        }
+    }
+    ASSERT(sym);
+    ASSERT(ring);
+    ASSERT(sums);
+    ASSERT(damaged);
+
+    for (n = 0; n < 300; ++n) {
+        int cx = rnd(-30, W + 30), cy = rnd(-30, H + 30);
+        uint32_t color = (uint32_t)n * 2654435761u;
+        r = rnd(0, 40);
+        for (i = 0; i < H * PITCH; ++i) orig[i] = (uint32_t)i * 40503u;
+        memcpy(full, orig, sizeof(orig));
+        memcpy(a, orig, sizeof(orig));
+        pas_gfx_circle_aa(&ff, cx, cy, r, color);
+        (void)pas_gfx_clip_push(&fa, rnd(-5, W), rnd(-5, H), rnd(1, W), rnd(1, H));
+        c = pas_gfx_clip_get(&fa);
+        pas_gfx_circle_aa(&fa, cx, cy, r, color);
+        pas_gfx_clip_pop(&fa);
+        for (i = 0; i < H * PITCH; ++i) {
+            int in = i % PITCH >= c.x && i % PITCH < c.x + c.w && i / PITCH >= c.y && i / PITCH < c.y + c.h;
+            masked &= a[i] == (in ? full[i] : orig[i]);
+        }
+    }
+    ASSERT(masked);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_round();
+    test_polygon();
+    test_line_aa();
+    test_circle_aa();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
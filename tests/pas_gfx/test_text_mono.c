@@ -0,0 +1,165 @@
+/*
+    test_text_mono.c - Test pas_gfx_text_mono (built-in 6x8 font, scale 1..4) against the
+    per-bit reference it replaced: random strings, positions, clips and a pitch wider than the fb;
+    control bytes, newlines, damage per line, window title and button label.
+    From repo root: gcc -o tests/pas_gfx/test_text_mono tests/pas_gfx/test_text_mono.c -I.
+*/
+
+#define PAS_GFX_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W     97
+#define H     53
+#define PITCH 101
+
+static unsigned g_seed = 777u;
+
+static int rnd(int lo, int hi)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return lo + (int)((g_seed >> 8) % (unsigned)(hi - lo + 1));
+}
+
+/* Every bit tested, every pixel bounds-checked against the clip c. */
+static void ref_text(uint32_t *px, const pas_gfx_rect_t *c, int x, int y, const char *text, uint32_t color, int scale)
+{
+    const unsigned char *s = (const unsigned char *)text;
+    long pen_x = x, pen_y = y;
+    int row, col, i, j;
+
+    for (; *s; ++s) {
+        if (*s == '\n') {
+            pen_x = x;
+            pen_y += 9L * scale;
+            continue;
+        }
+        if (*s >= 32 && *s <= 126)
+            for (row = 0; row < 8; ++row)
+                for (col = 0; col < 6; ++col) {
+                    if (!(pas_gfx__font6x8[*s - 32][row] & (1 << (5 - col)))) continue;
+                    for (j = 0; j < scale; ++j)
+                        for (i = 0; i < scale; ++i) {
+                            long px_x = pen_x + (long)col * scale + i, px_y = pen_y + (long)row * scale + j;
+                            if (px_x >= c->x && px_x < c->x + c->w && px_y >= c->y && px_y < c->y + c->h)
+                                px[px_y * PITCH + px_x] = color;
+                        }
+                }
+        pen_x += 6L * scale;
+    }
+}
+
+static void fill_bg(uint32_t *a, uint32_t *b)
+{
+    int i;
+    for (i = 0; i < H * PITCH; ++i) a[i] = b[i] = (uint32_t)i * 2654435761u;
+}
+
+static void test_random(void)
+{
+    static uint32_t got[H * PITCH], want[H * PITCH];
+    char text[40];
+    pas_gfx_fb_t fb;
+    pas_gfx_rect_t c;
+    int n, i, ok = 1;
+
+    pas_gfx_fb_init(&fb, got, W, H, PITCH);
+    for (n = 0; n < 3000 && ok; ++n) {
+        int len = rnd(0, 39), scale = rnd(1, 4), x = rnd(-60, W + 5), y = rnd(-40, H + 5);
+        uint32_t color = (uint32_t)n * 40503u;
+        for (i = 0; i < len; ++i) {
+            int r = rnd(0, 20);
+            text[i] = (char)(r == 0 ? '\n' : r == 1 ? rnd(1, 31) : r == 2 ? rnd(127, 255) : rnd(32, 126));
+        }
+        text[len] = '\0';
+        fill_bg(got, want);
+        if (n & 1) (void)pas_gfx_clip_push(&fb, rnd(-5, W), rnd(-5, H), rnd(1, W), rnd(1, H));
+        c = pas_gfx_clip_get(&fb);
+        pas_gfx_text_mono(&fb, x, y, text, color, scale);
+        if (n & 1) pas_gfx_clip_pop(&fb);
+        ref_text(want, &c, x, y, text, color, scale);
+        ok &= memcmp(got, want, sizeof(got)) == 0;
+    }
+    ASSERT(ok);
+
+    /* no scale, no text: nothing */
+    fill_bg(got, want);
+    pas_gfx_text_mono(&fb, 0, 0, "abc", PAS_GFX_RED, 0);
+    pas_gfx_text_mono(&fb, 0, 0, NULL, PAS_GFX_RED, 1);
+    pas_gfx_text_mono(NULL, 0, 0, "abc", PAS_GFX_RED, 1);
+    ASSERT(memcmp(got, want, sizeof(got)) == 0);
+}
+
+static void test_damage(void)
+{
+    static uint32_t px[H * PITCH];
+    pas_gfx_rect_t rects[4];
+    pas_gfx_damage_t damage;
+    pas_gfx_fb_t fb;
+
+    pas_gfx_fb_init(&fb, px, W, H, PITCH);
+    pas_gfx_damage_init(&damage, rects, 4);
+    fb.damage = &damage;
+
+    /* one rect per line, from the first printed cell to the last */
+    pas_gfx_text_mono(&fb, 3, 2, "\x01Hello\nab", PAS_GFX_WHITE, 1);
+    ASSERT_EQ(damage.count, 2);
+    ASSERT(rects[0].x == 9 && rects[0].y == 2 && rects[0].w == 30 && rects[0].h == 8);
+    ASSERT(rects[1].x == 3 && rects[1].y == 11 && rects[1].w == 12 && rects[1].h == 8);
+
+    /* scaled, and clipped to the fb */
+    pas_gfx_damage_reset(&damage);
+    pas_gfx_text_mono(&fb, 80, 40, "XYZ", PAS_GFX_WHITE, 2);
+    ASSERT_EQ(damage.count, 1);
+    ASSERT(rects[0].x == 80 && rects[0].y == 40 && rects[0].w == W - 80 && rects[0].h == H - 40);
+
+    fb.damage = NULL;
+}
+
+/* The frame and button labels go through the same path: compare with the reference at scale 1. */
+static void test_widgets(void)
+{
+    static uint32_t got[H * PITCH], want[H * PITCH];
+    pas_gfx_fb_t fb, fr;
+    pas_gfx_rect_t c;
+
+    pas_gfx_fb_init(&fb, got, W, H, PITCH);
+    pas_gfx_fb_init(&fr, want, W, H, PITCH);
+    c = pas_gfx_clip_get(&fb);
+    fill_bg(got, want);
+    pas_gfx_window_frame(&fb, -3, 5, 70, 30, "Title bar", PAS_GFX_GRAY);
+    pas_gfx_rect(&fr, -2, 6, 68, 28, PAS_GFX_GRAY);
+    pas_gfx_hline(&fr, -3, 5, 70, PAS_GFX_WHITE);
+    pas_gfx_hline(&fr, -3, 34, 70, PAS_GFX_WHITE);
+    pas_gfx_vline(&fr, -3, 5, 30, PAS_GFX_WHITE);
+    pas_gfx_vline(&fr, 66, 5, 30, PAS_GFX_WHITE);
+    pas_gfx_rect(&fr, -2, 6, 68, 14, PAS_GFX_BLUE);
+    ref_text(want, &c, 1, 9, "Title bar", PAS_GFX_WHITE, 1);
+    ASSERT(memcmp(got, want, sizeof(got)) == 0);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_random();
+    test_damage();
+    test_widgets();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
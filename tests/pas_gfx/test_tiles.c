@@ -0,0 +1,314 @@
+/*
+    test_tiles.c - Test caller-owned framebuffers, the clip stack, and command lists replayed per tile
+    on worker threads: replay must match drawing directly, pixel for pixel.
+    Uses tests/pas_gfx/fake_truetype.h in place of stb_truetype for the text primitive.
+    From repo root: gcc -o tests/pas_gfx/test_tiles tests/pas_gfx/test_tiles.c -I. -lpthread
+*/
+
+#define PAS_GFX_USE_STB_TRUETYPE
+#define PAS_GFX_STB_TRUETYPE_PATH "tests/pas_gfx/fake_truetype.h"
+#define PAS_GFX_USE_THREADS
+#define PAS_GFX_IMPLEMENTATION
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define W     200
+#define H     130
+#define PITCH 203
+
+static unsigned g_seed = 99u;
+
+static int rnd(int lo, int hi)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return lo + (int)((g_seed >> 8) % (unsigned)(hi - lo + 1));
+}
+
+static uint8_t g_mask[24 * 24];
+static const unsigned char g_ttf[4];
+static pas_font_t *g_font;
+
+/* One random primitive, the same for a given seed. */
+static void draw_one(pas_gfx_fb_t *fb, int kind)
+{
+    static const char *texts[] = { "Tiles AV", "caf\xC3\xA9\nline two", "x" };
+    static const int polys[2][8] = { { 10, 5, 150, 20, 120, 110, 30, 90 }, { -30, 60, 60, -10, 230, 70, 90, 140 } };
+    int x = rnd(-40, W), y = rnd(-30, H), w = rnd(1, 90), h = rnd(1, 60);
+    uint32_t c = (uint32_t)rnd(0, 0xFFFFFF) | ((uint32_t)rnd(40, 255) << 24);
+
+    switch (kind) {
+    case 0: pas_gfx_rect(fb, x, y, w, h, c); break;
+    case 1: pas_gfx_line(fb, x, y, rnd(-40, W + 40), rnd(-30, H + 30), c); break;
+    case 2: pas_gfx_hline(fb, x, y, w, c); break;
+    case 3: pas_gfx_vline(fb, x, y, h, c); break;
+    case 4: pas_gfx_pixel(fb, x, y, c); break;
+    case 5: pas_gfx_circle(fb, x, y, w / 2, c); break;
+    case 6: pas_gfx_bitmap(fb, x, y, g_mask, 24, 24, c); break;
+    case 7: pas_gfx_window_frame(fb, x, y, w + 10, h + 10, "Title", c); break;
+    case 8: pas_gfx_button(fb, x, y, w + 4, h + 4, "Push", rnd(0, 1)); break;
+    case 9: pas_gfx_text(fb, g_font, x, y, texts[rnd(0, 2)], c); break;
+    case 10: pas_gfx_fill_circle(fb, x, y, w / 3, c); break;
+    case 11: pas_gfx_fill_round_rect(fb, x, y, w, h, rnd(0, 20), c); break;
+    case 12: pas_gfx_fill_polygon(fb, polys[rnd(0, 1)], 4, c); break;
+    case 13: pas_gfx_line_aa(fb, x, y, rnd(-40, W + 40), rnd(-30, H + 30), c); break;
+    case 14: pas_gfx_circle_aa(fb, x, y, w / 2, c); break;
+    default: pas_gfx_text_mono(fb, x, y, texts[rnd(0, 2)], c, rnd(1, 3)); break;
+    }
+}
+
+/* A scene of n primitives with nested clips. */
+static void draw_scene(pas_gfx_fb_t *fb, unsigned seed, int n)
+{
+    int i, depth = 0;
+    g_seed = seed;
+    for (i = 0; i < n; ++i) {
+        int r = rnd(0, 11);
+        if (r == 10 && depth < 3) {
+            (void)pas_gfx_clip_push(fb, rnd(-20, W), rnd(-20, H), rnd(10, 150), rnd(10, 100));
+            ++depth;
+        } else if (r == 11 && depth > 0) {
+            pas_gfx_clip_pop(fb);
+            --depth;
+        } else {
+            draw_one(fb, rnd(0, 15));
+        }
+    }
+    while (depth-- > 0) pas_gfx_clip_pop(fb);
+}
+
+static void test_fbs(void)
+{
+    uint32_t a[8 * 8], b[4 * 4];
+    pas_gfx_fb_t fa, fb, *g;
+    pas_gfx_rect_t c;
+    int i, ok = 1;
+
+    /* independent surfaces */
+    memset(&fa, 0xAB, sizeof(fa));
+    ASSERT(pas_gfx_fb_init(&fa, a, 8, 8, 8) == &fa);
+    ASSERT(fa.flags == 0 && fa.damage == NULL && fa.record == NULL && fa.clip_depth == 0);
+    ASSERT(pas_gfx_fb_init(&fb, b, 4, 4, 4) == &fb);
+    ASSERT(pas_gfx_fb_init(NULL, a, 8, 8, 8) == NULL);
+    g = pas_gfx_init(a, 8, 8, 8);
+    ASSERT(g != &fa && g != &fb);
+    pas_gfx_rect(&fa, 0, 0, 8, 8, PAS_GFX_RED);
+    pas_gfx_rect(&fb, 0, 0, 8, 8, PAS_GFX_BLUE);
+    for (i = 0; i < 64; ++i) ok &= a[i] == PAS_GFX_RED;
+    for (i = 0; i < 16; ++i) ok &= b[i] == PAS_GFX_BLUE;
+    ASSERT(ok);
+
+    /* clip stack: intersect on push, restore on pop, bounded depth */
+    c = pas_gfx_clip_get(&fa);
+    ASSERT(c.x == 0 && c.y == 0 && c.w == 8 && c.h == 8);
+    ASSERT_EQ(pas_gfx_clip_push(&fa, 2, 2, 10, 3), 0);
+    c = pas_gfx_clip_get(&fa);
+    ASSERT(c.x == 2 && c.y == 2 && c.w == 6 && c.h == 3);
+    ASSERT_EQ(pas_gfx_clip_push(&fa, -5, 3, 9, 9), 0);
+    c = pas_gfx_clip_get(&fa);
+    ASSERT(c.x == 2 && c.y == 3 && c.w == 2 && c.h == 2);
+    pas_gfx_rect(&fa, 0, 0, 8, 8, PAS_GFX_GREEN);
+    ASSERT(a[3 * 8 + 2] == PAS_GFX_GREEN && a[4 * 8 + 3] == PAS_GFX_GREEN);
+    ASSERT(a[2 * 8 + 2] == PAS_GFX_RED && a[3 * 8 + 4] == PAS_GFX_RED && a[5 * 8 + 2] == PAS_GFX_RED);
+    pas_gfx_clip_pop(&fa);
+    pas_gfx_pixel(&fa, 7, 2, PAS_GFX_WHITE);
+    pas_gfx_pixel(&fa, 7, 1, PAS_GFX_WHITE);
+    ASSERT(a[2 * 8 + 7] == PAS_GFX_WHITE && a[1 * 8 + 7] == PAS_GFX_RED);
+    ASSERT_EQ(pas_gfx_clip_push(&fa, 100, 100, 5, 5), 0);   /* disjoint: empty */
+    pas_gfx_rect(&fa, 0, 0, 8, 8, PAS_GFX_BLACK);
+    pas_gfx_circle(&fa, 4, 4, 3, PAS_GFX_BLACK);
+    ok = 1;
+    for (i = 0; i < 64; ++i) ok &= a[i] != PAS_GFX_BLACK;
+    ASSERT(ok);
+    pas_gfx_clip_pop(&fa);
+    pas_gfx_clip_pop(&fa);
+    pas_gfx_clip_pop(&fa);   /* extra pops are harmless */
+    ASSERT_EQ(fa.clip_depth, 0);
+    for (i = 0; i < PAS_GFX_CLIP_DEPTH; ++i) ASSERT_EQ(pas_gfx_clip_push(&fa, 0, 0, 8, 8), 0);
+    ASSERT_EQ(pas_gfx_clip_push(&fa, 0, 0, 8, 8), -1);
+}
+
+/* Every primitive under a clip equals the unclipped result masked to the clip. */
+static void test_clip_primitives(void)
+{
+    static uint32_t orig[H * PITCH], full[H * PITCH], clipped[H * PITCH];
+    pas_gfx_fb_t fa, fc;
+    int n, x, y, ok = 1;
+
+    pas_gfx_fb_init(&fa, full, W, H, PITCH);
+    pas_gfx_fb_init(&fc, clipped, W, H, PITCH);
+    for (n = 0; n < 600 && ok; ++n) {
+        int cx = rnd(-10, W - 10), cy = rnd(-10, H - 10), cw = rnd(1, 120), ch = rnd(1, 80), kind = n % 16;
+        unsigned seed;
+        pas_gfx_rect_t c;
+
+        for (x = 0; x < H * PITCH; ++x) orig[x] = (uint32_t)x * 2654435761u;
+        memcpy(full, orig, sizeof(orig));
+        memcpy(clipped, orig, sizeof(orig));
+        seed = g_seed;
+        draw_one(&fa, kind);
+        g_seed = seed;
+        (void)pas_gfx_clip_push(&fc, cx, cy, cw, ch);
+        c = pas_gfx_clip_get(&fc);
+        draw_one(&fc, kind);
+        pas_gfx_clip_pop(&fc);
+        for (y = 0; y < H; ++y)
+            for (x = 0; x < PITCH; ++x) {
+                int in = x >= c.x && x < c.x + c.w && y >= c.y && y < c.y + c.h;
+                ok &= clipped[y * PITCH + x] == (in ? full[y * PITCH + x] : orig[y * PITCH + x]);
+            }
+    }
+    ASSERT(ok);
+}
+
+static void test_replay(void)
+{
+    static uint32_t direct[H * PITCH], replayed[H * PITCH];
+    static pas_gfx_cmd_t cmds[512];
+    static pas_gfx_glyph_t glyphs[64];
+    static uint8_t atlas[32 * 1024];
+    static const int tiles[][3] = { { 16, 16, 1 }, { 37, 23, 4 }, { 64, 64, 7 }, { 0, 0, 3 }, { 1000, 1000, 8 }, { 8, 200, 16 } };
+    pas_gfx_glyph_cache_t cache;
+    pas_gfx_cmdlist_t list;
+    pas_gfx_rect_t rects[8];
+    pas_gfx_damage_t damage;
+    pas_gfx_fb_t fd, fr;
+    int t, i, ok, covered;
+
+    for (i = 0; i < (int)sizeof(g_mask); ++i) g_mask[i] = (uint8_t)(i * 13);
+    g_font = pas_gfx_font_open(g_ttf, 14.0f);
+    pas_gfx_glyph_cache_init(&cache, glyphs, 64, atlas, sizeof(atlas));
+    g_font->cache = &cache;
+    pas_gfx_fb_init(&fd, direct, W, H, PITCH);
+    pas_gfx_fb_init(&fr, replayed, W, H, PITCH);
+    pas_gfx_cmdlist_init(&list, cmds, 512);
+
+    for (t = 0; t < (int)(sizeof(tiles) / sizeof(tiles[0])); ++t) {
+        memset(direct, 0x11, sizeof(direct));
+        memset(replayed, 0x11, sizeof(replayed));
+        draw_scene(&fd, 1000u + (unsigned)t, 300);
+
+        /* recording draws nothing */
+        pas_gfx_cmdlist_reset(&list);
+        fr.record = &list;
+        draw_scene(&fr, 1000u + (unsigned)t, 300);
+        fr.record = NULL;
+        ok = 1;
+        for (i = 0; i < H * PITCH; ++i) ok &= replayed[i] == 0x11111111u;
+        ASSERT(ok);
+        ASSERT(list.count > 250 && list.overflow == 0);
+
+        pas_gfx_damage_init(&damage, rects, 8);
+        fr.damage = &damage;
+        ASSERT_EQ(pas_gfx_replay(&fr, &list, tiles[t][0], tiles[t][1], tiles[t][2]), 0);
+        fr.damage = NULL;
+        ASSERT(memcmp(direct, replayed, sizeof(direct)) == 0);
+
+        /* damage from the workers covers every change */
+        covered = 1;
+        for (i = 0; i < H * PITCH; ++i) {
+            int x = i % PITCH, y = i / PITCH, in = 0, k;
+            if (replayed[i] == 0x11111111u) continue;
+            for (k = 0; k < damage.count; ++k)
+                in |= x >= rects[k].x && x < rects[k].x + rects[k].w && y >= rects[k].y && y < rects[k].y + rects[k].h;
+            covered &= in;
+        }
+        ASSERT(covered && damage.count > 0);
+    }
+
+    /* replay honours the fb's clip */
+    memset(direct, 0, sizeof(direct));
+    memset(replayed, 0, sizeof(replayed));
+    pas_gfx_cmdlist_reset(&list);
+    fr.record = &list;
+    pas_gfx_rect(&fr, 0, 0, W, H, PAS_GFX_RED);
+    fr.record = NULL;
+    (void)pas_gfx_clip_push(&fr, 10, 20, 30, 40);
+    (void)pas_gfx_clip_push(&fd, 10, 20, 30, 40);
+    pas_gfx_rect(&fd, 0, 0, W, H, PAS_GFX_RED);
+    ASSERT_EQ(pas_gfx_replay(&fr, &list, 7, 9, 5), 0);
+    ASSERT(memcmp(direct, replayed, sizeof(direct)) == 0);
+    ASSERT(replayed[20 * PITCH + 10] == PAS_GFX_RED && replayed[19 * PITCH + 10] == 0);
+    pas_gfx_clip_pop(&fr);
+    pas_gfx_clip_pop(&fd);
+
+    /* a list nesting PAS_GFX_CLIP_DEPTH clips keeps all of them on replay, and under
+       an fb clip the same pushes overflow as they do drawing directly */
+    for (t = 0; t < 2; ++t) {
+        memset(direct, 0, sizeof(direct));
+        memset(replayed, 0, sizeof(replayed));
+        if (t) {
+            (void)pas_gfx_clip_push(&fr, 0, 0, W / 2, H);
+            (void)pas_gfx_clip_push(&fd, 0, 0, W / 2, H);
+        }
+        pas_gfx_cmdlist_reset(&list);
+        fr.record = &list;
+        for (i = 0; i < PAS_GFX_CLIP_DEPTH; ++i) {
+            (void)pas_gfx_clip_push(&fd, i, i, W, H);
+            (void)pas_gfx_clip_push(&fr, i, i, W, H);
+        }
+        (void)pas_gfx_clip_push(&fd, 20, 30, 4, 4);   /* one past the depth: dropped */
+        (void)pas_gfx_clip_push(&fr, 20, 30, 4, 4);
+        pas_gfx_rect(&fd, 0, 0, W, H, PAS_GFX_GREEN);
+        pas_gfx_rect(&fr, 0, 0, W, H, PAS_GFX_GREEN);
+        for (i = 0; i <= PAS_GFX_CLIP_DEPTH; ++i) pas_gfx_clip_pop(&fr);
+        fr.record = NULL;
+        while (fd.clip_depth > t) pas_gfx_clip_pop(&fd);
+        ASSERT_EQ(pas_gfx_replay(&fr, &list, 16, 16, 3), 0);
+        ASSERT(memcmp(direct, replayed, sizeof(direct)) == 0);
+        if (t) {
+            pas_gfx_clip_pop(&fr);
+            pas_gfx_clip_pop(&fd);
+        }
+    }
+    /* the innermost of PAS_GFX_CLIP_DEPTH clips is a 4x4 square */
+    memset(replayed, 0, sizeof(replayed));
+    pas_gfx_cmdlist_reset(&list);
+    fr.record = &list;
+    for (i = 0; i + 1 < PAS_GFX_CLIP_DEPTH; ++i) (void)pas_gfx_clip_push(&fr, 0, 0, W, H);
+    (void)pas_gfx_clip_push(&fr, 20, 30, 4, 4);
+    pas_gfx_rect(&fr, 0, 0, W, H, PAS_GFX_GREEN);
+    fr.record = NULL;
+    ASSERT_EQ(pas_gfx_replay(&fr, &list, 0, 0, 4), 0);
+    covered = 0;
+    for (i = 0; i < H * PITCH; ++i) covered += replayed[i] == PAS_GFX_GREEN;
+    ASSERT_EQ(covered, 16);
+
+    /* a full list drops and says so; what fit is drawn */
+    pas_gfx_cmdlist_init(&list, cmds, 2);
+    fr.record = &list;
+    pas_gfx_pixel(&fr, 0, 0, PAS_GFX_BLUE);
+    pas_gfx_pixel(&fr, 1, 0, PAS_GFX_BLUE);
+    pas_gfx_pixel(&fr, 2, 0, PAS_GFX_BLUE);
+    fr.record = NULL;
+    ASSERT(list.count == 2 && list.overflow == 1);
+    ASSERT_EQ(pas_gfx_replay(&fr, &list, 0, 0, 2), -1);
+    ASSERT(replayed[0] == PAS_GFX_BLUE && replayed[1] == PAS_GFX_BLUE && replayed[2] == 0);
+    ASSERT_EQ(pas_gfx_replay(NULL, &list, 0, 0, 2), -1);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_fbs();
+    test_replay();   /* sets up the font and mask test_clip_primitives draws with */
+    test_clip_primitives();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
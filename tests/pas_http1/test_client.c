@@ -0,0 +1,609 @@
+/*
+    test_client.c - Test the pas_http_client_* keep-alive pool, streaming calls and pipelining against a loopback server.
+    From repo root: gcc -o tests/pas_http1/test_client tests/pas_http1/test_client.c -I. -lpthread
+    Unix only (the scripted server uses poll and pthreads).
+*/
+
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "test_server.h"
+
+#define BIG_SIZE 50000
+
+static unsigned char big_byte(size_t i) { return (unsigned char)(i * 31 + (i >> 8)); }
+
+/* BIG_SIZE bytes of big_byte(), by Content-Length or in 1000-byte chunks. */
+static size_t big_response(char *resp, size_t cap, int chunked)
+{
+    size_t n, i, k;
+
+    if (!chunked) {
+        n = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\nX-Big: 1\r\n\r\n", BIG_SIZE);
+        for (i = 0; i < BIG_SIZE; i++) resp[n++] = (char)big_byte(i);
+        return n;
+    }
+    n = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nX-Big: 1\r\n\r\n");
+    for (i = 0; i < BIG_SIZE; i += 1000) {
+        n += (size_t)snprintf(resp + n, cap - n, "3e8\r\n");
+        for (k = 0; k < 1000; k++) resp[n++] = (char)big_byte(i + k);
+        resp[n++] = '\r';
+        resp[n++] = '\n';
+    }
+    n += (size_t)snprintf(resp + n, cap - n, "0\r\n\r\n");
+    return n;
+}
+
+/* Path picks the response: /close, /chunked, /drop, /nobody, otherwise "hello" by length. */
+static int respond_path(test_server *s, const char *req, size_t req_len,
+                        char *resp, size_t cap, size_t *resp_len)
+{
+    (void)s; (void)req_len;
+    if (strncmp(req, "GET /close ", 11) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 3\r\n\r\nbye");
+        return TEST_CLOSE;
+    }
+    if (strncmp(req, "GET /chunked ", 13) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\n");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /continue ", 14) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 100 Continue\r\n\r\n"
+            "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\ndone");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /conflict ", 14) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 200 OK\r\nContent-Length: 4\r\nContent-Length: 5\r\n\r\nhello");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /big ", 9) == 0) {
+        *resp_len = big_response(resp, cap, 0);
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /bigchunked ", 16) == 0) {
+        *resp_len = big_response(resp, cap, 1);
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /echo/", 10) == 0 || strncmp(req, "POST /echo/", 11) == 0) {
+        const char *p = strchr(req, '/') + 6, *e = strchr(p, ' ');
+        *resp_len = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%.*s",
+                                     (int)(e - p), (int)(e - p), p);
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "HEAD ", 5) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "GET /drop ", 10) == 0) return TEST_DROP;
+    if (strncmp(req, "GET /nobody ", 12) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap, "HTTP/1.1 204 No Content\r\n\r\n");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "POST ", 5) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nok");
+        return TEST_KEEP;
+    }
+    *resp_len = (size_t)snprintf(resp, cap,
+        "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+    return TEST_KEEP;
+}
+
+/* Like a real server, closes after answering a request that asked for it. */
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    const char *end = strstr(req, "\r\n\r\n"), *close = strstr(req, "\r\nConnection: close\r\n");
+    int action = respond_path(s, req, req_len, resp, cap, resp_len);
+
+    if (action == TEST_KEEP && close && close < end) action = TEST_CLOSE;
+    return action;
+}
+
+/* Bulk peer for the pipeline stall test: one connection with small socket buffers,
+   request bodies read as a stream (test_server buffers whole requests), and every
+   request answered with BULK_SIZE bytes by a blocking send while the client may
+   still be writing. */
+#define BULK_SIZE  (256 * 1024)
+#define BULK_ITEMS 48
+#define BULK_SOCKBUF (64 * 1024)
+
+typedef struct {
+    int       listen_fd;
+    int       port;
+    int       answered;
+    pthread_t thread;
+} bulk_server;
+
+static char g_bulk[BULK_SIZE + 64];
+
+static void *bulk_main(void *arg)
+{
+    bulk_server *b = (bulk_server *)arg;
+    static char in[16384];
+    char head[1024], resp_head[64];
+    size_t head_len = 0, body_left = 0;
+    int fd = accept(b->listen_fd, NULL, NULL), in_body = 0, n_head;
+
+    n_head = snprintf(resp_head, sizeof(resp_head), "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", BULK_SIZE);
+    while (fd >= 0 && b->answered < BULK_ITEMS + 1) {
+        ssize_t r = recv(fd, in, sizeof(in), 0);
+        const char *p = in;
+
+        if (r <= 0) break;
+        while (r > 0) {
+            if (!in_body) {
+                const char *cl;
+                head[head_len++] = *p++;
+                r--;
+                if (head_len < 4 || memcmp(head + head_len - 4, "\r\n\r\n", 4) != 0) {
+                    if (head_len == sizeof(head) - 1) r = -1;
+                    continue;
+                }
+                head[head_len] = 0;
+                cl = strstr(head, "Content-Length: ");
+                body_left = cl ? (size_t)strtoul(cl + 16, NULL, 10) : 0;
+                head_len = 0;
+                in_body = 1;
+            }
+            if (body_left) {
+                size_t take = (size_t)r < body_left ? (size_t)r : body_left;
+                p += take;
+                r -= (ssize_t)take;
+                body_left -= take;
+            }
+            if (!body_left) {
+                in_body = 0;
+                test_send_all(fd, resp_head, (size_t)n_head);
+                test_send_all(fd, g_bulk, BULK_SIZE);
+                b->answered++;
+            }
+        }
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+static int bulk_start(bulk_server *b)
+{
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int size = BULK_SOCKBUF;
+
+    memset(b, 0, sizeof(*b));
+    memset(g_bulk, 'b', sizeof(g_bulk));
+    b->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (b->listen_fd < 0) return -1;
+    setsockopt(b->listen_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(b->listen_fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(b->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(b->listen_fd, 4) != 0 ||
+        getsockname(b->listen_fd, (struct sockaddr *)&addr, &alen) != 0 ||
+        pthread_create(&b->thread, NULL, bulk_main, b) != 0) {
+        close(b->listen_fd);
+        return -1;
+    }
+    b->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+typedef struct {
+    int    status;
+    int    headers;
+    int    big_header;
+    size_t body;
+    int    mismatch;
+    size_t calls;
+    size_t stop_after;   /* abort once this many body bytes arrived (0 = never) */
+} stream_state;
+
+static int on_status(void *user, int code)
+{
+    ((stream_state *)user)->status = code;
+    return 0;
+}
+
+static int on_header(void *user, const char *name, size_t name_len, const char *value, size_t value_len)
+{
+    stream_state *st = (stream_state *)user;
+    st->headers++;
+    if (name_len == 5 && memcmp(name, "X-Big", 5) == 0 && value_len == 1 && value[0] == '1')
+        st->big_header = 1;
+    return 0;
+}
+
+static int on_body(void *user, const void *data, size_t len)
+{
+    stream_state *st = (stream_state *)user;
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        if (p[i] != big_byte(st->body + i)) st->mismatch = 1;
+    st->body += len;
+    st->calls++;
+    return st->stop_after && st->body >= st->stop_after;
+}
+
+static int body_is(const pas_http_response_t *res, const char *s)
+{
+    return res->body_len == strlen(s) && memcmp(res->body, s, res->body_len) == 0;
+}
+
+int main(void)
+{
+    test_server srv;
+    pas_http_client_t client;
+    pas_http_conn_t conns[2];
+    pas_http_response_t res;
+    char buf[4096];
+    char url[128], url2[128];
+    int r, status, open_count;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("(skipped: cannot listen on 127.0.0.1)\n");
+        return 0;
+    }
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/a", srv.port);
+
+    /* two requests, one connection */
+    pas_http_client_init(&client, conns, 2, 5000);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(res.status_code, 200);
+    ASSERT(body_is(&res, "hello"));
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    ASSERT_EQ(srv.accepted, 1);
+    ASSERT(strstr(srv.last_request, "Connection: close") == NULL);
+
+    /* chunked and bodyless responses keep the connection too */
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/chunked", srv.port);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(res.status_code, 200);
+    ASSERT(body_is(&res, "hello world"));
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/continue", srv.port);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(res.status_code, 200);
+    ASSERT(body_is(&res, "done"));
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/nobody", srv.port);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(res.status_code, 204);
+    ASSERT_EQ(res.body_len, 0u);
+    r = pas_http_client_post(&client, url, "payload", 7, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(res.status_code, 201);
+    ASSERT(body_is(&res, "ok"));
+    ASSERT(srv.last_request_len > 7 &&
+           memcmp(srv.last_request + srv.last_request_len - 7, "payload", 7) == 0);
+    ASSERT_EQ(srv.accepted, 1);
+
+    /* HEAD: Content-Length describes the GET body, nothing follows */
+    r = pas_http_client_request(&client, "HEAD", url, NULL, 0, NULL, 0, NULL, buf, sizeof(buf), 2000,
+                                &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(res.status_code, 200);
+    ASSERT_EQ(res.body_len, 0u);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT(r == PAS_HTTP_OK && body_is(&res, "hello"));
+    ASSERT_EQ(srv.accepted, 1);
+
+    /* Connection: close is honoured */
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/close", srv.port);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(body_is(&res, "bye"));
+    ASSERT_EQ(conns[0].open + conns[1].open, 0);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(srv.accepted, 2);
+
+    /* server closed the idle connection: detected before reuse */
+    test_server_drop_all(&srv);
+    sleep_ms(50);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    ASSERT_EQ(srv.accepted, 3);
+
+    /* a server that drops the request gets an error, not a hang */
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/drop", srv.port);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_E_CONNECTION);
+    ASSERT_EQ(status, PAS_HTTP_E_CONNECTION);
+
+    /* idle timeout */
+    pas_http_client_close(&client);
+    pas_http_client_init(&client, conns, 2, 30);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    open_count = srv.accepted;
+    sleep_ms(60);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(srv.accepted, open_count + 1);
+
+    /* a one-slot pool evicts the connection when the host changes */
+    pas_http_client_close(&client);
+    pas_http_client_init(&client, conns, 1, 5000);
+    (void)snprintf(url2, sizeof(url2), "http://localhost:%d/a", srv.port);
+    open_count = srv.accepted;
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    r = pas_http_client_get(&client, url2, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(strcmp(conns[0].host, "localhost") == 0);
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(srv.accepted, open_count + 3);
+
+    /* too small a buffer: NOSPACE, and the connection is not reused */
+    r = pas_http_client_get(&client, url, buf, 20, 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_E_NOSPACE);
+    ASSERT_EQ(conns[0].open, 0);
+
+    /* no pool: one connection per request */
+    pas_http_client_init(&client, NULL, 0, 0);
+    open_count = srv.accepted;
+    r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    ASSERT(strstr(srv.last_request, "Connection: close") != NULL);
+    ASSERT_EQ(srv.accepted, open_count + 1);
+
+    /* the one-shot calls stop at the end of the message; this server never closes */
+    r = pas_http_get(url, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/chunked", srv.port);
+    r = pas_http_post(url2, "x", 1, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT_EQ(res.status_code, 201);
+    r = pas_http_get(url2, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT(body_is(&res, "hello world"));
+
+    /* a NULL body with a length is rejected before anything is sent */
+    open_count = srv.accepted;
+    r = pas_http_post(url2, NULL, 4096, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_E_INVALID_URL);
+    pas_http_client_init(&client, conns, 2, 5000);
+    r = pas_http_client_post(&client, url2, NULL, 4096, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_E_INVALID_URL);
+    {
+        pas_http_callbacks_t none;
+        memset(&none, 0, sizeof(none));
+        r = pas_http_client_post_stream(&client, url2, NULL, 4096, &none, buf, sizeof(buf), 5000, &status);
+        ASSERT_EQ(r, PAS_HTTP_E_INVALID_URL);
+    }
+    ASSERT_EQ(srv.accepted, open_count);
+    r = pas_http_post(url2, NULL, 0, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_OK);
+    ASSERT(strstr(srv.last_request, "Content-Length: 0\r\n") != NULL);
+
+    /* disagreeing Content-Length headers are rejected */
+    (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/conflict", srv.port);
+    r = pas_http_get(url2, buf, sizeof(buf), 5000, &res, &status);
+    ASSERT_EQ(r, PAS_HTTP_E_CONNECTION);
+
+    /* streaming through a buffer much smaller than the body */
+    {
+        pas_http_callbacks_t cb;
+        stream_state ss;
+        char small[300];
+
+        pas_http_client_init(&client, conns, 2, 5000);
+        open_count = srv.accepted;
+        cb.on_status = on_status;
+        cb.on_header = on_header;
+        cb.on_body = on_body;
+        cb.user = &ss;
+
+        memset(&ss, 0, sizeof(ss));
+        (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/big", srv.port);
+        r = pas_http_client_get_stream(&client, url2, &cb, small, sizeof(small), 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        ASSERT_EQ(ss.status, 200);
+        ASSERT_EQ(ss.headers, 2);
+        ASSERT(ss.big_header);
+        ASSERT_EQ(ss.body, (size_t)BIG_SIZE);
+        ASSERT(!ss.mismatch);
+        ASSERT(ss.calls > 1);
+
+        memset(&ss, 0, sizeof(ss));
+        (void)snprintf(url2, sizeof(url2), "http://127.0.0.1:%d/bigchunked", srv.port);
+        r = pas_http_client_get_stream(&client, url2, &cb, small, sizeof(small), 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        ASSERT_EQ(ss.body, (size_t)BIG_SIZE);
+        ASSERT(!ss.mismatch);
+        ASSERT_EQ(srv.accepted, open_count + 1);
+
+        /* body callback stops the transfer; the connection is not reused */
+        memset(&ss, 0, sizeof(ss));
+        ss.stop_after = 1000;
+        r = pas_http_client_get_stream(&client, url2, &cb, small, sizeof(small), 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_E_ABORTED);
+        ASSERT(ss.body < BIG_SIZE);
+        ASSERT_EQ(conns[0].open + conns[1].open, 0);
+
+        /* headers must fit the receive buffer */
+        memset(&ss, 0, sizeof(ss));
+        r = pas_http_client_get_stream(&client, url2, &cb, small, 16, 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_E_NOSPACE);
+
+        /* POST with a plain body, callbacks optional */
+        cb.on_header = NULL;
+        memset(&ss, 0, sizeof(ss));
+        r = pas_http_client_post_stream(&client, url, "x", 1, &cb, small, sizeof(small), 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        ASSERT_EQ(ss.status, 201);
+        ASSERT_EQ(ss.body, 2u);
+        pas_http_client_close(&client);
+    }
+
+    /* pipelining: many requests written together, answered in order on one connection */
+    {
+        static pas_http_pipeline_item_t items[24];
+        static char bufs[24][256];
+        static char urls[24][64];
+        int i, ok = 1;
+
+        pas_http_client_init(&client, conns, 2, 5000);
+        memset(items, 0, sizeof(items));
+        for (i = 0; i < 24; i++) {
+            if (i % 6 == 3)
+                (void)snprintf(urls[i], sizeof(urls[i]), "http://127.0.0.1:%d/chunked", srv.port);
+            else if (i % 6 == 5)
+                (void)snprintf(urls[i], sizeof(urls[i]), "http://127.0.0.1:%d/nobody", srv.port);
+            else
+                (void)snprintf(urls[i], sizeof(urls[i]), "http://127.0.0.1:%d/echo/%d", srv.port, i);
+            items[i].method = (i % 3 == 1) ? "POST" : "GET";
+            items[i].url = urls[i];
+            items[i].body = (i % 3 == 1) ? "tiny" : NULL;
+            items[i].body_len = (i % 3 == 1) ? 4 : 0;
+            items[i].buf = bufs[i];
+            items[i].size = sizeof(bufs[i]);
+        }
+        open_count = srv.accepted;
+        r = pas_http_client_pipeline(&client, items, 24, 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        for (i = 0; i < 24; i++) {
+            char expect[8];
+            ok &= items[i].status == PAS_HTTP_OK;
+            if (i % 6 == 3) ok &= body_is(&items[i].response, "hello world");
+            else if (i % 6 == 5) ok &= items[i].response.status_code == 204;
+            else {
+                (void)snprintf(expect, sizeof(expect), "%d", i);
+                ok &= body_is(&items[i].response, expect);
+            }
+        }
+        ASSERT(ok);
+        ASSERT_EQ(srv.accepted, open_count + 1);
+
+        /* the pipelined connection went back to the pool */
+        r = pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        ASSERT_EQ(srv.accepted, open_count + 1);
+
+        /* the server closes after the third response: the rest are left unanswered */
+        (void)snprintf(urls[2], sizeof(urls[2]), "http://127.0.0.1:%d/close", srv.port);
+        r = pas_http_client_pipeline(&client, items, 6, 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_E_CONNECTION);
+        ASSERT_EQ(items[1].status, PAS_HTTP_OK);
+        ASSERT(body_is(&items[2].response, "bye"));
+        ASSERT_EQ(items[3].status, PAS_HTTP_E_CONNECTION);
+        ASSERT_EQ(items[5].status, PAS_HTTP_E_CONNECTION);
+
+        /* no pool: the requests keep the connection open up to the last */
+        {
+            pas_http_client_t bare;
+            int reqs = srv.requests;
+
+            pas_http_client_init(&bare, NULL, 0, 5000);
+            (void)snprintf(urls[2], sizeof(urls[2]), "http://127.0.0.1:%d/echo/2", srv.port);
+            open_count = srv.accepted;
+            r = pas_http_client_pipeline(&bare, items, 3, 2000, &status);
+            ASSERT_EQ(r, PAS_HTTP_OK);
+            ASSERT(body_is(&items[2].response, "2"));
+            ASSERT_EQ(srv.requests, reqs + 3);
+            ASSERT_EQ(srv.accepted, open_count + 1);
+            ASSERT(strstr(srv.last_request, "Connection: close") != NULL);
+        }
+
+        /* one host per pipeline */
+        (void)snprintf(urls[1], sizeof(urls[1]), "http://localhost:%d/echo/1", srv.port);
+        r = pas_http_client_pipeline(&client, items, 3, 2000, &status);
+        ASSERT_EQ(r, PAS_HTTP_E_INVALID_URL);
+        pas_http_client_close(&client);
+    }
+
+    /* large bodies both ways against a server that answers while it reads: reading
+       overlaps writing, so the pipeline finishes well inside the socket timeout.
+       A first GET opens the pooled connection so its receive buffer can be capped
+       (autotuning would otherwise absorb every response). */
+    {
+        static pas_http_pipeline_item_t items[BULK_ITEMS];
+        static char bufs[BULK_ITEMS][BULK_SIZE + 256];
+        bulk_server bulk;
+        char bulk_url[64];
+        uint64_t t0;
+        int i, ok = 1, size = BULK_SOCKBUF;
+
+        ASSERT_EQ(bulk_start(&bulk), 0);
+        (void)snprintf(bulk_url, sizeof(bulk_url), "http://127.0.0.1:%d/upload", bulk.port);
+        pas_http_client_init(&client, conns, 2, 5000);
+        r = pas_http_client_get(&client, bulk_url, bufs[0], sizeof(bufs[0]), 3000, &res, &status);
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        ASSERT(conns[0].open);
+        setsockopt((int)conns[0].sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        memset(items, 0, sizeof(items));
+        for (i = 0; i < BULK_ITEMS; i++) {
+            items[i].method = "POST";
+            items[i].url = bulk_url;
+            items[i].body = g_bulk;
+            items[i].body_len = BULK_SIZE;
+            items[i].buf = bufs[i];
+            items[i].size = sizeof(bufs[i]);
+        }
+        t0 = pas_http__now_ms();
+        r = pas_http_client_pipeline(&client, items, BULK_ITEMS, 3000, &status);
+        t0 = pas_http__now_ms() - t0;
+        ASSERT_EQ(r, PAS_HTTP_OK);
+        for (i = 0; i < BULK_ITEMS; i++)
+            ok &= items[i].status == PAS_HTTP_OK && items[i].response.body_len == BULK_SIZE;
+        ASSERT(ok);
+        ASSERT(t0 < 1000);
+        pas_http_client_close(&client);
+        pthread_join(bulk.thread, NULL);
+        close(bulk.listen_fd);
+    }
+
+    r = pas_http_client_get(&client, "ftp://x/", buf, sizeof(buf), 2000, &res, &status);
+    ASSERT_EQ(status, PAS_HTTP_E_INVALID_URL);
+
+    pas_http_client_close(&client);
+    test_server_stop(&srv);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
+
+#else
+int main(void)
+{
+    (void)printf("(skipped: loopback server needs a Unix platform)\n");
+    return 0;
+}
+#endif
@@ -0,0 +1,298 @@
+/*
+    test_decode.c - Test gzip / deflate response decoding (client->decode), buffered and streamed.
+    From repo root: gcc -o tests/pas_http1/test_decode tests/pas_http1/test_decode.c -I. -DPAS_ZIP_USE_ZLIB -lz -lpthread
+    Needs a pas_zip backend (PAS_ZIP_USE_ZLIB or PAS_ZIP_USE_MINIZ); Unix only (the scripted
+    server uses poll and pthreads).
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#if defined(PAS_HTTP_HAS_DECODE) && (defined(__unix__) || defined(__APPLE__))
+#include "test_server.h"
+
+#define PLAIN_SIZE 20000
+
+static unsigned char g_plain[PLAIN_SIZE];
+static unsigned char g_gzip[PLAIN_SIZE], g_zlib[PLAIN_SIZE], g_raw[PLAIN_SIZE];
+static size_t g_gzip_len, g_zlib_len, g_raw_len;
+static unsigned char g_work[PAS_ZIP_INFLATE_WORK_SIZE];
+
+static size_t compress_into(unsigned char *dst, size_t cap, int window_bits)
+{
+    z_stream zs;
+    size_t out;
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, 6, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) return 0;
+    zs.next_in = g_plain;
+    zs.avail_in = PLAIN_SIZE;
+    zs.next_out = dst;
+    zs.avail_out = (unsigned)cap;
+    if (deflate(&zs, Z_FINISH) != Z_STREAM_END) { deflateEnd(&zs); return 0; }
+    out = (size_t)zs.total_out;
+    deflateEnd(&zs);
+    return out;
+}
+
+/* Header block plus a Content-Length body. */
+static size_t put_body(char *resp, size_t cap, const char *coding, const void *body, size_t len)
+{
+    size_t n = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\n%s%s%sContent-Length: %u\r\n\r\n",
+                                coding ? "Content-Encoding: " : "", coding ? coding : "",
+                                coding ? "\r\n" : "", (unsigned)len);
+    memcpy(resp + n, body, len);
+    return n + len;
+}
+
+/* gzip body in 7-byte chunks. */
+static size_t put_chunked(char *resp, size_t cap)
+{
+    size_t n = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\n"
+                                "Transfer-Encoding: chunked\r\n\r\n");
+    size_t i;
+
+    for (i = 0; i < g_gzip_len; i += 7) {
+        size_t k = g_gzip_len - i < 7 ? g_gzip_len - i : 7;
+        n += (size_t)snprintf(resp + n, cap - n, "%x\r\n", (unsigned)k);
+        memcpy(resp + n, g_gzip + i, k);
+        n += k;
+        memcpy(resp + n, "\r\n", 2);
+        n += 2;
+    }
+    memcpy(resp + n, "0\r\n\r\n", 5);
+    return n + 5;
+}
+
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    static unsigned char bad[PLAIN_SIZE];
+    (void)s; (void)req_len;
+
+    if (strncmp(req, "GET /gz ", 8) == 0) {
+        *resp_len = put_body(resp, cap, "gzip", g_gzip, g_gzip_len);
+    } else if (strncmp(req, "GET /chunked ", 13) == 0) {
+        *resp_len = put_chunked(resp, cap);
+    } else if (strncmp(req, "GET /zlib ", 10) == 0) {
+        *resp_len = put_body(resp, cap, "deflate", g_zlib, g_zlib_len);
+    } else if (strncmp(req, "GET /raw ", 9) == 0) {
+        *resp_len = put_body(resp, cap, "Deflate", g_raw, g_raw_len);
+    } else if (strncmp(req, "GET /crc ", 9) == 0) {
+        memcpy(bad, g_gzip, g_gzip_len);
+        bad[g_gzip_len - 8] ^= 1;   /* CRC-32 in the trailer */
+        *resp_len = put_body(resp, cap, "gzip", bad, g_gzip_len);
+    } else if (strncmp(req, "GET /cut ", 9) == 0) {
+        *resp_len = put_body(resp, cap, "gzip", g_gzip, g_gzip_len / 2);
+    } else if (strncmp(req, "GET /br ", 8) == 0) {
+        *resp_len = put_body(resp, cap, "br", "opaque", 6);
+    } else if (strncmp(req, "GET /stacked ", 13) == 0) {
+        *resp_len = put_body(resp, cap, "gzip, gzip", "opaque", 6);
+    } else {
+        *resp_len = put_body(resp, cap, NULL, "plain", 5);
+    }
+    return TEST_KEEP;
+}
+
+typedef struct {
+    unsigned char buf[PLAIN_SIZE + 64];
+    size_t        len;
+    size_t        runs;
+    size_t        max_run;
+    size_t        stop_after;   /* 0 = never */
+} sink;
+
+static int on_body(void *user, const void *data, size_t len)
+{
+    sink *k = (sink *)user;
+    if (k->len + len <= sizeof(k->buf)) memcpy(k->buf + k->len, data, len);
+    k->len += len;
+    k->runs++;
+    if (len > k->max_run) k->max_run = len;
+    return k->stop_after && k->runs >= k->stop_after;
+}
+
+static int on_status(void *user, int code)
+{
+    (void)user;
+    return code != 200;
+}
+
+static int body_is_plain(const pas_http_response_t *res)
+{
+    return res->body_len == PLAIN_SIZE && memcmp(res->body, g_plain, PLAIN_SIZE) == 0;
+}
+
+static int count_of(const char *s, size_t len, const char *needle)
+{
+    size_t n = strlen(needle), i;
+    int c = 0;
+    for (i = 0; i + n <= len; i++)
+        if (memcmp(s + i, needle, n) == 0) c++;
+    return c;
+}
+
+static void test_decode(void)
+{
+    static char buf[3 * PLAIN_SIZE];
+    static sink k;
+    test_server srv;
+    pas_http_conn_t conn;
+    pas_http_client_t client;
+    pas_http_response_t res;
+    pas_http_callbacks_t cb;
+    pas_http_header_t hdr;
+    char url[128], small[512];
+    int status, port;
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("  (server skip)\n");
+        return;
+    }
+    port = srv.port;
+    pas_http_client_init(&client, &conn, 1, 0);
+    ASSERT_EQ(client.decode, 0);
+
+    /* decode off: nothing advertised, the encoded body comes back as sent */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/gz", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "Accept-Encoding"), 0);
+    ASSERT(res.body_len == g_gzip_len && memcmp(res.body, g_gzip, g_gzip_len) == 0);
+
+    /* buffered: gzip, chunked gzip, zlib and raw deflate */
+    client.decode = 1;
+    client.decode_work = g_work;
+    client.decode_work_size = sizeof(g_work);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "\r\nAccept-Encoding: gzip, deflate\r\n"), 1);
+    ASSERT(body_is_plain(&res));
+    ASSERT(conn.open);   /* still pooled */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/chunked", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is_plain(&res));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/zlib", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is_plain(&res));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/raw", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is_plain(&res));
+
+    /* identity and codings the client cannot undo pass through */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/plain", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(res.body_len == 5 && memcmp(res.body, "plain", 5) == 0);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/br", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(res.body_len == 6 && memcmp(res.body, "opaque", 6) == 0);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/stacked", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(res.body_len == 6 && memcmp(res.body, "opaque", 6) == 0);
+
+    /* corrupt, truncated, and no room for the decoded body */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/crc", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_E_DECODE);
+    ASSERT_EQ(status, PAS_HTTP_E_DECODE);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/cut", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_E_DECODE);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/gz", port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, g_gzip_len + 1000, 2000, &res, &status), PAS_HTTP_E_NOSPACE);
+
+    /* a caller Accept-Encoding replaces the library's */
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.name = "accept-encoding";
+    hdr.value = "gzip";
+    ASSERT_EQ(pas_http_client_request(&client, "GET", url, &hdr, 1, NULL, 0, NULL,
+                                      buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "ccept-Encoding"), 0);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "accept-encoding: gzip\r\n"), 1);
+    ASSERT(body_is_plain(&res));
+
+    /* streamed through a small recv buffer: decoded runs of at most PAS_HTTP_DECODE_CHUNK */
+    memset(&cb, 0, sizeof(cb));
+    cb.on_status = on_status;
+    cb.on_body = on_body;
+    cb.user = &k;
+    memset(&k, 0, sizeof(k));
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_OK);
+    ASSERT(k.len == PLAIN_SIZE && memcmp(k.buf, g_plain, PLAIN_SIZE) == 0);
+    ASSERT(k.runs > 1 && k.max_run <= PAS_HTTP_DECODE_CHUNK);
+    memset(&k, 0, sizeof(k));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/chunked", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_OK);
+    ASSERT(k.len == PLAIN_SIZE && memcmp(k.buf, g_plain, PLAIN_SIZE) == 0);
+    memset(&k, 0, sizeof(k));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/zlib", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_OK);
+    ASSERT(k.len == PLAIN_SIZE && memcmp(k.buf, g_plain, PLAIN_SIZE) == 0);
+    memset(&k, 0, sizeof(k));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/plain", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_OK);
+    ASSERT(k.len == 5 && memcmp(k.buf, "plain", 5) == 0);
+
+    /* streamed errors; a caller stop stays PAS_HTTP_E_ABORTED */
+    memset(&k, 0, sizeof(k));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/crc", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_E_DECODE);
+    ASSERT(k.len > 0 && k.len < PLAIN_SIZE);   /* the run checked against the bad trailer is held back */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/cut", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_E_DECODE);
+    memset(&k, 0, sizeof(k));
+    k.stop_after = 2;
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/gz", port);
+    ASSERT_EQ(pas_http_client_get_stream(&client, url, &cb, small, sizeof(small), 2000, &status), PAS_HTTP_E_ABORTED);
+    ASSERT_EQ(k.runs, 2u);
+
+    /* backend-allocated inflate state */
+    client.decode_work = NULL;
+    client.decode_work_size = 0;
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is_plain(&res));
+    pas_http_client_close(&client);
+
+    test_server_stop(&srv);
+}
+#endif
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+#if defined(PAS_HTTP_HAS_DECODE) && (defined(__unix__) || defined(__APPLE__))
+    {
+        uint32_t x = 12345;
+        size_t i;
+        /* compressible but not trivial */
+        for (i = 0; i < PLAIN_SIZE; i++) {
+            x = x * 1103515245u + 12345u;
+            g_plain[i] = (unsigned char)("abcdefgh"[(x >> 16) & 7] + ((i / 1024) & 3));
+        }
+        g_gzip_len = compress_into(g_gzip, sizeof(g_gzip), 31);
+        g_zlib_len = compress_into(g_zlib, sizeof(g_zlib), 15);
+        g_raw_len = compress_into(g_raw, sizeof(g_raw), -15);
+        ASSERT(g_gzip_len > 0 && g_zlib_len > 0 && g_raw_len > 0);
+        ASSERT(g_gzip_len < PLAIN_SIZE / 2);
+    }
+    test_decode();
+#else
+    (void)printf("(decoding skipped: no PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB, or not Unix)\n");
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
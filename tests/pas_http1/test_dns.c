@@ -0,0 +1,248 @@
+/*
+    test_dns.c - Test the pas_http1 DNS cache and the happy-eyeballs connect race.
+    From repo root: gcc -o tests/pas_http1/test_dns tests/pas_http1/test_dns.c -I. -lpthread
+    Unix only (the scripted server uses poll and pthreads).
+*/
+
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "test_server.h"
+
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    (void)s; (void)req; (void)req_len;
+    *resp_len = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+    return TEST_KEEP;
+}
+
+/* Port with nothing listening. */
+static int closed_port(void)
+{
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0), port;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    (void)bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    (void)getsockname(fd, (struct sockaddr *)&addr, &alen);
+    port = ntohs(addr.sin_port);
+    close(fd);
+    return port;
+}
+
+/*
+    Port whose listener never accepts and whose queue is full, so a new connect
+    hangs (the SYN is dropped). fds receives the listener and the queued sockets.
+*/
+static int stalled_port(int *fds, int n)
+{
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int i;
+
+    fds[0] = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    (void)bind(fds[0], (struct sockaddr *)&addr, sizeof(addr));
+    (void)listen(fds[0], 0);
+    (void)getsockname(fds[0], (struct sockaddr *)&addr, &alen);
+    for (i = 1; i < n; i++) {
+        fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        (void)pas_http__set_nonblocking(fds[i], 1);
+        (void)connect(fds[i], (struct sockaddr *)&addr, sizeof(addr));
+    }
+    usleep(50000);
+    return ntohs(addr.sin_port);
+}
+
+/* Copies through a local struct: a->sa is uint64_t storage, not a sockaddr_in. */
+static void set_port(pas_http_addr_t *a, int port)
+{
+    struct sockaddr_in in;
+
+    memcpy(&in, a->sa, sizeof(in));
+    in.sin_port = htons((unsigned short)port);
+    memcpy(a->sa, &in, sizeof(in));
+}
+
+static int body_is(const pas_http_response_t *res, const char *s)
+{
+    return res->body_len == strlen(s) && memcmp(res->body, s, res->body_len) == 0;
+}
+
+static void test_dns(void)
+{
+    test_server srv;
+    pas_http_dns_entry_t entries[2];
+    pas_http_dns_cache_t cache;
+    pas_http_client_t client;
+    pas_http_conn_t conn;
+    pas_http_response_t res;
+    pas_http_addr_t addrs[PAS_HTTP_MAX_ADDRS];
+    pas_http_multi_t multi;
+    pas_http_request_t req;
+    char buf[512], rbuf[512], url[128];
+    int status, stall[4], i;
+    uint64_t t0;
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("  (server skip)\n");
+        return;
+    }
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/", srv.port);
+
+    pas_http_dns_init(&cache, entries, 2, 0);
+    ASSERT_EQ(cache.ttl_ms, PAS_HTTP_DEFAULT_DNS_TTL_MS);
+    pas_http_dns_init(&cache, entries, 2, 300);
+    pas_http_client_init(&client, NULL, 0, 0);
+    ASSERT(client.dns == NULL);
+    client.dns = &cache;
+
+    /* a lookup fills one entry */
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    ASSERT_EQ(entries[0].count, 1u);
+    ASSERT_EQ(entries[0].port, srv.port);
+    ASSERT(strcmp(entries[0].host, "127.0.0.1") == 0);
+    ASSERT_EQ(entries[0].addrs[0].family, AF_INET);
+    ASSERT_EQ(entries[1].count, 0u);
+
+    /* cached addresses are used as is: point the entry at a closed port */
+    set_port(&entries[0].addrs[0], closed_port());
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_E_CONNECTION);
+    ASSERT_EQ(entries[0].count, 0u);   /* failed lookup forgotten */
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(entries[0].count, 1u);
+
+    /* an expired entry is looked up again */
+    set_port(&entries[0].addrs[0], closed_port());
+    usleep(350000);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(entries[0].count, 1u);
+
+    /* race: the first address hangs, the second answers after the stagger */
+    pas_http_dns_init(&cache, entries, 2, 60000);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", srv.port, addrs), 1u);
+    entries[0].addrs[1] = entries[0].addrs[0];
+    entries[0].count = 2;
+    set_port(&entries[0].addrs[0], stalled_port(stall, 4));
+    client.connect_stagger_ms = 50;
+    t0 = pas_http__now_ms();
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 5000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    ASSERT(pas_http__now_ms() - t0 < 900);   /* did not wait out the stalled SYN */
+    ASSERT(pas_http__now_ms() - t0 >= 40);
+    ASSERT_EQ(entries[0].count, 2u);
+
+    /* every address stalled: bounded by the timeout */
+    entries[0].addrs[1] = entries[0].addrs[0];
+    t0 = pas_http__now_ms();
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 300, &res, &status), PAS_HTTP_E_TIMEOUT);
+    ASSERT(pas_http__now_ms() - t0 < 900);
+    for (i = 0; i < 4; i++) close(stall[i]);
+
+    /* a refused first address falls back at once, and the connection is pooled */
+    pas_http_client_init(&client, &conn, 1, 0);
+    client.dns = &cache;
+    pas_http_dns_init(&cache, entries, 2, 60000);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", srv.port, addrs), 1u);
+    entries[0].addrs[1] = entries[0].addrs[0];
+    entries[0].count = 2;
+    set_port(&entries[0].addrs[0], closed_port());
+    t0 = pas_http__now_ms();
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(pas_http__now_ms() - t0 < PAS_HTTP_DEFAULT_STAGGER_MS);
+    ASSERT(conn.open);
+    pas_http_client_close(&client);
+
+    /* host names: ::1 (nothing listening) falls back to 127.0.0.1 */
+    (void)snprintf(url, sizeof(url), "http://localhost:%d/", srv.port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is(&res, "hello"));
+    pas_http_client_close(&client);
+
+    /* multi engine: cached lookup, next address after a refused connect */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/", srv.port);
+    pas_http_dns_init(&cache, entries, 2, 60000);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", srv.port, addrs), 1u);
+    entries[0].addrs[1] = entries[0].addrs[0];
+    entries[0].count = 2;
+    set_port(&entries[0].addrs[0], closed_port());
+    ASSERT_EQ(pas_http_request_init(&req, "GET", url, NULL, 0, rbuf, sizeof(rbuf), 2000), PAS_HTTP_OK);
+    pas_http_multi_init(&multi, &req, 1);
+    ASSERT(multi.dns == NULL);
+    multi.dns = &cache;
+    for (i = 0; i < 100 && pas_http_multi_perform(&multi, 50) > 0; i++) {}
+    ASSERT(req.done);
+    ASSERT_EQ(req.status, PAS_HTTP_OK);
+    ASSERT(body_is(&req.response, "hello"));
+
+    /* ... and fails once none is left, forgetting the entry */
+    set_port(&entries[0].addrs[1], closed_port());
+    ASSERT_EQ(pas_http_request_init(&req, "GET", url, NULL, 0, rbuf, sizeof(rbuf), 2000), PAS_HTTP_OK);
+    for (i = 0; i < 100 && pas_http_multi_perform(&multi, 50) > 0; i++) {}
+    ASSERT_EQ(req.status, PAS_HTTP_E_CONNECTION);
+    ASSERT_EQ(entries[0].count, 0u);
+
+    test_server_stop(&srv);
+}
+#endif
+
+/* Keyed by host:port; a full cache replaces the least recently used entry. */
+static void test_lru(void)
+{
+    pas_http_dns_entry_t entries[2];
+    pas_http_dns_cache_t cache;
+    pas_http_addr_t addrs[PAS_HTTP_MAX_ADDRS];
+
+    pas_http_dns_init(&cache, entries, 2, 60000);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", 1001, addrs), 1u);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", 1002, addrs), 1u);
+    ASSERT(entries[0].port == 1001 && entries[1].port == 1002);
+    entries[0].last_used += 10;   /* 1001 used more recently */
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", 1003, addrs), 1u);
+    ASSERT_EQ(entries[0].port, 1001);
+    ASSERT_EQ(entries[1].port, 1003);
+    ASSERT_EQ(pas_http__resolve(&cache, "no-such-host.invalid", 80, addrs), 0u);
+    ASSERT(entries[0].port == 1001 && entries[1].port == 1003);
+
+    /* no cache: plain lookups */
+    ASSERT_EQ(pas_http__resolve(NULL, "127.0.0.1", 80, addrs), 1u);
+    pas_http_dns_init(&cache, NULL, 5, 0);
+    ASSERT_EQ(cache.count, 0u);
+    ASSERT_EQ(pas_http__resolve(&cache, "127.0.0.1", 80, addrs), 1u);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_lru();
+#if defined(__unix__) || defined(__APPLE__)
+    test_dns();
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+    test_multi.c - Test pas_http_multi_* concurrent requests against a loopback server.
+    From repo root: gcc -o tests/pas_http1/test_multi tests/pas_http1/test_multi.c -I. -lpthread
+    Unix only (the scripted server uses poll and pthreads).
+*/
+
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "test_server.h"
+
+#define REQUESTS 40
+
+/* /hang never answers; /chunked is chunked; POST echoes its body length; otherwise "hello". */
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    (void)s;
+    if (strncmp(req, "GET /hang ", 10) == 0) return TEST_IGNORE;
+    if (strncmp(req, "GET /chunked ", 13) == 0) {
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n");
+        return TEST_KEEP;
+    }
+    if (strncmp(req, "POST ", 5) == 0) {
+        const char *body = strstr(req, "\r\n\r\n") + 4;
+        *resp_len = (size_t)snprintf(resp, cap,
+            "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n%02u", (unsigned)(req + req_len - body));
+        return TEST_KEEP;
+    }
+    *resp_len = (size_t)snprintf(resp, cap,
+        "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+    return TEST_KEEP;
+}
+
+static int body_is(const pas_http_response_t *res, const char *s)
+{
+    return res->body_len == strlen(s) && memcmp(res->body, s, res->body_len) == 0;
+}
+
+static int on_body(void *user, const void *data, size_t len)
+{
+    char *acc = (char *)user;
+    size_t n = strlen(acc);
+    memcpy(acc + n, data, len);
+    acc[n + len] = '\0';
+    return 0;
+}
+
+/* Port with nothing listening. */
+static int closed_port(void)
+{
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0), port;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    (void)bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    (void)getsockname(fd, (struct sockaddr *)&addr, &alen);
+    port = ntohs(addr.sin_port);
+    close(fd);
+    return port;
+}
+
+static pas_http_request_t g_reqs[REQUESTS];
+static char g_bufs[REQUESTS][512];
+
+int main(void)
+{
+    test_server srv;
+    pas_http_multi_t multi;
+    pas_http_callbacks_t cb;
+    char url[128], acc[64];
+    int i, ok, rounds, running;
+    uint64_t t0;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("(skipped: cannot listen on 127.0.0.1)\n");
+        return 0;
+    }
+
+    /* many requests in flight on one thread */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/a", srv.port);
+    ok = 1;
+    for (i = 0; i < REQUESTS; i++) {
+        if (i % 2)
+            ok &= pas_http_request_init(&g_reqs[i], "POST", url, "0123456789", (size_t)(i % 10),
+                                        g_bufs[i], sizeof(g_bufs[i]), 5000) == PAS_HTTP_OK;
+        else
+            ok &= pas_http_request_init(&g_reqs[i], "GET", url, NULL, 0,
+                                        g_bufs[i], sizeof(g_bufs[i]), 5000) == PAS_HTTP_OK;
+    }
+    ASSERT(ok);
+    pas_http_multi_init(&multi, g_reqs, REQUESTS);
+    rounds = 0;
+    while ((running = pas_http_multi_perform(&multi, 1000)) > 0 && rounds < 1000) rounds++;
+    ASSERT_EQ(running, 0);
+    ok = 1;
+    for (i = 0; i < REQUESTS; i++) {
+        char expect[8];
+        if (i % 2) (void)snprintf(expect, sizeof(expect), "%02d", i % 10);
+        else (void)snprintf(expect, sizeof(expect), "hello");
+        ok &= g_reqs[i].done && g_reqs[i].status == PAS_HTTP_OK;
+        ok &= g_reqs[i].response.status_code == 200 && body_is(&g_reqs[i].response, expect);
+    }
+    ASSERT(ok);
+    ASSERT_EQ(srv.accepted, REQUESTS);
+
+    /* per-request deadline, a refused connect and a streamed body side by side */
+    memset(g_reqs, 0, sizeof(g_reqs));
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/hang", srv.port);
+    ASSERT_EQ(pas_http_request_init(&g_reqs[0], "GET", url, NULL, 0, g_bufs[0], sizeof(g_bufs[0]), 150), PAS_HTTP_OK);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/a", closed_port());
+    ASSERT_EQ(pas_http_request_init(&g_reqs[1], "GET", url, NULL, 0, g_bufs[1], sizeof(g_bufs[1]), 2000), PAS_HTTP_OK);
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/chunked", srv.port);
+    ASSERT_EQ(pas_http_request_init(&g_reqs[2], "GET", url, NULL, 0, g_bufs[2], 128, 2000), PAS_HTTP_OK);
+    acc[0] = '\0';
+    memset(&cb, 0, sizeof(cb));
+    cb.on_body = on_body;
+    cb.user = acc;
+    g_reqs[2].callbacks = &cb;
+    ASSERT_EQ(pas_http_request_init(&g_reqs[3], "GET", "ftp://x/", NULL, 0, g_bufs[3], sizeof(g_bufs[3]), 0),
+              PAS_HTTP_E_INVALID_URL);
+    ASSERT(g_reqs[3].done);
+    ASSERT_EQ(pas_http_request_init(&g_reqs[4], "GET", "http://h/", NULL, 0, g_bufs[4], 8, 0), PAS_HTTP_E_NOSPACE);
+
+    pas_http_multi_init(&multi, g_reqs, 5);
+    t0 = pas_http__now_ms();
+    rounds = 0;
+    while ((running = pas_http_multi_perform(&multi, -1)) > 0 && rounds < 1000) {
+        rounds++;
+        /* the finished stream slot is reused while the hanging request waits */
+        if (g_reqs[2].done && rounds < 1000 && g_reqs[2].callbacks) {
+            (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/a", srv.port);
+            ASSERT_EQ(pas_http_request_init(&g_reqs[2], "GET", url, NULL, 0, g_bufs[2], sizeof(g_bufs[2]), 2000),
+                      PAS_HTTP_OK);
+            ASSERT(strcmp(acc, "abcdef") == 0);
+        }
+    }
+    ASSERT_EQ(running, 0);
+    ASSERT_EQ(g_reqs[0].status, PAS_HTTP_E_TIMEOUT);
+    ASSERT(pas_http__now_ms() - t0 >= 150);
+    ASSERT(pas_http__now_ms() - t0 < 2000);
+    ASSERT_EQ(g_reqs[1].status, PAS_HTTP_E_CONNECTION);
+    ASSERT_EQ(g_reqs[2].status, PAS_HTTP_OK);
+    ASSERT(body_is(&g_reqs[2].response, "hello"));
+    ASSERT_EQ(g_reqs[3].status, PAS_HTTP_E_INVALID_URL);
+
+    /* cleanup aborts what is still in flight */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/hang", srv.port);
+    ASSERT_EQ(pas_http_request_init(&g_reqs[0], "GET", url, NULL, 0, g_bufs[0], sizeof(g_bufs[0]), 5000), PAS_HTTP_OK);
+    pas_http_multi_init(&multi, g_reqs, 1);
+    ASSERT_EQ(pas_http_multi_perform(&multi, 50), 1);
+    pas_http_multi_cleanup(&multi);
+    ASSERT(g_reqs[0].done);
+    ASSERT_EQ(g_reqs[0].status, PAS_HTTP_E_ABORTED);
+    ASSERT_EQ(pas_http_multi_perform(&multi, 0), 0);
+
+    test_server_stop(&srv);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
+
+#else
+int main(void)
+{
+    (void)printf("(skipped: loopback server needs a Unix platform)\n");
+    return 0;
+}
+#endif
@@ -1,5 +1,5 @@
 /*
-    test_pas_http1.c - Tests for pas_http1.h (URL parsing, error handling; no network)
+    test_pas_http1.c - Tests for pas_http1.h (URL parsing, error handling, response framing; no network)
     From repo root: gcc -o tests/pas_http1/test_pas_http1 tests/pas_http1/test_pas_http1.c -I.
     On Windows may need -lws2_32.
 */
@@ -73,6 +73,137 @@ static void test_get_example_com(void)
     ASSERT(res.body != NULL || res.body_len == 0);
 }
 
+/* Feeds msg to the response framer step bytes at a time; returns the last feed result.
+   head_req: msg answers a HEAD request. */
+static int feed_rx_as(pas_http__rx *rx, char *buf, size_t cap, const char *msg, size_t step, int head_req)
+{
+    size_t len = strlen(msg), off = 0;
+    int r = 0;
+
+    pas_http__rx_init(rx, buf, cap, head_req);
+    while (off < len && r == 0) {
+        size_t n = len - off < step ? len - off : step;
+        memcpy(buf + rx->len, msg + off, n);
+        off += n;
+        r = pas_http__rx_feed(rx, n);
+    }
+    return r;
+}
+
+static int feed_rx(pas_http__rx *rx, char *buf, size_t cap, const char *msg, size_t step)
+{
+    return feed_rx_as(rx, buf, cap, msg, step, 0);
+}
+
+/* Response framing: Content-Length, chunked decoding in place, malformed heads */
+static void test_framing(void)
+{
+    static const char chunked[] =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n\r\n"
+        "4\r\nWiki\r\n5;name=v\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\nTrailer: x\r\n\r\n";
+    char buf[512];
+    pas_http__rx rx;
+    size_t step;
+    int ok = 1;
+
+    for (step = 1; step <= 9; step += 4) {
+        ok &= feed_rx(&rx, buf, sizeof(buf), chunked, step) == 1;
+        ok &= rx.body_len == 23 && memcmp(buf + rx.head_len, "Wikipedia in\r\n\r\nchunks.", 23) == 0;
+        ok &= rx.keep_alive == 1;
+    }
+    ASSERT(ok);
+
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabcEXTRA", 2), 1);
+    ASSERT_EQ(rx.body_len, 3u);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nab", 100), 0);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: 3, 3\r\n\r\nabc", 100), 1);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: 3, 4\r\n\r\nabc", 100), -1);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: x\r\n\r\n", 100), -1);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 100), -1);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 304 Not Modified\r\nContent-Length: 9\r\n\r\n", 100), 1);
+    ASSERT_EQ(rx.body_len, 0u);
+
+    /* HEAD: the headers describe the body a GET would get, none follows */
+    ASSERT_EQ(feed_rx_as(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\n", 100, 1), 1);
+    ASSERT_EQ(rx.body_len, 0u);
+    ASSERT_EQ(rx.keep_alive, 1);
+    ASSERT_EQ(feed_rx_as(&rx, buf, sizeof(buf),
+                         "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nHTTP/1.1 200 OK\r\n", 100, 1), 1);
+    ASSERT_EQ(rx.body_len, 0u);
+    ASSERT_EQ(rx.extra, 17u);   /* the next pipelined response is left alone */
+
+    /* HTTP/1.0 and close-delimited bodies do not keep the connection */
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.0 200 OK\r\nContent-Length: 1\r\n\r\na", 100), 1);
+    ASSERT_EQ(rx.keep_alive, 0);
+    ASSERT_EQ(feed_rx(&rx, buf, sizeof(buf), "HTTP/1.1 200 OK\r\n\r\nuntil close", 100), 0);
+    ASSERT_EQ(pas_http__rx_eof(&rx), 1);
+    ASSERT_EQ(rx.body_len, 11u);
+    ASSERT_EQ(rx.keep_alive, 0);
+}
+
+/* Header index: slices into the buffer, well-known ids, repeated and unknown names */
+static void test_headers(void)
+{
+    static char msg[] =
+        "HTTP/1.1 200 OK\r\ncontent-type:  text/html; charset=utf-8 \r\nETag: \"abc\"\r\n"
+        "Set-Cookie: a=1\r\nX-Long-Custom-Header-Name: some value\r\nbogus line\r\n"
+        "Set-Cookie: b=2\r\nx-long-custom-header-name: again\r\nContent-Length: 2\r\n\r\nhi";
+    pas_http_response_t res;
+    pas_http_headers_t idx;
+    pas_http_header_t items[8];
+    const pas_http_header_t *h;
+    pas_http__rx rx;
+    char buf[512];
+    size_t i, n = 0;
+    int ok = 1;
+
+    ASSERT_EQ(pas_http_parse_response(msg, sizeof(msg) - 1, &res), 0);
+    ASSERT_EQ(pas_http_headers_parse(&idx, items, 8, &res), PAS_HTTP_OK);
+    ASSERT_EQ(idx.count, 7u);
+    h = pas_http_headers_get(&idx, PAS_HTTP_H_CONTENT_TYPE);
+    ASSERT(h && h->value_len == 24 && memcmp(h->value, "text/html; charset=utf-8", 24) == 0);
+    ASSERT(h && h->name == msg + 17);   /* zero-copy */
+    h = pas_http_headers_find(&idx, "etag");
+    ASSERT(h && h->id == PAS_HTTP_H_ETAG && h->value_len == 5);
+    ASSERT(pas_http_headers_get(&idx, PAS_HTTP_H_LOCATION) == NULL);
+    for (h = pas_http_headers_get(&idx, PAS_HTTP_H_SET_COOKIE); h; h = pas_http_headers_next(&idx, h)) n++;
+    ASSERT_EQ(n, 2u);
+    h = pas_http_headers_find(&idx, "X-LONG-custom-header-name");
+    ASSERT(h && h->id == PAS_HTTP_H_OTHER && h->value_len == 10);
+    h = pas_http_headers_next(&idx, h);
+    ASSERT(h && h->value_len == 5 && memcmp(h->value, "again", 5) == 0);
+    ASSERT(pas_http_headers_find(&idx, "X-Missing") == NULL);
+
+    /* more lines than slots: the first ones are still indexed */
+    ASSERT_EQ(pas_http_headers_parse(&idx, items, 3, &res), PAS_HTTP_E_NOSPACE);
+    ASSERT_EQ(idx.count, 3u);
+    ASSERT(pas_http_headers_get(&idx, PAS_HTTP_H_CONTENT_LENGTH) == NULL);
+
+    for (i = 0; i < PAS_HTTP_H_COUNT; i++) {
+        const char *name = pas_http__known[i].name;
+        ok &= pas_http_header_id(name, strlen(name)) == (int)i;
+    }
+    ASSERT(ok);
+    ASSERT_EQ(pas_http_header_id("content-lengthx", 15), PAS_HTTP_H_OTHER);
+    ASSERT_EQ(pas_http_header_id("Content-Lengt", 13), PAS_HTTP_H_OTHER);
+
+    /* line search across word boundaries, and heads split anywhere */
+    ok = 1;
+    for (i = 1; i <= 17; i++) ok &= feed_rx(&rx, buf, sizeof(buf), msg, i) == 1 && rx.body_len == 2;
+    ASSERT(ok);
+    ASSERT_EQ(pas_http__head_end("HTTP/1.1 200 OK\r\n\r", 0, 18), 0u);
+    ASSERT_EQ(pas_http__head_end("\r\n\r\n", 0, 4), 4u);
+    ok = 1;
+    for (i = 0; i < 20; i++) {
+        char line[21];
+        memset(line, 'a', 20);
+        line[i] = '\n';
+        ok &= pas_http__find_lf(line, line + 20) == line + i;
+        ok &= pas_http__find_lf(line, line + i) == line + i;   /* not found: end */
+    }
+    ASSERT(ok);
+}
+
 int main(void)
 {
     g_failed = 0;
@@ -80,6 +211,8 @@ int main(void)
 
     test_invalid_url();
     test_null_buffer();
+    test_framing();
+    test_headers();
     test_get_example_com();
 
     if (g_failed) {
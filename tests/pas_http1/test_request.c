@@ -0,0 +1,239 @@
+/*
+    test_request.c - Test caller request headers: pas_http_build_request, pas_http_client_request,
+    pas_http_request_init_headers and pipeline items with headers.
+    From repo root: gcc -o tests/pas_http1/test_request tests/pas_http1/test_request.c -I. -lpthread
+    The loopback part is Unix only (the scripted server uses poll and pthreads).
+*/
+
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define LONG_PATH 6000
+
+static int count_of(const char *s, size_t len, const char *needle)
+{
+    size_t n = strlen(needle), i;
+    int c = 0;
+    for (i = 0; i + n <= len; i++)
+        if (memcmp(s + i, needle, n) == 0) c++;
+    return c;
+}
+
+/* Serialization into a caller buffer, and what the library adds or leaves out */
+static void test_build(void)
+{
+    static const char expect[] =
+        "PUT /up?x=1 HTTP/1.1\r\nHost: example.com:8080\r\nAuthorization: Bearer t\r\n"
+        "Content-Encoding: gzip\r\nContent-Length: 3\r\n\r\n";
+    pas_http_header_t hdrs[3];
+    char buf[256];
+    size_t len;
+
+    memset(hdrs, 0, sizeof(hdrs));
+    hdrs[0].name = "Authorization";
+    hdrs[0].value = "Bearer tXXX";
+    hdrs[0].value_len = 8;   /* explicit lengths need not be terminated */
+    hdrs[1].name = "Content-Encoding";
+    hdrs[1].value = "gzip";
+
+    /* size query, then the exact size */
+    ASSERT_EQ(pas_http_build_request(NULL, 0, "PUT", "http://example.com:8080/up?x=1", hdrs, 2,
+                                     "abc", 3, &len), PAS_HTTP_E_NOSPACE);
+    ASSERT_EQ(len, sizeof(expect) - 1);
+    ASSERT_EQ(pas_http_build_request(buf, len - 1, "PUT", "http://example.com:8080/up?x=1", hdrs, 2,
+                                     "abc", 3, &len), PAS_HTTP_E_NOSPACE);
+    ASSERT_EQ(pas_http_build_request(buf, len, "PUT", "http://example.com:8080/up?x=1", hdrs, 2,
+                                     "abc", 3, &len), PAS_HTTP_OK);
+    ASSERT(len == sizeof(expect) - 1 && memcmp(buf, expect, len) == 0);
+
+    /* no body: no Content-Length; no path: "/" */
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "http://h", NULL, 0, NULL, 0, &len), PAS_HTTP_OK);
+    ASSERT(len == 27 && memcmp(buf, "GET / HTTP/1.1\r\nHost: h\r\n\r\n", 27) == 0);
+
+    /* caller Host and Content-Length replace the library's */
+    hdrs[0].name = "host";
+    hdrs[0].value = "virtual.example";
+    hdrs[0].value_len = 0;
+    hdrs[1].name = "Content-Length";
+    hdrs[1].value = "3";
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "POST", "http://h/p", hdrs, 2, "abc", 3, &len), PAS_HTTP_OK);
+    ASSERT_EQ(count_of(buf, len, "ost: "), 1);
+    ASSERT_EQ(count_of(buf, len, "host: virtual.example\r\n"), 1);
+    ASSERT_EQ(count_of(buf, len, "Content-Length"), 1);
+
+    /* header injection and malformed names are refused */
+    hdrs[2].name = "X-Evil";
+    hdrs[2].value = "a\r\nInjected: 1";
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "http://h/", hdrs, 3, NULL, 0, &len),
+              PAS_HTTP_E_INVALID_URL);
+    hdrs[2].name = "X:Evil";
+    hdrs[2].value = "a";
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "http://h/", hdrs, 3, NULL, 0, &len),
+              PAS_HTTP_E_INVALID_URL);
+    hdrs[2].name = "";
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "http://h/", hdrs, 3, NULL, 0, &len),
+              PAS_HTTP_E_INVALID_URL);
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "http://h/a b\r\n", NULL, 0, NULL, 0, &len),
+              PAS_HTTP_E_INVALID_URL);
+    ASSERT_EQ(pas_http_build_request(buf, sizeof(buf), "GET", "ftp://h/", NULL, 0, NULL, 0, &len),
+              PAS_HTTP_E_INVALID_URL);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "test_server.h"
+
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    (void)s; (void)req; (void)req_len;
+    *resp_len = (size_t)snprintf(resp, cap, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    return TEST_KEEP;
+}
+
+static int body_is(const pas_http_response_t *res, const char *s)
+{
+    return res->body_len == strlen(s) && memcmp(res->body, s, res->body_len) == 0;
+}
+
+static int on_body(void *user, const void *data, size_t len)
+{
+    *(size_t *)user += len;
+    (void)data;
+    return 0;
+}
+
+static void test_loopback(void)
+{
+    static const unsigned char gz[] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03 };
+    static char url[LONG_PATH + 64];
+    static pas_http_pipeline_item_t items[3];
+    static char bufs[3][256];
+    test_server srv;
+    pas_http_conn_t conn;
+    pas_http_client_t client;
+    pas_http_response_t res;
+    pas_http_header_t hdrs[24];
+    char names[24][16], values[24][16];
+    pas_http_callbacks_t cb;
+    pas_http_multi_t multi;
+    pas_http_request_t req;
+    char buf[512], line[64];
+    size_t i, streamed = 0, n;
+    int status, ok;
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("  (server skip)\n");
+        return;
+    }
+    pas_http_client_init(&client, &conn, 1, 0);
+
+    /* more headers than one gathered send takes, then a binary body */
+    memset(hdrs, 0, sizeof(hdrs));
+    for (i = 0; i < 24; i++) {
+        (void)sprintf(names[i], "X-Trace-%u", (unsigned)i);
+        (void)sprintf(values[i], "v%u", (unsigned)(i * 7));
+        hdrs[i].name = names[i];
+        hdrs[i].value = values[i];
+    }
+    hdrs[0].name = "Content-Encoding";
+    hdrs[0].value = "gzip";
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/upload", srv.port);
+    ASSERT_EQ(pas_http_client_request(&client, "PUT", url, hdrs, 24, gz, sizeof(gz), NULL,
+                                      buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(body_is(&res, "ok"));
+    ASSERT(strncmp(srv.last_request, "PUT /upload HTTP/1.1\r\n", 22) == 0);
+    ok = 1;
+    for (i = 1; i < 24; i++) {
+        (void)sprintf(line, "\r\n%s: %s\r\n", names[i], values[i]);
+        ok &= count_of(srv.last_request, srv.last_request_len, line) == 1;
+    }
+    ASSERT(ok);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "Content-Encoding: gzip\r\n"), 1);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "Content-Length: 10\r\n"), 1);
+    ASSERT(memcmp(srv.last_request + srv.last_request_len - sizeof(gz), gz, sizeof(gz)) == 0);
+    ASSERT(conn.open);   /* keep-alive client: no Connection header added */
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "Connection"), 0);
+
+    /* paths far past the old fixed limits */
+    n = (size_t)snprintf(url, sizeof(url), "http://127.0.0.1:%d/", srv.port);
+    for (i = 0; i < LONG_PATH; i++) url[n + i] = (char)('a' + i % 26);
+    url[n + LONG_PATH] = '\0';
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(srv.last_request_len > LONG_PATH && memcmp(srv.last_request + 5, url + n, LONG_PATH) == 0);
+
+    /* streamed, with headers */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/s", srv.port);
+    memset(&cb, 0, sizeof(cb));
+    cb.on_body = on_body;
+    cb.user = &streamed;
+    ASSERT_EQ(pas_http_client_request(&client, "GET", url, hdrs + 1, 1, NULL, 0, &cb,
+                                      buf, sizeof(buf), 2000, NULL, &status), PAS_HTTP_OK);
+    ASSERT_EQ(streamed, 2u);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "X-Trace-1: v7\r\n"), 1);
+    hdrs[1].value = "bad\n";
+    ASSERT_EQ(pas_http_client_request(&client, "GET", url, hdrs + 1, 1, NULL, 0, NULL,
+                                      buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_E_INVALID_URL);
+    hdrs[1].value = values[1];
+    pas_http_client_close(&client);
+
+    /* multi engine: headers formatted into the request buffer */
+    ASSERT_EQ(pas_http_request_init_headers(&req, "GET", url, hdrs + 2, 1, NULL, 0, buf, 40, 2000),
+              PAS_HTTP_E_NOSPACE);
+    ASSERT_EQ(pas_http_request_init_headers(&req, "GET", url, hdrs + 2, 1, NULL, 0, buf, sizeof(buf), 2000),
+              PAS_HTTP_OK);
+    pas_http_multi_init(&multi, &req, 1);
+    for (i = 0; i < 100 && pas_http_multi_perform(&multi, 50) > 0; i++) {}
+    ASSERT_EQ(req.status, PAS_HTTP_OK);
+    ASSERT(body_is(&req.response, "ok"));
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "X-Trace-2: v14\r\n"), 1);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "Connection: close\r\n"), 1);
+
+    /* pipeline items with headers */
+    pas_http_client_init(&client, &conn, 1, 0);
+    memset(items, 0, sizeof(items));
+    for (i = 0; i < 3; i++) {
+        items[i].method = "GET";
+        items[i].url = url;
+        items[i].headers = hdrs + 3 + i;
+        items[i].header_count = 1;
+        items[i].buf = bufs[i];
+        items[i].size = sizeof(bufs[i]);
+    }
+    ASSERT_EQ(pas_http_client_pipeline(&client, items, 3, 2000, &status), PAS_HTTP_OK);
+    ok = 1;
+    for (i = 0; i < 3; i++) ok &= items[i].status == PAS_HTTP_OK && body_is(&items[i].response, "ok");
+    ASSERT(ok);
+    ASSERT_EQ(count_of(srv.last_request, srv.last_request_len, "X-Trace-5: v35\r\n"), 1);
+    pas_http_client_close(&client);
+
+    test_server_stop(&srv);
+}
+#endif
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_build();
+#if defined(__unix__) || defined(__APPLE__)
+    test_loopback();
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
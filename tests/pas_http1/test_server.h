@@ -0,0 +1,220 @@
+/*
+    test_server.h - Scripted loopback HTTP server for the pas_http1 tests (Unix only).
+    One thread polls the listening socket and all client connections; every complete
+    request (headers plus Content-Length body) is handed to a responder callback.
+*/
+
+#ifndef TEST_SERVER_H
+#define TEST_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_SERVER_CLIENTS 64
+#define TEST_SERVER_BUF 16384
+
+#if defined(__GNUC__)
+#define TEST_UNUSED __attribute__((unused))
+#else
+#define TEST_UNUSED
+#endif
+
+/* responder results */
+#define TEST_KEEP   0   /* send response, keep the connection */
+#define TEST_CLOSE  1   /* send response, then close */
+#define TEST_DROP   2   /* close without responding */
+#define TEST_IGNORE 3   /* never respond, keep the connection open */
+
+typedef struct test_server test_server;
+
+/* Writes the response for one request into resp; returns TEST_KEEP / TEST_CLOSE / TEST_DROP / TEST_IGNORE. */
+typedef int (*test_responder)(test_server *s, const char *req, size_t req_len,
+                              char *resp, size_t resp_cap, size_t *resp_len);
+
+typedef struct {
+    int    fd;
+    size_t len;
+    char   buf[TEST_SERVER_BUF];
+} test_client;
+
+struct test_server {
+    int             listen_fd;
+    int             port;
+    pthread_t       thread;
+    volatile int    stop;
+    test_responder  respond;
+    void           *user;
+    volatile int    accepted;    /* connections accepted */
+    volatile int    requests;    /* requests answered */
+    char            last_request[TEST_SERVER_BUF];
+    size_t          last_request_len;
+    test_client     clients[TEST_SERVER_CLIENTS];
+};
+
+/* Length of the first complete request in buf, or 0 if more bytes are needed. */
+static size_t test_request_len(const char *buf, size_t len) {
+    size_t i, head = 0, body = 0;
+
+    for (i = 3; i < len; i++) {
+        if (buf[i - 3] == '\r' && buf[i - 2] == '\n' && buf[i - 1] == '\r' && buf[i] == '\n') {
+            head = i + 1;
+            break;
+        }
+    }
+    if (!head) return 0;
+    for (i = 0; i + 15 < head; i++) {
+        if ((i == 0 || buf[i - 1] == '\n') && strncasecmp(buf + i, "Content-Length:", 15) == 0) {
+            body = (size_t)strtoul(buf + i + 15, NULL, 10);
+            break;
+        }
+    }
+    return head + body <= len ? head + body : 0;
+}
+
+static void test_send_all(int fd, const char *p, size_t n) {
+    while (n) {
+        ssize_t r = send(fd, p, n, MSG_NOSIGNAL);
+        if (r <= 0) return;
+        p += r;
+        n -= (size_t)r;
+    }
+}
+
+static void test_client_close(test_client *c) {
+    close(c->fd);
+    c->fd = -1;
+    c->len = 0;
+}
+
+static void test_client_serve(test_server *s, test_client *c) {
+    static char resp[TEST_SERVER_BUF * 4];
+    size_t req;
+
+    while ((req = test_request_len(c->buf, c->len)) != 0) {
+        size_t resp_len = 0;
+        int action;
+
+        memcpy(s->last_request, c->buf, req);
+        s->last_request_len = req;
+        action = s->respond(s, c->buf, req, resp, sizeof(resp), &resp_len);
+        if (action == TEST_DROP) {
+            test_client_close(c);
+            return;
+        }
+        if (action == TEST_IGNORE) {
+            c->len = 0;
+            return;
+        }
+        test_send_all(c->fd, resp, resp_len);
+        s->requests++;
+        memmove(c->buf, c->buf + req, c->len - req);
+        c->len -= req;
+        if (action == TEST_CLOSE) {
+            test_client_close(c);
+            return;
+        }
+    }
+}
+
+static void *test_server_main(void *arg) {
+    test_server *s = (test_server *)arg;
+
+    while (!s->stop) {
+        struct pollfd pfd[TEST_SERVER_CLIENTS + 1];
+        int map[TEST_SERVER_CLIENTS + 1];
+        int n = 1, i;
+
+        pfd[0].fd = s->listen_fd;
+        pfd[0].events = POLLIN;
+        for (i = 0; i < TEST_SERVER_CLIENTS; i++) {
+            if (s->clients[i].fd < 0) continue;
+            pfd[n].fd = s->clients[i].fd;
+            pfd[n].events = POLLIN;
+            map[n++] = i;
+        }
+        if (poll(pfd, (nfds_t)n, 20) <= 0) continue;
+        if (pfd[0].revents & POLLIN) {
+            int fd = accept(s->listen_fd, NULL, NULL);
+            for (i = 0; fd >= 0 && i < TEST_SERVER_CLIENTS; i++) {
+                if (s->clients[i].fd < 0) {
+                    s->clients[i].fd = fd;
+                    s->clients[i].len = 0;
+                    s->accepted++;
+                    fd = -1;
+                }
+            }
+            if (fd >= 0) close(fd);
+        }
+        for (i = 1; i < n; i++) {
+            test_client *c = &s->clients[map[i]];
+            ssize_t r;
+
+            if (!(pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) || c->fd < 0) continue;
+            r = recv(c->fd, c->buf + c->len, sizeof(c->buf) - c->len, 0);
+            if (r <= 0) {
+                test_client_close(c);
+                continue;
+            }
+            c->len += (size_t)r;
+            test_client_serve(s, c);
+        }
+    }
+    return NULL;
+}
+
+/* Starts listening on an ephemeral 127.0.0.1 port (s->port). Returns 0 on success. */
+static int test_server_start(test_server *s, test_responder respond, void *user) {
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int one = 1, i;
+
+    memset(s, 0, sizeof(*s));
+    for (i = 0; i < TEST_SERVER_CLIENTS; i++) s->clients[i].fd = -1;
+    s->respond = respond;
+    s->user = user;
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) return -1;
+    setsockopt(s->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(s->listen_fd, 64) != 0 ||
+        getsockname(s->listen_fd, (struct sockaddr *)&addr, &alen) != 0) {
+        close(s->listen_fd);
+        return -1;
+    }
+    s->port = ntohs(addr.sin_port);
+    if (pthread_create(&s->thread, NULL, test_server_main, s) != 0) {
+        close(s->listen_fd);
+        return -1;
+    }
+    return 0;
+}
+
+static void test_server_stop(test_server *s) {
+    int i;
+
+    s->stop = 1;
+    pthread_join(s->thread, NULL);
+    for (i = 0; i < TEST_SERVER_CLIENTS; i++)
+        if (s->clients[i].fd >= 0) test_client_close(&s->clients[i]);
+    close(s->listen_fd);
+}
+
+/* Closes every open server-side connection (as an idle-timeout on the server would). */
+TEST_UNUSED static void test_server_drop_all(test_server *s) {
+    int i;
+    for (i = 0; i < TEST_SERVER_CLIENTS; i++)
+        if (s->clients[i].fd >= 0) shutdown(s->clients[i].fd, SHUT_RDWR);
+}
+
+#endif /* TEST_SERVER_H */
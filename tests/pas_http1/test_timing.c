@@ -0,0 +1,169 @@
+/*
+    test_timing.c - Test per-request timing (client->timing, client->on_timing, req->timing).
+    From repo root: gcc -o tests/pas_http1/test_timing tests/pas_http1/test_timing.c -I. -lpthread
+    Unix only (the scripted server uses poll and pthreads).
+*/
+
+#define PAS_HTTP1_IMPLEMENTATION
+#include "pas_http1.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "test_server.h"
+
+#define RESPONSE "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"
+
+static int respond(test_server *s, const char *req, size_t req_len,
+                   char *resp, size_t cap, size_t *resp_len)
+{
+    static int dropped;
+    (void)s; (void)req_len;
+    if (strncmp(req, "GET /slow ", 10) == 0) usleep(60000);
+    if (strncmp(req, "GET /drop ", 10) == 0 && !dropped++) return TEST_DROP;   /* once */
+    *resp_len = (size_t)snprintf(resp, cap, RESPONSE);
+    return TEST_KEEP;
+}
+
+typedef struct {
+    int               calls;
+    pas_http_timing_t last;
+} recorder;
+
+static void on_timing(void *user, const pas_http_timing_t *t)
+{
+    recorder *r = (recorder *)user;
+    r->calls++;
+    r->last = *t;
+}
+
+/* Every phase present and in order. */
+static int phases_ordered(const pas_http_timing_t *t)
+{
+    return t->start_us && t->start_us <= t->connected_us && t->connected_us <= t->sent_us &&
+           t->sent_us <= t->first_byte_us && t->first_byte_us <= t->done_us;
+}
+
+static int closed_port(void)
+{
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0), port;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    (void)bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    (void)getsockname(fd, (struct sockaddr *)&addr, &alen);
+    port = ntohs(addr.sin_port);
+    close(fd);
+    return port;
+}
+
+static void test_timing(void)
+{
+    test_server srv;
+    pas_http_conn_t conn;
+    pas_http_client_t client;
+    pas_http_response_t res;
+    pas_http_timing_t t;
+    pas_http_multi_t multi;
+    pas_http_request_t req;
+    recorder rec;
+    char buf[512], url[128];
+    uint64_t before;
+    int status, i;
+
+    /* microseconds */
+    before = pas_http_now_us();
+    usleep(2000);
+    ASSERT(pas_http_now_us() - before >= 1500 && pas_http_now_us() - before < 1000000);
+
+    if (test_server_start(&srv, respond, NULL) != 0) {
+        (void)printf("  (server skip)\n");
+        return;
+    }
+    pas_http_client_init(&client, &conn, 1, 0);
+    ASSERT(client.timing == NULL && client.on_timing == NULL);
+    memset(&rec, 0, sizeof(rec));
+    client.timing = &t;
+    client.on_timing = on_timing;
+    client.timing_user = &rec;
+
+    /* fresh connection: every phase, byte counts as on the wire */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/slow", srv.port);
+    before = pas_http_now_us();
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT_EQ(rec.calls, 1);
+    ASSERT(memcmp(&rec.last, &t, sizeof(t)) == 0);
+    ASSERT(t.start_us >= before && phases_ordered(&t));
+    ASSERT(t.resolved_us >= t.start_us && t.resolved_us <= t.connected_us);
+    ASSERT(t.first_byte_us - t.sent_us >= 50000);   /* the server's think time is TTFB */
+    ASSERT_EQ(t.bytes_sent, (uint64_t)srv.last_request_len);
+    ASSERT_EQ(t.bytes_received, (uint64_t)(sizeof(RESPONSE) - 1));
+    ASSERT(!t.reused && t.retries == 0 && t.status == PAS_HTTP_OK);
+
+    /* pooled: no lookup, reused flag set */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/", srv.port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(t.reused && t.resolved_us == 0 && phases_ordered(&t));
+    ASSERT(t.first_byte_us - t.sent_us < 50000);
+
+    /* the pooled connection is dropped unanswered: one retry on a fresh one */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/drop", srv.port);
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_OK);
+    ASSERT(t.retries == 1 && !t.reused && phases_ordered(&t));
+    ASSERT_EQ(t.bytes_sent, 2 * (uint64_t)srv.last_request_len);   /* both attempts */
+    ASSERT_EQ(t.bytes_received, (uint64_t)(sizeof(RESPONSE) - 1));
+    ASSERT_EQ(rec.calls, 3);
+    pas_http_client_close(&client);
+
+    /* failed connect: reported, with the phases that did not happen left 0 */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/", closed_port());
+    ASSERT_EQ(pas_http_client_get(&client, url, buf, sizeof(buf), 2000, &res, &status), PAS_HTTP_E_CONNECTION);
+    ASSERT_EQ(rec.calls, 4);
+    ASSERT(t.status == PAS_HTTP_E_CONNECTION && t.resolved_us && !t.connected_us && !t.sent_us);
+    ASSERT(t.done_us >= t.resolved_us && t.bytes_sent == 0 && t.bytes_received == 0);
+
+    /* multi engine: the request carries its own timing */
+    (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/slow", srv.port);
+    ASSERT_EQ(pas_http_request_init(&req, "GET", url, NULL, 0, buf, sizeof(buf), 2000), PAS_HTTP_OK);
+    ASSERT_EQ(req.timing.start_us, 0u);
+    pas_http_multi_init(&multi, &req, 1);
+    for (i = 0; i < 100 && pas_http_multi_perform(&multi, 50) > 0; i++) {}
+    ASSERT_EQ(req.status, PAS_HTTP_OK);
+    ASSERT(phases_ordered(&req.timing) && req.timing.resolved_us <= req.timing.connected_us);
+    ASSERT(req.timing.first_byte_us - req.timing.sent_us >= 50000);
+    ASSERT_EQ(req.timing.bytes_sent, (uint64_t)srv.last_request_len);
+    ASSERT_EQ(req.timing.bytes_received, (uint64_t)(sizeof(RESPONSE) - 1));
+    ASSERT_EQ(req.timing.status, PAS_HTTP_OK);
+    ASSERT_EQ(rec.calls, 4);   /* the hook is the client's only */
+
+    test_server_stop(&srv);
+}
+#endif
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+#if defined(__unix__) || defined(__APPLE__)
+    test_timing();
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
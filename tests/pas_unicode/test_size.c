@@ -0,0 +1,333 @@
+/*
+    test_size.c - Test the output-size functions and the single-pass _cstr conversions.
+    From repo root: gcc -o tests/pas_unicode/test_size tests/pas_unicode/test_size.c -I.
+    Also build with -mssse3, -mavx2 and -DPASU_NO_SIMD to cover each path.
+*/
+
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_unicode.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(MAP_ANON)
+#define PAGE_GUARD 1
+#endif
+#endif
+
+static int g_failed;
+static int g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { \
+        (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failed; \
+    } \
+} while (0)
+
+#define ASSERT_OK(st) ASSERT((st) == PASU_OK)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define BUF 600
+#define POISON 0xA5u
+
+static unsigned long g_seed = 4242;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+/* --- inputs --- */
+
+/* Code points in runs by script: ASCII, Latin-1, Cyrillic, CJK, emoji, plus the odd bad value. */
+static pasu_size gen_cps(pasu_codepoint *cp, pasu_size cap, int bad)
+{
+    pasu_size n = 0, run, k;
+    unsigned script;
+
+    while (n < cap) {
+        script = rnd(6);
+        run = 1 + rnd(24);
+        for (k = 0; k < run && n < cap; ++k) {
+            switch (script) {
+            case 0: cp[n] = 0x20 + rnd(0x5F); break;
+            case 1: cp[n] = rnd(3) ? 0x20 + rnd(0x5F) : 0x80 + rnd(0x780); break;
+            case 2: cp[n] = rnd(5) ? 0x410 + rnd(0x40) : 0x20; break;
+            case 3: cp[n] = rnd(2) ? 0x800 + rnd(0xD000) : 0xE000 + rnd(0x2000); break;
+            case 4: cp[n] = rnd(2) ? 0x10000 + rnd(0x100000) : 0x7FF + rnd(2); break;
+            default: cp[n] = rnd(2) ? 0xFFFF : 0x10FFFF - rnd(2); break;
+            }
+            ++n;
+        }
+        if (bad && rnd(10) == 0 && n < cap)
+            cp[n++] = rnd(2) ? 0xD800 + rnd(0x800) : 0x110000 + rnd(16) + (rnd(2) ? 0x7FF00000u : 0);
+    }
+    return n;
+}
+
+/* UTF-8 and UTF-16 forms of cps; bad values become raw defects in both. */
+static void encode_all(const pasu_codepoint *cps, pasu_size ncp, int bad,
+                       pasu_uint8 *u8, pasu_size *n8, pasu_uint16 *u16, pasu_size *n16)
+{
+    pasu_size k, used = 0;
+
+    *n8 = *n16 = 0;
+    for (k = 0; k < ncp; ++k) {
+        if (pasu_utf8_encode(cps[k], u8 + *n8, &used) == PASU_OK) *n8 += used;
+        else if (bad) u8[(*n8)++] = (pasu_uint8)(rnd(2) ? 0x80 + rnd(0x40) : 0xC0 + rnd(2));
+        if (pasu_utf16_encode(cps[k], u16 + *n16, &used) == PASU_OK) *n16 += used;
+        else if (bad) u16[(*n16)++] = (pasu_uint16)(0xD800 + rnd(0x800));
+    }
+}
+
+/* --- tests --- */
+
+static void test_fixed(void)
+{
+    static const pasu_uint8 s8[] = "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";   /* A, e-acute, euro, emoji */
+    static const pasu_uint16 s16[] = { 0x41, 0xE9, 0x20AC, 0xD83D, 0xDE00 };
+    static const pasu_codepoint s32[] = { 0x41, 0xE9, 0x20AC, 0x1F600 };
+    static const pasu_codepoint bad32[] = { 0x41, 0x20AC, 0x41, 0x41, 0xDC00, 0x41 };
+    pasu_status st;
+
+    ASSERT_EQ(pasu_utf8_to_utf16_size(s8, 10, &st), 5u);
+    ASSERT_OK(st);
+    ASSERT_EQ(pasu_utf8_to_utf32_size(s8, 10, &st), 4u);
+    ASSERT_EQ(pasu_utf16_to_utf8_size(s16, 5, &st), 10u);
+    ASSERT_EQ(pasu_utf16_to_utf32_size(s16, 5, &st), 4u);
+    ASSERT_EQ(pasu_utf32_to_utf8_size(s32, 4, &st), 10u);
+    ASSERT_EQ(pasu_utf32_to_utf16_size(s32, 4, &st), 5u);
+    ASSERT_OK(st);
+
+    /* the size of the part before the defect, with the conversion's status */
+    ASSERT_EQ(pasu_utf8_to_utf16_size(s8, 9, &st), 3u);
+    ASSERT_EQ(st, PASU_E_TRUNC);
+    ASSERT_EQ(pasu_utf16_to_utf8_size(s16, 4, &st), 6u);
+    ASSERT_EQ(st, PASU_E_TRUNC);
+    ASSERT_EQ(pasu_utf32_to_utf8_size(bad32, 6, &st), 6u);
+    ASSERT_EQ(st, PASU_E_SURROG);
+    ASSERT_EQ(pasu_utf32_to_utf16_size(bad32, 6, &st), 4u);
+    ASSERT_EQ(st, PASU_E_SURROG);
+
+    ASSERT_EQ(pasu_utf8_to_utf16_size(NULL, 0, &st), 0u);
+    ASSERT_OK(st);
+    ASSERT_EQ(pasu_utf16_to_utf8_size(NULL, 3, &st), 0u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+    ASSERT_EQ(pasu_utf32_to_utf16_size(NULL, 3, &st), 0u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+}
+
+/* Every size function against its conversion into a dst that cannot run out. */
+static void test_random_sizes(void)
+{
+    static pasu_codepoint cps[BUF], d32[BUF];
+    static pasu_uint8 u8[BUF * 4], d8[BUF * 4];
+    static pasu_uint16 u16[BUF * 2], d16[BUF * 2];
+    pasu_size ncp, n8, n16, off, len;
+    pasu_status st, rst;
+    int round, ok[6] = { 1, 1, 1, 1, 1, 1 }, errors = 0;
+
+    for (round = 0; round < 400; ++round) {
+        int bad = round % 2;
+        ncp = gen_cps(cps, 20 + rnd(BUF - 20), bad);
+        encode_all(cps, ncp, bad, u8, &n8, u16, &n16);
+
+        for (off = 0; off < 4; ++off) {
+            len = n8 - off - rnd(3);
+            ok[0] &= pasu_utf8_to_utf16_size(u8 + off, len, &st) ==
+                     pasu_utf8_to_utf16(u8 + off, len, d16, BUF * 2, &rst) && st == rst;
+            ok[1] &= pasu_utf8_to_utf32_size(u8 + off, len, &st) ==
+                     pasu_utf8_to_utf32(u8 + off, len, d32, BUF, &rst) && st == rst;
+            errors += rst != PASU_OK;
+
+            len = n16 - off - rnd(2);
+            ok[2] &= pasu_utf16_to_utf8_size(u16 + off, len, &st) ==
+                     pasu_utf16_to_utf8(u16 + off, len, d8, BUF * 4, &rst) && st == rst;
+            ok[3] &= pasu_utf16_to_utf32_size(u16 + off, len, &st) ==
+                     pasu_utf16_to_utf32(u16 + off, len, d32, BUF, &rst) && st == rst;
+
+            ok[4] &= pasu_utf32_to_utf8_size(cps + off, ncp - off, &st) ==
+                     pasu_utf32_to_utf8(cps + off, ncp - off, d8, BUF * 4, &rst) && st == rst;
+            ok[5] &= pasu_utf32_to_utf16_size(cps + off, ncp - off, &st) ==
+                     pasu_utf32_to_utf16(cps + off, ncp - off, d16, BUF * 2, &rst) && st == rst;
+        }
+    }
+    ASSERT(ok[0]);
+    ASSERT(ok[1]);
+    ASSERT(ok[2]);
+    ASSERT(ok[3]);
+    ASSERT(ok[4]);
+    ASSERT(ok[5]);
+    ASSERT(errors > 100);
+}
+
+static pasu_size len16(const pasu_uint16 *s) { pasu_size n = 0; while (s[n]) ++n; return n; }
+static pasu_size len32(const pasu_codepoint *s) { pasu_size n = 0; while (s[n]) ++n; return n; }
+
+/*
+    Each _cstr conversion against the buffer conversion of the measured string
+    (cap >= 2, src non-empty: the prologue cases are in test_cstr_edges).
+*/
+#define SAME_AS_MEASURED(ok, cstr, conv, src, n_src, d, r, cap) do { \
+    pasu_size n_, w_; \
+    pasu_status st_, rst_; \
+    memset(d, POISON, sizeof(d)); \
+    memset(r, POISON, sizeof(r)); \
+    n_ = cstr(src, d, cap, &st_); \
+    w_ = conv(src, n_src, r, (cap) - 1, &rst_); \
+    r[w_] = 0; \
+    (ok) &= n_ == w_ && st_ == rst_ && memcmp(d, r, sizeof(d)) == 0; \
+} while (0)
+
+static void check_cstr(int *ok, const pasu_uint8 *s8, const pasu_uint16 *s16, const pasu_codepoint *s32,
+                       pasu_size cap8, pasu_size cap16, pasu_size cap32)
+{
+    static pasu_codepoint d32[BUF + 1], r32[BUF + 1];
+    static pasu_uint8 d8[BUF * 4 + 1], r8[BUF * 4 + 1];
+    static pasu_uint16 d16[BUF * 2 + 1], r16[BUF * 2 + 1];
+    pasu_size n8 = strlen((const char *)s8), n16 = len16(s16), n32 = len32(s32);
+    pasu_status st, rst;
+
+    if (n8) {
+        SAME_AS_MEASURED(ok[0], pasu_utf8_to_utf16_cstr, pasu_utf8_to_utf16, s8, n8, d16, r16, cap16);
+        SAME_AS_MEASURED(ok[1], pasu_utf8_to_utf32_cstr, pasu_utf8_to_utf32, s8, n8, d32, r32, cap32);
+        ok[6] &= pasu_utf8_length_cstr(s8, &st) == pasu_utf8_length(s8, n8, &rst) && st == rst;
+    }
+    if (n16) {
+        SAME_AS_MEASURED(ok[2], pasu_utf16_to_utf8_cstr, pasu_utf16_to_utf8, s16, n16, d8, r8, cap8);
+        SAME_AS_MEASURED(ok[3], pasu_utf16_to_utf32_cstr, pasu_utf16_to_utf32, s16, n16, d32, r32, cap32);
+    }
+    if (n32) {
+        SAME_AS_MEASURED(ok[4], pasu_utf32_to_utf8_cstr, pasu_utf32_to_utf8, s32, n32, d8, r8, cap8);
+        SAME_AS_MEASURED(ok[5], pasu_utf32_to_utf16_cstr, pasu_utf32_to_utf16, s32, n32, d16, r16, cap16);
+        ok[7] &= pasu_utf32_length_cstr(s32, &st) == pasu_utf32_length(s32, n32, &rst) && st == rst;
+    }
+}
+
+/* Random strings cut short by a 0 anywhere, the middle of a sequence included. */
+static void test_random_cstr(void)
+{
+    static pasu_codepoint cps[BUF + 1];
+    static pasu_uint8 u8[BUF * 4 + 1];
+    static pasu_uint16 u16[BUF * 2 + 1];
+    pasu_size ncp, n8, n16;
+    int round, k, ok[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+
+    for (round = 0; round < 600; ++round) {
+        int bad = round % 3 == 0;
+        ncp = gen_cps(cps, 1 + rnd(BUF - 1), bad);
+        encode_all(cps, ncp, bad, u8, &n8, u16, &n16);
+        u8[rnd(2) ? n8 : rnd((unsigned)n8 + 1)] = 0;
+        u16[rnd(2) ? n16 : rnd((unsigned)n16 + 1)] = 0;
+        cps[rnd(2) ? ncp : rnd((unsigned)ncp + 1)] = 0;
+
+        if (rnd(3))
+            check_cstr(ok, u8, u16, cps, BUF * 4 + 1, BUF * 2 + 1, BUF + 1);
+        else
+            check_cstr(ok, u8, u16, cps, 2 + rnd(BUF * 4 - 1), 2 + rnd(BUF * 2 - 1), 2 + rnd(BUF - 1));
+    }
+    for (k = 0; k < 8; ++k)
+        ASSERT(ok[k]);
+}
+
+/* The checks before any conversion: unchanged by the single pass. */
+static void test_cstr_edges(void)
+{
+    static const pasu_uint8 bad8[] = "ab\xC3";
+    static const pasu_uint16 empty16[] = { 0 };
+    pasu_uint16 d16[4];
+    pasu_uint8 d8[4];
+    pasu_codepoint d32[4];
+    pasu_status st;
+
+    d16[0] = 7;
+    ASSERT_EQ(pasu_utf8_to_utf16_cstr((const pasu_uint8 *)"", d16, 4, &st), 0u);
+    ASSERT(st == PASU_OK && d16[0] == 0);
+    ASSERT_EQ(pasu_utf16_to_utf8_cstr(empty16, d8, 1, &st), 0u);
+    ASSERT_OK(st);
+
+    /* no room for anything but the terminator: NOSPACE before the input is looked at */
+    d32[0] = 7;
+    ASSERT_EQ(pasu_utf8_to_utf32_cstr(bad8 + 2, d32, 1, &st), 0u);
+    ASSERT(st == PASU_E_NOSPACE && d32[0] == 0);
+    ASSERT_EQ(pasu_utf8_to_utf32_cstr(bad8, d32, 4, &st), 2u);
+    ASSERT(st == PASU_E_TRUNC && d32[2] == 0);   /* the terminator ends the sequence */
+
+    ASSERT_EQ(pasu_utf8_to_utf16_cstr(NULL, d16, 4, &st), 0u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+    ASSERT_EQ(pasu_utf16_to_utf8_cstr(empty16, NULL, 4, &st), 0u);
+    ASSERT_EQ(st, PASU_E_NOSPACE);
+    ASSERT_EQ(pasu_utf8_length_cstr(bad8, &st), 2u);
+    ASSERT_EQ(st, PASU_E_TRUNC);
+}
+
+#if defined(PAGE_GUARD)
+/* Strings that end right before an unmapped page: no read may cross into it. */
+static void test_page_end(void)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    pasu_uint8 *map, *end;
+    pasu_codepoint cps[80 + 1];
+    pasu_uint8 u8[80 * 4 + 1];
+    pasu_uint16 u16[80 * 2 + 1];
+    pasu_size ncp, n8, n16, len;
+    int ok[8] = { 1, 1, 1, 1, 1, 1, 1, 1 }, k;
+
+    map = (pasu_uint8 *)mmap(NULL, (size_t)page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (map == (pasu_uint8 *)MAP_FAILED || mprotect(map + page, (size_t)page, PROT_NONE) != 0) {
+        (void)printf("  (page guard skip)\n");
+        return;
+    }
+    end = map + page;
+
+    for (len = 1; len <= 80; ++len) {
+        ncp = gen_cps(cps, len, 0);
+        encode_all(cps, ncp, 0, u8, &n8, u16, &n16);
+        u8[n8] = 0;
+        u16[n16] = 0;
+        cps[ncp] = 0;
+
+        /* each form in turn at the very end, the other two early in the page */
+        for (k = 0; k < 3; ++k) {
+            const pasu_uint8 *s8 = k == 0 ? end - (n8 + 1) : map;
+            const pasu_uint8 *s16 = k == 1 ? end - (n16 + 1) * 2 : map + 1024;
+            const pasu_uint8 *s32 = k == 2 ? end - (ncp + 1) * 4 : map + 2048;
+            memset(map, 'x', (size_t)page);
+            memcpy((void *)(size_t)s8, u8, n8 + 1);
+            memcpy((void *)(size_t)s16, u16, (n16 + 1) * 2);
+            memcpy((void *)(size_t)s32, cps, (ncp + 1) * 4);
+            check_cstr(ok, s8, (const pasu_uint16 *)(const void *)s16, (const pasu_codepoint *)(const void *)s32,
+                       80 * 4 + 1, 80 * 2 + 1, 80 + 1);
+        }
+    }
+    for (k = 0; k < 8; ++k)
+        ASSERT(ok[k]);
+    (void)munmap(map, (size_t)page * 2);
+}
+#endif
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_fixed();
+    test_random_sizes();
+    test_random_cstr();
+    test_cstr_edges();
+#if defined(PAGE_GUARD)
+    test_page_end();
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
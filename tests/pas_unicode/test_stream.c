@@ -0,0 +1,243 @@
+/*
+    test_stream.c - Test the streaming decoder (pasu_decoder, _feed, pasu_decoder_finish) against whole-buffer conversions.
+    From repo root: gcc -o tests/pas_unicode/test_stream tests/pas_unicode/test_stream.c -I.
+    Also build with -mssse3, -mavx2 and -DPASU_NO_SIMD to cover each path.
+*/
+
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_unicode.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed;
+static int g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { \
+        (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failed; \
+    } \
+} while (0)
+
+#define ASSERT_OK(st) ASSERT((st) == PASU_OK)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define BUF 500
+
+static unsigned long g_seed = 9001;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+/* --- inputs --- */
+
+/* Code points in runs by script: ASCII, Latin-1, Cyrillic, CJK, emoji. */
+static pasu_size gen_cps(pasu_codepoint *cp, pasu_size cap)
+{
+    pasu_size n = 0, run, k;
+    unsigned script;
+
+    while (n < cap) {
+        script = rnd(5);
+        run = 1 + rnd(24);
+        for (k = 0; k < run && n < cap; ++k) {
+            switch (script) {
+            case 0: cp[n] = 0x20 + rnd(0x5F); break;
+            case 1: cp[n] = rnd(3) ? 0x20 + rnd(0x5F) : 0xC0 + rnd(0x40); break;
+            case 2: cp[n] = rnd(5) ? 0x410 + rnd(0x40) : 0x20; break;
+            case 3: cp[n] = 0x4E00 + rnd(0x5000); break;
+            default: cp[n] = rnd(2) ? 0x1F600 + rnd(0x50) : 0x10000 + rnd(0x100000); break;
+            }
+            ++n;
+        }
+    }
+    return n;
+}
+
+/* The stream: cps encoded, with the odd defect, maybe cut off mid-sequence at the end. */
+static void gen_stream(pasu_uint8 *u8, pasu_size *n8, pasu_uint16 *u16, pasu_size *n16, int bad)
+{
+    static pasu_codepoint cps[BUF];
+    pasu_size ncp = gen_cps(cps, 1 + rnd(BUF - 1)), k, used = 0;
+
+    *n8 = *n16 = 0;
+    for (k = 0; k < ncp; ++k) {
+        (void)pasu_utf8_encode(cps[k], u8 + *n8, &used);
+        *n8 += used;
+        (void)pasu_utf16_encode(cps[k], u16 + *n16, &used);
+        *n16 += used;
+        if (bad && rnd(200) == 0) {
+            u8[rnd((unsigned)*n8)] = (pasu_uint8)(rnd(2) ? 0x80 + rnd(0x40) : 0xC0 + rnd(0x40));
+            u16[rnd((unsigned)*n16)] = (pasu_uint16)(0xD800 + rnd(0x800));
+        }
+    }
+    if (rnd(3) == 0 && *n8 > 0) --*n8;
+    if (rnd(3) == 0 && *n16 > 0) --*n16;
+}
+
+/* --- driver: one source, fed in random chunks into a random trickle of dst room --- */
+
+enum { S8_16, S8_32, S16_8, S16_32 };
+
+static pasu_size feed(int kind, pasu_decoder *d, const void *src, pasu_size off, pasu_size len,
+                      void *dst, pasu_size out, pasu_size cap, pasu_size *used, pasu_status *st)
+{
+    switch (kind) {
+    case S8_16:  return pasu_utf8_to_utf16_feed(d, (const pasu_uint8 *)src + off, len, (pasu_uint16 *)dst + out, cap, used, st);
+    case S8_32:  return pasu_utf8_to_utf32_feed(d, (const pasu_uint8 *)src + off, len, (pasu_codepoint *)dst + out, cap, used, st);
+    case S16_8:  return pasu_utf16_to_utf8_feed(d, (const pasu_uint16 *)src + off, len, (pasu_uint8 *)dst + out, cap, used, st);
+    default:     return pasu_utf16_to_utf32_feed(d, (const pasu_uint16 *)src + off, len, (pasu_codepoint *)dst + out, cap, used, st);
+    }
+}
+
+static pasu_size whole(int kind, const void *src, pasu_size len, void *dst, pasu_size cap, pasu_status *st)
+{
+    switch (kind) {
+    case S8_16:  return pasu_utf8_to_utf16((const pasu_uint8 *)src, len, (pasu_uint16 *)dst, cap, st);
+    case S8_32:  return pasu_utf8_to_utf32((const pasu_uint8 *)src, len, (pasu_codepoint *)dst, cap, st);
+    case S16_8:  return pasu_utf16_to_utf8((const pasu_uint16 *)src, len, (pasu_uint8 *)dst, cap, st);
+    default:     return pasu_utf16_to_utf32((const pasu_uint16 *)src, len, (pasu_codepoint *)dst, cap, st);
+    }
+}
+
+/*
+    Streams src and compares with the whole-buffer conversion: same output,
+    same status (from a _feed call, or from pasu_decoder_finish for a cut-off tail).
+*/
+static int stream_matches(int kind, const void *src, pasu_size len, int max_chunk, int tiny)
+{
+    static pasu_uint8 out[BUF * 4 * 4], ref[BUF * 4 * 4];
+    pasu_size unit = kind == S16_8 ? 1 : kind == S8_16 ? 2 : 4;
+    pasu_size pos = 0, n_out = 0, n_ref, chunk, sub, used, cap;
+    pasu_status st = PASU_OK, rst, fin;
+    pasu_decoder d;
+    int spins = 0;
+
+    memset(out, 0xA5, sizeof(out));
+    memset(ref, 0xA5, sizeof(ref));
+    n_ref = whole(kind, src, len, ref, sizeof(ref) / unit, &rst);
+
+    pasu_decoder_init(&d);
+    while (pos < len && st == PASU_OK) {
+        chunk = rnd((unsigned)max_chunk + 1);
+        if (chunk > len - pos) chunk = len - pos;
+        for (sub = 0;;) {
+            cap = tiny ? rnd(6) : rnd(300);
+            if (n_out + cap > sizeof(out) / unit) cap = sizeof(out) / unit - n_out;
+            n_out += feed(kind, &d, src, pos + sub, chunk - sub, out, n_out, cap, &used, &st);
+            sub += used;
+            if (st != PASU_E_NOSPACE) break;
+            if (++spins > 1000000) return 0;
+        }
+        if (st == PASU_OK && sub != chunk) return 0;   /* OK means the whole chunk was taken */
+        pos += chunk;
+    }
+    fin = pasu_decoder_finish(&d);
+
+    if (n_out != n_ref || memcmp(out, ref, sizeof(out)) != 0) return 0;
+    if (rst == PASU_OK) return st == PASU_OK && fin == PASU_OK;
+    if (rst == PASU_E_TRUNC && st == PASU_OK) return fin == PASU_E_TRUNC;
+    return st == rst;
+}
+
+/* --- tests --- */
+
+static void test_fixed(void)
+{
+    static const pasu_uint8 emoji[] = { 0xF0, 0x9F, 0x98, 0x80, 'A' };
+    static const pasu_uint16 pair[] = { 0xD83D, 0xDE00, 0x41 };
+    pasu_decoder d;
+    pasu_uint16 d16[8];
+    pasu_uint8 d8[8];
+    pasu_codepoint d32[8];
+    pasu_size used, n, k;
+    pasu_status st;
+
+    /* a 4-byte sequence one byte at a time */
+    pasu_decoder_init(&d);
+    for (k = 0, n = 0; k < 3; ++k) {
+        n += pasu_utf8_to_utf16_feed(&d, emoji + k, 1, d16 + n, 8 - n, &used, &st);
+        ASSERT(st == PASU_OK && used == 1);
+    }
+    ASSERT_EQ(n, 0u);
+    n += pasu_utf8_to_utf16_feed(&d, emoji + 3, 2, d16, 8, &used, &st);
+    ASSERT(n == 3 && used == 2 && d16[0] == 0xD83D && d16[1] == 0xDE00 && d16[2] == 'A');
+    ASSERT_OK(pasu_decoder_finish(&d));
+
+    /* the held sequence needs room: NOSPACE keeps it, nothing consumed */
+    pasu_decoder_init(&d);
+    (void)pasu_utf8_to_utf32_feed(&d, emoji, 2, d32, 8, &used, &st);
+    n = pasu_utf8_to_utf32_feed(&d, emoji + 2, 3, d32, 0, &used, &st);
+    ASSERT(n == 0 && used == 0 && st == PASU_E_NOSPACE);
+    n = pasu_utf8_to_utf32_feed(&d, emoji + 2, 3, d32, 8, &used, &st);
+    ASSERT(n == 2 && used == 3 && st == PASU_OK && d32[0] == 0x1F600);
+
+    /* a surrogate pair split between chunks */
+    pasu_decoder_init(&d);
+    n = pasu_utf16_to_utf8_feed(&d, pair, 1, d8, 8, &used, &st);
+    ASSERT(n == 0 && used == 1 && st == PASU_OK);
+    n = pasu_utf16_to_utf8_feed(&d, pair + 1, 2, d8, 8, &used, &st);
+    ASSERT(n == 5 && used == 2 && memcmp(d8, emoji, 5) == 0);
+
+    /* a bad continuation of a held lead: reported at offset 0 of the new chunk */
+    pasu_decoder_init(&d);
+    (void)pasu_utf8_to_utf16_feed(&d, emoji, 1, d16, 8, &used, &st);
+    n = pasu_utf8_to_utf16_feed(&d, (const pasu_uint8 *)"ABCD", 4, d16, 8, &used, &st);
+    ASSERT(n == 0 && used == 0 && st == PASU_E_INVALID);
+
+    /* a cut-off end shows at finish, which also resets */
+    pasu_decoder_init(&d);
+    (void)pasu_utf16_to_utf32_feed(&d, pair, 1, d32, 8, &used, &st);
+    ASSERT_OK(st);
+    ASSERT_EQ(pasu_decoder_finish(&d), PASU_E_TRUNC);
+    ASSERT_OK(pasu_decoder_finish(&d));
+
+    n = pasu_utf8_to_utf16_feed(NULL, emoji, 1, d16, 8, &used, &st);
+    ASSERT(n == 0 && st == PASU_E_INVALID);
+    pasu_decoder_init(&d);
+    n = pasu_utf16_to_utf8_feed(&d, NULL, 0, d8, 8, &used, &st);
+    ASSERT(n == 0 && used == 0 && st == PASU_OK);
+}
+
+/* Random streams, every pair, chunked from 1 byte up, into roomy or tiny dst. */
+static void test_random(void)
+{
+    static pasu_uint8 u8[BUF * 4];
+    static pasu_uint16 u16[BUF * 2];
+    pasu_size n8, n16;
+    int round, ok[4] = { 1, 1, 1, 1 };
+
+    for (round = 0; round < 600; ++round) {
+        int max_chunk = round % 3 == 0 ? 3 : round % 3 == 1 ? 17 : 200;
+        int tiny = round % 5 == 0;
+        gen_stream(u8, &n8, u16, &n16, round % 2);
+        ok[0] &= stream_matches(S8_16, u8, n8, max_chunk, tiny);
+        ok[1] &= stream_matches(S8_32, u8, n8, max_chunk, tiny);
+        ok[2] &= stream_matches(S16_8, u16, n16, max_chunk, tiny);
+        ok[3] &= stream_matches(S16_32, u16, n16, max_chunk, tiny);
+    }
+    ASSERT(ok[0]);
+    ASSERT(ok[1]);
+    ASSERT(ok[2]);
+    ASSERT(ok[3]);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_fixed();
+    test_random();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
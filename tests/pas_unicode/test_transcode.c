@@ -0,0 +1,309 @@
+/*
+    test_transcode.c - Test the block transcoders (UTF-8 <-> UTF-16 / UTF-32) against per-character loops.
+    From repo root: gcc -o tests/pas_unicode/test_transcode tests/pas_unicode/test_transcode.c -I.
+    Also build with -mssse3, -mavx2 and -DPASU_NO_SIMD to cover each path.
+*/
+
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_unicode.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed;
+static int g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { \
+        (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failed; \
+    } \
+} while (0)
+
+#define ASSERT_OK(st) ASSERT((st) == PASU_OK)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define BUF 700
+#define POISON 0xA5u
+
+static unsigned long g_seed = 777;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+/* --- references: decode one character, encode it, check room --- */
+
+static pasu_size ref_8_16(const pasu_uint8 *s, pasu_size len, pasu_uint16 *d, pasu_size cap, pasu_status *status)
+{
+    pasu_size i = 0, j = 0, used, n = 0;
+    pasu_uint16 tmp[2] = { 0, 0 };
+    pasu_codepoint cp;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, &cp, &used);
+        if (st != PASU_OK) { *status = st; return j; }
+        i += used;
+        (void)pasu_utf16_encode(cp, tmp, &n);
+        if (j + n > cap) { *status = PASU_E_NOSPACE; return j; }
+        d[j++] = tmp[0];
+        if (n == 2) d[j++] = tmp[1];
+    }
+    return j;
+}
+
+static pasu_size ref_8_32(const pasu_uint8 *s, pasu_size len, pasu_codepoint *d, pasu_size cap, pasu_status *status)
+{
+    pasu_size i = 0, j = 0, used;
+    pasu_codepoint cp;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, &cp, &used);
+        if (st != PASU_OK) { *status = st; return j; }
+        i += used;
+        if (j >= cap) { *status = PASU_E_NOSPACE; return j; }
+        d[j++] = cp;
+    }
+    return j;
+}
+
+static pasu_size ref_16_8(const pasu_uint16 *s, pasu_size len, pasu_uint8 *d, pasu_size cap, pasu_status *status)
+{
+    pasu_size i = 0, j = 0, used, n = 0, k;
+    pasu_uint8 tmp[4];
+    pasu_codepoint cp;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf16_decode(s + i, len - i, &cp, &used);
+        if (st != PASU_OK) { *status = st; return j; }
+        i += used;
+        (void)pasu_utf8_encode(cp, tmp, &n);
+        if (j + n > cap) { *status = PASU_E_NOSPACE; return j; }
+        for (k = 0; k < n; ++k) d[j++] = tmp[k];
+    }
+    return j;
+}
+
+static pasu_size ref_32_8(const pasu_codepoint *s, pasu_size len, pasu_uint8 *d, pasu_size cap, pasu_status *status)
+{
+    pasu_size i = 0, j = 0, n = 0, k;
+    pasu_uint8 tmp[4];
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_encode(s[i++], tmp, &n);
+        if (st != PASU_OK) { *status = st; return j; }
+        if (j + n > cap) { *status = PASU_E_NOSPACE; return j; }
+        for (k = 0; k < n; ++k) d[j++] = tmp[k];
+    }
+    return j;
+}
+
+/* --- inputs --- */
+
+/* Code points in runs by script: ASCII, Latin-1, Cyrillic, CJK, emoji, plus the odd bad value. */
+static pasu_size gen_cps(pasu_codepoint *cp, pasu_size cap, int bad)
+{
+    pasu_size n = 0, run, k;
+    unsigned script;
+
+    while (n < cap) {
+        script = rnd(6);
+        run = 1 + rnd(20);
+        for (k = 0; k < run && n < cap; ++k) {
+            switch (script) {
+            case 0: cp[n] = 0x20 + rnd(0x5F); break;
+            case 1: cp[n] = rnd(3) ? 0x20 + rnd(0x5F) : 0xC0 + rnd(0x40); break;
+            case 2: cp[n] = rnd(5) ? 0x410 + rnd(0x40) : 0x20; break;
+            case 3: cp[n] = rnd(2) ? 0x4E00 + rnd(0x5000) : 0xE000 + rnd(0x1000); break;
+            case 4: cp[n] = rnd(2) ? 0x1F600 + rnd(0x50) : 0x7FF + rnd(2); break;
+            default: cp[n] = rnd(2) ? 0xFFFF : 0x10FFFF - rnd(2); break;
+            }
+            ++n;
+        }
+        if (bad && rnd(12) == 0 && n < cap)
+            cp[n++] = rnd(2) ? 0xD800 + rnd(0x800) : 0x110000 + rnd(16);
+    }
+    return n;
+}
+
+static int all_poison(const void *p, pasu_size bytes)
+{
+    const pasu_uint8 *b = (const pasu_uint8 *)p;
+    pasu_size k;
+    for (k = 0; k < bytes; ++k)
+        if (b[k] != POISON) return 0;
+    return 1;
+}
+
+/* --- tests --- */
+
+/* Each known run shape, converted both ways. */
+static void test_fixed(void)
+{
+    static const char cyr[] = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\xBC\xD0\xB8\xD1\x80! "
+                              "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\xBC\xD0\xB8\xD1\x80!";
+    static const char mix[] = "na\xC3\xAFve caf\xC3\xA9 \xE2\x82\xAC" "5 \xE4\xB8\xAD\xE6\x96\x87 "
+                              "\xF0\x9F\x98\x80 end of the line";
+    pasu_uint16 u16[128];
+    pasu_codepoint u32[128];
+    pasu_uint8 back[256];
+    pasu_size n, m;
+    pasu_status st;
+
+    n = pasu_utf8_to_utf16((const pasu_uint8 *)cyr, sizeof(cyr) - 1, u16, 128, &st);
+    ASSERT_OK(st);
+    ASSERT_EQ(n, 25u);
+    ASSERT(u16[0] == 0x41F && u16[1] == 0x440 && u16[6] == ',' && u16[24] == '!');
+    m = pasu_utf16_to_utf8(u16, n, back, sizeof(back), &st);
+    ASSERT_OK(st);
+    ASSERT(m == sizeof(cyr) - 1 && memcmp(back, cyr, m) == 0);
+
+    n = pasu_utf8_to_utf32((const pasu_uint8 *)mix, sizeof(mix) - 1, u32, 128, &st);
+    ASSERT_OK(st);
+    ASSERT(u32[2] == 0xEF && u32[11] == 0x20AC && u32[14] == 0x4E2D && u32[17] == 0x1F600);
+    m = pasu_utf32_to_utf8(u32, n, back, sizeof(back), &st);
+    ASSERT_OK(st);
+    ASSERT(m == sizeof(mix) - 1 && memcmp(back, mix, m) == 0);
+    n = pasu_utf8_to_utf16((const pasu_uint8 *)mix, sizeof(mix) - 1, u16, 128, &st);
+    ASSERT_OK(st);
+    m = pasu_utf16_to_utf8(u16, n, back, sizeof(back), &st);
+    ASSERT_OK(st);
+    ASSERT(m == sizeof(mix) - 1 && memcmp(back, mix, m) == 0);
+
+    /* exactly full, one short */
+    ASSERT_EQ(pasu_utf8_to_utf16((const pasu_uint8 *)cyr, sizeof(cyr) - 1, u16, 25, &st), 25u);
+    ASSERT_OK(st);
+    ASSERT_EQ(pasu_utf8_to_utf16((const pasu_uint8 *)cyr, sizeof(cyr) - 1, u16, 24, &st), 24u);
+    ASSERT_EQ(st, PASU_E_NOSPACE);
+    ASSERT_EQ(pasu_utf16_to_utf8(u16, 24, back, 41, &st), 40u);   /* the last letter needs 2 */
+    ASSERT_EQ(st, PASU_E_NOSPACE);
+}
+
+/* Random scripts, random offsets and capacities, against the references. */
+static void test_random(void)
+{
+    static pasu_codepoint cps[BUF], d32[BUF], r32[BUF];
+    static pasu_uint8 u8[BUF * 4], d8[BUF * 4], r8[BUF * 4];
+    static pasu_uint16 u16[BUF * 2], d16[BUF * 2], r16[BUF * 2];
+    pasu_size ncp, n8, n16, off, len, cap, n, r, k, used;
+    pasu_status st, rst;
+    int round, ok[4] = { 1, 1, 1, 1 }, tail_ok = 1, errors = 0;
+
+    for (round = 0; round < 400; ++round) {
+        int bad = round % 2;
+        ncp = gen_cps(cps, 40 + rnd(BUF - 40), bad);
+
+        /* encoded forms of the valid prefix; UTF-8 may also carry raw defects */
+        n8 = n16 = 0;
+        for (k = 0; k < ncp; ++k) {
+            if (pasu_utf8_encode(cps[k], u8 + n8, &used) == PASU_OK) n8 += used;
+            else if (bad) u8[n8++] = (pasu_uint8)(rnd(2) ? 0x80 + rnd(0x40) : 0xF8);
+            if (pasu_utf16_encode(cps[k], u16 + n16, &used) == PASU_OK) n16 += used;
+            else if (bad) u16[n16++] = (pasu_uint16)(0xD800 + rnd(0x800));
+        }
+
+        for (off = 0; off < 4; ++off) {
+            cap = rnd(3) ? BUF * 4 : rnd(BUF);
+
+            len = n8 - off - rnd(3 < n8 - off ? 3 : (unsigned)(n8 - off));
+            memset(d16, POISON, sizeof(d16));
+            memset(r16, POISON, sizeof(r16));
+            n = pasu_utf8_to_utf16(u8 + off, len, d16, cap < BUF * 2 ? cap : BUF * 2, &st);
+            r = ref_8_16(u8 + off, len, r16, cap < BUF * 2 ? cap : BUF * 2, &rst);
+            ok[0] &= n == r && st == rst && memcmp(d16, r16, sizeof(d16)) == 0;
+            errors += rst != PASU_OK && rst != PASU_E_NOSPACE;
+
+            memset(d32, POISON, sizeof(d32));
+            memset(r32, POISON, sizeof(r32));
+            n = pasu_utf8_to_utf32(u8 + off, len, d32, cap < BUF ? cap : BUF, &st);
+            r = ref_8_32(u8 + off, len, r32, cap < BUF ? cap : BUF, &rst);
+            ok[1] &= n == r && st == rst && memcmp(d32, r32, sizeof(d32)) == 0;
+            tail_ok &= all_poison(d32 + n, sizeof(d32) - n * sizeof(d32[0]));
+
+            len = n16 - off - rnd(2 < n16 - off ? 2 : (unsigned)(n16 - off));
+            memset(d8, POISON, sizeof(d8));
+            memset(r8, POISON, sizeof(r8));
+            n = pasu_utf16_to_utf8(u16 + off, len, d8, cap, &st);
+            r = ref_16_8(u16 + off, len, r8, cap, &rst);
+            ok[2] &= n == r && st == rst && memcmp(d8, r8, sizeof(d8)) == 0;
+            tail_ok &= all_poison(d8 + n, sizeof(d8) - n);
+
+            memset(d8, POISON, sizeof(d8));
+            memset(r8, POISON, sizeof(r8));
+            n = pasu_utf32_to_utf8(cps + off, ncp - off, d8, cap, &st);
+            r = ref_32_8(cps + off, ncp - off, r8, cap, &rst);
+            ok[3] &= n == r && st == rst && memcmp(d8, r8, sizeof(d8)) == 0;
+        }
+    }
+    ASSERT(ok[0]);
+    ASSERT(ok[1]);
+    ASSERT(ok[2]);
+    ASSERT(ok[3]);
+    ASSERT(tail_ok);   /* nothing stored past the returned count */
+    ASSERT(errors > 100);
+}
+
+/* Truncated and bad sequences slid across the block edges of Cyrillic text. */
+static void test_sliding(void)
+{
+    static const pasu_uint8 defects[][4] = {
+        { 0xC3 }, { 0xE2, 0x82 }, { 0xF0, 0x9F, 0x98 }, { 0x80 }, { 0xC0, 0x80 }, { 0xED, 0xA0, 0x80 },
+        { 0xE2, 0x82, 0xAC }, { 0xF0, 0x9F, 0x98, 0x80 }
+    };
+    static const pasu_size lens[] = { 1, 2, 3, 1, 2, 3, 3, 4 };
+    pasu_uint8 s[64];
+    pasu_uint16 d16[64], r16[64];
+    pasu_codepoint d32[64], r32[64];
+    pasu_size k, p, n, r;
+    pasu_status st, rst;
+    int ok = 1;
+
+    for (k = 0; k < sizeof(lens) / sizeof(lens[0]); ++k) {
+        for (p = 0; p + lens[k] < sizeof(s); ++p) {
+            for (n = 0; n + 1 < sizeof(s); n += 2) {
+                s[n] = 0xD0;
+                s[n + 1] = (pasu_uint8)(0xB0 + n % 16);
+            }
+            memcpy(s + p, defects[k], lens[k]);
+            s[p + lens[k]] = 'A';
+            memset(d16, POISON, sizeof(d16));
+            memset(r16, POISON, sizeof(r16));
+            n = pasu_utf8_to_utf16(s, sizeof(s), d16, 64, &st);
+            r = ref_8_16(s, sizeof(s), r16, 64, &rst);
+            ok &= n == r && st == rst && memcmp(d16, r16, sizeof(d16)) == 0;
+            memset(d32, POISON, sizeof(d32));
+            memset(r32, POISON, sizeof(r32));
+            n = pasu_utf8_to_utf32(s, sizeof(s), d32, 64, &st);
+            r = ref_8_32(s, sizeof(s), r32, 64, &rst);
+            ok &= n == r && st == rst && memcmp(d32, r32, sizeof(d32)) == 0;
+        }
+    }
+    ASSERT(ok);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_fixed();
+    test_random();
+    test_sliding();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,291 @@
+/*
+    test_validate.c - Test pasu_utf8_validate and the ASCII fast paths against per-character loops.
+    From repo root: gcc -o tests/pas_unicode/test_validate tests/pas_unicode/test_validate.c -I.
+    Also build with -mssse3, -mavx2 and -DPASU_NO_SIMD to cover each path.
+*/
+
+#define PAS_UNICODE_IMPLEMENTATION
+#include "pas_unicode.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed;
+static int g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { \
+        (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failed; \
+    } \
+} while (0)
+
+#define ASSERT_OK(st) ASSERT((st) == PASU_OK)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define BUF 600
+
+static unsigned long g_seed = 12345;
+
+static unsigned rnd(unsigned n)
+{
+    g_seed = g_seed * 1103515245ul + 12345ul;
+    return (unsigned)((g_seed >> 16) & 0x7FFFu) % n;
+}
+
+/* --- references: one pasu_utf8_decode per character --- */
+
+static pasu_size ref_validate(const pasu_uint8 *s, pasu_size len, pasu_status *status)
+{
+    pasu_size i = 0, used;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, NULL, &used);
+        if (st != PASU_OK) { *status = st; return i; }
+        i += used;
+    }
+    return len;
+}
+
+static pasu_size ref_length(const pasu_uint8 *s, pasu_size len, pasu_status *status)
+{
+    pasu_size i = 0, n = 0, used;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, NULL, &used);
+        if (st != PASU_OK) { *status = st; return n; }
+        i += used;
+        ++n;
+    }
+    return n;
+}
+
+static pasu_size ref_to_utf16(const pasu_uint8 *s, pasu_size len, pasu_uint16 *dst, pasu_size cap,
+                              pasu_status *status)
+{
+    pasu_size i = 0, j = 0, used, used16 = 0;
+    pasu_codepoint cp;
+    pasu_uint16 tmp[2] = { 0, 0 };
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, &cp, &used);
+        if (st != PASU_OK) { *status = st; return j; }
+        i += used;
+        (void)pasu_utf16_encode(cp, tmp, &used16);
+        if (j + used16 > cap) { *status = PASU_E_NOSPACE; return j; }
+        dst[j++] = tmp[0];
+        if (used16 == 2) dst[j++] = tmp[1];
+    }
+    return j;
+}
+
+static pasu_size ref_to_utf32(const pasu_uint8 *s, pasu_size len, pasu_codepoint *dst, pasu_size cap,
+                              pasu_status *status)
+{
+    pasu_size i = 0, j = 0, used;
+    pasu_codepoint cp;
+    pasu_status st;
+
+    *status = PASU_OK;
+    while (i < len) {
+        st = pasu_utf8_decode(s + i, len - i, &cp, &used);
+        if (st != PASU_OK) { *status = st; return j; }
+        i += used;
+        if (j >= cap) { *status = PASU_E_NOSPACE; return j; }
+        dst[j++] = cp;
+    }
+    return j;
+}
+
+/* --- inputs --- */
+
+/* Mostly well-formed text: long ASCII runs, every sequence length, and now and then a defect. */
+static pasu_size gen(pasu_uint8 *s, pasu_size cap, unsigned defect_odds)
+{
+    static const pasu_uint8 bad[][4] = {
+        { 0x80 }, { 0xBF }, { 0xC0, 0x80 }, { 0xC1, 0xBF }, { 0xE0, 0x80, 0x80 }, { 0xE0, 0x9F, 0xBF },
+        { 0xED, 0xA0, 0x80 }, { 0xED, 0xBF, 0xBF }, { 0xF0, 0x80, 0x80, 0x80 }, { 0xF0, 0x8F, 0xBF, 0xBF },
+        { 0xF4, 0x90, 0x80, 0x80 }, { 0xF5, 0x80, 0x80, 0x80 }, { 0xFF }, { 0xFE }, { 0xF8, 0x88 },
+        { 0xC3 }, { 0xE2, 0x82 }, { 0xF0, 0x9F, 0x98 }, { 0xC3, 0x41 }, { 0xE2, 0x28, 0xA1 }
+    };
+    static const pasu_uint8 bad_len[] = { 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 1, 1, 2, 1, 2, 3, 2, 3 };
+    pasu_size n = 0, k, run;
+    pasu_codepoint cp;
+    pasu_size used;
+
+    while (n + 40 < cap) {
+        switch (rnd(6)) {
+        case 0: case 1:
+            run = rnd(40);
+            for (k = 0; k < run; ++k) s[n++] = (pasu_uint8)(0x20 + rnd(0x5F));
+            cp = '.';
+            break;
+        case 2: cp = 0x80 + rnd(0x780); break;
+        case 3: do cp = 0x800 + rnd(0xF800); while (cp >= 0xD800 && cp < 0xE000); break;
+        case 4: cp = 0x10000 + (pasu_codepoint)rnd(0x7FFF) * 32 + rnd(32); break;
+        default: cp = rnd(2) ? 0x10FFFF : 0xFFFF; break;
+        }
+        if (n + 40 >= cap) break;
+        if (rnd(6) >= 2) {
+            (void)pasu_utf8_encode(cp, s + n, &used);
+            n += used;
+        }
+        if (defect_odds && rnd(defect_odds) == 0) {
+            k = rnd(sizeof(bad_len));
+            memcpy(s + n, bad[k], bad_len[k]);
+            n += bad_len[k];
+        }
+    }
+    return n;
+}
+
+/* --- tests --- */
+
+static void test_fixed(void)
+{
+    pasu_uint8 s[80];
+    pasu_status st;
+    pasu_size i;
+
+    ASSERT_EQ(pasu_utf8_validate(NULL, 0, &st), 0u);
+    ASSERT_OK(st);
+    ASSERT_EQ(pasu_utf8_validate(NULL, 3, &st), 0u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+
+    /* 70 ASCII bytes, then each defect class at the end of a block */
+    memset(s, 'a', sizeof(s));
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 70u);
+    ASSERT_OK(st);
+    s[63] = 0xE2;   /* lead whose continuation is in the next block */
+    s[64] = 0x82;
+    s[65] = 0xAC;
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 70u);
+    ASSERT_OK(st);
+    s[65] = 'a';    /* ... cut short by an ASCII block */
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 63u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+    ASSERT_EQ(pasu_utf8_validate(s, 65, &st), 63u);
+    ASSERT_EQ(st, PASU_E_TRUNC);
+    s[63] = 0xED;   /* surrogate */
+    s[64] = 0xA0;
+    s[65] = 0x80;
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 63u);
+    ASSERT_EQ(st, PASU_E_RANGE);
+    s[63] = 0xF4;   /* above U+10FFFF */
+    s[64] = 0x90;
+    s[66] = 0x80;
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 63u);
+    ASSERT_EQ(st, PASU_E_RANGE);
+    s[64] = 0x8F;
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 70u);
+    ASSERT_OK(st);
+    s[67] = 0x80;   /* stray continuation after a 4-byte sequence */
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 67u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+    s[16] = 0xC0;   /* overlong, reported first */
+    s[17] = 0x80;
+    ASSERT_EQ(pasu_utf8_validate(s, 70, &st), 16u);
+    ASSERT_EQ(st, PASU_E_INVALID);
+
+    /* status may be NULL */
+    for (i = 0; i < sizeof(s); ++i) s[i] = (pasu_uint8)('0' + i % 10);
+    ASSERT_EQ(pasu_utf8_validate(s, sizeof(s), NULL), sizeof(s));
+}
+
+/* Every offset and length of random text, against the references. */
+static void test_random(void)
+{
+    static pasu_uint8 s[BUF];
+    static pasu_uint16 d16[BUF], r16[BUF];
+    static pasu_codepoint d32[BUF], r32[BUF];
+    pasu_size len, off, n, rn, cap, m, rm;
+    pasu_status st, rst;
+    int round, ok_v = 1, ok_l = 1, ok_16 = 1, ok_32 = 1, bad_seen = 0, valid_seen = 0;
+
+    for (round = 0; round < 300; ++round) {
+        len = gen(s, BUF, round % 3 == 0 ? 0u : 2u + (unsigned)round % 40u);
+        for (off = 0; off < 24 && off < len; ++off) {
+            m = len - off - rnd(8 < len - off ? 8 : (unsigned)(len - off));
+
+            n = pasu_utf8_validate(s + off, m, &st);
+            rn = ref_validate(s + off, m, &rst);
+            ok_v &= n == rn && st == rst;
+            if (rst == PASU_OK) valid_seen++; else bad_seen++;
+
+            n = pasu_utf8_length(s + off, m, &st);
+            rn = ref_length(s + off, m, &rst);
+            ok_l &= n == rn && st == rst;
+
+            /* roomy and short destinations */
+            cap = rnd(2) ? BUF : rnd((unsigned)m + 1);
+            memset(d16, 0, sizeof(d16));
+            memset(r16, 0, sizeof(r16));
+            rm = ref_to_utf16(s + off, m, r16, cap, &rst);
+            n = pasu_utf8_to_utf16(s + off, m, d16, cap, &st);
+            ok_16 &= n == rm && st == rst && memcmp(d16, r16, sizeof(d16)) == 0;
+
+            memset(d32, 0, sizeof(d32));
+            memset(r32, 0, sizeof(r32));
+            rm = ref_to_utf32(s + off, m, r32, cap, &rst);
+            n = pasu_utf8_to_utf32(s + off, m, d32, cap, &st);
+            ok_32 &= n == rm && st == rst && memcmp(d32, r32, sizeof(d32)) == 0;
+        }
+    }
+    ASSERT(ok_v);
+    ASSERT(ok_l);
+    ASSERT(ok_16);
+    ASSERT(ok_32);
+    ASSERT(bad_seen > 1000 && valid_seen > 1000);
+}
+
+/* Single defects slid across block boundaries in otherwise clean text. */
+static void test_sliding(void)
+{
+    static const pasu_uint8 seqs[][4] = {
+        { 0xC3, 0xA9 }, { 0xE2, 0x82, 0xAC }, { 0xF0, 0x9F, 0x98, 0x80 },
+        { 0xC3 }, { 0xE2, 0x82 }, { 0xF0, 0x9F, 0x98 }, { 0x80 }, { 0xC1, 0x81 },
+        { 0xE0, 0x9F, 0x80 }, { 0xED, 0xB0, 0x80 }, { 0xF0, 0x8F, 0x80, 0x80 }, { 0xF4, 0x90, 0x80, 0x80 }
+    };
+    static const pasu_size lens[] = { 2, 3, 4, 1, 2, 3, 1, 2, 3, 3, 4, 4 };
+    pasu_uint8 s[96];
+    pasu_size p, q, k, n, rn;
+    pasu_status st, rst;
+    int ok = 1;
+
+    for (k = 0; k < sizeof(lens) / sizeof(lens[0]); ++k) {
+        for (p = 0; p + lens[k] <= sizeof(s); ++p) {
+            for (q = 0; q < 2; ++q) {
+                memset(s, 'x', sizeof(s));
+                if (q) memcpy(s + 5, "\xC3\xA9\xE2\x82\xAC", 5);   /* non-ASCII earlier, too */
+                memcpy(s + p, seqs[k], lens[k]);
+                n = pasu_utf8_validate(s, sizeof(s), &st);
+                rn = ref_validate(s, sizeof(s), &rst);
+                ok &= n == rn && st == rst;
+            }
+        }
+    }
+    ASSERT(ok);
+}
+
+int main(void)
+{
+    g_failed = 0;
+    g_assertions = 0;
+
+    test_fixed();
+    test_random();
+    test_sliding();
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*
+    test_batch.c - Test pas_zip_entries and pas_zip_batch_* multi-entry extraction.
+    From repo root: gcc -o tests/pas_zip/test_batch tests/pas_zip/test_batch.c -I. -lpthread
+    Deflate entries: add -DPAS_ZIP_USE_ZLIB -lz (or -DPAS_ZIP_USE_MINIZ with miniz).
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define TEST_THREADS 1
+#endif
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define ENTRIES 300
+#define MAX_ENTRY 8192
+#define WORKERS 4
+
+typedef struct {
+    unsigned char *buf;
+    size_t         cap;
+    size_t         len;
+} mem_sink;
+
+static unsigned char g_zip[ENTRIES * (MAX_ENTRY + 128) + 4096];
+static unsigned char g_cd[ENTRIES * 96];
+static unsigned char g_src[MAX_ENTRY];
+static unsigned char g_dst[ENTRIES][MAX_ENTRY];
+static pas_zip_file_t g_files[ENTRIES];
+static pas_zip_job_t g_jobs[ENTRIES];
+#if defined(PAS_ZIP_HAS_INFLATE)
+static unsigned char g_deflate_work[PAS_ZIP_DEFLATE_WORK_SIZE];
+#endif
+static unsigned char g_work[WORKERS][PAS_ZIP_INFLATE_WORK_SIZE];
+
+static size_t sink_mem(void *user, const void *data, size_t size) {
+    mem_sink *m = (mem_sink *)user;
+    if (size > m->cap - m->len) size = m->cap - m->len;
+    memcpy(m->buf + m->len, data, size);
+    m->len += size;
+    return size;
+}
+
+static size_t entry_size(size_t i) { return (i * 389) % MAX_ENTRY; }
+
+static void fill(unsigned char *p, size_t i, size_t n) {
+    size_t k;
+    for (k = 0; k < n; k++) p[k] = (unsigned char)((k / 16) + i);
+}
+
+static void setup_jobs(size_t count) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        g_jobs[i].file = g_files[i];
+        g_jobs[i].dst = g_dst[i];
+        g_jobs[i].dst_size = MAX_ENTRY;
+    }
+    memset(g_dst, 0, sizeof(g_dst));
+}
+
+/* every job OK and its bytes match what was written */
+static int check_jobs(size_t count) {
+    unsigned char expect[MAX_ENTRY];
+    size_t i;
+    for (i = 0; i < count; i++) {
+        size_t n = entry_size(i);
+        fill(expect, i, n);
+        if (g_jobs[i].status != PAS_ZIP_OK || g_jobs[i].written != n) return 0;
+        if (memcmp(g_dst[i], expect, n) != 0) return 0;
+    }
+    return 1;
+}
+
+static int submit_inline(void *user, pas_zip_task_fn fn, void *arg) {
+    ++*(int *)user;
+    fn(arg);
+    return 0;
+}
+
+static int submit_refuse(void *user, pas_zip_task_fn fn, void *arg) {
+    (void)fn; (void)arg;
+    ++*(int *)user;
+    return -1;
+}
+
+#if defined(TEST_THREADS)
+typedef struct {
+    pas_zip_batch_t *batch;
+    void            *work;
+    size_t           done;
+} worker_arg;
+
+static void *worker_main(void *p) {
+    worker_arg *a = (worker_arg *)p;
+    a->done = pas_zip_batch_work(a->batch, a->work, PAS_ZIP_INFLATE_WORK_SIZE);
+    return NULL;
+}
+#endif
+
+int main(void) {
+    pas_zip_writer_t w;
+    mem_sink m;
+    pas_zip_t zip;
+    pas_zip_batch_t batch;
+    size_t i, count, done;
+    int method = PAS_ZIP_METHOD_STORE;
+    int calls;
+    char name[32];
+
+    g_failed = 0;
+    g_assertions = 0;
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+    method = PAS_ZIP_METHOD_DEFLATE;
+#endif
+    m.buf = g_zip; m.cap = sizeof(g_zip); m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    for (i = 0; i < ENTRIES; i++) {
+        size_t n = entry_size(i);
+        (void)sprintf(name, "dir/entry%03u.bin", (unsigned)i);
+        fill(g_src, i, n);
+#if defined(PAS_ZIP_HAS_INFLATE)
+        if (pas_zip_writer_add(&w, name, g_src, n, method, g_deflate_work, sizeof(g_deflate_work)) != PAS_ZIP_OK) break;
+#else
+        if (pas_zip_writer_add(&w, name, g_src, n, method, NULL, 0) != PAS_ZIP_OK) break;
+#endif
+    }
+    ASSERT_EQ(i, (size_t)ENTRIES);
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, m.len), PAS_ZIP_OK);
+
+    /* one central directory walk for every entry */
+    ASSERT_EQ(pas_zip_entries(&zip, g_files, 10, &count), PAS_ZIP_E_NOSPACE);
+    ASSERT_EQ(count, (size_t)ENTRIES);
+    ASSERT_EQ(pas_zip_entries(&zip, g_files, ENTRIES, &count), PAS_ZIP_OK);
+    ASSERT_EQ(count, (size_t)ENTRIES);
+    ASSERT_EQ(pas_zip_name_len(&g_files[7]), 16u);
+    ASSERT(memcmp(pas_zip_name(&g_files[7]), "dir/entry007.bin", 16) == 0);
+
+    /* single worker on the calling thread */
+    setup_jobs(ENTRIES);
+    ASSERT_EQ(pas_zip_batch_init(&batch, g_jobs, ENTRIES), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_batch_remaining(&batch), (size_t)ENTRIES);
+    done = pas_zip_batch_work(&batch, g_work[0], sizeof(g_work[0]));
+    ASSERT_EQ(done, (size_t)ENTRIES);
+    ASSERT_EQ(pas_zip_batch_remaining(&batch), 0u);
+    ASSERT(check_jobs(ENTRIES));
+    ASSERT_EQ(pas_zip_batch_work(&batch, NULL, 0), 0u);
+
+    /* per-entry status: a short destination fails only that job */
+    setup_jobs(ENTRIES);
+    g_jobs[5].dst_size = 1;
+    ASSERT_EQ(pas_zip_batch_init(&batch, g_jobs, ENTRIES), PAS_ZIP_OK);
+    (void)pas_zip_batch_work(&batch, NULL, 0);
+    ASSERT_EQ(g_jobs[5].status, PAS_ZIP_E_NOSPACE);
+    ASSERT_EQ(g_jobs[4].status, PAS_ZIP_OK);
+    ASSERT_EQ(g_jobs[6].status, PAS_ZIP_OK);
+
+    /* task-submission callback */
+    setup_jobs(ENTRIES);
+    ASSERT_EQ(pas_zip_batch_init(&batch, g_jobs, ENTRIES), PAS_ZIP_OK);
+    calls = 0;
+    ASSERT_EQ(pas_zip_batch_submit(&batch, submit_inline, &calls, 3), PAS_ZIP_OK);
+    ASSERT_EQ(calls, 3);
+    ASSERT_EQ(pas_zip_batch_remaining(&batch), 0u);
+    ASSERT(check_jobs(ENTRIES));
+
+    /* a pool that refuses work: the caller's thread picks it up */
+    setup_jobs(ENTRIES);
+    ASSERT_EQ(pas_zip_batch_init(&batch, g_jobs, ENTRIES), PAS_ZIP_OK);
+    calls = 0;
+    ASSERT_EQ(pas_zip_batch_submit(&batch, submit_refuse, &calls, 4), PAS_ZIP_OK);
+    ASSERT_EQ(calls, 1);
+    ASSERT_EQ(pas_zip_batch_remaining(&batch), 0u);
+    ASSERT(check_jobs(ENTRIES));
+
+#if defined(TEST_THREADS)
+    {
+        pthread_t th[WORKERS];
+        worker_arg args[WORKERS];
+        int started = 0;
+
+        setup_jobs(ENTRIES);
+        ASSERT_EQ(pas_zip_batch_init(&batch, g_jobs, ENTRIES), PAS_ZIP_OK);
+        for (i = 0; i < WORKERS; i++) {
+            args[i].batch = &batch;
+            args[i].work = g_work[i];
+            args[i].done = 0;
+            if (pthread_create(&th[i], NULL, worker_main, &args[i]) == 0) started++;
+        }
+        ASSERT_EQ(started, WORKERS);
+        done = 0;
+        for (i = 0; i < (size_t)started; i++) {
+            pthread_join(th[i], NULL);
+            done += args[i].done;
+        }
+        ASSERT_EQ(done, (size_t)ENTRIES);
+        ASSERT_EQ(pas_zip_batch_remaining(&batch), 0u);
+        ASSERT(check_jobs(ENTRIES));
+    }
+#endif
+
+    ASSERT_EQ(pas_zip_batch_init(&batch, NULL, 1), PAS_ZIP_E_INVALID);
+    ASSERT_EQ(pas_zip_batch_submit(&batch, NULL, NULL, 1), PAS_ZIP_E_INVALID);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+    test_index.c - Test pas_zip_index_build and indexed lookup.
+    From repo root: gcc -o tests/pas_zip/test_index tests/pas_zip/test_index.c -I.
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define N_FILES 500
+
+static unsigned char g_zip[N_FILES * 128];
+static char g_names[N_FILES][16];
+static uint32_t g_index[4096];
+
+int main(void) {
+    const char *names[N_FILES];
+    const void *datas[N_FILES];
+    size_t sizes[N_FILES];
+    size_t written;
+    pas_zip_status status;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    int i, found;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    for (i = 0; i < N_FILES; i++) {
+        (void)snprintf(g_names[i], sizeof(g_names[i]), "dir/f%d.bin", i);
+        names[i] = g_names[i];
+        datas[i] = g_names[i];
+        sizes[i] = strlen(g_names[i]);
+    }
+    written = pas_zip_create(names, datas, sizes, N_FILES, g_zip, sizeof(g_zip), &status);
+    ASSERT(status == PAS_ZIP_OK);
+
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, written), PAS_ZIP_OK);
+    ASSERT(zip.index == NULL);
+
+    /* sizing: power-of-two slot count, at least twice the entry count */
+    ASSERT(pas_zip_index_size(&zip) >= 2u * N_FILES * 2 * sizeof(uint32_t));
+    ASSERT(pas_zip_index_size(&zip) <= sizeof(g_index));
+    ASSERT_EQ(pas_zip_index_build(&zip, g_index, 16), PAS_ZIP_E_NOSPACE);
+    ASSERT(zip.index == NULL);
+    ASSERT_EQ(pas_zip_index_build(&zip, (char *)g_index + 1, sizeof(g_index) - 4), PAS_ZIP_E_INVALID);
+
+    ASSERT_EQ(pas_zip_index_build(&zip, g_index, sizeof(g_index)), PAS_ZIP_OK);
+    ASSERT(zip.index != NULL);
+
+    found = 0;
+    for (i = 0; i < N_FILES; i++) {
+        if (pas_zip_find_file(&zip, g_names[i], &file) == PAS_ZIP_OK &&
+            pas_zip_name_len(&file) == strlen(g_names[i]) &&
+            memcmp(pas_zip_name(&file), g_names[i], strlen(g_names[i])) == 0 &&
+            pas_zip_size(&file) == strlen(g_names[i]))
+            found++;
+    }
+    ASSERT_EQ(found, N_FILES);
+
+    ASSERT_EQ(pas_zip_find_file(&zip, "dir/f500.bin", &file), PAS_ZIP_E_NOT_FOUND);
+    ASSERT_EQ(pas_zip_find_file(&zip, "", &file), PAS_ZIP_E_NOT_FOUND);
+    ASSERT_EQ(pas_zip_find_file(&zip, "dir/f1.bi", &file), PAS_ZIP_E_NOT_FOUND);
+
+    /* extraction works from an indexed lookup */
+    {
+        char out[32];
+        size_t n;
+        ASSERT_EQ(pas_zip_find_file(&zip, "dir/f123.bin", &file), PAS_ZIP_OK);
+        n = pas_zip_extract(&file, out, sizeof(out), &status);
+        ASSERT(status == PAS_ZIP_OK);
+        ASSERT_EQ(n, 12u);
+        ASSERT(memcmp(out, "dir/f123.bin", 12) == 0);
+    }
+
+    /* legacy find uses the index of the handle it is given */
+    {
+        pas_zip_t *legacy = pas_zip_open(g_zip, written, &status);
+        pas_zip_file_t *f;
+        ASSERT(legacy != NULL);
+        ASSERT_EQ(pas_zip_index_build(legacy, g_index, sizeof(g_index)), PAS_ZIP_OK);
+        f = pas_zip_find(legacy, "dir/f42.bin");
+        ASSERT(f != NULL);
+        ASSERT(strcmp(pas_zip_name(f), "dir/f42.bin") == 0);
+        ASSERT(pas_zip_find(legacy, "dir/f42") == NULL);
+    }
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
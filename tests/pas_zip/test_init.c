@@ -0,0 +1,89 @@
+/*
+    test_init.c - Test reentrant pas_zip_init / pas_zip_find_file.
+    From repo root: gcc -o tests/pas_zip/test_init tests/pas_zip/test_init.c -I.
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+int main(void) {
+    unsigned char buf_a[1024], buf_b[1024];
+    size_t len_a, len_b;
+    pas_zip_status status;
+    pas_zip_t zip_a, zip_b;
+    pas_zip_file_t fa, fb;
+    char out[64];
+    size_t n;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    len_a = pas_zip_create(
+        (const char *[]){ "one.txt", "shared.txt" },
+        (const void *[]){ "first", "from A" },
+        (size_t[]){ 5, 6 },
+        2, buf_a, sizeof(buf_a), &status
+    );
+    ASSERT(status == PAS_ZIP_OK);
+    len_b = pas_zip_create(
+        (const char *[]){ "shared.txt" },
+        (const void *[]){ "from archive B" },
+        (size_t[]){ 14 },
+        1, buf_b, sizeof(buf_b), &status
+    );
+    ASSERT(status == PAS_ZIP_OK);
+
+    /* two archives open at once, each in caller storage */
+    ASSERT_EQ(pas_zip_init(&zip_a, buf_a, len_a), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_init(&zip_b, buf_b, len_b), PAS_ZIP_OK);
+    ASSERT_EQ(zip_a.num_entries, 2);
+    ASSERT_EQ(zip_b.num_entries, 1);
+
+    ASSERT_EQ(pas_zip_find_file(&zip_a, "shared.txt", &fa), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip_b, "shared.txt", &fb), PAS_ZIP_OK);
+
+    /* names point into the archive, not into a shared buffer */
+    ASSERT_EQ(pas_zip_name_len(&fa), 10u);
+    ASSERT(memcmp(pas_zip_name(&fa), "shared.txt", 10) == 0);
+    ASSERT((const unsigned char *)pas_zip_name(&fa) > buf_a);
+    ASSERT((const unsigned char *)pas_zip_name(&fa) < buf_a + len_a);
+    ASSERT((const unsigned char *)pas_zip_name(&fb) > buf_b);
+    ASSERT((const unsigned char *)pas_zip_name(&fb) < buf_b + len_b);
+
+    /* the legacy singleton must not disturb caller-owned handles */
+    ASSERT(pas_zip_open(buf_b, len_b, &status) != NULL);
+
+    n = pas_zip_extract(&fa, out, sizeof(out), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, 6u);
+    ASSERT(memcmp(out, "from A", 6) == 0);
+
+    n = pas_zip_extract(&fb, out, sizeof(out), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, 14u);
+    ASSERT(memcmp(out, "from archive B", 14) == 0);
+
+    /* prefix of an existing name must not match */
+    ASSERT_EQ(pas_zip_find_file(&zip_a, "one", &fa), PAS_ZIP_E_NOT_FOUND);
+    ASSERT_EQ(pas_zip_find_file(&zip_a, "one.txt.bak", &fa), PAS_ZIP_E_NOT_FOUND);
+    ASSERT_EQ(pas_zip_find_file(NULL, "one.txt", &fa), PAS_ZIP_E_INVALID);
+
+    ASSERT_EQ(pas_zip_init(&zip_a, "PK", 2), PAS_ZIP_E_INVALID);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+    test_range.c - Test pas_zip_read_at ranged reads and pas_zip_access_build.
+    From repo root: gcc -o tests/pas_zip/test_range tests/pas_zip/test_range.c -I.
+    Deflate part: add -DPAS_ZIP_USE_ZLIB -lz (access points need zlib; miniz reads from the start).
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define PLAIN_SIZE (1u << 20)
+#define SPAN (64u * 1024u)
+
+typedef struct {
+    unsigned char *buf;
+    size_t         cap;
+    size_t         len;
+} mem_sink;
+
+static unsigned char g_plain[PLAIN_SIZE];
+static unsigned char g_zip[PLAIN_SIZE + PLAIN_SIZE / 2 + 4096];
+static unsigned char g_cd[256];
+static unsigned char g_work[PAS_ZIP_INFLATE_WORK_SIZE];
+#if defined(PAS_ZIP_HAS_INFLATE)
+static unsigned char g_deflate_work[PAS_ZIP_DEFLATE_WORK_SIZE];
+#endif
+static pas_zip_access_point_t g_points[PLAIN_SIZE / SPAN + 1];
+
+static size_t sink_mem(void *user, const void *data, size_t size) {
+    mem_sink *m = (mem_sink *)user;
+    if (size > m->cap - m->len) size = m->cap - m->len;
+    memcpy(m->buf + m->len, data, size);
+    m->len += size;
+    return size;
+}
+
+/* Reads [off, off + len) and compares with g_plain. */
+static int range_ok(const pas_zip_file_t *file, const pas_zip_access_t *ax, size_t off, size_t len) {
+    unsigned char buf[5000];
+    pas_zip_status st;
+    size_t want = off + len > PLAIN_SIZE ? PLAIN_SIZE - off : len;
+    size_t n;
+
+    memset(buf, 0xAA, sizeof(buf));
+    n = pas_zip_read_at(file, ax, off, buf, len, g_work, sizeof(g_work), &st);
+    return st == PAS_ZIP_OK && n == want && memcmp(buf, g_plain + off, want) == 0;
+}
+
+/* A Store entry whose central directory claims more bytes than its payload holds. */
+static int lying_store_rejected(void) {
+    static unsigned char arc[256];
+    const char *names[1] = { "lie.bin" };
+    const void *datas[1] = { "0123456789abcdef" };
+    size_t sizes[1] = { 16 };
+    unsigned char buf[4000];
+    pas_zip_status st;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    size_t len, i, n;
+
+    len = pas_zip_create(names, datas, sizes, 1, arc, sizeof(arc), &st);
+    if (!len) return 0;
+    for (i = 0; i + 4 <= len; i++)
+        if (memcmp(arc + i, "PK\1\2", 4) == 0) break;
+    if (i + 28 > len) return 0;
+    arc[i + 24] = 0xA0; arc[i + 25] = 0x0F;   /* uncompressed size 4000 */
+    if (pas_zip_init(&zip, arc, len) != PAS_ZIP_OK) return 0;
+    if (pas_zip_find_file(&zip, "lie.bin", &file) != PAS_ZIP_OK || file.uncompressed_size != 4000) return 0;
+    n = pas_zip_read_at(&file, NULL, 0, buf, sizeof(buf), NULL, 0, &st);
+    return n == 0 && st == PAS_ZIP_E_INVALID;
+}
+
+int main(void) {
+    static const size_t offsets[] = { 0, 1, 4095, 65535, 65536, 300001, 524288, PLAIN_SIZE - 100, PLAIN_SIZE - 1 };
+    pas_zip_writer_t w;
+    mem_sink m;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    pas_zip_access_t ax;
+    pas_zip_status st;
+    unsigned char buf[16];
+    uint32_t x = 12345;
+    size_t i, n;
+    int ok;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    /* compressible but not trivially so */
+    for (i = 0; i < PLAIN_SIZE; i++) {
+        x = x * 1103515245u + 12345u;
+        g_plain[i] = (unsigned char)("abcdefgh"[(x >> 16) & 7] + (i >> 15));
+    }
+
+    m.buf = g_zip; m.cap = sizeof(g_zip); m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "plain.bin", g_plain, PLAIN_SIZE, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_OK);
+#if defined(PAS_ZIP_HAS_INFLATE)
+    ASSERT_EQ(pas_zip_writer_add(&w, "packed.bin", g_plain, PLAIN_SIZE, PAS_ZIP_METHOD_DEFLATE,
+                                 g_deflate_work, sizeof(g_deflate_work)), PAS_ZIP_OK);
+#endif
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, m.len), PAS_ZIP_OK);
+
+    /* Store: direct slices, clamped at the end of the entry */
+    ASSERT_EQ(pas_zip_find_file(&zip, "plain.bin", &file), PAS_ZIP_OK);
+    ok = 1;
+    for (i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) ok &= range_ok(&file, NULL, offsets[i], 4000);
+    ASSERT(ok);
+    n = pas_zip_read_at(&file, NULL, PLAIN_SIZE, buf, sizeof(buf), NULL, 0, &st);
+    ASSERT(st == PAS_ZIP_OK);
+    ASSERT_EQ(n, 0u);
+    n = pas_zip_read_at(&file, NULL, PLAIN_SIZE + 1, buf, sizeof(buf), NULL, 0, &st);
+    ASSERT(st == PAS_ZIP_E_INVALID);
+    ASSERT(lying_store_rejected());
+    ASSERT_EQ(pas_zip_access_build(&ax, &file, SPAN, g_points, sizeof(g_points), NULL, 0),
+#if defined(PAS_ZIP_USE_ZLIB)
+              PAS_ZIP_E_INVALID
+#else
+              PAS_ZIP_E_COMPRESSED
+#endif
+    );
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+    ASSERT_EQ(pas_zip_find_file(&zip, "packed.bin", &file), PAS_ZIP_OK);
+    ASSERT(file.compressed_size < PLAIN_SIZE);
+
+    /* without an index: inflate from the start */
+    ok = 1;
+    for (i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) ok &= range_ok(&file, NULL, offsets[i], 4000);
+    ASSERT(ok);
+
+    ASSERT(pas_zip_access_size(&file, SPAN) <= sizeof(g_points));
+#if defined(PAS_ZIP_USE_ZLIB)
+    ASSERT_EQ(pas_zip_access_build(&ax, &file, SPAN, g_points, sizeof(g_points), g_work, sizeof(g_work)), PAS_ZIP_OK);
+    ASSERT(ax.count > 4);
+    ok = 1;
+    for (i = 1; i < ax.count; i++) {
+        if (ax.points[i].out < ax.points[i - 1].out + SPAN) ok = 0;
+        if (ax.points[i].window_len != PAS_ZIP_WINDOW_SIZE) ok = 0;
+    }
+    ASSERT(ok);
+
+    /* with the index: resume at an access point, across point boundaries too */
+    ok = 1;
+    for (i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) ok &= range_ok(&file, &ax, offsets[i], 4000);
+    for (i = 1; i < ax.count; i++) {
+        ok &= range_ok(&file, &ax, (size_t)ax.points[i].out, 16);
+        ok &= range_ok(&file, &ax, (size_t)ax.points[i].out - 7, 4000);
+    }
+    ASSERT(ok);
+
+    /* index too small for the span */
+    ASSERT_EQ(pas_zip_access_build(&ax, &file, SPAN, g_points, 2 * sizeof(g_points[0]), NULL, 0), PAS_ZIP_E_NOSPACE);
+    ASSERT_EQ(ax.count, 0u);
+#else
+    ASSERT_EQ(pas_zip_access_build(&ax, &file, SPAN, g_points, sizeof(g_points), NULL, 0), PAS_ZIP_E_COMPRESSED);
+#endif
+#else
+    (void)printf("(deflate part skipped: no PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB)\n");
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+    test_reader.c - Test pas_zip_reader_* incremental extraction and gzip inflation.
+    From repo root: gcc -o tests/pas_zip/test_reader tests/pas_zip/test_reader.c -I.
+    Deflate part: add -DPAS_ZIP_USE_ZLIB -lz (or -DPAS_ZIP_USE_MINIZ with miniz).
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define PLAIN_SIZE (1u << 20)
+
+static unsigned char g_plain[PLAIN_SIZE];
+static unsigned char g_zip[PLAIN_SIZE + 4096];
+static unsigned char g_work[PAS_ZIP_INFLATE_WORK_SIZE];
+
+static void put16(unsigned char *p, unsigned v) { p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+static void put32(unsigned char *p, unsigned long v) { put16(p, (unsigned)(v & 0xFFFF)); put16(p + 2, (unsigned)(v >> 16)); }
+
+/* One-entry archive around an already-encoded payload. */
+static size_t build_zip(unsigned char *buf, const char *name, unsigned method,
+                        const unsigned char *payload, size_t comp_len, size_t plain_len) {
+    size_t w = 0, fn_len = strlen(name), cd_off;
+
+    memset(buf, 0, 30);
+    put32(buf, 0x04034b50UL); put16(buf + 4, 20); put16(buf + 8, method);
+    put32(buf + 18, (unsigned long)comp_len); put32(buf + 22, (unsigned long)plain_len);
+    put16(buf + 26, (unsigned)fn_len);
+    w = 30;
+    memcpy(buf + w, name, fn_len); w += fn_len;
+    memmove(buf + w, payload, comp_len); w += comp_len;
+
+    cd_off = w;
+    memset(buf + w, 0, 46);
+    put32(buf + w, 0x02014b50UL); put16(buf + w + 4, 20); put16(buf + w + 6, 20);
+    put16(buf + w + 10, method);
+    put32(buf + w + 20, (unsigned long)comp_len); put32(buf + w + 24, (unsigned long)plain_len);
+    put16(buf + w + 28, (unsigned)fn_len);
+    w += 46;
+    memcpy(buf + w, name, fn_len); w += fn_len;
+
+    memset(buf + w, 0, 22);
+    put32(buf + w, 0x06054b50UL); put16(buf + w + 8, 1); put16(buf + w + 10, 1);
+    put32(buf + w + 12, (unsigned long)(w - cd_off)); put32(buf + w + 16, (unsigned long)cd_off);
+    return w + 22;
+}
+
+/* Reads the whole entry in chunk-sized pieces and compares with g_plain. */
+static int read_all(const pas_zip_file_t *file, size_t chunk, size_t *total) {
+    pas_zip_reader_t r;
+    unsigned char buf[4096];
+    pas_zip_status st;
+    size_t n;
+    int ok = 1;
+
+    *total = 0;
+    if (pas_zip_reader_open(&r, file, g_work, sizeof(g_work)) != PAS_ZIP_OK) return 0;
+    for (;;) {
+        n = pas_zip_reader_read(&r, buf, chunk, &st);
+        if (st != PAS_ZIP_OK) { ok = 0; break; }
+        if (n == 0) break;
+        if (*total + n > PLAIN_SIZE || memcmp(buf, g_plain + *total, n) != 0) ok = 0;
+        *total += n;
+    }
+    pas_zip_reader_close(&r);
+    return ok;
+}
+
+static void test_store(void) {
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    size_t zip_len, total;
+
+    zip_len = build_zip(g_zip, "plain.bin", PAS_ZIP_METHOD_STORE, g_plain, PLAIN_SIZE, PLAIN_SIZE);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, zip_len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "plain.bin", &file), PAS_ZIP_OK);
+
+    ASSERT(read_all(&file, 4096, &total));
+    ASSERT_EQ(total, (size_t)PLAIN_SIZE);
+    ASSERT(read_all(&file, 1000, &total));
+    ASSERT_EQ(total, (size_t)PLAIN_SIZE);
+}
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+static size_t deflate_into(unsigned char *dst, size_t cap, int window_bits) {
+    z_stream zs;
+    size_t out;
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, 6, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) return 0;
+    zs.next_in = g_plain;
+    zs.avail_in = PLAIN_SIZE;
+    zs.next_out = dst;
+    zs.avail_out = (unsigned)cap;
+    if (deflate(&zs, Z_FINISH) != Z_STREAM_END) { deflateEnd(&zs); return 0; }
+    out = (size_t)zs.total_out;
+    deflateEnd(&zs);
+    return out;
+}
+
+static void test_deflate(void) {
+    static unsigned char comp[PLAIN_SIZE];
+    static unsigned char full[PLAIN_SIZE];
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    pas_zip_reader_t r;
+    pas_zip_status st;
+    size_t comp_len, zip_len, total, n;
+    unsigned char small_work[1024];
+
+    /* raw deflate, as real ZIP writers emit it */
+    comp_len = deflate_into(comp, sizeof(comp), -15);
+    ASSERT(comp_len > 0 && comp_len < PLAIN_SIZE);
+    zip_len = build_zip(g_zip, "packed.bin", PAS_ZIP_METHOD_DEFLATE, comp, comp_len, PLAIN_SIZE);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, zip_len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "packed.bin", &file), PAS_ZIP_OK);
+
+    ASSERT(read_all(&file, 4096, &total));
+    ASSERT_EQ(total, (size_t)PLAIN_SIZE);
+    ASSERT(read_all(&file, 7, &total));
+    ASSERT_EQ(total, (size_t)PLAIN_SIZE);
+
+    n = pas_zip_extract(&file, full, sizeof(full), &st);
+    ASSERT_EQ(st, PAS_ZIP_OK);
+    ASSERT_EQ(n, (size_t)PLAIN_SIZE);
+    ASSERT(memcmp(full, g_plain, PLAIN_SIZE) == 0);
+
+    /* work area too small for the inflate state */
+    ASSERT_EQ(pas_zip_reader_open(&r, &file, small_work, sizeof(small_work)), PAS_ZIP_OK);
+    n = pas_zip_reader_read(&r, full, 4096, &st);
+    ASSERT_EQ(n, 0u);
+    ASSERT_EQ(st, PAS_ZIP_E_NOSPACE);
+    pas_zip_reader_close(&r);
+
+    /* zlib-wrapped payloads are detected too */
+    comp_len = deflate_into(comp, sizeof(comp), 15);
+    ASSERT(comp_len > 0);
+    zip_len = build_zip(g_zip, "wrapped.bin", PAS_ZIP_METHOD_DEFLATE, comp, comp_len, PLAIN_SIZE);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, zip_len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "wrapped.bin", &file), PAS_ZIP_OK);
+    ASSERT(read_all(&file, 4096, &total));
+    ASSERT_EQ(total, (size_t)PLAIN_SIZE);
+
+    /* truncated payload is an error, not a silent short read */
+    zip_len = build_zip(g_zip, "cut.bin", PAS_ZIP_METHOD_DEFLATE, comp, comp_len / 2, PLAIN_SIZE);
+    ASSERT_EQ(pas_zip_init(&zip, g_zip, zip_len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "cut.bin", &file), PAS_ZIP_OK);
+    ASSERT(!read_all(&file, 4096, &total));
+}
+
+/* Inflates a whole gzip member feeding in_step input bytes at a time; returns the output length. */
+static size_t gunzip(const unsigned char *in, size_t in_len, size_t in_step, unsigned char *out, size_t out_cap,
+                     pas_zip_status *st) {
+    pas_zip_inflater_t inf;
+    size_t pos = 0, total = 0;
+    int done = 0;
+
+    *st = pas_zip_inflate_init(&inf, PAS_ZIP_INFLATE_GZIP, g_work, sizeof(g_work));
+    while (*st == PAS_ZIP_OK && !done) {
+        size_t step = in_len - pos < in_step ? in_len - pos : in_step, used = 0;
+        size_t n = pas_zip_inflate(&inf, in + pos, step, &used, out + total, out_cap - total, &done, st);
+        if (!n && !used && !done) {
+            if (*st == PAS_ZIP_OK) *st = PAS_ZIP_E_INVALID;   /* truncated */
+            break;
+        }
+        pos += used;
+        total += n;
+    }
+    pas_zip_inflate_end(&inf);
+    return total;
+}
+
+static void test_gzip(void) {
+    static const unsigned char header[] = {
+        0x1f, 0x8b, 8, 0x1e, 0, 0, 0, 0, 0, 3,   /* FHCRC | FEXTRA | FNAME | FCOMMENT */
+        3, 0, 'x', 'y', 'z',
+        'a', '.', 'b', 'i', 'n', 0,
+        'h', 'i', 0,
+        0x12, 0x34
+    };
+    static unsigned char comp[PLAIN_SIZE];
+    static unsigned char full[PLAIN_SIZE];
+    pas_zip_status st;
+    size_t comp_len, raw_len, n;
+    uint32_t crc;
+
+    comp_len = deflate_into(comp, sizeof(comp), 31);
+    ASSERT(comp_len > 18 && comp[0] == 0x1f);
+    n = gunzip(comp, comp_len, comp_len, full, sizeof(full), &st);
+    ASSERT_EQ(st, PAS_ZIP_OK);
+    ASSERT(n == PLAIN_SIZE && memcmp(full, g_plain, PLAIN_SIZE) == 0);
+    n = gunzip(comp, comp_len, 1, full, sizeof(full), &st);
+    ASSERT(st == PAS_ZIP_OK && n == PLAIN_SIZE);
+
+    /* every optional header field, split byte by byte */
+    raw_len = deflate_into(comp + sizeof(header), sizeof(comp) - sizeof(header) - 8, -15);
+    memcpy(comp, header, sizeof(header));
+    crc = pas_zip_crc32(0, g_plain, PLAIN_SIZE);
+    put32(comp + sizeof(header) + raw_len, crc);
+    put32(comp + sizeof(header) + raw_len + 4, PLAIN_SIZE);
+    comp_len = sizeof(header) + raw_len + 8;
+    n = gunzip(comp, comp_len, 1, full, sizeof(full), &st);
+    ASSERT(st == PAS_ZIP_OK && n == PLAIN_SIZE && memcmp(full, g_plain, PLAIN_SIZE) == 0);
+
+    /* trailer mismatch, truncation and a bad magic are errors */
+    put32(comp + sizeof(header) + raw_len, crc ^ 1);
+    (void)gunzip(comp, comp_len, 4096, full, sizeof(full), &st);
+    ASSERT_EQ(st, PAS_ZIP_E_ZLIB);
+    put32(comp + sizeof(header) + raw_len, crc);
+    (void)gunzip(comp, comp_len - 3, 4096, full, sizeof(full), &st);
+    ASSERT_EQ(st, PAS_ZIP_E_INVALID);
+    comp[1] = 0x8c;
+    (void)gunzip(comp, comp_len, 4096, full, sizeof(full), &st);
+    ASSERT_EQ(st, PAS_ZIP_E_ZLIB);
+}
+#endif
+
+int main(void) {
+    size_t i;
+    uint32_t x = 12345;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    /* compressible but not trivial */
+    for (i = 0; i < PLAIN_SIZE; i++) {
+        x = x * 1103515245u + 12345u;
+        g_plain[i] = (unsigned char)("abcdefgh"[(x >> 16) & 7] + ((i / 4096) & 3));
+    }
+
+    test_store();
+#if defined(PAS_ZIP_HAS_INFLATE)
+    test_deflate();
+    test_gzip();
+#else
+    (void)printf("(deflate part skipped: no PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB)\n");
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
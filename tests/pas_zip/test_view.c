@@ -0,0 +1,78 @@
+/*
+    test_view.c - Test pas_zip_view (zero-copy Store access).
+    From repo root: gcc -o tests/pas_zip/test_view tests/pas_zip/test_view.c -I.
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+int main(void) {
+    unsigned char zip_buf[1024];
+    size_t written;
+    pas_zip_status status;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    const unsigned char *view;
+    size_t size;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    written = pas_zip_create(
+        (const char *[]){ "blob.bin", "empty" },
+        (const void *[]){ "0123456789", "" },
+        (size_t[]){ 10, 0 },
+        2, zip_buf, sizeof(zip_buf), &status
+    );
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_init(&zip, zip_buf, written), PAS_ZIP_OK);
+
+    ASSERT_EQ(pas_zip_find_file(&zip, "blob.bin", &file), PAS_ZIP_OK);
+    view = (const unsigned char *)pas_zip_view(&file, &size, &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(size, 10u);
+    ASSERT(view != NULL);
+    /* points straight into the archive, no copy */
+    ASSERT(view > zip_buf && view + size <= zip_buf + written);
+    ASSERT(memcmp(view, "0123456789", 10) == 0);
+
+    ASSERT_EQ(pas_zip_find_file(&zip, "empty", &file), PAS_ZIP_OK);
+    view = (const unsigned char *)pas_zip_view(&file, &size, &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT(view != NULL);
+    ASSERT_EQ(size, 0u);
+
+    /* a Deflate entry cannot be viewed */
+    ASSERT_EQ(pas_zip_find_file(&zip, "blob.bin", &file), PAS_ZIP_OK);
+    file.compression_method = PAS_ZIP_METHOD_DEFLATE;
+    view = (const unsigned char *)pas_zip_view(&file, &size, &status);
+    ASSERT(view == NULL);
+    ASSERT_EQ(status, PAS_ZIP_E_COMPRESSED);
+
+    /* a corrupt local header is rejected */
+    ASSERT_EQ(pas_zip_find_file(&zip, "blob.bin", &file), PAS_ZIP_OK);
+    zip_buf[0] = 'X';
+    view = (const unsigned char *)pas_zip_view(&file, &size, &status);
+    ASSERT(view == NULL);
+    ASSERT_EQ(status, PAS_ZIP_E_INVALID);
+
+    ASSERT(pas_zip_view(NULL, &size, &status) == NULL);
+    ASSERT_EQ(status, PAS_ZIP_E_INVALID);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
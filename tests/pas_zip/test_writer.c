@@ -0,0 +1,165 @@
+/*
+    test_writer.c - Test pas_zip_writer_* streaming archive creation and pas_zip_crc32.
+    From repo root: gcc -o tests/pas_zip/test_writer tests/pas_zip/test_writer.c -I.
+    Deflate part: add -DPAS_ZIP_USE_ZLIB -lz (or -DPAS_ZIP_USE_MINIZ with miniz).
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define PLAIN_SIZE (256u * 1024u)
+
+typedef struct {
+    unsigned char *buf;
+    size_t         cap;
+    size_t         len;
+} mem_sink;
+
+static unsigned char g_plain[PLAIN_SIZE];
+static unsigned char g_out[PLAIN_SIZE * 2 + 4096];
+static unsigned char g_check[PLAIN_SIZE];
+static unsigned char g_cd[1024];
+static unsigned char g_work[PAS_ZIP_DEFLATE_WORK_SIZE];
+
+static size_t sink_mem(void *user, const void *data, size_t size) {
+    mem_sink *m = (mem_sink *)user;
+    if (size > m->cap - m->len) size = m->cap - m->len;
+    memcpy(m->buf + m->len, data, size);
+    m->len += size;
+    return size;
+}
+
+/* Writes entry name in pieces of chunk bytes. */
+static pas_zip_status add_chunked(pas_zip_writer_t *w, const char *name, int method, size_t chunk) {
+    size_t off = 0;
+    pas_zip_status st = pas_zip_writer_entry_begin(w, name, method, g_work, sizeof(g_work));
+
+    while (st == PAS_ZIP_OK && off < PLAIN_SIZE) {
+        size_t n = PLAIN_SIZE - off < chunk ? PLAIN_SIZE - off : chunk;
+        st = pas_zip_writer_entry_write(w, g_plain + off, n);
+        off += n;
+    }
+    if (st == PAS_ZIP_OK) st = pas_zip_writer_entry_end(w);
+    return st;
+}
+
+int main(void) {
+    pas_zip_writer_t w;
+    mem_sink m;
+    pas_zip_status status;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    size_t i, n;
+    uint32_t crc;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    for (i = 0; i < PLAIN_SIZE; i++) g_plain[i] = (unsigned char)((i * 7) ^ (i >> 9));
+
+    /* CRC-32 check value, and chunking does not change the result */
+    ASSERT_EQ(pas_zip_crc32(0, "123456789", 9), 0xCBF43926u);
+    ASSERT_EQ(pas_zip_crc32(0, NULL, 0), 0u);
+    crc = pas_zip_crc32(0, "1234", 4);
+    ASSERT_EQ(pas_zip_crc32(crc, "56789", 5), 0xCBF43926u);
+
+    /* Store entries streamed in odd-sized chunks */
+    m.buf = g_out; m.cap = sizeof(g_out); m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(add_chunked(&w, "big.bin", PAS_ZIP_METHOD_STORE, 1000), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "hello.txt", "Hello", 5, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "empty", NULL, 0, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_OK);
+    ASSERT_EQ(w.offset, (uint64_t)m.len);
+    ASSERT_EQ(w.count, 3u);
+
+    ASSERT_EQ(pas_zip_init(&zip, g_out, m.len), PAS_ZIP_OK);
+    ASSERT_EQ(zip.num_entries, 3u);
+    ASSERT_EQ(pas_zip_find_file(&zip, "big.bin", &file), PAS_ZIP_OK);
+    ASSERT_EQ(file.crc, pas_zip_crc32(0, g_plain, PLAIN_SIZE));
+    n = pas_zip_extract(&file, g_check, sizeof(g_check), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, PLAIN_SIZE);
+    ASSERT(memcmp(g_check, g_plain, PLAIN_SIZE) == 0);
+    ASSERT_EQ(pas_zip_find_file(&zip, "hello.txt", &file), PAS_ZIP_OK);
+    ASSERT_EQ(file.crc, 0xF7D18982u);
+    ASSERT_EQ(pas_zip_find_file(&zip, "empty", &file), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_size(&file), 0u);
+
+    /* pas_zip_create fills in the CRC too */
+    n = pas_zip_create((const char *[]){ "a" }, (const void *[]){ "Hello" }, (size_t[]){ 5 },
+                       1, g_out, sizeof(g_out), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_init(&zip, g_out, n), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "a", &file), PAS_ZIP_OK);
+    ASSERT_EQ(file.crc, 0xF7D18982u);
+
+    /* central directory buffer too small: sticky NOSPACE */
+    m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, PAS_ZIP_WRITER_CD_SIZE(1)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "a", "x", 1, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "b", "y", 1, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_E_NOSPACE);
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_E_NOSPACE);
+
+    /* sink that runs out of room */
+    m.cap = 70; m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "hello.txt", "Hello", 5, PAS_ZIP_METHOD_STORE, NULL, 0), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_E_WRITE);
+    m.cap = sizeof(g_out);
+
+    /* misuse */
+    ASSERT_EQ(pas_zip_writer_begin(&w, NULL, NULL, g_cd, sizeof(g_cd)), PAS_ZIP_E_INVALID);
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_entry_write(&w, "x", 1), PAS_ZIP_E_INVALID);
+
+#if defined(PAS_ZIP_HAS_INFLATE)
+    /* Deflate entries compress, and read back through the reader side */
+    m.len = 0;
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(add_chunked(&w, "big.z", PAS_ZIP_METHOD_DEFLATE, 777), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_add(&w, "tiny.z", "Hello", 5, PAS_ZIP_METHOD_DEFLATE, NULL, 0), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_finish(&w), PAS_ZIP_OK);
+
+    ASSERT_EQ(pas_zip_init(&zip, g_out, m.len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "big.z", &file), PAS_ZIP_OK);
+    ASSERT(pas_zip_is_compressed(&file));
+    ASSERT(file.compressed_size < PLAIN_SIZE);
+    ASSERT_EQ(file.crc, pas_zip_crc32(0, g_plain, PLAIN_SIZE));
+    memset(g_check, 0, sizeof(g_check));
+    n = pas_zip_extract(&file, g_check, sizeof(g_check), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, PLAIN_SIZE);
+    ASSERT(memcmp(g_check, g_plain, PLAIN_SIZE) == 0);
+    ASSERT_EQ(pas_zip_find_file(&zip, "tiny.z", &file), PAS_ZIP_OK);
+    n = pas_zip_extract(&file, g_check, sizeof(g_check), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, 5u);
+    ASSERT(memcmp(g_check, "Hello", 5) == 0);
+
+    /* compressor state must fit the documented work size */
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_entry_begin(&w, "x", PAS_ZIP_METHOD_DEFLATE, g_work, 1024), PAS_ZIP_E_NOSPACE);
+#else
+    ASSERT_EQ(pas_zip_writer_begin(&w, sink_mem, &m, g_cd, sizeof(g_cd)), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_writer_entry_begin(&w, "x", PAS_ZIP_METHOD_DEFLATE, NULL, 0), PAS_ZIP_E_COMPRESSED);
+    (void)printf("(deflate part skipped: no PAS_ZIP_USE_MINIZ / PAS_ZIP_USE_ZLIB)\n");
+#endif
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}
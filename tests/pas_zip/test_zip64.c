@@ -0,0 +1,147 @@
+/*
+    test_zip64.c - Test ZIP64 end records and extra fields.
+    From repo root: gcc -o tests/pas_zip/test_zip64 tests/pas_zip/test_zip64.c -I.
+*/
+
+#define PAS_ZIP_IMPLEMENTATION
+#include "pas_zip.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_failed, g_assertions;
+
+#define ASSERT(cond) do { \
+    ++g_assertions; \
+    if (!(cond)) { (void)fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); ++g_failed; } \
+} while (0)
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+
+#define MANY 70000
+
+static unsigned char g_big[8u << 20];
+static char g_names[MANY][8];
+static const char *g_name_ptrs[MANY];
+static const void *g_data_ptrs[MANY];
+static size_t g_sizes[MANY];
+static uint32_t g_index[1u << 19];
+
+static unsigned char *put16(unsigned char *p, unsigned v) {
+    p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8);
+    return p + 2;
+}
+
+static unsigned char *put32(unsigned char *p, unsigned long v) {
+    p = put16(p, (unsigned)(v & 0xFFFF));
+    return put16(p, (unsigned)((v >> 16) & 0xFFFF));
+}
+
+static unsigned char *put64(unsigned char *p, unsigned long long v) {
+    p = put32(p, (unsigned long)(v & 0xFFFFFFFFu));
+    return put32(p, (unsigned long)(v >> 32));
+}
+
+/* One Store entry whose CD sizes and offset live only in the ZIP64 extra. */
+static size_t build_extra_zip(unsigned char *buf) {
+    unsigned char *p = buf, *cd;
+
+    p = put32(p, 0x04034b50u); p = put16(p, 45); p = put16(p, 0); p = put16(p, 0);
+    p = put32(p, 0); p = put32(p, 0); p = put32(p, 5); p = put32(p, 5);
+    p = put16(p, 3); p = put16(p, 0);
+    memcpy(p, "big", 3); p += 3;
+    memcpy(p, "hello", 5); p += 5;
+
+    cd = p;
+    p = put32(p, 0x02014b50u); p = put16(p, 45); p = put16(p, 45); p = put16(p, 0);
+    p = put16(p, 0); p = put32(p, 0); p = put32(p, 0);
+    p = put32(p, 0xFFFFFFFFu); p = put32(p, 0xFFFFFFFFu);
+    p = put16(p, 3); p = put16(p, 28); p = put16(p, 0); p = put16(p, 0);
+    p = put16(p, 0); p = put32(p, 0); p = put32(p, 0xFFFFFFFFu);
+    memcpy(p, "big", 3); p += 3;
+    p = put16(p, 0x0001); p = put16(p, 24);
+    p = put64(p, 5); p = put64(p, 5); p = put64(p, 0);
+
+    p = put32(p, 0x06054b50u); p = put16(p, 0); p = put16(p, 0);
+    p = put16(p, 1); p = put16(p, 1);
+    p = put32(p, (unsigned long)(p - cd - 12)); p = put32(p, (unsigned long)(cd - buf));
+    p = put16(p, 0);
+    return (size_t)(p - buf);
+}
+
+int main(void) {
+    unsigned char small[256];
+    size_t len, n, i;
+    pas_zip_status status;
+    pas_zip_t zip;
+    pas_zip_file_t file;
+    const uint8_t *eocd;
+    char out[16];
+    int ok;
+
+    g_failed = 0;
+    g_assertions = 0;
+
+    /* more entries than a 16-bit EOCD count can hold */
+    for (i = 0; i < MANY; i++) {
+        (void)sprintf(g_names[i], "f%05u", (unsigned)i);
+        g_name_ptrs[i] = g_names[i];
+        g_data_ptrs[i] = &g_names[i][5];
+        g_sizes[i] = 1;
+    }
+    len = pas_zip_create(g_name_ptrs, g_data_ptrs, g_sizes, MANY, g_big, sizeof(g_big), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT(len > 0);
+
+    eocd = g_big + len - 22;
+    ASSERT_EQ(read_u32_le(eocd), PAS_ZIP_EOCD_SIG);
+    ASSERT_EQ(read_u16_le(eocd + 10), 0xFFFFu);
+    ASSERT_EQ(read_u32_le(eocd - 20), PAS_ZIP_LOC64_SIG);
+    ASSERT_EQ(read_u32_le(eocd - 20 - 56), PAS_ZIP_EOCD64_SIG);
+
+    ASSERT_EQ(pas_zip_init(&zip, g_big, len), PAS_ZIP_OK);
+    ASSERT_EQ(zip.num_entries, (uint64_t)MANY);
+
+    ASSERT_EQ(pas_zip_find_file(&zip, "f69999", &file), PAS_ZIP_OK);
+    n = pas_zip_extract(&file, out, sizeof(out), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, 1u);
+    ASSERT_EQ(out[0], '9');
+
+    ASSERT_EQ(pas_zip_index_size(&zip) <= sizeof(g_index), 1);
+    ASSERT_EQ(pas_zip_index_build(&zip, g_index, sizeof(g_index)), PAS_ZIP_OK);
+    ok = 1;
+    for (i = 0; i < MANY; i += 997) {
+        if (pas_zip_find_file(&zip, g_names[i], &file) != PAS_ZIP_OK ||
+            pas_zip_extract(&file, out, sizeof(out), &status) != 1 ||
+            out[0] != g_names[i][5]) ok = 0;
+    }
+    ASSERT(ok);
+    ASSERT_EQ(pas_zip_find_file(&zip, "f70000", &file), PAS_ZIP_E_NOT_FOUND);
+
+    /* small archives keep the classic layout */
+    len = pas_zip_create((const char *[]){ "a" }, (const void *[]){ "x" }, (size_t[]){ 1 },
+                         1, small, sizeof(small), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(len, 30u + 2 + 46 + 1 + 22);
+
+    /* saturated CD fields resolved through the ZIP64 extra */
+    len = build_extra_zip(small);
+    ASSERT_EQ(pas_zip_init(&zip, small, len), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_find_file(&zip, "big", &file), PAS_ZIP_OK);
+    ASSERT_EQ(pas_zip_size(&file), 5u);
+    ASSERT_EQ(file.local_header_offset, 0u);
+    n = pas_zip_extract(&file, out, sizeof(out), &status);
+    ASSERT(status == PAS_ZIP_OK);
+    ASSERT_EQ(n, 5u);
+    ASSERT(memcmp(out, "hello", 5) == 0);
+
+    /* a saturated field without its extra is rejected */
+    small[len - 22 - 28 - 3 - 46 + 30] = 0;
+    ASSERT(pas_zip_find_file(&zip, "big", &file) != PAS_ZIP_OK);
+
+    if (g_failed) {
+        (void)fprintf(stderr, "Total: %d assertions, %d failed\n", g_assertions, g_failed);
+        return 1;
+    }
+    (void)printf("All %d assertions passed.\n", g_assertions);
+    return 0;
+}